@@ -0,0 +1,12 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/ChebyshevTest.dir/ChebyshevTest.cpp.o"
+  "CMakeFiles/ChebyshevTest.dir/ChebyshevTest.cpp.o.d"
+  "ChebyshevTest"
+  "ChebyshevTest.cpp"
+  "ChebyshevTest.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/ChebyshevTest.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,12 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/IDSearchTest.dir/IDSearchTest.cpp.o"
+  "CMakeFiles/IDSearchTest.dir/IDSearchTest.cpp.o.d"
+  "IDSearchTest"
+  "IDSearchTest.cpp"
+  "IDSearchTest.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/IDSearchTest.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,12 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/IteratorsTest.dir/IteratorsTest.cpp.o"
+  "CMakeFiles/IteratorsTest.dir/IteratorsTest.cpp.o.d"
+  "IteratorsTest"
+  "IteratorsTest.cpp"
+  "IteratorsTest.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/IteratorsTest.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,12 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/MetafunctionsTest.dir/MetafunctionsTest.cpp.o"
+  "CMakeFiles/MetafunctionsTest.dir/MetafunctionsTest.cpp.o.d"
+  "MetafunctionsTest"
+  "MetafunctionsTest.cpp"
+  "MetafunctionsTest.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/MetafunctionsTest.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,12 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/OperatorsTest.dir/OperatorsTest.cpp.o"
+  "CMakeFiles/OperatorsTest.dir/OperatorsTest.cpp.o.d"
+  "OperatorsTest"
+  "OperatorsTest.cpp"
+  "OperatorsTest.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/OperatorsTest.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,12 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/ParallelTest.dir/ParallelTest.cpp.o"
+  "CMakeFiles/ParallelTest.dir/ParallelTest.cpp.o.d"
+  "ParallelTest"
+  "ParallelTest.cpp"
+  "ParallelTest.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/ParallelTest.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
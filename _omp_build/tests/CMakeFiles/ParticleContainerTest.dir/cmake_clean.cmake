@@ -0,0 +1,12 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/ParticleContainerTest.dir/ParticleContainerTest.cpp.o"
+  "CMakeFiles/ParticleContainerTest.dir/ParticleContainerTest.cpp.o.d"
+  "ParticleContainerTest"
+  "ParticleContainerTest.cpp"
+  "ParticleContainerTest.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/ParticleContainerTest.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,12 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/SpatialDataStructuresTest.dir/SpatialDataStructuresTest.cpp.o"
+  "CMakeFiles/SpatialDataStructuresTest.dir/SpatialDataStructuresTest.cpp.o.d"
+  "SpatialDataStructuresTest"
+  "SpatialDataStructuresTest.cpp"
+  "SpatialDataStructuresTest.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/SpatialDataStructuresTest.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
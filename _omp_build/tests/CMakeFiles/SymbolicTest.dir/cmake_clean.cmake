@@ -0,0 +1,12 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/SymbolicTest.dir/SymbolicTest.cpp.o"
+  "CMakeFiles/SymbolicTest.dir/SymbolicTest.cpp.o.d"
+  "SymbolicTest"
+  "SymbolicTest.cpp"
+  "SymbolicTest.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/SymbolicTest.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,12 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/UtilsTest.dir/UtilsTest.cpp.o"
+  "CMakeFiles/UtilsTest.dir/UtilsTest.cpp.o.d"
+  "UtilsTest"
+  "UtilsTest.cpp"
+  "UtilsTest.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/UtilsTest.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,254 @@
+# CMake generated Testfile for 
+# Source directory: /root/repo/tests
+# Build directory: /root/repo/_omp_build/tests
+# 
+# This file includes the relevant testing commands required for 
+# testing this directory and lists subdirectories to be tested as well.
+add_test(MetafunctionsTest:__test_aliasing "/MetafunctionsTest" "MetafunctionsTest" "test_aliasing")
+set_tests_properties(MetafunctionsTest:__test_aliasing PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=1" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;376;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(MetafunctionsTest:__test_expr_matching "/MetafunctionsTest" "MetafunctionsTest" "test_expr_matching")
+set_tests_properties(MetafunctionsTest:__test_expr_matching PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=1" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;376;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(MetafunctionsTest:__test_get_labels "/MetafunctionsTest" "MetafunctionsTest" "test_get_labels")
+set_tests_properties(MetafunctionsTest:__test_get_labels PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=1" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;376;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(MetafunctionsTest:__test_thrust "/MetafunctionsTest" "MetafunctionsTest" "test_thrust")
+set_tests_properties(MetafunctionsTest:__test_thrust PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=1" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;376;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(MetafunctionsTest__OpenMP:__test_aliasing "/MetafunctionsTest" "MetafunctionsTest" "test_aliasing")
+set_tests_properties(MetafunctionsTest__OpenMP:__test_aliasing PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=3" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;381;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(MetafunctionsTest__OpenMP:__test_expr_matching "/MetafunctionsTest" "MetafunctionsTest" "test_expr_matching")
+set_tests_properties(MetafunctionsTest__OpenMP:__test_expr_matching PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=3" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;381;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(MetafunctionsTest__OpenMP:__test_get_labels "/MetafunctionsTest" "MetafunctionsTest" "test_get_labels")
+set_tests_properties(MetafunctionsTest__OpenMP:__test_get_labels PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=3" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;381;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(MetafunctionsTest__OpenMP:__test_thrust "/MetafunctionsTest" "MetafunctionsTest" "test_thrust")
+set_tests_properties(MetafunctionsTest__OpenMP:__test_thrust PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=3" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;381;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(NeighboursTest:__test_std_vector_CellList "/NeighboursTest" "NeighboursTest" "test_std_vector_CellList")
+set_tests_properties(NeighboursTest:__test_std_vector_CellList PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=1" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;376;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(NeighboursTest:__test_std_vector_CellList_fast_bucketsearch "/NeighboursTest" "NeighboursTest" "test_std_vector_CellList_fast_bucketsearch")
+set_tests_properties(NeighboursTest:__test_std_vector_CellList_fast_bucketsearch PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=1" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;376;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(NeighboursTest:__test_std_vector_CellListOrdered "/NeighboursTest" "NeighboursTest" "test_std_vector_CellListOrdered")
+set_tests_properties(NeighboursTest:__test_std_vector_CellListOrdered PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=1" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;376;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(NeighboursTest:__test_std_vector_CellListOrdered_fast_bucketsearch "/NeighboursTest" "NeighboursTest" "test_std_vector_CellListOrdered_fast_bucketsearch")
+set_tests_properties(NeighboursTest:__test_std_vector_CellListOrdered_fast_bucketsearch PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=1" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;376;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(NeighboursTest:__test_std_vector_HashedCellList "/NeighboursTest" "NeighboursTest" "test_std_vector_HashedCellList")
+set_tests_properties(NeighboursTest:__test_std_vector_HashedCellList PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=1" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;376;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(NeighboursTest:__test_std_vector_CellListMultiLevel "/NeighboursTest" "NeighboursTest" "test_std_vector_CellListMultiLevel")
+set_tests_properties(NeighboursTest:__test_std_vector_CellListMultiLevel PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=1" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;376;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(NeighboursTest:__test_std_vector_Kdtree "/NeighboursTest" "NeighboursTest" "test_std_vector_Kdtree")
+set_tests_properties(NeighboursTest:__test_std_vector_Kdtree PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=1" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;376;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(NeighboursTest:__test_std_vector_KdtreeNanoflann "/NeighboursTest" "NeighboursTest" "test_std_vector_KdtreeNanoflann")
+set_tests_properties(NeighboursTest:__test_std_vector_KdtreeNanoflann PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=1" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;376;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(NeighboursTest:__test_std_vector_HyperOctree "/NeighboursTest" "NeighboursTest" "test_std_vector_HyperOctree")
+set_tests_properties(NeighboursTest:__test_std_vector_HyperOctree PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=1" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;376;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(NeighboursTest:__test_documentation "/NeighboursTest" "NeighboursTest" "test_documentation")
+set_tests_properties(NeighboursTest:__test_documentation PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=1" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;376;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(NeighboursTest__OpenMP:__test_std_vector_CellList "/NeighboursTest" "NeighboursTest" "test_std_vector_CellList")
+set_tests_properties(NeighboursTest__OpenMP:__test_std_vector_CellList PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=3" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;381;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(NeighboursTest__OpenMP:__test_std_vector_CellList_fast_bucketsearch "/NeighboursTest" "NeighboursTest" "test_std_vector_CellList_fast_bucketsearch")
+set_tests_properties(NeighboursTest__OpenMP:__test_std_vector_CellList_fast_bucketsearch PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=3" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;381;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(NeighboursTest__OpenMP:__test_std_vector_CellListOrdered "/NeighboursTest" "NeighboursTest" "test_std_vector_CellListOrdered")
+set_tests_properties(NeighboursTest__OpenMP:__test_std_vector_CellListOrdered PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=3" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;381;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(NeighboursTest__OpenMP:__test_std_vector_CellListOrdered_fast_bucketsearch "/NeighboursTest" "NeighboursTest" "test_std_vector_CellListOrdered_fast_bucketsearch")
+set_tests_properties(NeighboursTest__OpenMP:__test_std_vector_CellListOrdered_fast_bucketsearch PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=3" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;381;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(NeighboursTest__OpenMP:__test_std_vector_HashedCellList "/NeighboursTest" "NeighboursTest" "test_std_vector_HashedCellList")
+set_tests_properties(NeighboursTest__OpenMP:__test_std_vector_HashedCellList PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=3" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;381;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(NeighboursTest__OpenMP:__test_std_vector_CellListMultiLevel "/NeighboursTest" "NeighboursTest" "test_std_vector_CellListMultiLevel")
+set_tests_properties(NeighboursTest__OpenMP:__test_std_vector_CellListMultiLevel PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=3" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;381;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(NeighboursTest__OpenMP:__test_std_vector_Kdtree "/NeighboursTest" "NeighboursTest" "test_std_vector_Kdtree")
+set_tests_properties(NeighboursTest__OpenMP:__test_std_vector_Kdtree PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=3" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;381;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(NeighboursTest__OpenMP:__test_std_vector_KdtreeNanoflann "/NeighboursTest" "NeighboursTest" "test_std_vector_KdtreeNanoflann")
+set_tests_properties(NeighboursTest__OpenMP:__test_std_vector_KdtreeNanoflann PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=3" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;381;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(NeighboursTest__OpenMP:__test_std_vector_HyperOctree "/NeighboursTest" "NeighboursTest" "test_std_vector_HyperOctree")
+set_tests_properties(NeighboursTest__OpenMP:__test_std_vector_HyperOctree PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=3" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;381;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(NeighboursTest__OpenMP:__test_documentation "/NeighboursTest" "NeighboursTest" "test_documentation")
+set_tests_properties(NeighboursTest__OpenMP:__test_documentation PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=3" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;381;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(SpatialDataStructuresTest:__test_documentation "/SpatialDataStructuresTest" "SpatialDataStructuresTest" "test_documentation")
+set_tests_properties(SpatialDataStructuresTest:__test_documentation PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=1" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;376;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(SpatialDataStructuresTest:__test_CellList "/SpatialDataStructuresTest" "SpatialDataStructuresTest" "test_CellList")
+set_tests_properties(SpatialDataStructuresTest:__test_CellList PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=1" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;376;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(SpatialDataStructuresTest:__test_CellListOrdered "/SpatialDataStructuresTest" "SpatialDataStructuresTest" "test_CellListOrdered")
+set_tests_properties(SpatialDataStructuresTest:__test_CellListOrdered PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=1" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;376;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(SpatialDataStructuresTest:__test_HyperOctree "/SpatialDataStructuresTest" "SpatialDataStructuresTest" "test_HyperOctree")
+set_tests_properties(SpatialDataStructuresTest:__test_HyperOctree PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=1" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;376;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(SpatialDataStructuresTest:__test_kdtree "/SpatialDataStructuresTest" "SpatialDataStructuresTest" "test_kdtree")
+set_tests_properties(SpatialDataStructuresTest:__test_kdtree PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=1" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;376;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(SpatialDataStructuresTest:__test_BoundingVolumeHierarchy "/SpatialDataStructuresTest" "SpatialDataStructuresTest" "test_BoundingVolumeHierarchy")
+set_tests_properties(SpatialDataStructuresTest:__test_BoundingVolumeHierarchy PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=1" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;376;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(SpatialDataStructuresTest__OpenMP:__test_documentation "/SpatialDataStructuresTest" "SpatialDataStructuresTest" "test_documentation")
+set_tests_properties(SpatialDataStructuresTest__OpenMP:__test_documentation PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=3" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;381;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(SpatialDataStructuresTest__OpenMP:__test_CellList "/SpatialDataStructuresTest" "SpatialDataStructuresTest" "test_CellList")
+set_tests_properties(SpatialDataStructuresTest__OpenMP:__test_CellList PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=3" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;381;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(SpatialDataStructuresTest__OpenMP:__test_CellListOrdered "/SpatialDataStructuresTest" "SpatialDataStructuresTest" "test_CellListOrdered")
+set_tests_properties(SpatialDataStructuresTest__OpenMP:__test_CellListOrdered PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=3" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;381;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(SpatialDataStructuresTest__OpenMP:__test_HyperOctree "/SpatialDataStructuresTest" "SpatialDataStructuresTest" "test_HyperOctree")
+set_tests_properties(SpatialDataStructuresTest__OpenMP:__test_HyperOctree PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=3" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;381;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(SpatialDataStructuresTest__OpenMP:__test_kdtree "/SpatialDataStructuresTest" "SpatialDataStructuresTest" "test_kdtree")
+set_tests_properties(SpatialDataStructuresTest__OpenMP:__test_kdtree PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=3" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;381;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(SpatialDataStructuresTest__OpenMP:__test_BoundingVolumeHierarchy "/SpatialDataStructuresTest" "SpatialDataStructuresTest" "test_BoundingVolumeHierarchy")
+set_tests_properties(SpatialDataStructuresTest__OpenMP:__test_BoundingVolumeHierarchy PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=3" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;381;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(IDSearchTest:__test_std_vector_CellList "/IDSearchTest" "IDSearchTest" "test_std_vector_CellList")
+set_tests_properties(IDSearchTest:__test_std_vector_CellList PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=1" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;376;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(IDSearchTest:__test_std_vector_CellListOrdered "/IDSearchTest" "IDSearchTest" "test_std_vector_CellListOrdered")
+set_tests_properties(IDSearchTest:__test_std_vector_CellListOrdered PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=1" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;376;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(IDSearchTest:__test_std_vector_HashedCellList "/IDSearchTest" "IDSearchTest" "test_std_vector_HashedCellList")
+set_tests_properties(IDSearchTest:__test_std_vector_HashedCellList PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=1" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;376;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(IDSearchTest:__test_std_vector_Kdtree "/IDSearchTest" "IDSearchTest" "test_std_vector_Kdtree")
+set_tests_properties(IDSearchTest:__test_std_vector_Kdtree PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=1" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;376;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(IDSearchTest:__test_std_vector_HyperOctree "/IDSearchTest" "IDSearchTest" "test_std_vector_HyperOctree")
+set_tests_properties(IDSearchTest:__test_std_vector_HyperOctree PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=1" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;376;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(IDSearchTest:__test_documentation "/IDSearchTest" "IDSearchTest" "test_documentation")
+set_tests_properties(IDSearchTest:__test_documentation PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=1" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;376;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(IDSearchTest__OpenMP:__test_std_vector_CellList "/IDSearchTest" "IDSearchTest" "test_std_vector_CellList")
+set_tests_properties(IDSearchTest__OpenMP:__test_std_vector_CellList PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=3" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;381;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(IDSearchTest__OpenMP:__test_std_vector_CellListOrdered "/IDSearchTest" "IDSearchTest" "test_std_vector_CellListOrdered")
+set_tests_properties(IDSearchTest__OpenMP:__test_std_vector_CellListOrdered PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=3" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;381;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(IDSearchTest__OpenMP:__test_std_vector_HashedCellList "/IDSearchTest" "IDSearchTest" "test_std_vector_HashedCellList")
+set_tests_properties(IDSearchTest__OpenMP:__test_std_vector_HashedCellList PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=3" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;381;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(IDSearchTest__OpenMP:__test_std_vector_Kdtree "/IDSearchTest" "IDSearchTest" "test_std_vector_Kdtree")
+set_tests_properties(IDSearchTest__OpenMP:__test_std_vector_Kdtree PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=3" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;381;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(IDSearchTest__OpenMP:__test_std_vector_HyperOctree "/IDSearchTest" "IDSearchTest" "test_std_vector_HyperOctree")
+set_tests_properties(IDSearchTest__OpenMP:__test_std_vector_HyperOctree PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=3" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;381;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(IDSearchTest__OpenMP:__test_documentation "/IDSearchTest" "IDSearchTest" "test_documentation")
+set_tests_properties(IDSearchTest__OpenMP:__test_documentation PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=3" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;381;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(ParticleContainerTest:__test_std_vector_CellList "/ParticleContainerTest" "ParticleContainerTest" "test_std_vector_CellList")
+set_tests_properties(ParticleContainerTest:__test_std_vector_CellList PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=1" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;376;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(ParticleContainerTest:__test_std_vector_CellListOrdered "/ParticleContainerTest" "ParticleContainerTest" "test_std_vector_CellListOrdered")
+set_tests_properties(ParticleContainerTest:__test_std_vector_CellListOrdered PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=1" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;376;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(ParticleContainerTest:__test_documentation "/ParticleContainerTest" "ParticleContainerTest" "test_documentation")
+set_tests_properties(ParticleContainerTest:__test_documentation PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=1" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;376;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(ParticleContainerTest__OpenMP:__test_std_vector_CellList "/ParticleContainerTest" "ParticleContainerTest" "test_std_vector_CellList")
+set_tests_properties(ParticleContainerTest__OpenMP:__test_std_vector_CellList PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=3" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;381;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(ParticleContainerTest__OpenMP:__test_std_vector_CellListOrdered "/ParticleContainerTest" "ParticleContainerTest" "test_std_vector_CellListOrdered")
+set_tests_properties(ParticleContainerTest__OpenMP:__test_std_vector_CellListOrdered PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=3" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;381;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(ParticleContainerTest__OpenMP:__test_documentation "/ParticleContainerTest" "ParticleContainerTest" "test_documentation")
+set_tests_properties(ParticleContainerTest__OpenMP:__test_documentation PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=3" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;381;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(SymbolicTest:__test_default "/SymbolicTest" "SymbolicTest" "test_default")
+set_tests_properties(SymbolicTest:__test_default PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=1" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;376;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(SymbolicTest__OpenMP:__test_default "/SymbolicTest" "SymbolicTest" "test_default")
+set_tests_properties(SymbolicTest__OpenMP:__test_default PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=3" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;381;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(VariablesTest:__test_std_vector "/VariablesTest" "VariablesTest" "test_std_vector")
+set_tests_properties(VariablesTest:__test_std_vector PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=1" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;376;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(VariablesTest__OpenMP:__test_std_vector "/VariablesTest" "VariablesTest" "test_std_vector")
+set_tests_properties(VariablesTest__OpenMP:__test_std_vector PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=3" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;381;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(ConstructorsTest:__test_std_vector "/ConstructorsTest" "ConstructorsTest" "test_std_vector")
+set_tests_properties(ConstructorsTest:__test_std_vector PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=1" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;376;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(ConstructorsTest__OpenMP:__test_std_vector "/ConstructorsTest" "ConstructorsTest" "test_std_vector")
+set_tests_properties(ConstructorsTest__OpenMP:__test_std_vector PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=3" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;381;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(OperatorsTest:__test_dense_operator "/OperatorsTest" "OperatorsTest" "test_dense_operator")
+set_tests_properties(OperatorsTest:__test_dense_operator PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=1" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;376;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(OperatorsTest:__test_sparse_operator "/OperatorsTest" "OperatorsTest" "test_sparse_operator")
+set_tests_properties(OperatorsTest:__test_sparse_operator PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=1" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;376;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(OperatorsTest:__test_block_operator "/OperatorsTest" "OperatorsTest" "test_block_operator")
+set_tests_properties(OperatorsTest:__test_block_operator PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=1" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;376;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(OperatorsTest:__test_documentation "/OperatorsTest" "OperatorsTest" "test_documentation")
+set_tests_properties(OperatorsTest:__test_documentation PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=1" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;376;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(OperatorsTest__OpenMP:__test_dense_operator "/OperatorsTest" "OperatorsTest" "test_dense_operator")
+set_tests_properties(OperatorsTest__OpenMP:__test_dense_operator PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=3" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;381;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(OperatorsTest__OpenMP:__test_sparse_operator "/OperatorsTest" "OperatorsTest" "test_sparse_operator")
+set_tests_properties(OperatorsTest__OpenMP:__test_sparse_operator PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=3" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;381;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(OperatorsTest__OpenMP:__test_block_operator "/OperatorsTest" "OperatorsTest" "test_block_operator")
+set_tests_properties(OperatorsTest__OpenMP:__test_block_operator PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=3" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;381;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(OperatorsTest__OpenMP:__test_documentation "/OperatorsTest" "OperatorsTest" "test_documentation")
+set_tests_properties(OperatorsTest__OpenMP:__test_documentation PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=3" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;381;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(UtilsTest:__test_bucket_indicies "/UtilsTest" "UtilsTest" "test_bucket_indicies")
+set_tests_properties(UtilsTest:__test_bucket_indicies PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=1" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;376;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(UtilsTest:__test_point_to_bucket_indicies "/UtilsTest" "UtilsTest" "test_point_to_bucket_indicies")
+set_tests_properties(UtilsTest:__test_point_to_bucket_indicies PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=1" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;376;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(UtilsTest:__test_algorithms "/UtilsTest" "UtilsTest" "test_algorithms")
+set_tests_properties(UtilsTest:__test_algorithms PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=1" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;376;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(UtilsTest:__test_radix_sort "/UtilsTest" "UtilsTest" "test_radix_sort")
+set_tests_properties(UtilsTest:__test_radix_sort PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=1" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;376;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(UtilsTest:__test_low_rank "/UtilsTest" "UtilsTest" "test_low_rank")
+set_tests_properties(UtilsTest:__test_low_rank PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=1" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;376;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(UtilsTest__OpenMP:__test_bucket_indicies "/UtilsTest" "UtilsTest" "test_bucket_indicies")
+set_tests_properties(UtilsTest__OpenMP:__test_bucket_indicies PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=3" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;381;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(UtilsTest__OpenMP:__test_point_to_bucket_indicies "/UtilsTest" "UtilsTest" "test_point_to_bucket_indicies")
+set_tests_properties(UtilsTest__OpenMP:__test_point_to_bucket_indicies PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=3" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;381;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(UtilsTest__OpenMP:__test_algorithms "/UtilsTest" "UtilsTest" "test_algorithms")
+set_tests_properties(UtilsTest__OpenMP:__test_algorithms PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=3" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;381;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(UtilsTest__OpenMP:__test_radix_sort "/UtilsTest" "UtilsTest" "test_radix_sort")
+set_tests_properties(UtilsTest__OpenMP:__test_radix_sort PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=3" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;381;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(UtilsTest__OpenMP:__test_low_rank "/UtilsTest" "UtilsTest" "test_low_rank")
+set_tests_properties(UtilsTest__OpenMP:__test_low_rank PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=3" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;381;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(IteratorsTest:__test_lattice_within_distance "/IteratorsTest" "IteratorsTest" "test_lattice_within_distance")
+set_tests_properties(IteratorsTest:__test_lattice_within_distance PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=1" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;376;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(IteratorsTest__OpenMP:__test_lattice_within_distance "/IteratorsTest" "IteratorsTest" "test_lattice_within_distance")
+set_tests_properties(IteratorsTest__OpenMP:__test_lattice_within_distance PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=3" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;381;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(ChebyshevTest:__test_Rn_calculation "/ChebyshevTest" "ChebyshevTest" "test_Rn_calculation")
+set_tests_properties(ChebyshevTest:__test_Rn_calculation PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=1" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;376;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(ChebyshevTest:__test_fast_methods_CellList "/ChebyshevTest" "ChebyshevTest" "test_fast_methods_CellList")
+set_tests_properties(ChebyshevTest:__test_fast_methods_CellList PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=1" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;376;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(ChebyshevTest:__test_fast_methods_CellListOrdered "/ChebyshevTest" "ChebyshevTest" "test_fast_methods_CellListOrdered")
+set_tests_properties(ChebyshevTest:__test_fast_methods_CellListOrdered PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=1" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;376;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(ChebyshevTest:__test_fast_methods_kd_tree "/ChebyshevTest" "ChebyshevTest" "test_fast_methods_kd_tree")
+set_tests_properties(ChebyshevTest:__test_fast_methods_kd_tree PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=1" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;376;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(ChebyshevTest:__test_fast_methods_HyperOctree "/ChebyshevTest" "ChebyshevTest" "test_fast_methods_HyperOctree")
+set_tests_properties(ChebyshevTest:__test_fast_methods_HyperOctree PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=1" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;376;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(ChebyshevTest:__test_chebyshev_polynomial_calculation "/ChebyshevTest" "ChebyshevTest" "test_chebyshev_polynomial_calculation")
+set_tests_properties(ChebyshevTest:__test_chebyshev_polynomial_calculation PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=1" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;376;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(ChebyshevTest__OpenMP:__test_Rn_calculation "/ChebyshevTest" "ChebyshevTest" "test_Rn_calculation")
+set_tests_properties(ChebyshevTest__OpenMP:__test_Rn_calculation PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=3" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;381;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(ChebyshevTest__OpenMP:__test_fast_methods_CellList "/ChebyshevTest" "ChebyshevTest" "test_fast_methods_CellList")
+set_tests_properties(ChebyshevTest__OpenMP:__test_fast_methods_CellList PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=3" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;381;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(ChebyshevTest__OpenMP:__test_fast_methods_CellListOrdered "/ChebyshevTest" "ChebyshevTest" "test_fast_methods_CellListOrdered")
+set_tests_properties(ChebyshevTest__OpenMP:__test_fast_methods_CellListOrdered PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=3" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;381;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(ChebyshevTest__OpenMP:__test_fast_methods_kd_tree "/ChebyshevTest" "ChebyshevTest" "test_fast_methods_kd_tree")
+set_tests_properties(ChebyshevTest__OpenMP:__test_fast_methods_kd_tree PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=3" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;381;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(ChebyshevTest__OpenMP:__test_fast_methods_HyperOctree "/ChebyshevTest" "ChebyshevTest" "test_fast_methods_HyperOctree")
+set_tests_properties(ChebyshevTest__OpenMP:__test_fast_methods_HyperOctree PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=3" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;381;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(ChebyshevTest__OpenMP:__test_chebyshev_polynomial_calculation "/ChebyshevTest" "ChebyshevTest" "test_chebyshev_polynomial_calculation")
+set_tests_properties(ChebyshevTest__OpenMP:__test_chebyshev_polynomial_calculation PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=3" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;381;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(FMMTest:__test_fast_methods_CellList "/FMMTest" "FMMTest" "test_fast_methods_CellList")
+set_tests_properties(FMMTest:__test_fast_methods_CellList PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=1" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;376;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(FMMTest:__test_fast_methods_CellListOrdered "/FMMTest" "FMMTest" "test_fast_methods_CellListOrdered")
+set_tests_properties(FMMTest:__test_fast_methods_CellListOrdered PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=1" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;376;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(FMMTest:__test_fast_methods_kd_tree "/FMMTest" "FMMTest" "test_fast_methods_kd_tree")
+set_tests_properties(FMMTest:__test_fast_methods_kd_tree PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=1" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;376;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(FMMTest:__test_fast_methods_kd_tree_nanoflann "/FMMTest" "FMMTest" "test_fast_methods_kd_tree_nanoflann")
+set_tests_properties(FMMTest:__test_fast_methods_kd_tree_nanoflann PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=1" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;376;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(FMMTest:__test_fast_methods_HyperOctree "/FMMTest" "FMMTest" "test_fast_methods_HyperOctree")
+set_tests_properties(FMMTest:__test_fast_methods_HyperOctree PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=1" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;376;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(FMMTest:__test_fmm_operators "/FMMTest" "FMMTest" "test_fmm_operators")
+set_tests_properties(FMMTest:__test_fmm_operators PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=1" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;376;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(FMMTest__OpenMP:__test_fast_methods_CellList "/FMMTest" "FMMTest" "test_fast_methods_CellList")
+set_tests_properties(FMMTest__OpenMP:__test_fast_methods_CellList PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=3" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;381;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(FMMTest__OpenMP:__test_fast_methods_CellListOrdered "/FMMTest" "FMMTest" "test_fast_methods_CellListOrdered")
+set_tests_properties(FMMTest__OpenMP:__test_fast_methods_CellListOrdered PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=3" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;381;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(FMMTest__OpenMP:__test_fast_methods_kd_tree "/FMMTest" "FMMTest" "test_fast_methods_kd_tree")
+set_tests_properties(FMMTest__OpenMP:__test_fast_methods_kd_tree PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=3" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;381;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(FMMTest__OpenMP:__test_fast_methods_kd_tree_nanoflann "/FMMTest" "FMMTest" "test_fast_methods_kd_tree_nanoflann")
+set_tests_properties(FMMTest__OpenMP:__test_fast_methods_kd_tree_nanoflann PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=3" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;381;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(FMMTest__OpenMP:__test_fast_methods_HyperOctree "/FMMTest" "FMMTest" "test_fast_methods_HyperOctree")
+set_tests_properties(FMMTest__OpenMP:__test_fast_methods_HyperOctree PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=3" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;381;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(FMMTest__OpenMP:__test_fmm_operators "/FMMTest" "FMMTest" "test_fmm_operators")
+set_tests_properties(FMMTest__OpenMP:__test_fmm_operators PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=3" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;381;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(DocGettingStartedTest:__test_getting_started "/DocGettingStartedTest" "DocGettingStartedTest" "test_getting_started")
+set_tests_properties(DocGettingStartedTest:__test_getting_started PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=1" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;376;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(DocGettingStartedTest__OpenMP:__test_getting_started "/DocGettingStartedTest" "DocGettingStartedTest" "test_getting_started")
+set_tests_properties(DocGettingStartedTest__OpenMP:__test_getting_started PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=3" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;381;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(ParallelTest:__test_documentation "/ParallelTest" "ParallelTest" "test_documentation")
+set_tests_properties(ParallelTest:__test_documentation PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=1" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;376;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(ParallelTest__OpenMP:__test_documentation "/ParallelTest" "ParallelTest" "test_documentation")
+set_tests_properties(ParallelTest__OpenMP:__test_documentation PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=3" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;381;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(H2Test:__test_fast_methods_CellList "/H2Test" "H2Test" "test_fast_methods_CellList")
+set_tests_properties(H2Test:__test_fast_methods_CellList PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=1" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;376;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(H2Test:__test_fast_methods_CellListOrdered "/H2Test" "H2Test" "test_fast_methods_CellListOrdered")
+set_tests_properties(H2Test:__test_fast_methods_CellListOrdered PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=1" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;376;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(H2Test:__test_fast_methods_kd_tree "/H2Test" "H2Test" "test_fast_methods_kd_tree")
+set_tests_properties(H2Test:__test_fast_methods_kd_tree PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=1" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;376;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(H2Test:__test_fast_methods_kd_tree_nanoflann "/H2Test" "H2Test" "test_fast_methods_kd_tree_nanoflann")
+set_tests_properties(H2Test:__test_fast_methods_kd_tree_nanoflann PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=1" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;376;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(H2Test:__test_fast_methods_HyperOctree "/H2Test" "H2Test" "test_fast_methods_HyperOctree")
+set_tests_properties(H2Test:__test_fast_methods_HyperOctree PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=1" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;376;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(H2Test:__test_fmm_matrix_operators "/H2Test" "H2Test" "test_fmm_matrix_operators")
+set_tests_properties(H2Test:__test_fmm_matrix_operators PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=1" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;376;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(H2Test__OpenMP:__test_fast_methods_CellList "/H2Test" "H2Test" "test_fast_methods_CellList")
+set_tests_properties(H2Test__OpenMP:__test_fast_methods_CellList PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=3" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;381;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(H2Test__OpenMP:__test_fast_methods_CellListOrdered "/H2Test" "H2Test" "test_fast_methods_CellListOrdered")
+set_tests_properties(H2Test__OpenMP:__test_fast_methods_CellListOrdered PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=3" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;381;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(H2Test__OpenMP:__test_fast_methods_kd_tree "/H2Test" "H2Test" "test_fast_methods_kd_tree")
+set_tests_properties(H2Test__OpenMP:__test_fast_methods_kd_tree PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=3" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;381;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(H2Test__OpenMP:__test_fast_methods_kd_tree_nanoflann "/H2Test" "H2Test" "test_fast_methods_kd_tree_nanoflann")
+set_tests_properties(H2Test__OpenMP:__test_fast_methods_kd_tree_nanoflann PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=3" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;381;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(H2Test__OpenMP:__test_fast_methods_HyperOctree "/H2Test" "H2Test" "test_fast_methods_HyperOctree")
+set_tests_properties(H2Test__OpenMP:__test_fast_methods_HyperOctree PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=3" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;381;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(H2Test__OpenMP:__test_fmm_matrix_operators "/H2Test" "H2Test" "test_fmm_matrix_operators")
+set_tests_properties(H2Test__OpenMP:__test_fmm_matrix_operators PROPERTIES  ENVIRONMENT "OMP_NUM_THREADS=3" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;381;add_test;/root/repo/tests/CMakeLists.txt;0;")
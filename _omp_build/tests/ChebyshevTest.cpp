@@ -0,0 +1,67 @@
+/* Generated file, do not edit */
+
+#ifndef CXXTEST_RUNNING
+#define CXXTEST_RUNNING
+#endif
+
+#define _CXXTEST_HAVE_STD
+#include <cxxtest/TestListener.h>
+#include <cxxtest/TestTracker.h>
+#include <cxxtest/TestRunner.h>
+#include <cxxtest/RealDescriptions.h>
+#include <cxxtest/TestMain.h>
+#include <cxxtest/ErrorPrinter.h>
+
+int main( int argc, char *argv[] ) {
+ int status;
+    CxxTest::ErrorPrinter tmp;
+    CxxTest::RealWorldDescription::_worldName = "cxxtest";
+    status = CxxTest::Main< CxxTest::ErrorPrinter >( tmp, argc, argv );
+    return status;
+}
+bool suite_ChebyshevTest_init = false;
+#include "../../tests/chebyshev.h"
+
+static ChebyshevTest suite_ChebyshevTest;
+
+static CxxTest::List Tests_ChebyshevTest = { 0, 0 };
+CxxTest::StaticSuiteDescription suiteDescription_ChebyshevTest( "/root/repo/tests/chebyshev.h", 52, "ChebyshevTest", suite_ChebyshevTest, Tests_ChebyshevTest );
+
+static class TestDescription_suite_ChebyshevTest_test_chebyshev_polynomial_calculation : public CxxTest::RealTestDescription {
+public:
+ TestDescription_suite_ChebyshevTest_test_chebyshev_polynomial_calculation() : CxxTest::RealTestDescription( Tests_ChebyshevTest, suiteDescription_ChebyshevTest, 239, "test_chebyshev_polynomial_calculation" ) {}
+ void runTest() { suite_ChebyshevTest.test_chebyshev_polynomial_calculation(); }
+} testDescription_suite_ChebyshevTest_test_chebyshev_polynomial_calculation;
+
+static class TestDescription_suite_ChebyshevTest_test_fast_methods_CellList : public CxxTest::RealTestDescription {
+public:
+ TestDescription_suite_ChebyshevTest_test_fast_methods_CellList() : CxxTest::RealTestDescription( Tests_ChebyshevTest, suiteDescription_ChebyshevTest, 255, "test_fast_methods_CellList" ) {}
+ void runTest() { suite_ChebyshevTest.test_fast_methods_CellList(); }
+} testDescription_suite_ChebyshevTest_test_fast_methods_CellList;
+
+static class TestDescription_suite_ChebyshevTest_test_fast_methods_CellListOrdered : public CxxTest::RealTestDescription {
+public:
+ TestDescription_suite_ChebyshevTest_test_fast_methods_CellListOrdered() : CxxTest::RealTestDescription( Tests_ChebyshevTest, suiteDescription_ChebyshevTest, 265, "test_fast_methods_CellListOrdered" ) {}
+ void runTest() { suite_ChebyshevTest.test_fast_methods_CellListOrdered(); }
+} testDescription_suite_ChebyshevTest_test_fast_methods_CellListOrdered;
+
+static class TestDescription_suite_ChebyshevTest_test_fast_methods_kd_tree : public CxxTest::RealTestDescription {
+public:
+ TestDescription_suite_ChebyshevTest_test_fast_methods_kd_tree() : CxxTest::RealTestDescription( Tests_ChebyshevTest, suiteDescription_ChebyshevTest, 275, "test_fast_methods_kd_tree" ) {}
+ void runTest() { suite_ChebyshevTest.test_fast_methods_kd_tree(); }
+} testDescription_suite_ChebyshevTest_test_fast_methods_kd_tree;
+
+static class TestDescription_suite_ChebyshevTest_test_fast_methods_HyperOctree : public CxxTest::RealTestDescription {
+public:
+ TestDescription_suite_ChebyshevTest_test_fast_methods_HyperOctree() : CxxTest::RealTestDescription( Tests_ChebyshevTest, suiteDescription_ChebyshevTest, 285, "test_fast_methods_HyperOctree" ) {}
+ void runTest() { suite_ChebyshevTest.test_fast_methods_HyperOctree(); }
+} testDescription_suite_ChebyshevTest_test_fast_methods_HyperOctree;
+
+static class TestDescription_suite_ChebyshevTest_test_Rn_calculation : public CxxTest::RealTestDescription {
+public:
+ TestDescription_suite_ChebyshevTest_test_Rn_calculation() : CxxTest::RealTestDescription( Tests_ChebyshevTest, suiteDescription_ChebyshevTest, 295, "test_Rn_calculation" ) {}
+ void runTest() { suite_ChebyshevTest.test_Rn_calculation(); }
+} testDescription_suite_ChebyshevTest_test_Rn_calculation;
+
+#include <cxxtest/Root.cpp>
+const char* CxxTest::RealWorldDescription::_worldName = "cxxtest";
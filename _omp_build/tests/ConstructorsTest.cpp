@@ -0,0 +1,43 @@
+/* Generated file, do not edit */
+
+#ifndef CXXTEST_RUNNING
+#define CXXTEST_RUNNING
+#endif
+
+#define _CXXTEST_HAVE_STD
+#include <cxxtest/TestListener.h>
+#include <cxxtest/TestTracker.h>
+#include <cxxtest/TestRunner.h>
+#include <cxxtest/RealDescriptions.h>
+#include <cxxtest/TestMain.h>
+#include <cxxtest/ErrorPrinter.h>
+
+int main( int argc, char *argv[] ) {
+ int status;
+    CxxTest::ErrorPrinter tmp;
+    CxxTest::RealWorldDescription::_worldName = "cxxtest";
+    status = CxxTest::Main< CxxTest::ErrorPrinter >( tmp, argc, argv );
+    return status;
+}
+bool suite_ConstructorsTest_init = false;
+#include "../../tests/constructors.h"
+
+static ConstructorsTest suite_ConstructorsTest;
+
+static CxxTest::List Tests_ConstructorsTest = { 0, 0 };
+CxxTest::StaticSuiteDescription suiteDescription_ConstructorsTest( "/root/repo/tests/constructors.h", 47, "ConstructorsTest", suite_ConstructorsTest, Tests_ConstructorsTest );
+
+static class TestDescription_suite_ConstructorsTest_test_std_vector : public CxxTest::RealTestDescription {
+public:
+ TestDescription_suite_ConstructorsTest_test_std_vector() : CxxTest::RealTestDescription( Tests_ConstructorsTest, suiteDescription_ConstructorsTest, 93, "test_std_vector" ) {}
+ void runTest() { suite_ConstructorsTest.test_std_vector(); }
+} testDescription_suite_ConstructorsTest_test_std_vector;
+
+static class TestDescription_suite_ConstructorsTest_test_thrust_vector : public CxxTest::RealTestDescription {
+public:
+ TestDescription_suite_ConstructorsTest_test_thrust_vector() : CxxTest::RealTestDescription( Tests_ConstructorsTest, suiteDescription_ConstructorsTest, 101, "test_thrust_vector" ) {}
+ void runTest() { suite_ConstructorsTest.test_thrust_vector(); }
+} testDescription_suite_ConstructorsTest_test_thrust_vector;
+
+#include <cxxtest/Root.cpp>
+const char* CxxTest::RealWorldDescription::_worldName = "cxxtest";
@@ -0,0 +1,37 @@
+/* Generated file, do not edit */
+
+#ifndef CXXTEST_RUNNING
+#define CXXTEST_RUNNING
+#endif
+
+#define _CXXTEST_HAVE_STD
+#include <cxxtest/TestListener.h>
+#include <cxxtest/TestTracker.h>
+#include <cxxtest/TestRunner.h>
+#include <cxxtest/RealDescriptions.h>
+#include <cxxtest/TestMain.h>
+#include <cxxtest/ErrorPrinter.h>
+
+int main( int argc, char *argv[] ) {
+ int status;
+    CxxTest::ErrorPrinter tmp;
+    CxxTest::RealWorldDescription::_worldName = "cxxtest";
+    status = CxxTest::Main< CxxTest::ErrorPrinter >( tmp, argc, argv );
+    return status;
+}
+bool suite_DocGettingStartedTest_init = false;
+#include "../../tests/doc_getting_started.h"
+
+static DocGettingStartedTest suite_DocGettingStartedTest;
+
+static CxxTest::List Tests_DocGettingStartedTest = { 0, 0 };
+CxxTest::StaticSuiteDescription suiteDescription_DocGettingStartedTest( "/root/repo/tests/doc_getting_started.h", 118, "DocGettingStartedTest", suite_DocGettingStartedTest, Tests_DocGettingStartedTest );
+
+static class TestDescription_suite_DocGettingStartedTest_test_getting_started : public CxxTest::RealTestDescription {
+public:
+ TestDescription_suite_DocGettingStartedTest_test_getting_started() : CxxTest::RealTestDescription( Tests_DocGettingStartedTest, suiteDescription_DocGettingStartedTest, 122, "test_getting_started" ) {}
+ void runTest() { suite_DocGettingStartedTest.test_getting_started(); }
+} testDescription_suite_DocGettingStartedTest_test_getting_started;
+
+#include <cxxtest/Root.cpp>
+const char* CxxTest::RealWorldDescription::_worldName = "cxxtest";
@@ -0,0 +1,67 @@
+/* Generated file, do not edit */
+
+#ifndef CXXTEST_RUNNING
+#define CXXTEST_RUNNING
+#endif
+
+#define _CXXTEST_HAVE_STD
+#include <cxxtest/TestListener.h>
+#include <cxxtest/TestTracker.h>
+#include <cxxtest/TestRunner.h>
+#include <cxxtest/RealDescriptions.h>
+#include <cxxtest/TestMain.h>
+#include <cxxtest/ErrorPrinter.h>
+
+int main( int argc, char *argv[] ) {
+ int status;
+    CxxTest::ErrorPrinter tmp;
+    CxxTest::RealWorldDescription::_worldName = "cxxtest";
+    status = CxxTest::Main< CxxTest::ErrorPrinter >( tmp, argc, argv );
+    return status;
+}
+bool suite_FMMTest_init = false;
+#include "../../tests/fmm.h"
+
+static FMMTest suite_FMMTest;
+
+static CxxTest::List Tests_FMMTest = { 0, 0 };
+CxxTest::StaticSuiteDescription suiteDescription_FMMTest( "/root/repo/tests/fmm.h", 57, "FMMTest", suite_FMMTest, Tests_FMMTest );
+
+static class TestDescription_suite_FMMTest_test_fmm_operators : public CxxTest::RealTestDescription {
+public:
+ TestDescription_suite_FMMTest_test_fmm_operators() : CxxTest::RealTestDescription( Tests_FMMTest, suiteDescription_FMMTest, 474, "test_fmm_operators" ) {}
+ void runTest() { suite_FMMTest.test_fmm_operators(); }
+} testDescription_suite_FMMTest_test_fmm_operators;
+
+static class TestDescription_suite_FMMTest_test_fast_methods_CellList : public CxxTest::RealTestDescription {
+public:
+ TestDescription_suite_FMMTest_test_fast_methods_CellList() : CxxTest::RealTestDescription( Tests_FMMTest, suiteDescription_FMMTest, 485, "test_fast_methods_CellList" ) {}
+ void runTest() { suite_FMMTest.test_fast_methods_CellList(); }
+} testDescription_suite_FMMTest_test_fast_methods_CellList;
+
+static class TestDescription_suite_FMMTest_test_fast_methods_CellListOrdered : public CxxTest::RealTestDescription {
+public:
+ TestDescription_suite_FMMTest_test_fast_methods_CellListOrdered() : CxxTest::RealTestDescription( Tests_FMMTest, suiteDescription_FMMTest, 501, "test_fast_methods_CellListOrdered" ) {}
+ void runTest() { suite_FMMTest.test_fast_methods_CellListOrdered(); }
+} testDescription_suite_FMMTest_test_fast_methods_CellListOrdered;
+
+static class TestDescription_suite_FMMTest_test_fast_methods_kd_tree : public CxxTest::RealTestDescription {
+public:
+ TestDescription_suite_FMMTest_test_fast_methods_kd_tree() : CxxTest::RealTestDescription( Tests_FMMTest, suiteDescription_FMMTest, 517, "test_fast_methods_kd_tree" ) {}
+ void runTest() { suite_FMMTest.test_fast_methods_kd_tree(); }
+} testDescription_suite_FMMTest_test_fast_methods_kd_tree;
+
+static class TestDescription_suite_FMMTest_test_fast_methods_kd_tree_nanoflann : public CxxTest::RealTestDescription {
+public:
+ TestDescription_suite_FMMTest_test_fast_methods_kd_tree_nanoflann() : CxxTest::RealTestDescription( Tests_FMMTest, suiteDescription_FMMTest, 533, "test_fast_methods_kd_tree_nanoflann" ) {}
+ void runTest() { suite_FMMTest.test_fast_methods_kd_tree_nanoflann(); }
+} testDescription_suite_FMMTest_test_fast_methods_kd_tree_nanoflann;
+
+static class TestDescription_suite_FMMTest_test_fast_methods_HyperOctree : public CxxTest::RealTestDescription {
+public:
+ TestDescription_suite_FMMTest_test_fast_methods_HyperOctree() : CxxTest::RealTestDescription( Tests_FMMTest, suiteDescription_FMMTest, 549, "test_fast_methods_HyperOctree" ) {}
+ void runTest() { suite_FMMTest.test_fast_methods_HyperOctree(); }
+} testDescription_suite_FMMTest_test_fast_methods_HyperOctree;
+
+#include <cxxtest/Root.cpp>
+const char* CxxTest::RealWorldDescription::_worldName = "cxxtest";
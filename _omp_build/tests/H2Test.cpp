@@ -0,0 +1,67 @@
+/* Generated file, do not edit */
+
+#ifndef CXXTEST_RUNNING
+#define CXXTEST_RUNNING
+#endif
+
+#define _CXXTEST_HAVE_STD
+#include <cxxtest/TestListener.h>
+#include <cxxtest/TestTracker.h>
+#include <cxxtest/TestRunner.h>
+#include <cxxtest/RealDescriptions.h>
+#include <cxxtest/TestMain.h>
+#include <cxxtest/ErrorPrinter.h>
+
+int main( int argc, char *argv[] ) {
+ int status;
+    CxxTest::ErrorPrinter tmp;
+    CxxTest::RealWorldDescription::_worldName = "cxxtest";
+    status = CxxTest::Main< CxxTest::ErrorPrinter >( tmp, argc, argv );
+    return status;
+}
+bool suite_H2Test_init = false;
+#include "../../tests/h2.h"
+
+static H2Test suite_H2Test;
+
+static CxxTest::List Tests_H2Test = { 0, 0 };
+CxxTest::StaticSuiteDescription suiteDescription_H2Test( "/root/repo/tests/h2.h", 55, "H2Test", suite_H2Test, Tests_H2Test );
+
+static class TestDescription_suite_H2Test_test_fmm_matrix_operators : public CxxTest::RealTestDescription {
+public:
+ TestDescription_suite_H2Test_test_fmm_matrix_operators() : CxxTest::RealTestDescription( Tests_H2Test, suiteDescription_H2Test, 783, "test_fmm_matrix_operators" ) {}
+ void runTest() { suite_H2Test.test_fmm_matrix_operators(); }
+} testDescription_suite_H2Test_test_fmm_matrix_operators;
+
+static class TestDescription_suite_H2Test_test_fast_methods_CellList : public CxxTest::RealTestDescription {
+public:
+ TestDescription_suite_H2Test_test_fast_methods_CellList() : CxxTest::RealTestDescription( Tests_H2Test, suiteDescription_H2Test, 795, "test_fast_methods_CellList" ) {}
+ void runTest() { suite_H2Test.test_fast_methods_CellList(); }
+} testDescription_suite_H2Test_test_fast_methods_CellList;
+
+static class TestDescription_suite_H2Test_test_fast_methods_CellListOrdered : public CxxTest::RealTestDescription {
+public:
+ TestDescription_suite_H2Test_test_fast_methods_CellListOrdered() : CxxTest::RealTestDescription( Tests_H2Test, suiteDescription_H2Test, 816, "test_fast_methods_CellListOrdered" ) {}
+ void runTest() { suite_H2Test.test_fast_methods_CellListOrdered(); }
+} testDescription_suite_H2Test_test_fast_methods_CellListOrdered;
+
+static class TestDescription_suite_H2Test_test_fast_methods_kd_tree : public CxxTest::RealTestDescription {
+public:
+ TestDescription_suite_H2Test_test_fast_methods_kd_tree() : CxxTest::RealTestDescription( Tests_H2Test, suiteDescription_H2Test, 837, "test_fast_methods_kd_tree" ) {}
+ void runTest() { suite_H2Test.test_fast_methods_kd_tree(); }
+} testDescription_suite_H2Test_test_fast_methods_kd_tree;
+
+static class TestDescription_suite_H2Test_test_fast_methods_kd_tree_nanoflann : public CxxTest::RealTestDescription {
+public:
+ TestDescription_suite_H2Test_test_fast_methods_kd_tree_nanoflann() : CxxTest::RealTestDescription( Tests_H2Test, suiteDescription_H2Test, 858, "test_fast_methods_kd_tree_nanoflann" ) {}
+ void runTest() { suite_H2Test.test_fast_methods_kd_tree_nanoflann(); }
+} testDescription_suite_H2Test_test_fast_methods_kd_tree_nanoflann;
+
+static class TestDescription_suite_H2Test_test_fast_methods_HyperOctree : public CxxTest::RealTestDescription {
+public:
+ TestDescription_suite_H2Test_test_fast_methods_HyperOctree() : CxxTest::RealTestDescription( Tests_H2Test, suiteDescription_H2Test, 879, "test_fast_methods_HyperOctree" ) {}
+ void runTest() { suite_H2Test.test_fast_methods_HyperOctree(); }
+} testDescription_suite_H2Test_test_fast_methods_HyperOctree;
+
+#include <cxxtest/Root.cpp>
+const char* CxxTest::RealWorldDescription::_worldName = "cxxtest";
@@ -0,0 +1,86 @@
+/* Generated file, do not edit */
+
+#ifndef CXXTEST_RUNNING
+#define CXXTEST_RUNNING
+#endif
+
+#define _CXXTEST_HAVE_STD
+#define _CXXTEST_HAVE_EH
+#include <cxxtest/TestListener.h>
+#include <cxxtest/TestTracker.h>
+#include <cxxtest/TestRunner.h>
+#include <cxxtest/RealDescriptions.h>
+#include <cxxtest/TestMain.h>
+#include <cxxtest/ErrorPrinter.h>
+
+int main( int argc, char *argv[] ) {
+ int status;
+    CxxTest::ErrorPrinter tmp;
+    CxxTest::RealWorldDescription::_worldName = "cxxtest";
+    status = CxxTest::Main< CxxTest::ErrorPrinter >( tmp, argc, argv );
+    return status;
+}
+bool suite_IDSearchTest_init = false;
+#include "../../tests/id_search.h"
+
+static IDSearchTest suite_IDSearchTest;
+
+static CxxTest::List Tests_IDSearchTest = { 0, 0 };
+CxxTest::StaticSuiteDescription suiteDescription_IDSearchTest( "/root/repo/tests/id_search.h", 47, "IDSearchTest", suite_IDSearchTest, Tests_IDSearchTest );
+
+static class TestDescription_suite_IDSearchTest_test_documentation : public CxxTest::RealTestDescription {
+public:
+ TestDescription_suite_IDSearchTest_test_documentation() : CxxTest::RealTestDescription( Tests_IDSearchTest, suiteDescription_IDSearchTest, 53, "test_documentation" ) {}
+ void runTest() { suite_IDSearchTest.test_documentation(); }
+} testDescription_suite_IDSearchTest_test_documentation;
+
+static class TestDescription_suite_IDSearchTest_test_std_vector_CellList : public CxxTest::RealTestDescription {
+public:
+ TestDescription_suite_IDSearchTest_test_std_vector_CellList() : CxxTest::RealTestDescription( Tests_IDSearchTest, suiteDescription_IDSearchTest, 402, "test_std_vector_CellList" ) {}
+ void runTest() { suite_IDSearchTest.test_std_vector_CellList(); }
+} testDescription_suite_IDSearchTest_test_std_vector_CellList;
+
+static class TestDescription_suite_IDSearchTest_test_std_vector_CellListOrdered : public CxxTest::RealTestDescription {
+public:
+ TestDescription_suite_IDSearchTest_test_std_vector_CellListOrdered() : CxxTest::RealTestDescription( Tests_IDSearchTest, suiteDescription_IDSearchTest, 406, "test_std_vector_CellListOrdered" ) {}
+ void runTest() { suite_IDSearchTest.test_std_vector_CellListOrdered(); }
+} testDescription_suite_IDSearchTest_test_std_vector_CellListOrdered;
+
+static class TestDescription_suite_IDSearchTest_test_std_vector_HashedCellList : public CxxTest::RealTestDescription {
+public:
+ TestDescription_suite_IDSearchTest_test_std_vector_HashedCellList() : CxxTest::RealTestDescription( Tests_IDSearchTest, suiteDescription_IDSearchTest, 410, "test_std_vector_HashedCellList" ) {}
+ void runTest() { suite_IDSearchTest.test_std_vector_HashedCellList(); }
+} testDescription_suite_IDSearchTest_test_std_vector_HashedCellList;
+
+static class TestDescription_suite_IDSearchTest_test_std_vector_Kdtree : public CxxTest::RealTestDescription {
+public:
+ TestDescription_suite_IDSearchTest_test_std_vector_Kdtree() : CxxTest::RealTestDescription( Tests_IDSearchTest, suiteDescription_IDSearchTest, 414, "test_std_vector_Kdtree" ) {}
+ void runTest() { suite_IDSearchTest.test_std_vector_Kdtree(); }
+} testDescription_suite_IDSearchTest_test_std_vector_Kdtree;
+
+static class TestDescription_suite_IDSearchTest_test_std_vector_HyperOctree : public CxxTest::RealTestDescription {
+public:
+ TestDescription_suite_IDSearchTest_test_std_vector_HyperOctree() : CxxTest::RealTestDescription( Tests_IDSearchTest, suiteDescription_IDSearchTest, 420, "test_std_vector_HyperOctree" ) {}
+ void runTest() { suite_IDSearchTest.test_std_vector_HyperOctree(); }
+} testDescription_suite_IDSearchTest_test_std_vector_HyperOctree;
+
+static class TestDescription_suite_IDSearchTest_test_thrust_vector_CellList : public CxxTest::RealTestDescription {
+public:
+ TestDescription_suite_IDSearchTest_test_thrust_vector_CellList() : CxxTest::RealTestDescription( Tests_IDSearchTest, suiteDescription_IDSearchTest, 424, "test_thrust_vector_CellList" ) {}
+ void runTest() { suite_IDSearchTest.test_thrust_vector_CellList(); }
+} testDescription_suite_IDSearchTest_test_thrust_vector_CellList;
+
+static class TestDescription_suite_IDSearchTest_test_thrust_vector_CellListOrdered : public CxxTest::RealTestDescription {
+public:
+ TestDescription_suite_IDSearchTest_test_thrust_vector_CellListOrdered() : CxxTest::RealTestDescription( Tests_IDSearchTest, suiteDescription_IDSearchTest, 430, "test_thrust_vector_CellListOrdered" ) {}
+ void runTest() { suite_IDSearchTest.test_thrust_vector_CellListOrdered(); }
+} testDescription_suite_IDSearchTest_test_thrust_vector_CellListOrdered;
+
+static class TestDescription_suite_IDSearchTest_test_thrust_vector_HyperOctree : public CxxTest::RealTestDescription {
+public:
+ TestDescription_suite_IDSearchTest_test_thrust_vector_HyperOctree() : CxxTest::RealTestDescription( Tests_IDSearchTest, suiteDescription_IDSearchTest, 436, "test_thrust_vector_HyperOctree" ) {}
+ void runTest() { suite_IDSearchTest.test_thrust_vector_HyperOctree(); }
+} testDescription_suite_IDSearchTest_test_thrust_vector_HyperOctree;
+
+#include <cxxtest/Root.cpp>
+const char* CxxTest::RealWorldDescription::_worldName = "cxxtest";
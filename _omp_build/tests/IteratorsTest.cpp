@@ -0,0 +1,43 @@
+/* Generated file, do not edit */
+
+#ifndef CXXTEST_RUNNING
+#define CXXTEST_RUNNING
+#endif
+
+#define _CXXTEST_HAVE_STD
+#include <cxxtest/TestListener.h>
+#include <cxxtest/TestTracker.h>
+#include <cxxtest/TestRunner.h>
+#include <cxxtest/RealDescriptions.h>
+#include <cxxtest/TestMain.h>
+#include <cxxtest/ErrorPrinter.h>
+
+int main( int argc, char *argv[] ) {
+ int status;
+    CxxTest::ErrorPrinter tmp;
+    CxxTest::RealWorldDescription::_worldName = "cxxtest";
+    status = CxxTest::Main< CxxTest::ErrorPrinter >( tmp, argc, argv );
+    return status;
+}
+bool suite_IteratorsTest_init = false;
+#include "../../tests/iterators.h"
+
+static IteratorsTest suite_IteratorsTest;
+
+static CxxTest::List Tests_IteratorsTest = { 0, 0 };
+CxxTest::StaticSuiteDescription suiteDescription_IteratorsTest( "/root/repo/tests/iterators.h", 45, "IteratorsTest", suite_IteratorsTest, Tests_IteratorsTest );
+
+static class TestDescription_suite_IteratorsTest_test_lattice_within_distance : public CxxTest::RealTestDescription {
+public:
+ TestDescription_suite_IteratorsTest_test_lattice_within_distance() : CxxTest::RealTestDescription( Tests_IteratorsTest, suiteDescription_IteratorsTest, 50, "test_lattice_within_distance" ) {}
+ void runTest() { suite_IteratorsTest.test_lattice_within_distance(); }
+} testDescription_suite_IteratorsTest_test_lattice_within_distance;
+
+static class TestDescription_suite_IteratorsTest_test_lattice_within_distance_2d : public CxxTest::RealTestDescription {
+public:
+ TestDescription_suite_IteratorsTest_test_lattice_within_distance_2d() : CxxTest::RealTestDescription( Tests_IteratorsTest, suiteDescription_IteratorsTest, 116, "test_lattice_within_distance_2d" ) {}
+ void runTest() { suite_IteratorsTest.test_lattice_within_distance_2d(); }
+} testDescription_suite_IteratorsTest_test_lattice_within_distance_2d;
+
+#include <cxxtest/Root.cpp>
+const char* CxxTest::RealWorldDescription::_worldName = "cxxtest";
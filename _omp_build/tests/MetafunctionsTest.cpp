@@ -0,0 +1,55 @@
+/* Generated file, do not edit */
+
+#ifndef CXXTEST_RUNNING
+#define CXXTEST_RUNNING
+#endif
+
+#define _CXXTEST_HAVE_STD
+#include <cxxtest/TestListener.h>
+#include <cxxtest/TestTracker.h>
+#include <cxxtest/TestRunner.h>
+#include <cxxtest/RealDescriptions.h>
+#include <cxxtest/TestMain.h>
+#include <cxxtest/ErrorPrinter.h>
+
+int main( int argc, char *argv[] ) {
+ int status;
+    CxxTest::ErrorPrinter tmp;
+    CxxTest::RealWorldDescription::_worldName = "cxxtest";
+    status = CxxTest::Main< CxxTest::ErrorPrinter >( tmp, argc, argv );
+    return status;
+}
+bool suite_MetafunctionsTest_init = false;
+#include "../../tests/metafunctions.h"
+
+static MetafunctionsTest suite_MetafunctionsTest;
+
+static CxxTest::List Tests_MetafunctionsTest = { 0, 0 };
+CxxTest::StaticSuiteDescription suiteDescription_MetafunctionsTest( "/root/repo/tests/metafunctions.h", 46, "MetafunctionsTest", suite_MetafunctionsTest, Tests_MetafunctionsTest );
+
+static class TestDescription_suite_MetafunctionsTest_test_aliasing : public CxxTest::RealTestDescription {
+public:
+ TestDescription_suite_MetafunctionsTest_test_aliasing() : CxxTest::RealTestDescription( Tests_MetafunctionsTest, suiteDescription_MetafunctionsTest, 48, "test_aliasing" ) {}
+ void runTest() { suite_MetafunctionsTest.test_aliasing(); }
+} testDescription_suite_MetafunctionsTest_test_aliasing;
+
+static class TestDescription_suite_MetafunctionsTest_test_expr_matching : public CxxTest::RealTestDescription {
+public:
+ TestDescription_suite_MetafunctionsTest_test_expr_matching() : CxxTest::RealTestDescription( Tests_MetafunctionsTest, suiteDescription_MetafunctionsTest, 92, "test_expr_matching" ) {}
+ void runTest() { suite_MetafunctionsTest.test_expr_matching(); }
+} testDescription_suite_MetafunctionsTest_test_expr_matching;
+
+static class TestDescription_suite_MetafunctionsTest_test_get_labels : public CxxTest::RealTestDescription {
+public:
+ TestDescription_suite_MetafunctionsTest_test_get_labels() : CxxTest::RealTestDescription( Tests_MetafunctionsTest, suiteDescription_MetafunctionsTest, 177, "test_get_labels" ) {}
+ void runTest() { suite_MetafunctionsTest.test_get_labels(); }
+} testDescription_suite_MetafunctionsTest_test_get_labels;
+
+static class TestDescription_suite_MetafunctionsTest_test_thrust : public CxxTest::RealTestDescription {
+public:
+ TestDescription_suite_MetafunctionsTest_test_thrust() : CxxTest::RealTestDescription( Tests_MetafunctionsTest, suiteDescription_MetafunctionsTest, 317, "test_thrust" ) {}
+ void runTest() { suite_MetafunctionsTest.test_thrust(); }
+} testDescription_suite_MetafunctionsTest_test_thrust;
+
+#include <cxxtest/Root.cpp>
+const char* CxxTest::RealWorldDescription::_worldName = "cxxtest";
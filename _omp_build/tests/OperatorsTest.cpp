@@ -0,0 +1,55 @@
+/* Generated file, do not edit */
+
+#ifndef CXXTEST_RUNNING
+#define CXXTEST_RUNNING
+#endif
+
+#define _CXXTEST_HAVE_STD
+#include <cxxtest/TestListener.h>
+#include <cxxtest/TestTracker.h>
+#include <cxxtest/TestRunner.h>
+#include <cxxtest/RealDescriptions.h>
+#include <cxxtest/TestMain.h>
+#include <cxxtest/ErrorPrinter.h>
+
+int main( int argc, char *argv[] ) {
+ int status;
+    CxxTest::ErrorPrinter tmp;
+    CxxTest::RealWorldDescription::_worldName = "cxxtest";
+    status = CxxTest::Main< CxxTest::ErrorPrinter >( tmp, argc, argv );
+    return status;
+}
+bool suite_OperatorsTest_init = false;
+#include "../../tests/operators.h"
+
+static OperatorsTest suite_OperatorsTest;
+
+static CxxTest::List Tests_OperatorsTest = { 0, 0 };
+CxxTest::StaticSuiteDescription suiteDescription_OperatorsTest( "/root/repo/tests/operators.h", 45, "OperatorsTest", suite_OperatorsTest, Tests_OperatorsTest );
+
+static class TestDescription_suite_OperatorsTest_test_documentation : public CxxTest::RealTestDescription {
+public:
+ TestDescription_suite_OperatorsTest_test_documentation() : CxxTest::RealTestDescription( Tests_OperatorsTest, suiteDescription_OperatorsTest, 47, "test_documentation" ) {}
+ void runTest() { suite_OperatorsTest.test_documentation(); }
+} testDescription_suite_OperatorsTest_test_documentation;
+
+static class TestDescription_suite_OperatorsTest_test_dense_operator : public CxxTest::RealTestDescription {
+public:
+ TestDescription_suite_OperatorsTest_test_dense_operator() : CxxTest::RealTestDescription( Tests_OperatorsTest, suiteDescription_OperatorsTest, 703, "test_dense_operator" ) {}
+ void runTest() { suite_OperatorsTest.test_dense_operator(); }
+} testDescription_suite_OperatorsTest_test_dense_operator;
+
+static class TestDescription_suite_OperatorsTest_test_sparse_operator : public CxxTest::RealTestDescription {
+public:
+ TestDescription_suite_OperatorsTest_test_sparse_operator() : CxxTest::RealTestDescription( Tests_OperatorsTest, suiteDescription_OperatorsTest, 810, "test_sparse_operator" ) {}
+ void runTest() { suite_OperatorsTest.test_sparse_operator(); }
+} testDescription_suite_OperatorsTest_test_sparse_operator;
+
+static class TestDescription_suite_OperatorsTest_test_block_operator : public CxxTest::RealTestDescription {
+public:
+ TestDescription_suite_OperatorsTest_test_block_operator() : CxxTest::RealTestDescription( Tests_OperatorsTest, suiteDescription_OperatorsTest, 969, "test_block_operator" ) {}
+ void runTest() { suite_OperatorsTest.test_block_operator(); }
+} testDescription_suite_OperatorsTest_test_block_operator;
+
+#include <cxxtest/Root.cpp>
+const char* CxxTest::RealWorldDescription::_worldName = "cxxtest";
@@ -0,0 +1,37 @@
+/* Generated file, do not edit */
+
+#ifndef CXXTEST_RUNNING
+#define CXXTEST_RUNNING
+#endif
+
+#define _CXXTEST_HAVE_STD
+#include <cxxtest/TestListener.h>
+#include <cxxtest/TestTracker.h>
+#include <cxxtest/TestRunner.h>
+#include <cxxtest/RealDescriptions.h>
+#include <cxxtest/TestMain.h>
+#include <cxxtest/ErrorPrinter.h>
+
+int main( int argc, char *argv[] ) {
+ int status;
+    CxxTest::ErrorPrinter tmp;
+    CxxTest::RealWorldDescription::_worldName = "cxxtest";
+    status = CxxTest::Main< CxxTest::ErrorPrinter >( tmp, argc, argv );
+    return status;
+}
+bool suite_ParallelTest_init = false;
+#include "../../tests/parallel.h"
+
+static ParallelTest suite_ParallelTest;
+
+static CxxTest::List Tests_ParallelTest = { 0, 0 };
+CxxTest::StaticSuiteDescription suiteDescription_ParallelTest( "/root/repo/tests/parallel.h", 47, "ParallelTest", suite_ParallelTest, Tests_ParallelTest );
+
+static class TestDescription_suite_ParallelTest_test_documentation : public CxxTest::RealTestDescription {
+public:
+ TestDescription_suite_ParallelTest_test_documentation() : CxxTest::RealTestDescription( Tests_ParallelTest, suiteDescription_ParallelTest, 51, "test_documentation" ) {}
+ void runTest() { suite_ParallelTest.test_documentation(); }
+} testDescription_suite_ParallelTest_test_documentation;
+
+#include <cxxtest/Root.cpp>
+const char* CxxTest::RealWorldDescription::_worldName = "cxxtest";
@@ -0,0 +1,56 @@
+/* Generated file, do not edit */
+
+#ifndef CXXTEST_RUNNING
+#define CXXTEST_RUNNING
+#endif
+
+#define _CXXTEST_HAVE_STD
+#define _CXXTEST_HAVE_EH
+#include <cxxtest/TestListener.h>
+#include <cxxtest/TestTracker.h>
+#include <cxxtest/TestRunner.h>
+#include <cxxtest/RealDescriptions.h>
+#include <cxxtest/TestMain.h>
+#include <cxxtest/ErrorPrinter.h>
+
+int main( int argc, char *argv[] ) {
+ int status;
+    CxxTest::ErrorPrinter tmp;
+    CxxTest::RealWorldDescription::_worldName = "cxxtest";
+    status = CxxTest::Main< CxxTest::ErrorPrinter >( tmp, argc, argv );
+    return status;
+}
+bool suite_ParticleContainerTest_init = false;
+#include "../../tests/particle_container.h"
+
+static ParticleContainerTest suite_ParticleContainerTest;
+
+static CxxTest::List Tests_ParticleContainerTest = { 0, 0 };
+CxxTest::StaticSuiteDescription suiteDescription_ParticleContainerTest( "/root/repo/tests/particle_container.h", 45, "ParticleContainerTest", suite_ParticleContainerTest, Tests_ParticleContainerTest );
+
+static class TestDescription_suite_ParticleContainerTest_test_documentation : public CxxTest::RealTestDescription {
+public:
+ TestDescription_suite_ParticleContainerTest_test_documentation() : CxxTest::RealTestDescription( Tests_ParticleContainerTest, suiteDescription_ParticleContainerTest, 170, "test_documentation" ) {}
+ void runTest() { suite_ParticleContainerTest.test_documentation(); }
+} testDescription_suite_ParticleContainerTest_test_documentation;
+
+static class TestDescription_suite_ParticleContainerTest_test_std_vector_CellList : public CxxTest::RealTestDescription {
+public:
+ TestDescription_suite_ParticleContainerTest_test_std_vector_CellList() : CxxTest::RealTestDescription( Tests_ParticleContainerTest, suiteDescription_ParticleContainerTest, 462, "test_std_vector_CellList" ) {}
+ void runTest() { suite_ParticleContainerTest.test_std_vector_CellList(); }
+} testDescription_suite_ParticleContainerTest_test_std_vector_CellList;
+
+static class TestDescription_suite_ParticleContainerTest_test_std_vector_CellListOrdered : public CxxTest::RealTestDescription {
+public:
+ TestDescription_suite_ParticleContainerTest_test_std_vector_CellListOrdered() : CxxTest::RealTestDescription( Tests_ParticleContainerTest, suiteDescription_ParticleContainerTest, 470, "test_std_vector_CellListOrdered" ) {}
+ void runTest() { suite_ParticleContainerTest.test_std_vector_CellListOrdered(); }
+} testDescription_suite_ParticleContainerTest_test_std_vector_CellListOrdered;
+
+static class TestDescription_suite_ParticleContainerTest_test_thrust_vector_CellListOrdered : public CxxTest::RealTestDescription {
+public:
+ TestDescription_suite_ParticleContainerTest_test_thrust_vector_CellListOrdered() : CxxTest::RealTestDescription( Tests_ParticleContainerTest, suiteDescription_ParticleContainerTest, 478, "test_thrust_vector_CellListOrdered" ) {}
+ void runTest() { suite_ParticleContainerTest.test_thrust_vector_CellListOrdered(); }
+} testDescription_suite_ParticleContainerTest_test_thrust_vector_CellListOrdered;
+
+#include <cxxtest/Root.cpp>
+const char* CxxTest::RealWorldDescription::_worldName = "cxxtest";
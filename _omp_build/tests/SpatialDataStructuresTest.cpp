@@ -0,0 +1,73 @@
+/* Generated file, do not edit */
+
+#ifndef CXXTEST_RUNNING
+#define CXXTEST_RUNNING
+#endif
+
+#define _CXXTEST_HAVE_STD
+#include <cxxtest/TestListener.h>
+#include <cxxtest/TestTracker.h>
+#include <cxxtest/TestRunner.h>
+#include <cxxtest/RealDescriptions.h>
+#include <cxxtest/TestMain.h>
+#include <cxxtest/ErrorPrinter.h>
+
+int main( int argc, char *argv[] ) {
+ int status;
+    CxxTest::ErrorPrinter tmp;
+    CxxTest::RealWorldDescription::_worldName = "cxxtest";
+    status = CxxTest::Main< CxxTest::ErrorPrinter >( tmp, argc, argv );
+    return status;
+}
+bool suite_SpatialDataStructuresTest_init = false;
+#include "../../tests/data_structures.h"
+
+static SpatialDataStructuresTest suite_SpatialDataStructuresTest;
+
+static CxxTest::List Tests_SpatialDataStructuresTest = { 0, 0 };
+CxxTest::StaticSuiteDescription suiteDescription_SpatialDataStructuresTest( "/root/repo/tests/data_structures.h", 52, "SpatialDataStructuresTest", suite_SpatialDataStructuresTest, Tests_SpatialDataStructuresTest );
+
+static class TestDescription_suite_SpatialDataStructuresTest_test_documentation : public CxxTest::RealTestDescription {
+public:
+ TestDescription_suite_SpatialDataStructuresTest_test_documentation() : CxxTest::RealTestDescription( Tests_SpatialDataStructuresTest, suiteDescription_SpatialDataStructuresTest, 54, "test_documentation" ) {}
+ void runTest() { suite_SpatialDataStructuresTest.test_documentation(); }
+} testDescription_suite_SpatialDataStructuresTest_test_documentation;
+
+static class TestDescription_suite_SpatialDataStructuresTest_test_visualise_data_structures : public CxxTest::RealTestDescription {
+public:
+ TestDescription_suite_SpatialDataStructuresTest_test_visualise_data_structures() : CxxTest::RealTestDescription( Tests_SpatialDataStructuresTest, suiteDescription_SpatialDataStructuresTest, 586, "test_visualise_data_structures" ) {}
+ void runTest() { suite_SpatialDataStructuresTest.test_visualise_data_structures(); }
+} testDescription_suite_SpatialDataStructuresTest_test_visualise_data_structures;
+
+static class TestDescription_suite_SpatialDataStructuresTest_test_CellList : public CxxTest::RealTestDescription {
+public:
+ TestDescription_suite_SpatialDataStructuresTest_test_CellList() : CxxTest::RealTestDescription( Tests_SpatialDataStructuresTest, suiteDescription_SpatialDataStructuresTest, 594, "test_CellList" ) {}
+ void runTest() { suite_SpatialDataStructuresTest.test_CellList(); }
+} testDescription_suite_SpatialDataStructuresTest_test_CellList;
+
+static class TestDescription_suite_SpatialDataStructuresTest_test_CellListOrdered : public CxxTest::RealTestDescription {
+public:
+ TestDescription_suite_SpatialDataStructuresTest_test_CellListOrdered() : CxxTest::RealTestDescription( Tests_SpatialDataStructuresTest, suiteDescription_SpatialDataStructuresTest, 598, "test_CellListOrdered" ) {}
+ void runTest() { suite_SpatialDataStructuresTest.test_CellListOrdered(); }
+} testDescription_suite_SpatialDataStructuresTest_test_CellListOrdered;
+
+static class TestDescription_suite_SpatialDataStructuresTest_test_HyperOctree : public CxxTest::RealTestDescription {
+public:
+ TestDescription_suite_SpatialDataStructuresTest_test_HyperOctree() : CxxTest::RealTestDescription( Tests_SpatialDataStructuresTest, suiteDescription_SpatialDataStructuresTest, 602, "test_HyperOctree" ) {}
+ void runTest() { suite_SpatialDataStructuresTest.test_HyperOctree(); }
+} testDescription_suite_SpatialDataStructuresTest_test_HyperOctree;
+
+static class TestDescription_suite_SpatialDataStructuresTest_test_kdtree : public CxxTest::RealTestDescription {
+public:
+ TestDescription_suite_SpatialDataStructuresTest_test_kdtree() : CxxTest::RealTestDescription( Tests_SpatialDataStructuresTest, suiteDescription_SpatialDataStructuresTest, 606, "test_kdtree" ) {}
+ void runTest() { suite_SpatialDataStructuresTest.test_kdtree(); }
+} testDescription_suite_SpatialDataStructuresTest_test_kdtree;
+
+static class TestDescription_suite_SpatialDataStructuresTest_test_BoundingVolumeHierarchy : public CxxTest::RealTestDescription {
+public:
+ TestDescription_suite_SpatialDataStructuresTest_test_BoundingVolumeHierarchy() : CxxTest::RealTestDescription( Tests_SpatialDataStructuresTest, suiteDescription_SpatialDataStructuresTest, 611, "test_BoundingVolumeHierarchy" ) {}
+ void runTest() { suite_SpatialDataStructuresTest.test_BoundingVolumeHierarchy(); }
+} testDescription_suite_SpatialDataStructuresTest_test_BoundingVolumeHierarchy;
+
+#include <cxxtest/Root.cpp>
+const char* CxxTest::RealWorldDescription::_worldName = "cxxtest";
@@ -0,0 +1,43 @@
+/* Generated file, do not edit */
+
+#ifndef CXXTEST_RUNNING
+#define CXXTEST_RUNNING
+#endif
+
+#define _CXXTEST_HAVE_STD
+#include <cxxtest/TestListener.h>
+#include <cxxtest/TestTracker.h>
+#include <cxxtest/TestRunner.h>
+#include <cxxtest/RealDescriptions.h>
+#include <cxxtest/TestMain.h>
+#include <cxxtest/ErrorPrinter.h>
+
+int main( int argc, char *argv[] ) {
+ int status;
+    CxxTest::ErrorPrinter tmp;
+    CxxTest::RealWorldDescription::_worldName = "cxxtest";
+    status = CxxTest::Main< CxxTest::ErrorPrinter >( tmp, argc, argv );
+    return status;
+}
+bool suite_SymbolicTest_init = false;
+#include "../../tests/symbolic.h"
+
+static SymbolicTest suite_SymbolicTest;
+
+static CxxTest::List Tests_SymbolicTest = { 0, 0 };
+CxxTest::StaticSuiteDescription suiteDescription_SymbolicTest( "/root/repo/tests/symbolic.h", 45, "SymbolicTest", suite_SymbolicTest, Tests_SymbolicTest );
+
+static class TestDescription_suite_SymbolicTest_test_documentation : public CxxTest::RealTestDescription {
+public:
+ TestDescription_suite_SymbolicTest_test_documentation() : CxxTest::RealTestDescription( Tests_SymbolicTest, suiteDescription_SymbolicTest, 47, "test_documentation" ) {}
+ void runTest() { suite_SymbolicTest.test_documentation(); }
+} testDescription_suite_SymbolicTest_test_documentation;
+
+static class TestDescription_suite_SymbolicTest_test_default : public CxxTest::RealTestDescription {
+public:
+ TestDescription_suite_SymbolicTest_test_default() : CxxTest::RealTestDescription( Tests_SymbolicTest, suiteDescription_SymbolicTest, 547, "test_default" ) {}
+ void runTest() { suite_SymbolicTest.test_default(); }
+} testDescription_suite_SymbolicTest_test_default;
+
+#include <cxxtest/Root.cpp>
+const char* CxxTest::RealWorldDescription::_worldName = "cxxtest";
@@ -0,0 +1,61 @@
+/* Generated file, do not edit */
+
+#ifndef CXXTEST_RUNNING
+#define CXXTEST_RUNNING
+#endif
+
+#define _CXXTEST_HAVE_STD
+#include <cxxtest/TestListener.h>
+#include <cxxtest/TestTracker.h>
+#include <cxxtest/TestRunner.h>
+#include <cxxtest/RealDescriptions.h>
+#include <cxxtest/TestMain.h>
+#include <cxxtest/ErrorPrinter.h>
+
+int main( int argc, char *argv[] ) {
+ int status;
+    CxxTest::ErrorPrinter tmp;
+    CxxTest::RealWorldDescription::_worldName = "cxxtest";
+    status = CxxTest::Main< CxxTest::ErrorPrinter >( tmp, argc, argv );
+    return status;
+}
+bool suite_UtilsTest_init = false;
+#include "../../tests/utils.h"
+
+static UtilsTest suite_UtilsTest;
+
+static CxxTest::List Tests_UtilsTest = { 0, 0 };
+CxxTest::StaticSuiteDescription suiteDescription_UtilsTest( "/root/repo/tests/utils.h", 50, "UtilsTest", suite_UtilsTest, Tests_UtilsTest );
+
+static class TestDescription_suite_UtilsTest_test_bucket_indicies : public CxxTest::RealTestDescription {
+public:
+ TestDescription_suite_UtilsTest_test_bucket_indicies() : CxxTest::RealTestDescription( Tests_UtilsTest, suiteDescription_UtilsTest, 52, "test_bucket_indicies" ) {}
+ void runTest() { suite_UtilsTest.test_bucket_indicies(); }
+} testDescription_suite_UtilsTest_test_bucket_indicies;
+
+static class TestDescription_suite_UtilsTest_test_point_to_bucket_indicies : public CxxTest::RealTestDescription {
+public:
+ TestDescription_suite_UtilsTest_test_point_to_bucket_indicies() : CxxTest::RealTestDescription( Tests_UtilsTest, suiteDescription_UtilsTest, 75, "test_point_to_bucket_indicies" ) {}
+ void runTest() { suite_UtilsTest.test_point_to_bucket_indicies(); }
+} testDescription_suite_UtilsTest_test_point_to_bucket_indicies;
+
+static class TestDescription_suite_UtilsTest_test_algorithms : public CxxTest::RealTestDescription {
+public:
+ TestDescription_suite_UtilsTest_test_algorithms() : CxxTest::RealTestDescription( Tests_UtilsTest, suiteDescription_UtilsTest, 112, "test_algorithms" ) {}
+ void runTest() { suite_UtilsTest.test_algorithms(); }
+} testDescription_suite_UtilsTest_test_algorithms;
+
+static class TestDescription_suite_UtilsTest_test_radix_sort : public CxxTest::RealTestDescription {
+public:
+ TestDescription_suite_UtilsTest_test_radix_sort() : CxxTest::RealTestDescription( Tests_UtilsTest, suiteDescription_UtilsTest, 223, "test_radix_sort" ) {}
+ void runTest() { suite_UtilsTest.test_radix_sort(); }
+} testDescription_suite_UtilsTest_test_radix_sort;
+
+static class TestDescription_suite_UtilsTest_test_low_rank : public CxxTest::RealTestDescription {
+public:
+ TestDescription_suite_UtilsTest_test_low_rank() : CxxTest::RealTestDescription( Tests_UtilsTest, suiteDescription_UtilsTest, 235, "test_low_rank" ) {}
+ void runTest() { suite_UtilsTest.test_low_rank(); }
+} testDescription_suite_UtilsTest_test_low_rank;
+
+#include <cxxtest/Root.cpp>
+const char* CxxTest::RealWorldDescription::_worldName = "cxxtest";
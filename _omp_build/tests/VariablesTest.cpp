@@ -0,0 +1,43 @@
+/* Generated file, do not edit */
+
+#ifndef CXXTEST_RUNNING
+#define CXXTEST_RUNNING
+#endif
+
+#define _CXXTEST_HAVE_STD
+#include <cxxtest/TestListener.h>
+#include <cxxtest/TestTracker.h>
+#include <cxxtest/TestRunner.h>
+#include <cxxtest/RealDescriptions.h>
+#include <cxxtest/TestMain.h>
+#include <cxxtest/ErrorPrinter.h>
+
+int main( int argc, char *argv[] ) {
+ int status;
+    CxxTest::ErrorPrinter tmp;
+    CxxTest::RealWorldDescription::_worldName = "cxxtest";
+    status = CxxTest::Main< CxxTest::ErrorPrinter >( tmp, argc, argv );
+    return status;
+}
+bool suite_VariablesTest_init = false;
+#include "../../tests/variables.h"
+
+static VariablesTest suite_VariablesTest;
+
+static CxxTest::List Tests_VariablesTest = { 0, 0 };
+CxxTest::StaticSuiteDescription suiteDescription_VariablesTest( "/root/repo/tests/variables.h", 47, "VariablesTest", suite_VariablesTest, Tests_VariablesTest );
+
+static class TestDescription_suite_VariablesTest_test_std_vector : public CxxTest::RealTestDescription {
+public:
+ TestDescription_suite_VariablesTest_test_std_vector() : CxxTest::RealTestDescription( Tests_VariablesTest, suiteDescription_VariablesTest, 97, "test_std_vector" ) {}
+ void runTest() { suite_VariablesTest.test_std_vector(); }
+} testDescription_suite_VariablesTest_test_std_vector;
+
+static class TestDescription_suite_VariablesTest_test_thrust_vector : public CxxTest::RealTestDescription {
+public:
+ TestDescription_suite_VariablesTest_test_thrust_vector() : CxxTest::RealTestDescription( Tests_VariablesTest, suiteDescription_VariablesTest, 102, "test_thrust_vector" ) {}
+ void runTest() { suite_VariablesTest.test_thrust_vector(); }
+} testDescription_suite_VariablesTest_test_thrust_vector;
+
+#include <cxxtest/Root.cpp>
+const char* CxxTest::RealWorldDescription::_worldName = "cxxtest";
@@ -41,6 +41,7 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 // Level2
 #include "Search.h"
+#include "VerletList.h"
 
 #ifdef HAVE_EIGEN
 #include "Kernels.h"
@@ -0,0 +1,610 @@
+/*
+
+Copyright (c) 2005-2016, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Aboria.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+
+#ifndef BOUNDING_VOLUME_HIERARCHY_H_
+#define BOUNDING_VOLUME_HIERARCHY_H_
+
+#include "CudaInclude.h"
+#include "Elements.h"
+#include "Get.h"
+#include "SpatialUtil.h"
+#include "Traits.h"
+#include "Vector.h"
+#include "detail/Algorithms.h"
+
+#include "Log.h"
+#include <cstdint>
+#include <limits>
+#include <utility>
+
+namespace Aboria {
+
+namespace detail {
+
+///
+/// @brief returns the number of leading zero bits in @p x
+///
+inline CUDA_HOST_DEVICE int count_leading_zeros(const uint64_t x) {
+#if defined(__CUDA_ARCH__)
+  return __clzll(x);
+#else
+  return x == 0 ? 64 : __builtin_clzll(x);
+#endif
+}
+
+///
+/// @brief returns the length of the common prefix of the sorted keys @p i
+/// and @p j. Equal keys are made unique by appending their index, and -1 is
+/// returned if @p j is outside [0, n)
+///
+inline CUDA_HOST_DEVICE int bvh_common_prefix(const size_t *keys, const int n,
+                                              const int i, const int j) {
+  if (j < 0 || j >= n) {
+    return -1;
+  }
+  if (keys[i] == keys[j]) {
+    return 64 + count_leading_zeros(static_cast<uint64_t>(i ^ j));
+  }
+  return count_leading_zeros(static_cast<uint64_t>(keys[i] ^ keys[j]));
+}
+
+///
+/// @brief the squared distance between the point @p p and the box @p box
+/// (zero if @p p is inside @p box)
+///
+template <unsigned int D>
+CUDA_HOST_DEVICE double squared_distance_to_bbox(const Vector<double, D> &p,
+                                                 const bbox<D> &box) {
+  double accum = 0;
+  for (size_t i = 0; i < D; ++i) {
+    double dx = 0;
+    if (p[i] < box.bmin[i]) {
+      dx = box.bmin[i] - p[i];
+    } else if (p[i] > box.bmax[i]) {
+      dx = p[i] - box.bmax[i];
+    }
+    accum += dx * dx;
+  }
+  return accum;
+}
+
+///
+/// @brief returns true if the boxes @p a and @p b overlap
+///
+template <unsigned int D>
+CUDA_HOST_DEVICE bool bbox_intersects(const bbox<D> &a, const bbox<D> &b) {
+  for (size_t i = 0; i < D; ++i) {
+    if (a.bmax[i] < b.bmin[i] || b.bmax[i] < a.bmin[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+///
+/// @brief returns the closest point to @p p on an element given by its
+/// @p SelfD vertices: a point, a line segment or a triangle
+///
+template <unsigned int SelfD> struct closest_point_on_element {};
+
+template <> struct closest_point_on_element<1> {
+  template <unsigned int D>
+  CUDA_HOST_DEVICE Vector<double, D>
+  operator()(const Vector<double, D> *vertices,
+             const Vector<double, D> &p) const {
+    return vertices[0];
+  }
+};
+
+template <> struct closest_point_on_element<2> {
+  template <unsigned int D>
+  CUDA_HOST_DEVICE Vector<double, D>
+  operator()(const Vector<double, D> *vertices,
+             const Vector<double, D> &p) const {
+    const Vector<double, D> &a = vertices[0];
+    const Vector<double, D> ab = vertices[1] - a;
+    const double length2 = ab.squaredNorm();
+    double t = length2 > 0 ? (p - a).dot(ab) / length2 : 0;
+    t = t < 0 ? 0 : (t > 1 ? 1 : t);
+    return a + t * ab;
+  }
+};
+
+/// Ericson, "Real-Time Collision Detection", 2005, section 5.1.5
+template <> struct closest_point_on_element<3> {
+  template <unsigned int D>
+  CUDA_HOST_DEVICE Vector<double, D>
+  operator()(const Vector<double, D> *vertices,
+             const Vector<double, D> &p) const {
+    const Vector<double, D> &a = vertices[0];
+    const Vector<double, D> &b = vertices[1];
+    const Vector<double, D> &c = vertices[2];
+    const Vector<double, D> ab = b - a;
+    const Vector<double, D> ac = c - a;
+
+    // vertex region a
+    const Vector<double, D> ap = p - a;
+    const double d1 = ab.dot(ap);
+    const double d2 = ac.dot(ap);
+    if (d1 <= 0 && d2 <= 0) {
+      return a;
+    }
+
+    // vertex region b
+    const Vector<double, D> bp = p - b;
+    const double d3 = ab.dot(bp);
+    const double d4 = ac.dot(bp);
+    if (d3 >= 0 && d4 <= d3) {
+      return b;
+    }
+
+    // edge region ab
+    const double vc = d1 * d4 - d3 * d2;
+    if (vc <= 0 && d1 >= 0 && d3 <= 0) {
+      return a + (d1 / (d1 - d3)) * ab;
+    }
+
+    // vertex region c
+    const Vector<double, D> cp = p - c;
+    const double d5 = ab.dot(cp);
+    const double d6 = ac.dot(cp);
+    if (d6 >= 0 && d5 <= d6) {
+      return c;
+    }
+
+    // edge region ac
+    const double vb = d5 * d2 - d1 * d6;
+    if (vb <= 0 && d2 >= 0 && d6 <= 0) {
+      return a + (d2 / (d2 - d6)) * ac;
+    }
+
+    // edge region bc
+    const double va = d3 * d6 - d5 * d4;
+    if (va <= 0 && d4 - d3 >= 0 && d5 - d6 >= 0) {
+      return b + ((d4 - d3) / ((d4 - d3) + (d5 - d6))) * (c - b);
+    }
+
+    // face region
+    const double denom = 1.0 / (va + vb + vc);
+    return a + (vb * denom) * ab + (vc * denom) * ac;
+  }
+};
+
+} // namespace detail
+
+/// @brief A bounding volume hierarchy over the elements of an Elements
+/// container, for box, radius and closest-element queries
+///
+/// The hierarchy is a linear BVH (T. Karras, "Maximizing parallelism in the
+/// construction of BVHs, octrees, and k-d trees", HPG 2012). The elements
+/// are sorted by the Morton code of their centroids, and then every internal
+/// node of the binary radix tree over the sorted codes is found
+/// independently, so the construction is parallel apart from a final pass
+/// that merges the bounding boxes of the children up the tree.
+///
+/// The positions of the element vertices are copied from the particles when
+/// the hierarchy is built, so update() must be called after the particles
+/// have moved. The particles must have the find-by-id map enabled (see
+/// Particles::init_id_search()), as they do for the Elements container.
+///
+/// Elements with 1, 2 or 3 vertices are treated as points, line segments and
+/// triangles respectively. Element indices returned by the queries are
+/// indices into the Elements container.
+///
+/// @tparam ElementsType the Elements container type
+///
+template <typename ElementsType> class BoundingVolumeHierarchy {
+public:
+  typedef typename ElementsType::traits_type traits_type;
+  typedef typename ElementsType::particles_type particles_type;
+  static const unsigned int dimension = ElementsType::dimension;
+  static const unsigned int element_dimension =
+      ElementsType::element_dimension;
+  typedef Vector<double, dimension> double_d;
+  typedef bbox<dimension> box_type;
+
+private:
+  typedef typename ElementsType::particles element_particles;
+  typedef typename particles_type::position position;
+  typedef typename traits_type::vector_int vector_int;
+  typedef typename traits_type::vector_size_t vector_size_t;
+  typedef typename traits_type::vector_double_d vector_double_d;
+  typedef typename traits_type::template vector<box_type> vector_box;
+
+public:
+  ///
+  /// @brief builds the hierarchy over the elements in @p elements
+  ///
+  explicit BoundingVolumeHierarchy(const ElementsType &elements)
+      : m_elements(&elements) {
+    update();
+  }
+
+  ///
+  /// @brief rebuilds the hierarchy using the current positions of the
+  /// element vertices
+  ///
+  void update() {
+    const int n = m_elements->size();
+    const int nv = element_dimension;
+    LOG(2, "BoundingVolumeHierarchy: building over " << n << " elements");
+
+    // gather the element vertices from the particles
+    const particles_type &particles = m_elements->get_particles();
+    const auto query = particles.get_query();
+    const auto &ids = get<element_particles>(*m_elements);
+    m_vertices.resize(n * nv);
+    detail::tabulate(
+        m_vertices.begin(), m_vertices.end(), [&](const int i) {
+          auto p = query.find(ids[i / nv][i % nv]);
+          CHECK(p != query.get_particles_begin() + particles.size(),
+                "particle " << ids[i / nv][i % nv] << " does not exist");
+          return *get<position>(p);
+        });
+
+    // the bounds of each element, and of all the element centroids
+    const double_d *vertices = iterator_to_raw_pointer(m_vertices.begin());
+    m_element_bounds.resize(n);
+    detail::tabulate(m_element_bounds.begin(), m_element_bounds.end(),
+                     [=] CUDA_HOST_DEVICE(const int i) {
+                       box_type bounds(vertices[i * nv]);
+                       for (int j = 1; j < nv; ++j) {
+                         bounds = bounds + box_type(vertices[i * nv + j]);
+                       }
+                       return bounds;
+                     });
+    const box_type *element_bounds =
+        iterator_to_raw_pointer(m_element_bounds.begin());
+    vector_box centroids(n);
+    detail::tabulate(centroids.begin(), centroids.end(),
+                     [=] CUDA_HOST_DEVICE(const int i) {
+                       return box_type(0.5 * (element_bounds[i].bmin +
+                                              element_bounds[i].bmax));
+                     });
+    const box_type centroid_bounds = detail::reduce(
+        centroids.begin(), centroids.end(), box_type(),
+        [] CUDA_HOST_DEVICE(box_type a, const box_type &b) { return a + b; });
+
+    // sort the elements by the morton code of their centroids
+    const int max_level = detail::get_max_tag_level(dimension);
+    m_keys.resize(n);
+    detail::tabulate(m_keys.begin(), m_keys.end(),
+                     [=] CUDA_HOST_DEVICE(const int i) {
+                       return detail::point_to_tag(
+                           0.5 * (element_bounds[i].bmin +
+                                  element_bounds[i].bmax),
+                           centroid_bounds, max_level);
+                     });
+    m_order.resize(n);
+    detail::sequence(m_order.begin(), m_order.end());
+    detail::sort_by_key(m_keys.begin(), m_keys.end(), m_order.begin());
+
+    build_nodes();
+  }
+
+  ///
+  /// @brief returns the number of elements in the hierarchy
+  ///
+  size_t size() const { return m_order.size(); }
+
+  ///
+  /// @brief returns the bounds of all the elements
+  ///
+  box_type get_bounds() const {
+    return m_nodes_bounds.empty()
+               ? (m_element_bounds.empty() ? box_type() : m_element_bounds[0])
+               : static_cast<box_type>(m_nodes_bounds[0]);
+  }
+
+  ///
+  /// @brief returns the bounds of element @p i
+  ///
+  box_type get_element_bounds(const int i) const {
+    return m_element_bounds[i];
+  }
+
+  ///
+  /// @brief returns the distance between the point @p p and element @p i
+  ///
+  double distance(const int i, const double_d &p) const {
+    return std::sqrt(squared_distance(i, p));
+  }
+
+  ///
+  /// @brief calls @p f with the index of every element whose bounding box
+  /// intersects @p box
+  ///
+  template <typename Function>
+  void for_each_intersecting(const box_type &box, Function f) const {
+    traverse(
+        [&](const box_type &bounds) {
+          return detail::bbox_intersects(bounds, box);
+        },
+        [&](const int i) {
+          if (detail::bbox_intersects(box_type(m_element_bounds[i]), box)) {
+            f(i);
+          }
+        });
+  }
+
+  ///
+  /// @brief calls @p f with the index of, and distance to, every element
+  /// within a distance @p radius of the point @p p
+  ///
+  /// @param p the point to search around
+  /// @param radius the search radius
+  /// @param f called as `f(i, distance)` for each element `i` found
+  ///
+  template <typename Function>
+  void for_each_within(const double_d &p, const double radius,
+                       Function f) const {
+    const double radius2 = radius * radius;
+    traverse(
+        [&](const box_type &bounds) {
+          return detail::squared_distance_to_bbox(p, bounds) <= radius2;
+        },
+        [&](const int i) {
+          const double distance2 = squared_distance(i, p);
+          if (distance2 <= radius2) {
+            f(i, std::sqrt(distance2));
+          }
+        });
+  }
+
+  ///
+  /// @brief finds the closest element to the point @p p
+  ///
+  /// The tree is searched depth-first, visiting the closer child first and
+  /// pruning any node further away than the closest element found so far
+  ///
+  /// @return the index of the closest element and its distance from @p p,
+  /// or (-1, infinity) if there are no elements
+  ///
+  std::pair<int, double> closest_element(const double_d &p) const {
+    int best = -1;
+    double best_distance2 = std::numeric_limits<double>::infinity();
+    const int n = size();
+    if (n == 1) {
+      best = m_order[0];
+      best_distance2 = squared_distance(best, p);
+    } else if (n > 1) {
+      int stack[m_max_stack_size];
+      int stack_size = 0;
+      stack[stack_size++] = 0;
+      while (stack_size > 0) {
+        const int node = stack[--stack_size];
+        if (detail::squared_distance_to_bbox(
+                p, static_cast<box_type>(m_nodes_bounds[node])) >=
+            best_distance2) {
+          continue;
+        }
+        int children[2] = {m_nodes_left[node], m_nodes_right[node]};
+        double children_distance2[2];
+        for (int c = 0; c < 2; ++c) {
+          if (children[c] < 0) {
+            const int i = m_order[-children[c] - 1];
+            const double distance2 = squared_distance(i, p);
+            if (distance2 < best_distance2) {
+              best = i;
+              best_distance2 = distance2;
+            }
+            children_distance2[c] = best_distance2;
+          } else {
+            children_distance2[c] = detail::squared_distance_to_bbox(
+                p, static_cast<box_type>(m_nodes_bounds[children[c]]));
+          }
+        }
+        // push the further child first, so the closer is visited first
+        const int first = children_distance2[0] <= children_distance2[1];
+        for (int c : {first, 1 - first}) {
+          if (children[c] >= 0 && children_distance2[c] < best_distance2) {
+            ASSERT(stack_size < m_max_stack_size, "stack overflow");
+            stack[stack_size++] = children[c];
+          }
+        }
+      }
+    }
+    return std::make_pair(best, std::sqrt(best_distance2));
+  }
+
+private:
+  ///
+  /// @brief finds the children of every internal node in parallel, then
+  /// merges the bounding boxes up the tree
+  ///
+  void build_nodes() {
+    const int n = m_order.size();
+    const int n_nodes = n > 1 ? n - 1 : 0;
+    m_nodes_left.resize(n_nodes);
+    m_nodes_right.resize(n_nodes);
+    m_nodes_bounds.resize(n_nodes);
+    if (n_nodes == 0) {
+      return;
+    }
+
+    const size_t *keys = iterator_to_raw_pointer(m_keys.begin());
+    int *left = iterator_to_raw_pointer(m_nodes_left.begin());
+    int *right = iterator_to_raw_pointer(m_nodes_right.begin());
+    detail::for_each(
+        traits_type::make_counting_iterator(0),
+        traits_type::make_counting_iterator(n_nodes),
+        [=] CUDA_HOST_DEVICE(const int i) {
+          // direction of the range covered by node i
+          const int d = detail::bvh_common_prefix(keys, n, i, i + 1) >
+                                detail::bvh_common_prefix(keys, n, i, i - 1)
+                            ? 1
+                            : -1;
+
+          // find the other end of the range using a binary search
+          const int min_prefix = detail::bvh_common_prefix(keys, n, i, i - d);
+          int max_length = 2;
+          while (detail::bvh_common_prefix(keys, n, i, i + max_length * d) >
+                 min_prefix) {
+            max_length *= 2;
+          }
+          int length = 0;
+          for (int t = max_length / 2; t >= 1; t /= 2) {
+            if (detail::bvh_common_prefix(keys, n, i, i + (length + t) * d) >
+                min_prefix) {
+              length += t;
+            }
+          }
+          const int j = i + length * d;
+
+          // find the split position using a binary search
+          const int node_prefix = detail::bvh_common_prefix(keys, n, i, j);
+          int split = 0;
+          int t = length;
+          do {
+            t = (t + 1) / 2;
+            if (detail::bvh_common_prefix(keys, n, i, i + (split + t) * d) >
+                node_prefix) {
+              split += t;
+            }
+          } while (t > 1);
+          const int gamma = i + split * d + (d < 0 ? -1 : 0);
+
+          // leaves are stored as -leaf-1
+          const int first = i < j ? i : j;
+          const int last = i < j ? j : i;
+          left[i] = first == gamma ? -gamma - 1 : gamma;
+          right[i] = last == gamma + 1 ? -gamma - 2 : gamma + 1;
+        });
+
+#ifdef HAVE_OPENMP
+#pragma omp parallel
+#pragma omp single
+#endif
+    build_bounds(0, 0, n - 1);
+  }
+
+  ///
+  /// @brief sets the bounds of internal node @p node, which covers the
+  /// sorted leaves @p first to @p last, and returns them
+  ///
+  box_type build_bounds(const int node, const int first, const int last) {
+    const int left = m_nodes_left[node];
+    const int right = m_nodes_right[node];
+    const int split = left < 0 ? -left - 1 : left;
+    box_type left_bounds, right_bounds;
+    if (left < 0) {
+      left_bounds = m_element_bounds[m_order[split]];
+    } else {
+#ifdef HAVE_OPENMP
+#pragma omp task default(shared) if (split - first > 10000)
+#endif
+      left_bounds = build_bounds(left, first, split);
+    }
+    if (right < 0) {
+      right_bounds = m_element_bounds[m_order[split + 1]];
+    } else {
+      right_bounds = build_bounds(right, split + 1, last);
+    }
+#ifdef HAVE_OPENMP
+#pragma omp taskwait
+#endif
+    m_nodes_bounds[node] = left_bounds + right_bounds;
+    return m_nodes_bounds[node];
+  }
+
+  ///
+  /// @brief depth-first traversal of the tree, descending into nodes for
+  /// which @p visit_node returns true, and calling @p visit_element for the
+  /// elements in the leaves reached
+  ///
+  template <typename VisitNode, typename VisitElement>
+  void traverse(VisitNode visit_node, VisitElement visit_element) const {
+    const int n = size();
+    if (n == 1) {
+      if (visit_node(static_cast<box_type>(m_element_bounds[0]))) {
+        visit_element(m_order[0]);
+      }
+      return;
+    } else if (n == 0) {
+      return;
+    }
+    int stack[m_max_stack_size];
+    int stack_size = 0;
+    stack[stack_size++] = 0;
+    while (stack_size > 0) {
+      const int node = stack[--stack_size];
+      if (!visit_node(static_cast<box_type>(m_nodes_bounds[node]))) {
+        continue;
+      }
+      for (int child : {m_nodes_right[node], m_nodes_left[node]}) {
+        if (child < 0) {
+          visit_element(m_order[-child - 1]);
+        } else {
+          ASSERT(stack_size < m_max_stack_size, "stack overflow");
+          stack[stack_size++] = child;
+        }
+      }
+    }
+  }
+
+  double squared_distance(const int i, const double_d &p) const {
+    const double_d *vertices = &m_vertices[i * element_dimension];
+    return (detail::closest_point_on_element<element_dimension>()(vertices,
+                                                                   p) -
+            p)
+        .squaredNorm();
+  }
+
+  ///
+  /// @brief the maximum depth of the tree, which is at most the number of
+  /// bits in the keys plus the number of bits in the element index
+  ///
+  static const int m_max_stack_size = 64 + 32;
+
+  const ElementsType *m_elements;
+
+  // the vertices of each element, element_dimension per element
+  vector_double_d m_vertices;
+  // the bounding box of each element
+  vector_box m_element_bounds;
+  // the sorted morton codes and the elements in the same order
+  vector_size_t m_keys;
+  vector_int m_order;
+  // the children of each internal node (the root is node 0). Leaves are
+  // stored as -leaf-1, where leaf indexes into m_order
+  vector_int m_nodes_left;
+  vector_int m_nodes_right;
+  vector_box m_nodes_bounds;
+};
+
+} // namespace Aboria
+
+#endif /* BOUNDING_VOLUME_HIERARCHY_H_ */
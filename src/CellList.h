@@ -86,7 +86,8 @@ public:
   CellList()
       : base_type(),
         m_size_calculated_with_n(std::numeric_limits<size_t>::max()),
-        m_serial(detail::concurrent_processes<Traits>() == 1) {}
+        m_serial(detail::concurrent_processes<Traits>() == 1),
+        m_stencil_radius(0) {}
 
   ///
   /// @brief This structure is not ordered. That is, the order of the particles
@@ -102,6 +103,25 @@ public:
   struct insert_points_lambda_non_sequential;
   struct copy_points_in_bucket_lambda;
 
+  ///
+  /// @brief cache the stencil of buckets that can contain points within a
+  /// euclidean distance @p radius of a bucket
+  ///
+  /// Once set, euclidean searches with a search radius of at most @p radius
+  /// iterate over this precomputed list of bucket offsets, rather than
+  /// calculating the distance to each candidate bucket for every query point.
+  /// The stencil is rebuilt whenever the bucket size changes. Set @p radius to
+  /// zero to disable the stencil
+  ///
+  /// @param radius the maximum search radius that will use the stencil
+  ///
+  void set_stencil_radius(const double radius) {
+    m_stencil_radius = radius;
+    if (this->domain_has_been_set()) {
+      build_stencil();
+    }
+  }
+
   ///
   /// @brief Print the data structure to stdout
   ///
@@ -188,6 +208,7 @@ private:
       this->m_query.m_periodic = this->m_periodic;
       this->m_query.m_end_bucket = m_size - 1;
       this->m_query.m_point_to_bucket_index = m_point_to_bucket_index;
+      build_stencil();
       return true;
     } else {
       return false;
@@ -476,6 +497,70 @@ private:
     }
   }
 
+  ///
+  /// @brief fill the cached stencil with all the bucket offsets whose minimum
+  /// distance to the central bucket is less than m_stencil_radius, sorted by
+  /// this distance
+  ///
+  void build_stencil() {
+    typedef typename Traits::int_d int_d;
+    const unsigned int dimension = Traits::dimension;
+    const double radius2 = m_stencil_radius * m_stencil_radius;
+
+    std::vector<std::pair<double, int_d>> stencil;
+    int_d width;
+    bool use_stencil = m_stencil_radius > 0;
+    for (size_t i = 0; i < dimension; ++i) {
+      width[i] = static_cast<int>(
+          std::ceil(m_stencil_radius / m_bucket_side_length[i]));
+      // larger than the domain, the lattice search is just as good
+      if (width[i] >= static_cast<int>(m_size[i])) {
+        use_stencil = false;
+      }
+    }
+
+    if (use_stencil) {
+      for (auto offset = lattice_iterator<dimension>(-width, width + 1);
+           offset != false; ++offset) {
+        double dist2 = 0;
+        for (size_t i = 0; i < dimension; ++i) {
+          const int gap = std::abs((*offset)[i]) - 1;
+          if (gap > 0) {
+            const double dist = gap * m_bucket_side_length[i];
+            dist2 += dist * dist;
+          }
+        }
+        if (dist2 <= radius2) {
+          stencil.push_back(std::make_pair(std::sqrt(dist2), *offset));
+        }
+      }
+      std::stable_sort(stencil.begin(), stencil.end(),
+                       [](const std::pair<double, int_d> &a,
+                          const std::pair<double, int_d> &b) {
+                         return a.first < b.first;
+                       });
+    }
+
+    LOG(2, "CellList: stencil radius = " << m_stencil_radius << " with "
+                                         << stencil.size() << " buckets");
+
+    std::vector<int_d> offsets(stencil.size());
+    std::vector<double> distances(stencil.size());
+    for (size_t i = 0; i < stencil.size(); ++i) {
+      distances[i] = stencil[i].first;
+      offsets[i] = stencil[i].second;
+    }
+    m_stencil_offsets.assign(offsets.begin(), offsets.end());
+    m_stencil_distances.assign(distances.begin(), distances.end());
+
+    m_query.m_stencil_offsets = iterator_to_raw_pointer(
+        m_stencil_offsets.begin());
+    m_query.m_stencil_distances = iterator_to_raw_pointer(
+        m_stencil_distances.begin());
+    m_query.m_stencil_size = stencil.size();
+    m_query.m_stencil_radius = use_stencil ? m_stencil_radius : 0;
+  }
+
   ///
   /// @brief returns the query object via the base class
   ///
@@ -552,6 +637,22 @@ private:
   /// @brief struct to convert a point to a bucket index
   ///
   detail::point_to_bucket_index<Traits::dimension> m_point_to_bucket_index;
+
+  ///
+  /// @brief maximum search radius of the cached stencil
+  ///
+  double m_stencil_radius;
+
+  ///
+  /// @brief bucket offsets of the cached stencil
+  ///
+  typename Traits::vector_int_d m_stencil_offsets;
+
+  ///
+  /// @brief minimum distance from the central bucket to each bucket in the
+  /// cached stencil
+  ///
+  typename Traits::vector_double m_stencil_distances;
 };
 
 ///
@@ -903,6 +1004,214 @@ struct CellList<Traits>::copy_points_in_bucket_lambda {
   }
 };
 
+///
+/// @brief iterates over the buckets of a CellList that are within a given
+/// distance of a point
+///
+/// If the CellList has a cached stencil (see CellList::set_stencil_radius())
+/// that covers the search radius, then this iterates over the stencil bucket
+/// offsets around the bucket containing the query point, skipping those
+/// outside the domain. Since the stencil is sorted by the minimum distance to
+/// each bucket, the iteration stops at the first bucket beyond the search
+/// radius. Otherwise, this falls back to a @ref
+/// lattice_iterator_within_distance.
+///
+/// @tparam Query the query type (CellListQuery)
+/// @tparam LNormNumber the p-norm used for the distance. Only the euclidean
+/// norm (2) uses the stencil
+///
+template <typename Query, int LNormNumber> class cell_list_stencil_iterator {
+  typedef cell_list_stencil_iterator<Query, LNormNumber> iterator;
+  typedef lattice_iterator_within_distance<Query, LNormNumber>
+      lattice_iterator_type;
+  static const unsigned int dimension = Query::dimension;
+  typedef Vector<double, dimension> double_d;
+  typedef Vector<int, dimension> int_d;
+
+public:
+  typedef typename lattice_iterator_type::pointer pointer;
+  typedef std::forward_iterator_tag iterator_category;
+  typedef typename lattice_iterator_type::reference reference;
+  typedef typename lattice_iterator_type::value_type value_type;
+  typedef std::ptrdiff_t difference_type;
+
+  CUDA_HOST_DEVICE
+  cell_list_stencil_iterator()
+      : m_query(nullptr), m_use_stencil(false), m_stencil_index(0),
+        m_stencil_end(0), m_max_distance(0) {}
+
+  CUDA_HOST_DEVICE
+  cell_list_stencil_iterator(const double_d &query_point,
+                             const double_d &max_distance, const Query *query)
+      : m_query(query), m_use_stencil(use_stencil(max_distance, query)),
+        m_stencil_index(0), m_stencil_end(0), m_max_distance(0) {
+    if (m_use_stencil) {
+      m_max_distance = max_distance[0];
+      m_base_index =
+          m_query->m_point_to_bucket_index.find_bucket_index_vector(
+              query_point);
+      if (!outside_domain(query_point, max_distance)) {
+        m_stencil_end = m_query->m_stencil_size;
+        go_to_valid_bucket();
+      }
+    } else {
+      m_lattice = lattice_iterator_type(query_point, max_distance, query);
+    }
+  }
+
+  CUDA_HOST_DEVICE
+  explicit operator size_t() const {
+    return m_query->m_point_to_bucket_index.collapse_index_vector(
+        dereference());
+  }
+
+  lattice_iterator<dimension> get_child_iterator() const {
+    lattice_iterator<dimension> ret = m_query->get_subtree();
+    ret = dereference();
+    return ret;
+  }
+
+  CUDA_HOST_DEVICE
+  reference operator*() const { return dereference(); }
+
+  CUDA_HOST_DEVICE
+  reference operator->() const { return dereference(); }
+
+  CUDA_HOST_DEVICE
+  iterator &operator++() {
+    increment();
+    return *this;
+  }
+
+  CUDA_HOST_DEVICE
+  iterator operator++(int) {
+    iterator tmp(*this);
+    operator++();
+    return tmp;
+  }
+
+  CUDA_HOST_DEVICE
+  size_t operator-(const iterator &start) const {
+    int distance = 0;
+    iterator tmp = start;
+    while (tmp != *this) {
+      ++distance;
+      ++tmp;
+    }
+    return distance;
+  }
+
+  CUDA_HOST_DEVICE
+  inline bool operator==(const iterator &rhs) const { return equal(rhs); }
+
+  CUDA_HOST_DEVICE
+  inline bool operator==(const bool rhs) const { return equal(rhs); }
+
+  CUDA_HOST_DEVICE
+  inline bool operator!=(const iterator &rhs) const { return !operator==(rhs); }
+
+  CUDA_HOST_DEVICE
+  inline bool operator!=(const bool rhs) const { return !operator==(rhs); }
+
+private:
+  CUDA_HOST_DEVICE
+  static bool use_stencil(const double_d &max_distance, const Query *query) {
+    if (LNormNumber != 2 || query->m_stencil_size == 0) {
+      return false;
+    }
+    for (size_t i = 0; i < dimension; ++i) {
+      if (max_distance[i] != max_distance[0] ||
+          max_distance[i] > query->m_stencil_radius) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  CUDA_HOST_DEVICE
+  bool outside_domain(const double_d &position, const double_d &max_distance) {
+    const int_d start =
+        m_query->m_point_to_bucket_index.find_bucket_index_vector(
+            position - max_distance);
+    const int_d end = m_query->m_point_to_bucket_index.find_bucket_index_vector(
+        position + max_distance);
+    for (size_t i = 0; i < dimension; i++) {
+      if (start[i] > m_query->m_end_bucket[i] || end[i] < 0) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  CUDA_HOST_DEVICE
+  void go_to_valid_bucket() {
+    for (; m_stencil_index < m_stencil_end; ++m_stencil_index) {
+      if (m_query->m_stencil_distances[m_stencil_index] > m_max_distance) {
+        // stencil is sorted by distance, so no more buckets in range
+        m_stencil_end = m_stencil_index;
+        return;
+      }
+      const int_d &offset = m_query->m_stencil_offsets[m_stencil_index];
+      bool in_domain = true;
+      for (size_t i = 0; i < dimension; ++i) {
+        m_index[i] = m_base_index[i] + offset[i];
+        if (m_index[i] < 0 || m_index[i] > m_query->m_end_bucket[i]) {
+          in_domain = false;
+          break;
+        }
+      }
+      if (in_domain) {
+        return;
+      }
+    }
+  }
+
+  CUDA_HOST_DEVICE
+  bool valid() const {
+    return m_use_stencil ? m_stencil_index < m_stencil_end : m_lattice != false;
+  }
+
+  CUDA_HOST_DEVICE
+  bool equal(iterator const &other) const {
+    if (!other.valid())
+      return !valid();
+    if (!valid())
+      return false;
+    if (m_use_stencil != other.m_use_stencil)
+      return false;
+    if (m_use_stencil)
+      return m_stencil_index == other.m_stencil_index;
+    return m_lattice == other.m_lattice;
+  }
+
+  CUDA_HOST_DEVICE
+  bool equal(const bool other) const { return valid() == other; }
+
+  CUDA_HOST_DEVICE
+  reference dereference() const {
+    return m_use_stencil ? m_index : *m_lattice;
+  }
+
+  CUDA_HOST_DEVICE
+  void increment() {
+    if (m_use_stencil) {
+      ++m_stencil_index;
+      go_to_valid_bucket();
+    } else {
+      ++m_lattice;
+    }
+  }
+
+  const Query *m_query;
+  bool m_use_stencil;
+  size_t m_stencil_index;
+  size_t m_stencil_end;
+  double m_max_distance;
+  int_d m_base_index;
+  value_type m_index;
+  lattice_iterator_type m_lattice;
+};
+
 /// @copydetails NeighbourQueryBase
 ///
 /// @brief This is a query object for the CellList spatial data structure
@@ -920,8 +1229,7 @@ struct CellListQuery : public NeighbourQueryBase<Traits> {
   typedef typename Traits::const_reference particle_const_reference;
   const static unsigned int dimension = Traits::dimension;
   template <int LNormNumber>
-  using query_iterator =
-      lattice_iterator_within_distance<CellListQuery, LNormNumber>;
+  using query_iterator = cell_list_stencil_iterator<CellListQuery, LNormNumber>;
 
   typedef lattice_iterator<dimension> all_iterator;
   typedef lattice_iterator<dimension> child_iterator;
@@ -966,6 +1274,17 @@ struct CellListQuery : public NeighbourQueryBase<Traits> {
   ///
   raw_pointer m_particles_end;
 
+  ///
+  /// @brief the particle positions stored as a structure-of-arrays (if
+  /// enabled)
+  ///
+  detail::position_soa<dimension> m_position_soa;
+
+  ///
+  /// @brief the ghost particles of a periodic domain (if enabled)
+  ///
+  detail::ghost_halo<dimension> m_ghosts;
+
   ///
   /// @brief pointer to the beginning of the buckets
   ///
@@ -977,14 +1296,29 @@ struct CellListQuery : public NeighbourQueryBase<Traits> {
   int *m_linked_list_begin;
 
   ///
-  /// @brief pointer to the find-by-id map key
+  /// @brief the find-by-id hash table
+  ///
+  detail::id_map_table m_id_map;
+
+  ///
+  /// @brief pointer to the bucket offsets of the cached stencil
   ///
-  size_t *m_id_map_key;
+  int_d *m_stencil_offsets;
 
   ///
-  /// @brief pointer to the find-by-id map value
+  /// @brief pointer to the minimum distances of the cached stencil buckets
   ///
-  size_t *m_id_map_value;
+  double *m_stencil_distances;
+
+  ///
+  /// @brief number of buckets in the cached stencil
+  ///
+  size_t m_stencil_size;
+
+  ///
+  /// @brief maximum search radius that can use the cached stencil
+  ///
+  double m_stencil_radius;
 
   ///
   /// @brief constructor checks that we are not using std::vector and cuda
@@ -992,7 +1326,7 @@ struct CellListQuery : public NeighbourQueryBase<Traits> {
   ///
   ABORIA_HOST_DEVICE_IGNORE_WARN
   CUDA_HOST_DEVICE
-  CellListQuery() {
+  CellListQuery() : m_stencil_size(0), m_stencil_radius(0) {
 #if defined(__CUDA_ARCH__)
     CHECK_CUDA((!std::is_same<typename Traits::template vector<double>,
                               std::vector<double>>::value),
@@ -1007,13 +1341,7 @@ struct CellListQuery : public NeighbourQueryBase<Traits> {
   CUDA_HOST_DEVICE
   raw_pointer find(const size_t id) const {
     const size_t n = number_of_particles();
-    size_t *last = m_id_map_key + n;
-    size_t *first = detail::lower_bound(m_id_map_key, last, id);
-    if ((first != last) && !(id < *first)) {
-      return m_particles_begin + m_id_map_value[first - m_id_map_key];
-    } else {
-      return m_particles_begin + n;
-    }
+    return m_particles_begin + m_id_map.find(id, n);
   }
 
   /*
@@ -1118,6 +1446,21 @@ struct CellListQuery : public NeighbourQueryBase<Traits> {
                              m_linked_list_begin);
   }
 
+  ///
+  /// @copydoc NeighbourQueryBase::number_of_particles(const reference) const
+  ///
+  /// Note that this walks the linked list of particles in the bucket
+  ///
+  ABORIA_HOST_DEVICE_IGNORE_WARN
+  CUDA_HOST_DEVICE
+  size_t number_of_particles(const reference bucket) const {
+    size_t count = 0;
+    for (auto i = get_bucket_particles(bucket); i != false; ++i) {
+      ++count;
+    }
+    return count;
+  }
+
   ///
   /// @copydoc NeighbourQueryBase::get_bucket_bbox()
   ///
@@ -0,0 +1,915 @@
+/*
+
+Copyright (c) 2005-2016, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Aboria.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+
+#ifndef CELL_LIST_MULTI_LEVEL_H_
+#define CELL_LIST_MULTI_LEVEL_H_
+
+#include "CudaInclude.h"
+#include "Get.h"
+#include "NeighbourSearchBase.h"
+#include "Search.h"
+#include "SpatialUtil.h"
+#include "Traits.h"
+#include "Variable.h"
+#include "Vector.h"
+#include "detail/Algorithms.h"
+
+#include "Log.h"
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+namespace Aboria {
+
+namespace detail {
+
+///
+/// @brief one level of the grid hierarchy used by CellListMultiLevel
+///
+template <unsigned int D> struct cell_list_level {
+  typedef Vector<double, D> double_d;
+  typedef Vector<int, D> int_d;
+  static const unsigned int dimension = D;
+
+  ///
+  /// @brief function object to transform a point to a bucket index within
+  /// this level
+  ///
+  point_to_bucket_index<D> m_point_to_bucket_index;
+
+  ///
+  /// @brief index of the last bucket in this level
+  ///
+  int_d m_end_bucket;
+
+  ///
+  /// @brief the smallest side length of the buckets in this level
+  ///
+  double m_min_side_length;
+
+  ///
+  /// @brief an upper bound on the search radius of the particles binned at
+  /// this level
+  ///
+  double m_max_radius;
+
+  ///
+  /// @brief index of the first bucket of this level in the bucket arrays
+  ///
+  unsigned int m_offset;
+
+  ///
+  /// @brief the number of buckets in this level
+  ///
+  unsigned int m_nbuckets;
+};
+
+///
+/// @brief a bucket of CellListMultiLevel, given by the level and the index
+/// of the bucket within that level
+///
+template <unsigned int D> struct cell_list_level_bucket {
+  Vector<int, D> m_index;
+  unsigned int m_level;
+};
+
+///
+/// @brief function object that converts a particle position and search
+/// radius to the index of its bucket. Each particle is binned at the finest
+/// level with buckets at least as wide as the particle diameter
+///
+template <unsigned int D> struct point_to_level_bucket_index {
+  typedef Vector<double, D> double_d;
+
+  const cell_list_level<D> *m_levels;
+  unsigned int m_nlevels;
+
+  CUDA_HOST_DEVICE
+  point_to_level_bucket_index() {}
+
+  CUDA_HOST_DEVICE
+  point_to_level_bucket_index(const cell_list_level<D> *levels,
+                              const unsigned int nlevels)
+      : m_levels(levels), m_nlevels(nlevels) {}
+
+  CUDA_HOST_DEVICE
+  unsigned int find_level(const double radius) const {
+    unsigned int level = 0;
+    while (level + 1 < m_nlevels &&
+           2 * radius > m_levels[level].m_min_side_length) {
+      ++level;
+    }
+    return level;
+  }
+
+  CUDA_HOST_DEVICE
+  unsigned int operator()(const double_d &point, const double radius) const {
+    const cell_list_level<D> &level = m_levels[find_level(radius)];
+    return level.m_offset + level.m_point_to_bucket_index(point);
+  }
+};
+
+} // namespace detail
+
+template <typename Traits> struct CellListMultiLevelQuery;
+
+/// @brief A multi-level cell list (hierarchical grid) spatial data structure
+/// for particles with a variable search radius, paired with a
+/// CellListMultiLevelQuery query type
+///
+/// The domain is covered by a hierarchy of regular grids, each with buckets
+/// twice the size of the level below. The finest level is sized using the
+/// number of particles in each bucket (like CellListOrdered), but is never
+/// finer than the smallest particle diameter. Each particle is binned at the
+/// finest level with buckets at least as wide as its diameter, and the
+/// particle set is reordered by level, then by bucket.
+///
+/// The search radius of each particle is read from the @ref
+/// multi_level_radius variable, which must be one of the variables of the
+/// particle set.
+/// CellListMultiLevelQuery::get_buckets_near_sphere() (and
+/// for_each_overlapping()) then finds the particles whose spheres overlap a
+/// given sphere, searching each level only as far as the largest radius
+/// binned at that level, so small particles do not search the buckets sized
+/// for the large ones, and large particles do not search lots of small
+/// buckets.
+///
+template <typename Traits>
+class CellListMultiLevel
+    : public neighbour_search_base<CellListMultiLevel<Traits>, Traits,
+                                   CellListMultiLevelQuery<Traits>> {
+
+  typedef typename Traits::double_d double_d;
+  typedef typename Traits::position position;
+  typedef typename Traits::vector_unsigned_int vector_unsigned_int;
+  typedef typename Traits::unsigned_int_d unsigned_int_d;
+  typedef typename Traits::iterator iterator;
+  typedef detail::cell_list_level<Traits::dimension> level_type;
+  typedef typename Traits::template vector<level_type> vector_level;
+
+  typedef neighbour_search_base<CellListMultiLevel<Traits>, Traits,
+                                CellListMultiLevelQuery<Traits>>
+      base_type;
+
+  friend base_type;
+
+public:
+  CellListMultiLevel() : base_type() {}
+
+  static constexpr bool ordered() { return true; }
+
+  ///
+  /// @brief the maximum number of levels in the hierarchy
+  ///
+  static constexpr unsigned int max_levels() { return 24; }
+
+  void print_data_structure() const {
+#ifndef __CUDA_ARCH__
+    LOG(1, "\tlevels:");
+    for (size_t i = 0; i < m_host_levels.size(); ++i) {
+      LOG(1, "\ti = " << i << " number of buckets = "
+                      << m_host_levels[i].m_end_bucket + 1
+                      << " max radius = " << m_host_levels[i].m_max_radius);
+    }
+    LOG(1, "\tend levels");
+    LOG(1, "\tbuckets:");
+    for (size_t i = 0; i < m_bucket_begin.size(); ++i) {
+      LOG(1, "\ti = " << i << " bucket contents = " << m_bucket_begin[i]
+                      << " to " << m_bucket_end[i]);
+    }
+    LOG(1, "\tend buckets");
+    LOG(1, "\tparticles:");
+    for (size_t i = 0; i < m_bucket_indices.size(); ++i) {
+      LOG(1, "\ti = " << i << " p = "
+                      << static_cast<const double_d &>(
+                             get<position>(*(this->m_particles_begin + i)))
+                      << " r = "
+                      << get<multi_level_radius>(*(this->m_particles_begin + i))
+                      << " bucket = " << m_bucket_indices[i]);
+    }
+    LOG(1, "\tend particles:");
+#endif
+  }
+
+private:
+  bool set_domain_impl() {
+    set_levels(0, 0);
+    return true;
+  }
+
+  ///
+  /// @brief sets up the grid hierarchy for particles with search radii
+  /// between @p min_radius and @p max_radius
+  ///
+  void set_levels(const double min_radius, const double max_radius) {
+    const size_t n = this->m_alive_indices.size();
+    const double_d width = this->m_bounds.bmax - this->m_bounds.bmin;
+
+    // the finest level has buckets at least as wide as the smallest particle
+    double side_length = 0;
+    if (this->m_n_particles_in_leaf <= n) {
+      const double box_volume =
+          this->m_n_particles_in_leaf / double(n) * width.prod();
+      side_length = std::pow(box_volume, 1.0 / Traits::dimension);
+    } else {
+      side_length = width.maxCoeff();
+    }
+    if (2 * min_radius > side_length) {
+      side_length = 2 * min_radius;
+    }
+    unsigned_int_d size =
+        floor(width / side_length).template cast<unsigned int>();
+    for (size_t i = 0; i < Traits::dimension; ++i) {
+      if (size[i] == 0) {
+        size[i] = 1;
+      }
+    }
+
+    // keep halving the number of buckets until the largest particle fits in
+    // a bucket, or there is only one bucket left
+    m_host_levels.clear();
+    unsigned int offset = 0;
+    while (true) {
+      level_type level;
+      const double_d bucket_side_length = width / size;
+      level.m_point_to_bucket_index =
+          detail::point_to_bucket_index<Traits::dimension>(
+              size, bucket_side_length, this->m_bounds);
+      level.m_end_bucket = size.template cast<int>() - 1;
+      level.m_min_side_length = bucket_side_length.minCoeff();
+      level.m_max_radius = 0.5 * level.m_min_side_length < max_radius
+                               ? 0.5 * level.m_min_side_length
+                               : max_radius;
+      level.m_offset = offset;
+      level.m_nbuckets = size.prod();
+      offset += level.m_nbuckets;
+      m_host_levels.push_back(level);
+
+      bool single_bucket = true;
+      for (size_t i = 0; i < Traits::dimension; ++i) {
+        single_bucket &= size[i] == 1;
+        size[i] = size[i] > 1 ? size[i] / 2 : 1;
+      }
+      if (2 * max_radius <= level.m_min_side_length || single_bucket ||
+          m_host_levels.size() == max_levels()) {
+        break;
+      }
+    }
+    m_host_levels.back().m_max_radius = max_radius;
+
+    LOG(2, "CellListMultiLevel: radius range = ("
+               << min_radius << "," << max_radius << ") number of levels = "
+               << m_host_levels.size() << " finest bucket side length = "
+               << width / (m_host_levels[0].m_end_bucket + 1)
+               << " total number of buckets = " << offset);
+
+    m_levels.resize(m_host_levels.size());
+    detail::copy(m_host_levels.begin(), m_host_levels.end(),
+                 m_levels.begin());
+    m_bucket_begin.resize(offset);
+    m_bucket_end.resize(offset);
+    m_point_to_level_bucket_index =
+        detail::point_to_level_bucket_index<Traits::dimension>(
+            iterator_to_raw_pointer(m_levels.begin()), m_levels.size());
+
+    this->m_query.m_levels = iterator_to_raw_pointer(m_levels.begin());
+    this->m_query.m_nlevels = m_levels.size();
+    this->m_query.m_bucket_begin =
+        iterator_to_raw_pointer(m_bucket_begin.begin());
+    this->m_query.m_bucket_end = iterator_to_raw_pointer(m_bucket_end.begin());
+    this->m_query.m_nbuckets = offset;
+    this->m_query.m_bounds.bmin = this->m_bounds.bmin;
+    this->m_query.m_bounds.bmax = this->m_bounds.bmax;
+    this->m_query.m_periodic = this->m_periodic;
+    this->m_query.m_point_to_level_bucket_index =
+        m_point_to_level_bucket_index;
+  }
+
+  void update_iterator_impl() {}
+
+  void update_positions_impl(iterator update_begin, iterator update_end,
+                             const int new_n,
+                             const bool call_set_domain = true) {
+
+    ASSERT(update_begin == this->m_particles_begin &&
+               update_end == this->m_particles_end,
+           "error should be update all");
+
+    const size_t n = this->m_alive_indices.size();
+
+    // the hierarchy depends on the range of search radii, so is always
+    // recalculated
+    double min_radius = 0;
+    double max_radius = 0;
+    if (n > 0) {
+      auto radii = Traits::make_permutation_iterator(
+          get<multi_level_radius>(this->m_particles_begin),
+          this->m_alive_indices.begin());
+      min_radius = detail::reduce(
+          radii, radii + n, detail::get_max<double>(),
+          [] CUDA_HOST_DEVICE(const double a, const double b) {
+            return a < b ? a : b;
+          });
+      max_radius = detail::reduce(
+          radii, radii + n, 0.0,
+          [] CUDA_HOST_DEVICE(const double a, const double b) {
+            return a < b ? b : a;
+          });
+    }
+    set_levels(min_radius, max_radius);
+
+    m_bucket_indices.resize(n);
+    if (n > 0) {
+      // transform the points and radii to their bucket indices
+      const double_d *positions =
+          iterator_to_raw_pointer(get<position>(this->m_particles_begin));
+      const double *radii = iterator_to_raw_pointer(
+          get<multi_level_radius>(this->m_particles_begin));
+      const int *alive_indices =
+          iterator_to_raw_pointer(this->m_alive_indices.begin());
+      const auto point_to_index = m_point_to_level_bucket_index;
+      detail::tabulate(m_bucket_indices.begin(), m_bucket_indices.end(),
+                       [=] CUDA_HOST_DEVICE(const int i) {
+                         const int j = alive_indices[i];
+                         return point_to_index(positions[j], radii[j]);
+                       });
+
+      // sort the points by their bucket index
+      detail::sort_by_key(m_bucket_indices.begin(), m_bucket_indices.end(),
+                          this->m_alive_indices.begin());
+    }
+
+    // find the beginning of each bucket's list of points
+    auto search_begin = Traits::make_counting_iterator(0);
+    detail::lower_bound(m_bucket_indices.begin(), m_bucket_indices.end(),
+                        search_begin, search_begin + m_bucket_begin.size(),
+                        m_bucket_begin.begin());
+
+    // find the end of each bucket's list of points
+    detail::upper_bound(m_bucket_indices.begin(), m_bucket_indices.end(),
+                        search_begin, search_begin + m_bucket_end.size(),
+                        m_bucket_end.begin());
+
+#ifndef __CUDA_ARCH__
+    if (4 <= ABORIA_LOG_LEVEL) {
+      print_data_structure();
+    }
+#endif
+  }
+
+  const CellListMultiLevelQuery<Traits> &get_query_impl() const {
+    return m_query;
+  }
+
+  CellListMultiLevelQuery<Traits> &get_query_impl() { return m_query; }
+
+  // the buckets of all the levels are stored contiguously, level by level
+  vector_unsigned_int m_bucket_begin;
+  vector_unsigned_int m_bucket_end;
+  vector_unsigned_int m_bucket_indices;
+  std::vector<level_type> m_host_levels;
+  vector_level m_levels;
+  CellListMultiLevelQuery<Traits> m_query;
+
+  detail::point_to_level_bucket_index<Traits::dimension>
+      m_point_to_level_bucket_index;
+};
+
+///
+/// @brief iterator over the buckets of a CellListMultiLevelQuery that are
+/// within a given distance of a point. The levels are searched in turn, and
+/// the distance can be extended at each level by the largest search radius
+/// binned at that level
+///
+template <typename Query, int LNormNumber>
+class cell_list_multi_level_iterator {
+  typedef cell_list_multi_level_iterator<Query, LNormNumber> iterator;
+  static const unsigned int dimension = Query::dimension;
+  typedef Vector<double, dimension> double_d;
+  typedef detail::cell_list_level<dimension> level_type;
+  typedef lattice_iterator_within_distance<level_type, LNormNumber>
+      level_iterator;
+
+public:
+  typedef detail::cell_list_level_bucket<dimension> value_type;
+  typedef const value_type *pointer;
+  typedef std::forward_iterator_tag iterator_category;
+  typedef const value_type &reference;
+  typedef std::ptrdiff_t difference_type;
+
+  CUDA_HOST_DEVICE
+  cell_list_multi_level_iterator() : m_query(nullptr) {}
+
+  CUDA_HOST_DEVICE
+  cell_list_multi_level_iterator(const double_d &query_point,
+                                 const double_d &max_distance,
+                                 const bool add_level_radius,
+                                 const Query *query)
+      : m_query_point(query_point), m_max_distance(max_distance),
+        m_add_level_radius(add_level_radius), m_query(query) {
+    m_bucket.m_level = 0;
+    start_level();
+  }
+
+  CUDA_HOST_DEVICE
+  reference operator*() const { return m_bucket; }
+
+  CUDA_HOST_DEVICE
+  pointer operator->() const { return &m_bucket; }
+
+  CUDA_HOST_DEVICE
+  iterator &operator++() {
+    increment();
+    return *this;
+  }
+
+  CUDA_HOST_DEVICE
+  iterator operator++(int) {
+    iterator tmp(*this);
+    operator++();
+    return tmp;
+  }
+
+  CUDA_HOST_DEVICE
+  inline bool operator==(const iterator &rhs) const { return equal(rhs); }
+
+  CUDA_HOST_DEVICE
+  inline bool operator==(const bool rhs) const { return valid() == rhs; }
+
+  CUDA_HOST_DEVICE
+  inline bool operator!=(const iterator &rhs) const { return !operator==(rhs); }
+
+  CUDA_HOST_DEVICE
+  inline bool operator!=(const bool rhs) const { return !operator==(rhs); }
+
+private:
+  CUDA_HOST_DEVICE
+  bool valid() const {
+    return m_query != nullptr && m_bucket.m_level < m_query->m_nlevels;
+  }
+
+  CUDA_HOST_DEVICE
+  bool equal(const iterator &other) const {
+    if (!valid() || !other.valid()) {
+      return valid() == other.valid();
+    }
+    if (m_bucket.m_level != other.m_bucket.m_level) {
+      return false;
+    }
+    for (size_t i = 0; i < dimension; ++i) {
+      if (m_bucket.m_index[i] != other.m_bucket.m_index[i]) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  ///
+  /// @brief starts searching the current level, moving on to the next
+  /// level if there are no particles or buckets to search
+  ///
+  CUDA_HOST_DEVICE
+  void start_level() {
+    while (m_bucket.m_level < m_query->m_nlevels) {
+      const level_type &level = m_query->m_levels[m_bucket.m_level];
+      if (!m_query->empty_level(m_bucket.m_level)) {
+        const double_d max_distance =
+            m_add_level_radius ? m_max_distance + level.m_max_radius
+                               : m_max_distance;
+        m_level_iterator =
+            level_iterator(m_query_point, max_distance, &level);
+        if (m_level_iterator != false) {
+          m_bucket.m_index = *m_level_iterator;
+          return;
+        }
+      }
+      ++m_bucket.m_level;
+    }
+  }
+
+  CUDA_HOST_DEVICE
+  void increment() {
+    ++m_level_iterator;
+    if (m_level_iterator != false) {
+      m_bucket.m_index = *m_level_iterator;
+    } else {
+      ++m_bucket.m_level;
+      start_level();
+    }
+  }
+
+  double_d m_query_point;
+  double_d m_max_distance;
+  bool m_add_level_radius;
+  const Query *m_query;
+  level_iterator m_level_iterator;
+  value_type m_bucket;
+};
+
+/// @copydetails NeighbourQueryBase
+///
+/// @brief This is a query object for the CellListMultiLevel spatial data
+/// structure
+///
+template <typename Traits>
+struct CellListMultiLevelQuery : public NeighbourQueryBase<Traits> {
+
+  typedef Traits traits_type;
+  typedef typename Traits::raw_pointer raw_pointer;
+  typedef typename Traits::double_d double_d;
+  typedef typename Traits::bool_d bool_d;
+  typedef typename Traits::int_d int_d;
+  const static unsigned int dimension = Traits::dimension;
+  template <int LNormNumber>
+  using query_iterator =
+      cell_list_multi_level_iterator<CellListMultiLevelQuery, LNormNumber>;
+  typedef typename query_iterator<2>::reference reference;
+  typedef typename query_iterator<2>::pointer pointer;
+  typedef typename query_iterator<2>::value_type value_type;
+  typedef ranges_iterator<Traits> particle_iterator;
+  typedef bbox<dimension> box_type;
+
+  ///
+  /// @brief pointer to the beginning of the particle set
+  ///
+  raw_pointer m_particles_begin;
+
+  ///
+  /// @brief pointer to the end of the particle set
+  ///
+  raw_pointer m_particles_end;
+
+  ///
+  /// @brief the particle positions stored as a structure-of-arrays (if
+  /// enabled)
+  ///
+  detail::position_soa<dimension> m_position_soa;
+
+  ///
+  /// @brief the ghost particles of a periodic domain (if enabled)
+  ///
+  detail::ghost_halo<dimension> m_ghosts;
+
+  ///
+  /// @brief periodicity of the domain
+  ///
+  bool_d m_periodic;
+
+  ///
+  /// @brief min/max bounds of the domain
+  ///
+  bbox<dimension> m_bounds;
+
+  ///
+  /// @brief pointer to the levels of the grid hierarchy, finest first
+  ///
+  const detail::cell_list_level<dimension> *m_levels;
+
+  ///
+  /// @brief the number of levels
+  ///
+  unsigned int m_nlevels;
+
+  ///
+  /// @brief function object to transform a point and radius to a bucket
+  /// index
+  ///
+  detail::point_to_level_bucket_index<dimension> m_point_to_level_bucket_index;
+
+  ///
+  /// @brief pointer to the beginning of the buckets
+  ///
+  unsigned int *m_bucket_begin;
+
+  ///
+  /// @brief pointer to the end of the buckets
+  ///
+  unsigned int *m_bucket_end;
+
+  ///
+  /// @brief the total number of buckets over all the levels
+  ///
+  unsigned int m_nbuckets;
+
+  ///
+  /// @brief the find-by-id hash table
+  ///
+  detail::id_map_table m_id_map;
+
+  ABORIA_HOST_DEVICE_IGNORE_WARN
+  CUDA_HOST_DEVICE
+  CellListMultiLevelQuery() {}
+
+  /*
+   * functions for id mapping
+   */
+
+  ///
+  /// @copydoc NeighbourQueryBase::find()
+  ///
+  ABORIA_HOST_DEVICE_IGNORE_WARN
+  CUDA_HOST_DEVICE
+  raw_pointer find(const size_t id) const {
+    const size_t n = number_of_particles();
+    return m_particles_begin + m_id_map.find(id, n);
+  }
+
+  ///
+  /// @copydoc NeighbourQueryBase::is_leaf_node()
+  ///
+  /// always true for CellListMultiLevel
+  ///
+  ABORIA_HOST_DEVICE_IGNORE_WARN
+  CUDA_HOST_DEVICE
+  static bool is_leaf_node(const value_type &bucket) { return true; }
+
+  ///
+  /// @copydoc NeighbourQueryBase::is_tree()
+  ///
+  /// always false for CellListMultiLevel
+  ///
+  ABORIA_HOST_DEVICE_IGNORE_WARN
+  CUDA_HOST_DEVICE
+  static bool is_tree() { return false; }
+
+  ///
+  /// @copydoc NeighbourQueryBase::get_bounds()
+  ///
+  ABORIA_HOST_DEVICE_IGNORE_WARN
+  CUDA_HOST_DEVICE
+  const box_type &get_bounds() const { return m_bounds; }
+
+  ///
+  /// @copydoc NeighbourQueryBase::get_periodic()
+  ///
+  ABORIA_HOST_DEVICE_IGNORE_WARN
+  CUDA_HOST_DEVICE
+  const bool_d &get_periodic() const { return m_periodic; }
+
+  ///
+  /// @brief returns true if there are no particles binned at level @p level
+  ///
+  ABORIA_HOST_DEVICE_IGNORE_WARN
+  CUDA_HOST_DEVICE
+  bool empty_level(const unsigned int level) const {
+    const detail::cell_list_level<dimension> &l = m_levels[level];
+    return m_bucket_begin[l.m_offset] ==
+           m_bucket_end[l.m_offset + l.m_nbuckets - 1];
+  }
+
+  ///
+  /// @copydoc NeighbourQueryBase::get_bucket_particles()
+  ///
+  ABORIA_HOST_DEVICE_IGNORE_WARN
+  CUDA_HOST_DEVICE
+  particle_iterator get_bucket_particles(const reference bucket) const {
+    const detail::cell_list_level<dimension> &level =
+        m_levels[bucket.m_level];
+#ifndef __CUDA_ARCH__
+    ASSERT(bucket.m_level < m_nlevels, "invalid level");
+    ASSERT((bucket.m_index >= int_d::Constant(0)).all() &&
+               (bucket.m_index <= level.m_end_bucket).all(),
+           "invalid bucket");
+#endif
+
+    const unsigned int bucket_index =
+        level.m_offset +
+        level.m_point_to_bucket_index.collapse_index_vector(bucket.m_index);
+    const unsigned int range_start_index = m_bucket_begin[bucket_index];
+    const unsigned int range_end_index = m_bucket_end[bucket_index];
+
+#ifndef __CUDA_ARCH__
+    LOG(4, "\tlooking in bucket " << bucket.m_index << " of level "
+                                  << bucket.m_level << " = " << bucket_index
+                                  << ". found "
+                                  << range_end_index - range_start_index
+                                  << " particles");
+#endif
+    return particle_iterator(m_particles_begin + range_start_index,
+                             m_particles_begin + range_end_index);
+  }
+
+  ///
+  /// @copydoc NeighbourQueryBase::number_of_particles(const reference) const
+  ///
+  ABORIA_HOST_DEVICE_IGNORE_WARN
+  CUDA_HOST_DEVICE
+  size_t number_of_particles(const reference bucket) const {
+    const detail::cell_list_level<dimension> &level =
+        m_levels[bucket.m_level];
+    const unsigned int bucket_index =
+        level.m_offset +
+        level.m_point_to_bucket_index.collapse_index_vector(bucket.m_index);
+    return m_bucket_end[bucket_index] - m_bucket_begin[bucket_index];
+  }
+
+  ///
+  /// @copydoc NeighbourQueryBase::get_bucket_bbox()
+  ///
+  ABORIA_HOST_DEVICE_IGNORE_WARN
+  CUDA_HOST_DEVICE
+  bbox<dimension> get_bucket_bbox(const reference bucket) const {
+    const detail::point_to_bucket_index<dimension> &point_to_bucket_index =
+        m_levels[bucket.m_level].m_point_to_bucket_index;
+    return bbox<dimension>(
+        bucket.m_index * point_to_bucket_index.m_bucket_side_length +
+            m_bounds.bmin,
+        (bucket.m_index + 1) * point_to_bucket_index.m_bucket_side_length +
+            m_bounds.bmin);
+  }
+
+  ///
+  /// @copydoc NeighbourQueryBase::get_bucket_index()
+  ///
+  ABORIA_HOST_DEVICE_IGNORE_WARN
+  CUDA_HOST_DEVICE
+  size_t get_bucket_index(const reference bucket) const {
+    const detail::cell_list_level<dimension> &level =
+        m_levels[bucket.m_level];
+    return level.m_offset +
+           level.m_point_to_bucket_index.collapse_index_vector(bucket.m_index);
+  }
+
+  ///
+  /// @copydoc NeighbourQueryBase::get_buckets_near_point()
+  ///
+  /// The buckets of every level are searched
+  ///
+  ABORIA_HOST_DEVICE_IGNORE_WARN
+  template <int LNormNumber = -1>
+  CUDA_HOST_DEVICE query_iterator<LNormNumber>
+  get_buckets_near_point(const double_d &position,
+                         const double max_distance) const {
+#ifndef __CUDA_ARCH__
+    LOG(4, "\tget_buckets_near_point: position = "
+               << position << " max_distance = " << max_distance);
+#endif
+    return query_iterator<LNormNumber>(
+        position, double_d::Constant(max_distance), false, this);
+  }
+
+  ///
+  /// @copydoc NeighbourQueryBase::get_buckets_near_point()
+  ///
+  /// The buckets of every level are searched
+  ///
+  ABORIA_HOST_DEVICE_IGNORE_WARN
+  template <int LNormNumber = -1>
+  CUDA_HOST_DEVICE query_iterator<LNormNumber>
+  get_buckets_near_point(const double_d &position,
+                         const double_d &max_distance) const {
+#ifndef __CUDA_ARCH__
+    LOG(4, "\tget_buckets_near_point: position = "
+               << position << " max_distance = " << max_distance);
+#endif
+    return query_iterator<LNormNumber>(position, max_distance, false, this);
+  }
+
+  ///
+  /// @brief returns an iterator over all the buckets that might contain a
+  /// particle whose sphere overlaps the sphere with centre @p position and
+  /// radius @p radius. That is, every particle `j` with
+  /// `|position - r_j| <= radius + multi_level_radius_j` is in one of the
+  /// buckets
+  ///
+  /// Each level is searched out to @p radius plus the largest search radius
+  /// binned at that level, and levels with no particles are skipped
+  ///
+  ABORIA_HOST_DEVICE_IGNORE_WARN
+  template <int LNormNumber = 2>
+  CUDA_HOST_DEVICE query_iterator<LNormNumber>
+  get_buckets_near_sphere(const double_d &position,
+                          const double radius) const {
+#ifndef __CUDA_ARCH__
+    LOG(4, "\tget_buckets_near_sphere: position = " << position
+                                                    << " radius = " << radius);
+#endif
+    return query_iterator<LNormNumber>(position, double_d::Constant(radius),
+                                       true, this);
+  }
+
+  ///
+  /// @copydoc NeighbourQueryBase::number_of_buckets()
+  ///
+  ABORIA_HOST_DEVICE_IGNORE_WARN
+  CUDA_HOST_DEVICE
+  size_t number_of_buckets() const { return m_nbuckets; }
+
+  ///
+  /// @brief returns the number of levels in the grid hierarchy
+  ///
+  ABORIA_HOST_DEVICE_IGNORE_WARN
+  CUDA_HOST_DEVICE
+  unsigned int number_of_grid_levels() const { return m_nlevels; }
+
+  ///
+  /// @copydoc NeighbourQueryBase::number_of_particles()
+  ///
+  ABORIA_HOST_DEVICE_IGNORE_WARN
+  CUDA_HOST_DEVICE
+  size_t number_of_particles() const {
+    return (m_particles_end - m_particles_begin);
+  }
+
+  ///
+  /// @copydoc NeighbourQueryBase::get_particles_begin() const
+  ///
+  ABORIA_HOST_DEVICE_IGNORE_WARN
+  CUDA_HOST_DEVICE
+  const raw_pointer &get_particles_begin() const { return m_particles_begin; }
+
+  ///
+  /// @copydoc NeighbourQueryBase::get_particles_begin()
+  ///
+  ABORIA_HOST_DEVICE_IGNORE_WARN
+  CUDA_HOST_DEVICE
+  raw_pointer &get_particles_begin() { return m_particles_begin; }
+
+  ///
+  /// @copydoc NeighbourQueryBase::number_of_levels()
+  ///
+  /// always 2 for CellListMultiLevel, which is not a tree
+  ///
+  unsigned number_of_levels() const { return 2; }
+};
+
+///
+/// @brief calls @p f for every particle whose sphere overlaps the sphere
+/// with centre @p centre and radius @p radius
+///
+/// A particle `j` overlaps if `|dx| < radius + multi_level_radius_j`, where
+/// `dx` is the shortest vector from @p centre to the particle (taking into
+/// account any periodicity of the domain). @p f is called as `f(particle,
+/// dx)`. To find all the overlapping pairs of a particle set, call this for
+/// each particle `i` with the centre and radius of `i` (in which case `i`
+/// itself is also found, with `dx = 0`)
+///
+/// @param query the query object of a CellListMultiLevel
+/// @param centre the centre of the sphere
+/// @param radius the radius of the sphere
+/// @param f the function to call for each overlapping particle
+///
+template <typename Query, typename Function>
+CUDA_HOST_DEVICE void
+for_each_overlapping(const Query &query,
+                     const typename Query::double_d &centre,
+                     const double radius, Function f) {
+  typedef typename Query::traits_type Traits;
+  typedef typename Traits::position position;
+  typedef typename Query::double_d double_d;
+
+  const double_d width = query.get_bounds().bmax - query.get_bounds().bmin;
+  for (auto periodic_it =
+           search_iterator<Query, 2>::get_periodic_range(query.get_periodic());
+       periodic_it != false; ++periodic_it) {
+    const double_d point = centre + (*periodic_it) * width;
+    for (auto bucket = query.get_buckets_near_sphere(point, radius);
+         bucket != false; ++bucket) {
+      for (auto particle = query.get_bucket_particles(*bucket);
+           particle != false; ++particle) {
+        const double_d dx = get<position>(*particle) - point;
+        const double sum = radius + get<multi_level_radius>(*particle);
+        if (dx.squaredNorm() < sum * sum) {
+          f(*particle, dx);
+        }
+      }
+    }
+  }
+}
+
+} // namespace Aboria
+
+#endif /* CELL_LIST_MULTI_LEVEL_H_ */
@@ -90,6 +90,7 @@ class CellListOrdered
   typedef typename Traits::vector_unsigned_int_iterator
       vector_unsigned_int_iterator;
   typedef typename Traits::vector_unsigned_int vector_unsigned_int;
+  typedef typename Traits::vector_int vector_int;
   typedef typename Traits::unsigned_int_d unsigned_int_d;
   typedef typename Traits::iterator iterator;
   typedef CellListOrdered_params<Traits> params_type;
@@ -102,7 +103,7 @@ class CellListOrdered
 
 public:
   CellListOrdered()
-      : base_type(),
+      : base_type(), m_bucket_indices_valid(false),
         m_size_calculated_with_n(std::numeric_limits<size_t>::max()) {}
 
   static constexpr bool ordered() { return true; }
@@ -179,6 +180,9 @@ private:
       this->m_query.m_periodic = this->m_periodic;
       this->m_query.m_end_bucket = m_size - 1;
       this->m_query.m_point_to_bucket_index = m_point_to_bucket_index;
+
+      // bucket indices from the last update are no longer valid
+      m_bucket_indices_valid = false;
       return true;
     } else {
       return false;
@@ -200,6 +204,15 @@ private:
     }
 
     const size_t n = this->m_alive_indices.size();
+
+    // if no particles have been added or removed since the last update, the
+    // particles are still sorted by their previous bucket indices
+    if (m_bucket_indices_valid && n > 0 && m_bucket_indices.size() == n &&
+        static_cast<size_t>(update_end - update_begin) == n &&
+        update_positions_incremental()) {
+      return;
+    }
+
     m_bucket_indices.resize(n);
     if (n > 0) {
       // transform the points to their bucket indices
@@ -238,6 +251,113 @@ private:
                         search_begin, search_begin + m_size.prod(),
                         m_bucket_end.begin());
 
+    m_bucket_indices_valid = true;
+
+    print_buckets();
+  }
+
+  ///
+  /// @brief update the buckets when the particles are still in the order
+  /// given by the last update
+  ///
+  /// Only the particles that have changed buckets are sorted, and these are
+  /// then merged with the (already sorted) particles that did not move. The
+  /// bucket ranges are updated using the change in the number of particles in
+  /// each bucket and a scan, rather than a binary search for every bucket
+  ///
+  /// @return false if too many particles have changed buckets, in which case
+  /// nothing is updated and a full rebuild is needed
+  ///
+  bool update_positions_incremental() {
+    const size_t n = m_bucket_indices.size();
+    const size_t nbuckets = m_bucket_begin.size();
+
+    m_new_bucket_indices.resize(n);
+    detail::transform(get<position>(this->m_particles_begin),
+                      get<position>(this->m_particles_begin) + n,
+                      m_new_bucket_indices.begin(), m_point_to_bucket_index);
+
+    // find the particles that have changed bucket
+    m_bucket_changed.resize(n);
+    const unsigned int *old_indices =
+        iterator_to_raw_pointer(m_bucket_indices.begin());
+    const unsigned int *new_indices =
+        iterator_to_raw_pointer(m_new_bucket_indices.begin());
+    detail::tabulate(m_bucket_changed.begin(), m_bucket_changed.end(),
+                     [=] CUDA_HOST_DEVICE(const int i) {
+                       return static_cast<int>(old_indices[i] !=
+                                               new_indices[i]);
+                     });
+    m_moved_indices.resize(n);
+    auto count_start = Traits::make_counting_iterator(0);
+    const size_t n_moved =
+        detail::copy_if(count_start, count_start + n, m_bucket_changed.begin(),
+                        m_moved_indices.begin()) -
+        m_moved_indices.begin();
+
+    LOG(2, "CellListOrdered: " << n_moved << " of " << n
+                               << " particles changed bucket");
+
+    if (n_moved > n / 4) {
+      return false;
+    }
+    if (n_moved == 0) {
+      return true;
+    }
+    m_moved_indices.resize(n_moved);
+
+    // change in the number of particles in each bucket
+    m_bucket_counts.resize(nbuckets);
+    const unsigned int *bucket_begin =
+        iterator_to_raw_pointer(m_bucket_begin.begin());
+    const unsigned int *bucket_end =
+        iterator_to_raw_pointer(m_bucket_end.begin());
+    detail::tabulate(m_bucket_counts.begin(), m_bucket_counts.end(),
+                     [=] CUDA_HOST_DEVICE(const int i) {
+                       return static_cast<int>(bucket_end[i] -
+                                               bucket_begin[i]);
+                     });
+    for (size_t i = 0; i < n_moved; ++i) {
+      const int moved = m_moved_indices[i];
+      --m_bucket_counts[m_bucket_indices[moved]];
+      ++m_bucket_counts[m_new_bucket_indices[moved]];
+    }
+    detail::exclusive_scan(m_bucket_counts.begin(), m_bucket_counts.end(),
+                           m_bucket_begin.begin(), 0);
+    const int *bucket_counts = iterator_to_raw_pointer(m_bucket_counts.begin());
+    detail::tabulate(m_bucket_end.begin(), m_bucket_end.end(),
+                     [=] CUDA_HOST_DEVICE(const int i) {
+                       return bucket_begin[i] + bucket_counts[i];
+                     });
+
+    // sort the particles that have moved by their new bucket
+    m_stayed_indices.resize(n - n_moved);
+    detail::copy_if(count_start, count_start + n, m_bucket_changed.begin(),
+                    m_stayed_indices.begin(),
+                    [] CUDA_HOST_DEVICE(const int changed) {
+                      return changed == 0;
+                    });
+    m_moved_keys.resize(n_moved);
+    detail::gather(m_moved_indices.begin(), m_moved_indices.end(),
+                   m_new_bucket_indices.begin(), m_moved_keys.begin());
+    detail::sort_by_key(m_moved_keys.begin(), m_moved_keys.end(),
+                        m_moved_indices.begin());
+
+    // merge the moved particles with those that stayed in the same bucket
+    m_stayed_keys.resize(n - n_moved);
+    detail::gather(m_stayed_indices.begin(), m_stayed_indices.end(),
+                   m_new_bucket_indices.begin(), m_stayed_keys.begin());
+    detail::merge_by_key(m_stayed_keys.begin(), m_stayed_keys.end(),
+                         m_moved_keys.begin(), m_moved_keys.end(),
+                         m_stayed_indices.begin(), m_moved_indices.begin(),
+                         m_bucket_indices.begin(),
+                         this->m_alive_indices.begin());
+
+    print_buckets();
+    return true;
+  }
+
+  void print_buckets() const {
 #ifndef __CUDA_ARCH__
     if (4 <= ABORIA_LOG_LEVEL) {
       LOG(4, "\tbuckets:");
@@ -271,6 +391,19 @@ private:
   vector_unsigned_int m_bucket_indices;
   CellListOrderedQuery<Traits> m_query;
 
+  // true if the particles are sorted by m_bucket_indices, so the next update
+  // can be incremental
+  bool m_bucket_indices_valid;
+
+  // temporary storage for the incremental update
+  vector_unsigned_int m_new_bucket_indices;
+  vector_unsigned_int m_moved_keys;
+  vector_unsigned_int m_stayed_keys;
+  vector_int m_bucket_changed;
+  vector_int m_moved_indices;
+  vector_int m_stayed_indices;
+  vector_int m_bucket_counts;
+
   double_d m_bucket_side_length;
   unsigned_int_d m_size;
   size_t m_size_calculated_with_n;
@@ -312,6 +445,17 @@ struct CellListOrderedQuery : public NeighbourQueryBase<Traits> {
   ///
   raw_pointer m_particles_end;
 
+  ///
+  /// @brief the particle positions stored as a structure-of-arrays (if
+  /// enabled)
+  ///
+  detail::position_soa<dimension> m_position_soa;
+
+  ///
+  /// @brief the ghost particles of a periodic domain (if enabled)
+  ///
+  detail::ghost_halo<dimension> m_ghosts;
+
   ///
   /// @brief periodicity of the domain
   ///
@@ -353,14 +497,9 @@ struct CellListOrderedQuery : public NeighbourQueryBase<Traits> {
   unsigned int m_nbuckets;
 
   ///
-  /// @brief a pointer to the "key" values of the find-by-id map
+  /// @brief the find-by-id hash table
   ///
-  size_t *m_id_map_key;
-
-  ///
-  /// @brief a pointer to the "value" values of the find-by-id map
-  ///
-  size_t *m_id_map_value;
+  detail::id_map_table m_id_map;
 
   ABORIA_HOST_DEVICE_IGNORE_WARN
   CUDA_HOST_DEVICE
@@ -377,13 +516,7 @@ struct CellListOrderedQuery : public NeighbourQueryBase<Traits> {
   CUDA_HOST_DEVICE
   raw_pointer find(const size_t id) const {
     const size_t n = number_of_particles();
-    size_t *last = m_id_map_key + n;
-    size_t *first = detail::lower_bound(m_id_map_key, last, id);
-    if ((first != last) && !(id < *first)) {
-      return m_particles_begin + m_id_map_value[first - m_id_map_key];
-    } else {
-      return m_particles_begin + n;
-    }
+    return m_particles_begin + m_id_map.find(id, n);
   }
 
   /*
@@ -489,6 +622,17 @@ size_t num_children() const { return number_of_buckets(); }
                              m_particles_begin + range_end_index);
   }
 
+  ///
+  /// @copydoc NeighbourQueryBase::number_of_particles(const reference) const
+  ///
+  ABORIA_HOST_DEVICE_IGNORE_WARN
+  CUDA_HOST_DEVICE
+  size_t number_of_particles(const reference bucket) const {
+    const unsigned int bucket_index =
+        m_point_to_bucket_index.collapse_index_vector(bucket);
+    return m_bucket_end[bucket_index] - m_bucket_begin[bucket_index];
+  }
+
   ///
   /// @copydoc NeighbourQueryBase::get_bucket_bbox()
   ///
@@ -83,7 +83,7 @@ public:
   /// The traits type used to build up the Elements container.
   /// Contains Level 0 vector class and dimension information
   typedef TraitsCommon<VAR, ParticlesType::dimension, SelfD,
-                       typename ParticlesType::TRAITS_USER>
+                       typename ParticlesType::traits_user_type>
       traits_type;
 
   ///
@@ -232,9 +232,10 @@ public:
         // TODO: this will not work with thrust
         typename ParticlesType::raw_pointer p =
             m_particles->get_query().find(particle_id);
-        CHECK(p != iterator_to_raw_pointer(m_particles->end()),
+        CHECK(p != m_particles->get_query().get_particles_begin() +
+                       m_particles->size(),
               "particle " << particle_id << " does not exist");
-        get<VariableType>(p).clear(i);
+        get<VariableType>(p)->clear();
       }
     }
 
@@ -244,20 +245,25 @@ public:
   /// return the total number of elements in the container
   size_t size() const { return Aboria::get<particles>(m_data).size(); }
 
+  /// returns the particle set that contains the element vertices
+  const particles_type &get_particles() const { return *m_particles; }
+
   /// Update the particle connections for particles between
   /// \p update_begin and \p update_end (not including \p update_end).
   /// It is assumed that this range is all new elements
   ///
   void push_connections(iterator update_begin, iterator update_end) {
-    for (size_t i = update_begin - begin(); i < update_end - end(); ++i) {
+    for (size_t i = update_begin - begin();
+         i < static_cast<size_t>(update_end - begin()); ++i) {
       for (size_t d = 0; d < element_dimension; ++d) {
         size_t particle_id = get<particles>(m_data)[i][d];
         // TODO: this will not work with thrust
         typename ParticlesType::raw_pointer p =
             m_particles->get_query().find(particle_id);
-        CHECK(p != iterator_to_raw_pointer(m_particles->end()),
+        CHECK(p != m_particles->get_query().get_particles_begin() +
+                       m_particles->size(),
               "particle " << particle_id << " does not exist");
-        get<VariableType>(p).push_back(i);
+        get<VariableType>(p)->push_back(i);
       }
     }
   }
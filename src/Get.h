@@ -480,6 +480,8 @@ struct zip_pointer<std::tuple<Types *...>, MplVector> {
 
   bool operator==(const zip_pointer &other) const { return equal(other); }
 
+  bool operator!=(const zip_pointer &other) const { return !equal(other); }
+
   zip_pointer &operator++() {
     advance(1);
     return *this;
@@ -656,6 +658,9 @@ struct zip_pointer<thrust::tuple<TT1, TT2, TT3, TT4, TT5, TT6, TT7, TT8, TT9>,
   CUDA_HOST_DEVICE
   bool operator==(const zip_pointer &other) const { return equal(other); }
 
+  CUDA_HOST_DEVICE
+  bool operator!=(const zip_pointer &other) const { return !equal(other); }
+
   CUDA_HOST_DEVICE
   zip_pointer &operator++() {
     advance(1);
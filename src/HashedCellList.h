@@ -0,0 +1,1059 @@
+/*
+
+Copyright (c) 2005-2016, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Aboria.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+
+#ifndef HASHED_CELL_LIST_H_
+#define HASHED_CELL_LIST_H_
+
+#include "CudaInclude.h"
+#include "Get.h"
+#include "NeighbourSearchBase.h"
+#include "SpatialUtil.h"
+#include "Traits.h"
+#include "Vector.h"
+#include "detail/Algorithms.h"
+
+#include "Log.h"
+#include <cmath>
+#include <iostream>
+#include <limits>
+
+namespace Aboria {
+
+namespace detail {
+
+///
+/// @brief the key used to mark an empty slot in the cell hash table
+///
+inline CUDA_HOST_DEVICE constexpr size_t get_empty_cell_key() {
+  return std::numeric_limits<size_t>::max();
+}
+
+///
+/// @brief hashes a cell key to a slot in a hash table of size `2^bits`,
+/// using Fibonacci hashing
+///
+inline CUDA_HOST_DEVICE size_t hash_cell_key(const size_t key,
+                                             const unsigned int bits) {
+  return bits == 0 ? 0
+                   : static_cast<size_t>(
+                         (static_cast<uint64_t>(key) *
+                          uint64_t(11400714819323198485ull)) >>
+                         (64 - bits));
+}
+
+///
+/// @brief function object that converts a point to the key of the cell that
+/// contains it, for a grid of cells with @p size cells in each dimension
+///
+/// The key packs the integer coordinates of the cell into a single 64-bit
+/// word, using bits_per_dimension bits for each coordinate, so unlike a
+/// dense (row-major) index it does not depend on the product of the grid
+/// sizes. The keys are below `2^63`, so never equal get_empty_cell_key(), and
+/// sort in the same (row-major) order as the cells
+///
+template <unsigned int D> struct point_to_cell_key {
+  typedef Vector<double, D> double_d;
+  typedef Vector<int, D> int_d;
+  typedef Vector<unsigned int, D> unsigned_int_d;
+
+  ///
+  /// @brief the number of bits used for each cell coordinate, which limits
+  /// the number of cells in each dimension of the grid to
+  /// `2^bits_per_dimension`
+  ///
+  static const unsigned int bits_per_dimension = 63 / D < 31 ? 63 / D : 31;
+
+  point_to_bucket_index<D> m_point_to_bucket_index;
+  int_d m_end_bucket;
+
+  CUDA_HOST_DEVICE
+  point_to_cell_key() {}
+
+  point_to_cell_key(unsigned_int_d size,
+                    const double_d &bucket_side_length, const bbox<D> &bounds)
+      : m_point_to_bucket_index(size, bucket_side_length, bounds),
+        m_end_bucket(size.template cast<int>() - 1) {}
+
+  ///
+  /// @brief returns the maximum number of cells in each dimension of the grid
+  ///
+  static CUDA_HOST_DEVICE constexpr size_t max_size() {
+    return size_t(1) << bits_per_dimension;
+  }
+
+  CUDA_HOST_DEVICE
+  size_t collapse_index_vector(const int_d &bucket) const {
+    uint64_t key = 0;
+    for (size_t i = 0; i < D; ++i) {
+      key = (key << bits_per_dimension) | static_cast<uint64_t>(bucket[i]);
+    }
+    return key;
+  }
+
+  CUDA_HOST_DEVICE
+  int_d reassemble_index_vector(size_t key) const {
+    const size_t mask = max_size() - 1;
+    int_d bucket;
+    for (int i = D - 1; i >= 0; --i) {
+      bucket[i] = static_cast<int>(key & mask);
+      key >>= bits_per_dimension;
+    }
+    return bucket;
+  }
+
+  CUDA_HOST_DEVICE
+  size_t operator()(const double_d &point) const {
+    int_d bucket = m_point_to_bucket_index.find_bucket_index_vector(point);
+    for (size_t i = 0; i < D; ++i) {
+      if (bucket[i] < 0) {
+        bucket[i] = 0;
+      } else if (bucket[i] > m_end_bucket[i]) {
+        bucket[i] = m_end_bucket[i];
+      }
+    }
+    return collapse_index_vector(bucket);
+  }
+};
+
+///
+/// @brief function object that converts a point to a bounding box containing
+/// only that point
+///
+template <unsigned int D> struct point_to_bbox {
+  typedef bbox<D> result_type;
+  CUDA_HOST_DEVICE
+  bbox<D> operator()(const Vector<double, D> &point) const {
+    return bbox<D>(point);
+  }
+};
+
+///
+/// @brief function object that returns the bounding box of two boxes
+///
+template <unsigned int D> struct bbox_union {
+  CUDA_HOST_DEVICE
+  bbox<D> operator()(bbox<D> a, const bbox<D> &b) const { return a + b; }
+};
+
+} // namespace detail
+
+template <typename Traits> struct HashedCellListQuery;
+
+///
+/// @brief iterator over the occupied buckets of a HashedCellList, which
+/// walks the sorted list of cell keys, so visiting every bucket costs time
+/// proportional to the number of occupied buckets rather than the volume of
+/// the grid. It can also point to a single (possibly empty) bucket, as
+/// returned by HashedCellListQuery::get_bucket()
+///
+template <unsigned int D> class hashed_cell_iterator {
+  typedef hashed_cell_iterator<D> iterator;
+  typedef Vector<int, D> int_d;
+
+public:
+  typedef typename lattice_iterator<D>::value_type value_type;
+  typedef value_type pointer;
+  typedef std::forward_iterator_tag iterator_category;
+  typedef const value_type &reference;
+  typedef std::ptrdiff_t difference_type;
+
+  CUDA_HOST_DEVICE
+  hashed_cell_iterator() : m_key(nullptr), m_end(nullptr), m_single(false) {}
+
+  CUDA_HOST_DEVICE
+  hashed_cell_iterator(const size_t *begin, const size_t *end,
+                       const detail::point_to_cell_key<D> &point_to_cell_key)
+      : m_key(begin), m_end(end), m_single(false),
+        m_point_to_cell_key(point_to_cell_key) {
+    update_bucket();
+  }
+
+  ///
+  /// @brief creates an iterator that points to @p bucket only
+  ///
+  CUDA_HOST_DEVICE
+  explicit hashed_cell_iterator(const int_d &bucket)
+      : m_key(nullptr), m_end(nullptr), m_single(true), m_bucket(bucket) {}
+
+  ///
+  /// @brief returns an iterator that points to the current bucket only
+  ///
+  CUDA_HOST_DEVICE
+  iterator get_child_iterator() const { return iterator(m_bucket); }
+
+  CUDA_HOST_DEVICE
+  reference operator*() const { return m_bucket; }
+
+  CUDA_HOST_DEVICE
+  reference operator->() const { return m_bucket; }
+
+  CUDA_HOST_DEVICE
+  iterator &operator++() {
+    if (m_single) {
+      m_single = false;
+    } else {
+      ++m_key;
+      update_bucket();
+    }
+    return *this;
+  }
+
+  CUDA_HOST_DEVICE
+  iterator operator++(int) {
+    iterator tmp(*this);
+    operator++();
+    return tmp;
+  }
+
+  CUDA_HOST_DEVICE
+  size_t operator-(const iterator &start) const { return m_key - start.m_key; }
+
+  CUDA_HOST_DEVICE
+  inline bool operator==(const iterator &rhs) const {
+    if (!valid() || !rhs.valid()) {
+      return valid() == rhs.valid();
+    }
+    return m_single ? rhs.m_single && (m_bucket == rhs.m_bucket).all()
+                    : m_key == rhs.m_key;
+  }
+
+  CUDA_HOST_DEVICE
+  inline bool operator==(const bool rhs) const { return valid() == rhs; }
+
+  CUDA_HOST_DEVICE
+  inline bool operator!=(const iterator &rhs) const { return !operator==(rhs); }
+
+  CUDA_HOST_DEVICE
+  inline bool operator!=(const bool rhs) const { return !operator==(rhs); }
+
+private:
+  CUDA_HOST_DEVICE
+  bool valid() const { return m_single || m_key != m_end; }
+
+  CUDA_HOST_DEVICE
+  void update_bucket() {
+    if (valid()) {
+      m_bucket = m_point_to_cell_key.reassemble_index_vector(*m_key);
+    }
+  }
+
+  const size_t *m_key;
+  const size_t *m_end;
+  bool m_single;
+  detail::point_to_cell_key<D> m_point_to_cell_key;
+  value_type m_bucket;
+};
+
+/// @brief A cell list spatial data structure that only stores the occupied
+/// cells, and is paired with a HashedCellListQuery query type
+///
+/// Like CellListOrdered, the domain is divided up into a regular grid of
+/// constant size "buckets", and the particle set is reordered so that
+/// particles within a given bucket are sequential in memory. The difference
+/// is that only the occupied buckets are stored, in an open-addressing hash
+/// table keyed by the bucket index, so the memory used scales with the number
+/// of particles rather than with the volume of the domain.
+///
+/// The domain given to Particles::init_neighbour_search() sets the origin of
+/// the grid, and is only enforced for periodic dimensions. In non-periodic
+/// dimensions particles are free to move outside the domain, and the grid
+/// grows (or shrinks) to cover the particles each time the positions are
+/// updated. The bounds of the query object are the bounds of this grid.
+///
+/// The size of the buckets is chosen so that there are on average
+/// `n_particles_in_leaf` particles per bucket within the bounding box of the
+/// particles (the domain in periodic dimensions), rather than within the
+/// domain, so a small plume of particles in a large domain still has small
+/// buckets. It is recalculated when the number of particles halves or
+/// doubles. The tree functions of the query object (e.g.
+/// HashedCellListQuery::get_children()) only visit the occupied buckets.
+///
+template <typename Traits>
+class HashedCellList
+    : public neighbour_search_base<HashedCellList<Traits>, Traits,
+                                   HashedCellListQuery<Traits>> {
+
+  typedef typename Traits::double_d double_d;
+  typedef typename Traits::int_d int_d;
+  typedef typename Traits::position position;
+  typedef typename Traits::vector_unsigned_int vector_unsigned_int;
+  typedef typename Traits::vector_size_t vector_size_t;
+  typedef typename Traits::unsigned_int_d unsigned_int_d;
+  typedef typename Traits::iterator iterator;
+
+  typedef neighbour_search_base<HashedCellList<Traits>, Traits,
+                                HashedCellListQuery<Traits>>
+      base_type;
+
+  friend base_type;
+
+public:
+  HashedCellList()
+      : base_type(),
+        m_size_calculated_with_n(std::numeric_limits<size_t>::max()) {
+    build_hash_table();
+  }
+
+  static constexpr bool ordered() { return true; }
+
+  ///
+  /// @brief Particles outside the domain are not removed in non-periodic
+  /// dimensions, instead the grid grows to cover them
+  ///
+  static constexpr bool bounded() { return false; }
+
+  void print_data_structure() const {
+#ifndef __CUDA_ARCH__
+    LOG(1, "\tbuckets:");
+    for (size_t i = 0; i < m_cell_keys.size(); ++i) {
+      LOG(1, "\ti = " << i << " key = " << m_cell_keys[i]
+                      << " bucket contents = " << m_cell_begin[i] << " to "
+                      << m_cell_end[i]);
+    }
+    LOG(1, "\tend buckets");
+    LOG(1, "\tparticles:");
+    for (size_t i = 0; i < m_particle_keys.size(); ++i) {
+      LOG(1, "\ti = " << i << " p = "
+                      << static_cast<const double_d &>(
+                             get<position>(*(this->m_particles_begin + i)))
+                      << " key = " << m_particle_keys[i]);
+    }
+    LOG(1, "\tend particles:");
+#endif
+  }
+
+private:
+  bool set_domain_impl() {
+    // the particle positions are not known until the next update, so until
+    // then the buckets are sized using the domain
+    m_size_calculated_with_n = std::numeric_limits<size_t>::max();
+    set_bucket_side_length(0, bbox<Traits::dimension>());
+    set_grid(false, bbox<Traits::dimension>());
+    return true;
+  }
+
+  ///
+  /// @brief recalculates the size of the buckets if the number of alive
+  /// particles has halved or doubled since it was last calculated
+  ///
+  /// @return true if the size of the buckets was recalculated
+  ///
+  bool update_bucket_side_length(
+      const bbox<Traits::dimension> &particle_bounds) {
+    const size_t n = this->m_alive_indices.size();
+    if (n < 0.5 * m_size_calculated_with_n ||
+        n > 2 * m_size_calculated_with_n) {
+      LOG(2, "HashedCellList: recalculating bucket size");
+      m_size_calculated_with_n = n;
+      set_bucket_side_length(n, particle_bounds);
+      return true;
+    } else {
+      return false;
+    }
+  }
+
+  ///
+  /// @brief sets the size of the buckets so that there are on average
+  /// `n_particles_in_leaf` particles in each bucket that overlaps the box
+  /// containing @p n particles with bounds @p particle_bounds (or the domain,
+  /// in periodic dimensions or if @p n is zero)
+  ///
+  void set_bucket_side_length(const size_t n,
+                              const bbox<Traits::dimension> &particle_bounds) {
+    const double_d domain_width = this->m_bounds.bmax - this->m_bounds.bmin;
+    double_d extent;
+    for (size_t i = 0; i < Traits::dimension; ++i) {
+      extent[i] = this->m_periodic[i] || n == 0
+                      ? domain_width[i]
+                      : particle_bounds.bmax[i] - particle_bounds.bmin[i];
+    }
+
+    // find the side length s of a cube that gives n/n_particles_in_leaf
+    // buckets, where the box has a single bucket in each dimension narrower
+    // than s. This is a fixed point iteration, starting with all the
+    // dimensions of non-zero extent
+    double side = 0;
+    if (n > 0 && this->m_n_particles_in_leaf <= n) {
+      for (int iteration = 0; iteration < 4; ++iteration) {
+        double volume = 1;
+        int number_of_dimensions = 0;
+        for (size_t i = 0; i < Traits::dimension; ++i) {
+          if (extent[i] > side) {
+            volume *= extent[i];
+            ++number_of_dimensions;
+          }
+        }
+        if (number_of_dimensions == 0) {
+          break;
+        }
+        side = std::pow(this->m_n_particles_in_leaf / double(n) * volume,
+                        1.0 / number_of_dimensions);
+      }
+    }
+
+    for (size_t i = 0; i < Traits::dimension; ++i) {
+      if (this->m_periodic[i] || !(side > 0)) {
+        // periodic dimensions have a whole number of buckets in the domain
+        const double size = side > 0 ? std::floor(domain_width[i] / side) : 1;
+        m_bucket_side_length[i] = domain_width[i] / (size < 1 ? 1 : size);
+      } else {
+        m_bucket_side_length[i] = side;
+      }
+    }
+    LOG(2, "\tbucket side length = " << m_bucket_side_length);
+
+    this->m_query.m_bucket_side_length = m_bucket_side_length;
+    this->m_query.m_periodic = this->m_periodic;
+  }
+
+  ///
+  /// @brief returns the bounding box of the alive particles
+  ///
+  bbox<Traits::dimension> get_particle_bounds() const {
+    const size_t n = this->m_alive_indices.size();
+    if (n == 0) {
+      return bbox<Traits::dimension>();
+    }
+    auto positions = Traits::make_permutation_iterator(
+        get<position>(this->m_particles_begin), this->m_alive_indices.begin());
+    return detail::reduce(
+        Traits::make_transform_iterator(
+            positions, detail::point_to_bbox<Traits::dimension>()),
+        Traits::make_transform_iterator(
+            positions + n, detail::point_to_bbox<Traits::dimension>()),
+        bbox<Traits::dimension>(), detail::bbox_union<Traits::dimension>());
+  }
+
+  ///
+  /// @brief sets the grid to cover the domain in periodic dimensions and
+  /// (if @p fit_to_particles is true) the alive particles, with bounds
+  /// @p particle_bounds, in non-periodic dimensions
+  ///
+  void set_grid(const bool fit_to_particles,
+                const bbox<Traits::dimension> &particle_bounds) {
+    const size_t n = fit_to_particles ? this->m_alive_indices.size() : 0;
+
+    // the cell coordinates are found in double precision, and checked to fit
+    // in the cell keys before they are converted to integers
+    const double max_size = static_cast<double>(
+        detail::point_to_cell_key<Traits::dimension>::max_size());
+    bbox<Traits::dimension> grid_bounds;
+    unsigned_int_d size;
+    for (size_t i = 0; i < Traits::dimension; ++i) {
+      double size_i;
+      if (this->m_periodic[i] || n == 0) {
+        grid_bounds.bmin[i] = this->m_bounds.bmin[i];
+        size_i = std::round((this->m_bounds.bmax[i] - this->m_bounds.bmin[i]) /
+                            m_bucket_side_length[i]);
+      } else {
+        // snap the grid to the buckets of the original domain
+        const double first =
+            std::floor((particle_bounds.bmin[i] - this->m_bounds.bmin[i]) /
+                       m_bucket_side_length[i]);
+        const double last =
+            std::floor((particle_bounds.bmax[i] - this->m_bounds.bmin[i]) /
+                       m_bucket_side_length[i]);
+        grid_bounds.bmin[i] =
+            this->m_bounds.bmin[i] + first * m_bucket_side_length[i];
+        size_i = last - first + 1;
+      }
+      CHECK(size_i < max_size,
+            "HashedCellList: the particles span " << size_i
+                << " buckets in dimension " << i << ", more than the "
+                << max_size << " that fit in a cell key");
+      size[i] = size_i < 1 ? 1 : static_cast<unsigned int>(size_i);
+      grid_bounds.bmax[i] =
+          grid_bounds.bmin[i] + size[i] * m_bucket_side_length[i];
+    }
+    m_point_to_cell_key = detail::point_to_cell_key<Traits::dimension>(
+        size, m_bucket_side_length, grid_bounds);
+
+    LOG(2, "\tgrid bounds = " << grid_bounds);
+    LOG(2, "\tnumber of buckets = " << size);
+
+    this->m_query.m_bounds = grid_bounds;
+    this->m_query.m_end_bucket = size.template cast<int>() - 1;
+    this->m_query.m_point_to_bucket_index =
+        m_point_to_cell_key.m_point_to_bucket_index;
+    this->m_query.m_point_to_cell_key = m_point_to_cell_key;
+  }
+
+  void update_iterator_impl() {}
+
+  void update_positions_impl(iterator update_begin, iterator update_end,
+                             const int new_n,
+                             const bool call_set_domain = true) {
+
+    ASSERT(update_begin == this->m_particles_begin &&
+               update_end == this->m_particles_end,
+           "error should be update all");
+
+    const bbox<Traits::dimension> particle_bounds = get_particle_bounds();
+    if (call_set_domain) {
+      update_bucket_side_length(particle_bounds);
+    }
+    set_grid(true, particle_bounds);
+
+    const size_t n = this->m_alive_indices.size();
+    m_particle_keys.resize(n);
+    if (n > 0) {
+      // transform the points to their cell keys
+      if (static_cast<size_t>(update_end - update_begin) == n) {
+        // m_alive_indicies is just a sequential list of indices
+        // (i.e. no dead)
+        detail::transform(get<position>(this->m_particles_begin) +
+                              this->m_alive_indices[0],
+                          get<position>(this->m_particles_begin) +
+                              this->m_alive_indices[0] + n,
+                          m_particle_keys.begin(), m_point_to_cell_key);
+      } else {
+        // m_alive_indicies contains all alive indicies
+        detail::transform(Traits::make_permutation_iterator(
+                              get<position>(this->m_particles_begin),
+                              this->m_alive_indices.begin()),
+                          Traits::make_permutation_iterator(
+                              get<position>(this->m_particles_begin),
+                              this->m_alive_indices.end()),
+                          m_particle_keys.begin(), m_point_to_cell_key);
+      }
+
+      // sort the points by their cell key
+      detail::sort_by_key(m_particle_keys.begin(), m_particle_keys.end(),
+                          this->m_alive_indices.begin());
+    }
+
+    // find the occupied cells, and the range of particles in each
+    m_cell_keys.resize(n);
+    detail::copy(m_particle_keys.begin(), m_particle_keys.end(),
+                 m_cell_keys.begin());
+    m_cell_keys.erase(detail::unique(m_cell_keys.begin(), m_cell_keys.end()),
+                      m_cell_keys.end());
+    const size_t n_cells = m_cell_keys.size();
+    m_cell_begin.resize(n_cells);
+    m_cell_end.resize(n_cells);
+    detail::lower_bound(m_particle_keys.begin(), m_particle_keys.end(),
+                        m_cell_keys.begin(), m_cell_keys.end(),
+                        m_cell_begin.begin());
+    detail::upper_bound(m_particle_keys.begin(), m_particle_keys.end(),
+                        m_cell_keys.begin(), m_cell_keys.end(),
+                        m_cell_end.begin());
+
+    build_hash_table();
+
+    this->m_query.m_cell_begin = iterator_to_raw_pointer(m_cell_begin.begin());
+    this->m_query.m_cell_end = iterator_to_raw_pointer(m_cell_end.begin());
+
+#ifndef __CUDA_ARCH__
+    if (4 <= ABORIA_LOG_LEVEL) {
+      print_data_structure();
+    }
+#endif
+  }
+
+  ///
+  /// @brief inserts each occupied cell into an open-addressing hash table
+  /// (with linear probing) that maps the cell key to its index in
+  /// m_cell_keys. The table is kept at most half full
+  ///
+  void build_hash_table() {
+    const size_t n_cells = m_cell_keys.size();
+    unsigned int bits = 0;
+    while ((size_t(1) << bits) < 2 * n_cells) {
+      ++bits;
+    }
+    const size_t mask = (size_t(1) << bits) - 1;
+    m_hash_keys.assign(mask + 1, detail::get_empty_cell_key());
+    m_hash_values.resize(mask + 1);
+    for (size_t i = 0; i < n_cells; ++i) {
+      const size_t key = m_cell_keys[i];
+      size_t slot = detail::hash_cell_key(key, bits);
+      while (m_hash_keys[slot] != detail::get_empty_cell_key()) {
+        slot = (slot + 1) & mask;
+      }
+      m_hash_keys[slot] = key;
+      m_hash_values[slot] = i;
+    }
+
+    LOG(2, "\tnumber of occupied buckets = " << n_cells
+                                             << " hash table size = "
+                                             << mask + 1);
+
+    this->m_query.m_cell_keys = iterator_to_raw_pointer(m_cell_keys.begin());
+    this->m_query.m_hash_keys = iterator_to_raw_pointer(m_hash_keys.begin());
+    this->m_query.m_hash_values =
+        iterator_to_raw_pointer(m_hash_values.begin());
+    this->m_query.m_hash_bits = bits;
+    this->m_query.m_number_of_occupied_buckets = n_cells;
+  }
+
+  const HashedCellListQuery<Traits> &get_query_impl() const { return m_query; }
+
+  HashedCellListQuery<Traits> &get_query_impl() { return m_query; }
+
+  // the cell key of each particle, sorted
+  vector_size_t m_particle_keys;
+  // the key of each occupied cell, and the range of particles it contains
+  vector_size_t m_cell_keys;
+  vector_unsigned_int m_cell_begin;
+  vector_unsigned_int m_cell_end;
+  // open-addressing hash table from cell key to index into m_cell_keys
+  vector_size_t m_hash_keys;
+  vector_unsigned_int m_hash_values;
+  HashedCellListQuery<Traits> m_query;
+
+  double_d m_bucket_side_length;
+  size_t m_size_calculated_with_n;
+  detail::point_to_cell_key<Traits::dimension> m_point_to_cell_key;
+};
+
+/// @copydetails NeighbourQueryBase
+///
+/// @brief This is a query object for the HashedCellList spatial data structure
+///
+template <typename Traits>
+struct HashedCellListQuery : public NeighbourQueryBase<Traits> {
+
+  typedef Traits traits_type;
+  typedef typename Traits::raw_pointer raw_pointer;
+  typedef typename Traits::double_d double_d;
+  typedef typename Traits::bool_d bool_d;
+  typedef typename Traits::int_d int_d;
+  typedef typename Traits::unsigned_int_d unsigned_int_d;
+  const static unsigned int dimension = Traits::dimension;
+  template <int LNormNumber>
+  using query_iterator =
+      lattice_iterator_within_distance<HashedCellListQuery, LNormNumber>;
+  typedef hashed_cell_iterator<dimension> all_iterator;
+  typedef hashed_cell_iterator<dimension> child_iterator;
+  typedef typename query_iterator<2>::reference reference;
+  typedef typename query_iterator<2>::pointer pointer;
+  typedef typename query_iterator<2>::value_type value_type;
+  typedef ranges_iterator<Traits> particle_iterator;
+  typedef bbox<dimension> box_type;
+
+  ///
+  /// @brief pointer to the beginning of the particle set
+  ///
+  raw_pointer m_particles_begin;
+
+  ///
+  /// @brief pointer to the end of the particle set
+  ///
+  raw_pointer m_particles_end;
+
+  ///
+  /// @brief the particle positions stored as a structure-of-arrays (if
+  /// enabled)
+  ///
+  detail::position_soa<dimension> m_position_soa;
+
+  ///
+  /// @brief the ghost particles of a periodic domain (if enabled)
+  ///
+  detail::ghost_halo<dimension> m_ghosts;
+
+  ///
+  /// @brief periodicity of the domain
+  ///
+  bool_d m_periodic;
+
+  ///
+  /// @brief dimensions of each bucket
+  ///
+  double_d m_bucket_side_length;
+
+  ///
+  /// @brief index of the last bucket in the grid
+  ///
+  int_d m_end_bucket;
+
+  ///
+  /// @brief min/max bounds of the grid
+  ///
+  bbox<dimension> m_bounds;
+
+  ///
+  /// @brief function object to transform a point to a bucket index
+  ///
+  detail::point_to_bucket_index<dimension> m_point_to_bucket_index;
+
+  ///
+  /// @brief function object to transform a point or bucket to a cell key
+  ///
+  detail::point_to_cell_key<dimension> m_point_to_cell_key;
+
+  ///
+  /// @brief pointer to the beginning of each occupied bucket
+  ///
+  unsigned int *m_cell_begin;
+
+  ///
+  /// @brief pointer to the end of each occupied bucket
+  ///
+  unsigned int *m_cell_end;
+
+  ///
+  /// @brief pointer to the sorted keys of the occupied buckets
+  ///
+  size_t *m_cell_keys;
+
+  ///
+  /// @brief pointer to the keys of the bucket hash table
+  ///
+  size_t *m_hash_keys;
+
+  ///
+  /// @brief pointer to the values (occupied bucket indices) of the bucket
+  /// hash table
+  ///
+  unsigned int *m_hash_values;
+
+  ///
+  /// @brief the bucket hash table has `2^m_hash_bits` slots
+  ///
+  unsigned int m_hash_bits;
+
+  ///
+  /// @brief the number of buckets that contain at least one particle
+  ///
+  size_t m_number_of_occupied_buckets;
+
+  ///
+  /// @brief the find-by-id hash table
+  ///
+  detail::id_map_table m_id_map;
+
+  ABORIA_HOST_DEVICE_IGNORE_WARN
+  CUDA_HOST_DEVICE
+  HashedCellListQuery() {}
+
+  /*
+   * functions for id mapping
+   */
+
+  ///
+  /// @copydoc NeighbourQueryBase::find()
+  ///
+  ABORIA_HOST_DEVICE_IGNORE_WARN
+  CUDA_HOST_DEVICE
+  raw_pointer find(const size_t id) const {
+    const size_t n = number_of_particles();
+    return m_particles_begin + m_id_map.find(id, n);
+  }
+
+  /*
+   * functions for trees
+   */
+
+  ///
+  /// @copydoc NeighbourQueryBase::is_leaf_node()
+  ///
+  /// always true for HashedCellList
+  ///
+  ABORIA_HOST_DEVICE_IGNORE_WARN
+  CUDA_HOST_DEVICE
+  static bool is_leaf_node(const value_type &bucket) { return true; }
+
+  ///
+  /// @copydoc NeighbourQueryBase::is_tree()
+  ///
+  /// always false for HashedCellList
+  ///
+  ABORIA_HOST_DEVICE_IGNORE_WARN
+  CUDA_HOST_DEVICE
+  static bool is_tree() { return false; }
+
+  ///
+  /// @copydoc NeighbourQueryBase::get_children() const
+  ///
+  /// only the occupied buckets are visited
+  ///
+  ABORIA_HOST_DEVICE_IGNORE_WARN
+  CUDA_HOST_DEVICE
+  child_iterator get_children() const { return get_subtree(); }
+
+  ///
+  /// @copydoc NeighbourQueryBase::get_children(const child_iterator&) const
+  ///
+  ABORIA_HOST_DEVICE_IGNORE_WARN
+  CUDA_HOST_DEVICE
+  child_iterator get_children(const child_iterator &ci) const {
+    return child_iterator();
+  }
+
+  ///
+  /// @copydoc NeighbourQueryBase::num_children(const child_iterator&) const
+  ///
+  static size_t num_children(const child_iterator &ci) { return 0; }
+
+  ///
+  /// @copydoc NeighbourQueryBase::num_children() const
+  ///
+  size_t num_children() const { return number_of_buckets(); }
+
+  ///
+  /// @copydoc NeighbourQueryBase::get_bounds()
+  ///
+  ABORIA_HOST_DEVICE_IGNORE_WARN
+  CUDA_HOST_DEVICE
+  const box_type get_bounds(const child_iterator &ci) const {
+    box_type bounds;
+    bounds.bmin = (*ci) * m_bucket_side_length + m_bounds.bmin;
+    bounds.bmax = ((*ci) + 1) * m_bucket_side_length + m_bounds.bmin;
+    return bounds;
+  }
+
+  ///
+  /// @copydoc NeighbourQueryBase::get_bounds()
+  ///
+  ABORIA_HOST_DEVICE_IGNORE_WARN
+  CUDA_HOST_DEVICE
+  const box_type &get_bounds() const { return m_bounds; }
+
+  ///
+  /// @copydoc NeighbourQueryBase::get_periodic()
+  ///
+  ABORIA_HOST_DEVICE_IGNORE_WARN
+  CUDA_HOST_DEVICE
+  const bool_d &get_periodic() const { return m_periodic; }
+
+  ///
+  /// @brief returns the index of @p bucket in the list of occupied buckets,
+  /// or -1 if @p bucket is empty
+  ///
+  ABORIA_HOST_DEVICE_IGNORE_WARN
+  CUDA_HOST_DEVICE
+  int find_occupied_bucket(const reference bucket) const {
+    const size_t key = m_point_to_cell_key.collapse_index_vector(bucket);
+    const size_t mask = (size_t(1) << m_hash_bits) - 1;
+    size_t slot = detail::hash_cell_key(key, m_hash_bits);
+    while (true) {
+      const size_t slot_key = m_hash_keys[slot];
+      if (slot_key == key) {
+        return m_hash_values[slot];
+      } else if (slot_key == detail::get_empty_cell_key()) {
+        return -1;
+      }
+      slot = (slot + 1) & mask;
+    }
+  }
+
+  ///
+  /// @copydoc NeighbourQueryBase::get_bucket_particles()
+  ///
+  ABORIA_HOST_DEVICE_IGNORE_WARN
+  CUDA_HOST_DEVICE
+  particle_iterator get_bucket_particles(const reference bucket) const {
+#ifndef __CUDA_ARCH__
+    ASSERT((bucket >= int_d::Constant(0)).all() &&
+               (bucket <= m_end_bucket).all(),
+           "invalid bucket");
+#endif
+
+    const int cell = find_occupied_bucket(bucket);
+    if (cell < 0) {
+      return particle_iterator(m_particles_begin, m_particles_begin);
+    }
+    const unsigned int range_start_index = m_cell_begin[cell];
+    const unsigned int range_end_index = m_cell_end[cell];
+
+#ifndef __CUDA_ARCH__
+    LOG(4, "\tlooking in bucket "
+               << bucket << " = " << cell << ". found "
+               << range_end_index - range_start_index << " particles");
+#endif
+    return particle_iterator(m_particles_begin + range_start_index,
+                             m_particles_begin + range_end_index);
+  }
+
+  ///
+  /// @copydoc NeighbourQueryBase::number_of_particles(const reference) const
+  ///
+  ABORIA_HOST_DEVICE_IGNORE_WARN
+  CUDA_HOST_DEVICE
+  size_t number_of_particles(const reference bucket) const {
+    const int cell = find_occupied_bucket(bucket);
+    if (cell < 0) {
+      return 0;
+    }
+    return m_cell_end[cell] - m_cell_begin[cell];
+  }
+
+  ///
+  /// @copydoc NeighbourQueryBase::get_bucket_bbox()
+  ///
+  ABORIA_HOST_DEVICE_IGNORE_WARN
+  CUDA_HOST_DEVICE
+  bbox<dimension> get_bucket_bbox(const reference bucket) const {
+    return bbox<dimension>(bucket * m_bucket_side_length + m_bounds.bmin,
+                           (bucket + 1) * m_bucket_side_length + m_bounds.bmin);
+  }
+
+  ///
+  /// @copydoc NeighbourQueryBase::get_bucket()
+  ///
+  ABORIA_HOST_DEVICE_IGNORE_WARN
+  CUDA_HOST_DEVICE
+  child_iterator get_bucket(const double_d &position) const {
+    return child_iterator(
+        m_point_to_bucket_index.find_bucket_index_vector(position));
+  }
+
+  ///
+  /// @copydoc NeighbourQueryBase::get_bucket_index()
+  ///
+  /// This is the index of @p bucket in the list of occupied buckets, or
+  /// number_of_buckets() if @p bucket is empty
+  ///
+  ABORIA_HOST_DEVICE_IGNORE_WARN
+  CUDA_HOST_DEVICE
+  size_t get_bucket_index(const reference bucket) const {
+    const int cell = find_occupied_bucket(bucket);
+    return cell < 0 ? number_of_buckets() : cell;
+  }
+
+  ///
+  /// @copydoc NeighbourQueryBase::get_buckets_near_point()
+  ///
+  ABORIA_HOST_DEVICE_IGNORE_WARN
+  template <int LNormNumber = -1>
+  CUDA_HOST_DEVICE query_iterator<LNormNumber>
+  get_buckets_near_point(const double_d &position,
+                         const double max_distance) const {
+#ifndef __CUDA_ARCH__
+    LOG(4, "\tget_buckets_near_point: position = "
+               << position << " max_distance = " << max_distance);
+#endif
+    return query_iterator<LNormNumber>(position,
+                                       double_d::Constant(max_distance), this);
+  }
+
+  ///
+  /// @copydoc NeighbourQueryBase::get_buckets_near_point()
+  ///
+  ABORIA_HOST_DEVICE_IGNORE_WARN
+  template <int LNormNumber = -1>
+  CUDA_HOST_DEVICE query_iterator<LNormNumber>
+  get_buckets_near_point(const double_d &position,
+                         const double_d &max_distance) const {
+#ifndef __CUDA_ARCH__
+    LOG(4, "\tget_buckets_near_point: position = "
+               << position << " max_distance = " << max_distance);
+#endif
+    return query_iterator<LNormNumber>(position, max_distance, this);
+  }
+
+  ///
+  /// @copydoc NeighbourQueryBase::get_end_bucket()
+  ///
+  ABORIA_HOST_DEVICE_IGNORE_WARN
+  CUDA_HOST_DEVICE
+  const int_d &get_end_bucket() const { return m_end_bucket; }
+
+  ///
+  /// @copydoc NeighbourQueryBase::get_subtree(const child_iterator&) const
+  ///
+  ABORIA_HOST_DEVICE_IGNORE_WARN
+  CUDA_HOST_DEVICE
+  all_iterator get_subtree(const child_iterator &ci) const {
+    return all_iterator();
+  }
+
+  ///
+  /// @copydoc NeighbourQueryBase::get_subtree() const
+  ///
+  ABORIA_HOST_DEVICE_IGNORE_WARN
+  CUDA_HOST_DEVICE
+  all_iterator get_subtree() const {
+    return all_iterator(m_cell_keys,
+                        m_cell_keys + m_number_of_occupied_buckets,
+                        m_point_to_cell_key);
+  }
+
+  ///
+  /// @copydoc NeighbourQueryBase::number_of_buckets()
+  ///
+  /// Only the occupied buckets are counted, so this is the same as
+  /// number_of_occupied_buckets()
+  ///
+  ABORIA_HOST_DEVICE_IGNORE_WARN
+  CUDA_HOST_DEVICE
+  size_t number_of_buckets() const { return m_number_of_occupied_buckets; }
+
+  ///
+  /// @brief returns the number of buckets that contain at least one particle,
+  /// which is the number of buckets stored in the hash table
+  ///
+  ABORIA_HOST_DEVICE_IGNORE_WARN
+  CUDA_HOST_DEVICE
+  size_t number_of_occupied_buckets() const {
+    return m_number_of_occupied_buckets;
+  }
+
+  ///
+  /// @copydoc NeighbourQueryBase::number_of_particles()
+  ///
+  ABORIA_HOST_DEVICE_IGNORE_WARN
+  CUDA_HOST_DEVICE
+  size_t number_of_particles() const {
+    return (m_particles_end - m_particles_begin);
+  }
+
+  ///
+  /// @copydoc NeighbourQueryBase::get_particles_begin() const
+  ///
+  ABORIA_HOST_DEVICE_IGNORE_WARN
+  CUDA_HOST_DEVICE
+  const raw_pointer &get_particles_begin() const { return m_particles_begin; }
+
+  ///
+  /// @copydoc NeighbourQueryBase::get_particles_begin()
+  ///
+  ABORIA_HOST_DEVICE_IGNORE_WARN
+  CUDA_HOST_DEVICE
+  raw_pointer &get_particles_begin() { return m_particles_begin; }
+
+  ///
+  /// @copydoc NeighbourQueryBase::number_of_levels()
+  ///
+  /// always 2 for HashedCellList
+  ///
+  unsigned number_of_levels() const { return 2; }
+};
+
+} // namespace Aboria
+
+#endif /* HASHED_CELL_LIST_H_ */
@@ -60,6 +60,7 @@ class Kdtree : public neighbour_search_base<Kdtree<Traits>, Traits,
   typedef typename Traits::double_d double_d;
   typedef typename Traits::position position;
   typedef typename Traits::vector_int vector_int;
+  typedef typename Traits::vector_size_t vector_size_t;
   typedef typename Traits::vector_int2 vector_int2;
   typedef typename Traits::vector_double vector_double;
   typedef typename Traits::vector_double_d vector_double_d;
@@ -72,7 +73,9 @@ class Kdtree : public neighbour_search_base<Kdtree<Traits>, Traits,
   friend base_type;
 
 public:
-  Kdtree() : base_type(), m_number_of_levels(0) {
+  Kdtree()
+      : base_type(), m_number_of_levels(0), m_refit(false),
+        m_refit_max_imbalance(2.0), m_build_by_selection(false) {
 
     this->m_query.m_nodes_child =
         iterator_to_raw_pointer(m_nodes_child.begin());
@@ -90,11 +93,53 @@ public:
 
   void print_data_structure() const { print_tree(); }
 
+  ///
+  /// @brief Set whether the tree is refitted, rather than rebuilt, when the
+  ///        particle positions are updated
+  ///
+  /// A refit keeps the topology of the tree and the position of every split
+  /// plane. Only the particles that have crossed a split plane are moved to a
+  /// new leaf, and the particle ranges of the leaves are updated. This is
+  /// much cheaper than a full rebuild when the particles only move a small
+  /// fraction of a leaf between updates. The tree is still rebuilt if
+  /// particles are added or removed, or if the number of particles in any
+  /// leaf exceeds @p max_imbalance times the number of particles per leaf
+  /// given to Particles::init_neighbour_search()
+  ///
+  /// @param enable turn refitting on or off
+  /// @param max_imbalance the maximum allowed ratio of the largest leaf to the
+  ///        number of particles per leaf before a full rebuild is triggered
+  ///
+  void set_refit(const bool enable, const double max_imbalance = 2.0) {
+    m_refit = enable;
+    m_refit_max_imbalance = max_imbalance;
+  }
+
+  ///
+  /// @brief Set whether the tree is built by median selection (see
+  ///        build_tree_by_selection()), rather than by build_tree()
+  ///
+  /// The selection builder splits each node at the median particle along
+  /// its widest dimension, and splits the nodes of each level in parallel
+  /// using OpenMP. It is only available for host (std) vectors, for other
+  /// vectors build_tree() is always used. The new builder is used from the
+  /// next rebuild of the tree
+  ///
+  /// @param enable turn the selection builder on or off
+  ///
+  void set_build_by_selection(const bool enable) {
+    m_build_by_selection = enable;
+    // the split planes change, so rebuild rather than refit
+    m_particle_leaf.clear();
+  }
+
 private:
   void set_domain_impl() {
     this->m_query.m_bounds.bmin = this->m_bounds.bmin;
     this->m_query.m_bounds.bmax = this->m_bounds.bmax;
     this->m_query.m_periodic = this->m_periodic;
+    // the leaf size might have changed, so rebuild rather than refit
+    m_particle_leaf.clear();
   }
 
   void update_iterator_impl() {}
@@ -138,46 +183,199 @@ private:
 
     const size_t num_points = this->m_alive_indices.size();
 
-    // setup particles
-    LOG(3, "update_positions_impl(kdtree): setup particles");
-    m_particle_node.resize(dimension * num_points);
-    detail::fill(m_particle_node.begin(), m_particle_node.end(), 0);
-    m_particle_indicies.resize(dimension * num_points);
-    for (size_t i = 0; i < dimension; ++i) {
-      // copy particle indicies that are alive
-      detail::copy(this->m_alive_indices.begin(), this->m_alive_indices.end(),
-                   m_particle_indicies.begin() + i * num_points);
-
-      // sort indicies by position in dimension i
-      detail::sort(
-          m_particle_indicies.begin() + i * num_points,
-          m_particle_indicies.begin() + (i + 1) * num_points,
-          [_p = iterator_to_raw_pointer(get<position>(this->m_particles_begin)),
-           _i = i](const int a, const int b) { return _p[a][_i] < _p[b][_i]; });
+    if (m_refit && refit(update_end - update_begin, new_n)) {
+      return;
     }
-    /*
-    for (size_t i = 0; i < dimension; ++i) {
-      std::cout << "dimension " << i << std::endl;
-      for (size_t j = i * num_points; j < (i + 1) * num_points; ++j) {
-        std::cout << "particle_indicies[" << j
-                  << "] = " << m_particle_indicies[j] << " ("
-                  << get<position>(
-                         this->m_particles_begin)[m_particle_indicies[j]]
-                  << ")" << std::endl;
+
+    if (m_build_by_selection &&
+        detail::is_std_iterator<typename vector_int::iterator>::type::value) {
+      LOG(3, "update_positions_impl(kdtree): build tree by selection");
+      build_tree_by_selection();
+    } else {
+      // setup particles
+      LOG(3, "update_positions_impl(kdtree): setup particles");
+      m_particle_node.resize(dimension * num_points);
+      detail::fill(m_particle_node.begin(), m_particle_node.end(), 0);
+      m_particle_indicies.resize(dimension * num_points);
+      for (size_t i = 0; i < dimension; ++i) {
+        // copy particle indicies that are alive
+        detail::copy(this->m_alive_indices.begin(), this->m_alive_indices.end(),
+                     m_particle_indicies.begin() + i * num_points);
+
+        // sort indicies by position in dimension i
+        detail::sort(
+            m_particle_indicies.begin() + i * num_points,
+            m_particle_indicies.begin() + (i + 1) * num_points,
+            [_p = iterator_to_raw_pointer(
+                 get<position>(this->m_particles_begin)),
+             _i = i](const int a, const int b) {
+              return _p[a][_i] < _p[b][_i];
+            });
       }
+      /*
+      for (size_t i = 0; i < dimension; ++i) {
+        std::cout << "dimension " << i << std::endl;
+        for (size_t j = i * num_points; j < (i + 1) * num_points; ++j) {
+          std::cout << "particle_indicies[" << j
+                    << "] = " << m_particle_indicies[j] << " ("
+                    << get<position>(
+                           this->m_particles_begin)[m_particle_indicies[j]]
+                    << ")" << std::endl;
+        }
+      }
+      */
+
+      // build the tree
+      LOG(3, "update_positions_impl(kdtree): build tree");
+      build_tree();
+
+      // copy sorted indicies from 1st dim back to m_alive_indicies
+      LOG(3, "update_positions_impl(kdtree): finished build tree");
+      detail::copy(m_particle_indicies.begin(),
+                   m_particle_indicies.begin() + num_points,
+                   this->m_alive_indices.begin());
     }
-    */
 
-    // build the tree
-    LOG(3, "update_positions_impl(kdtree): build tree");
-    build_tree();
+    // record the leaf of each particle, used for refitting
+    if (m_refit) {
+      m_particle_leaf.resize(num_points);
+      detail::for_each(
+          Traits::make_counting_iterator(0),
+          Traits::make_counting_iterator(
+              static_cast<int>(m_nodes_child.size())),
+          [_nodes_child = iterator_to_raw_pointer(m_nodes_child.begin()),
+           _nodes_split_dim =
+               iterator_to_raw_pointer(m_nodes_split_dim.begin()),
+           _particle_leaf =
+               iterator_to_raw_pointer(m_particle_leaf.begin())](const int i) {
+            if (_nodes_child[i] < 0) {
+              for (int j = -_nodes_child[i] - 1; j < -_nodes_split_dim[i] - 1;
+                   ++j) {
+                _particle_leaf[j] = i;
+              }
+            }
+          });
+    } else {
+      m_particle_leaf.clear();
+    }
 
-    // copy sorted indicies from 1st dim back to m_alive_indicies
-    LOG(3, "update_positions_impl(kdtree): finished build tree");
-    detail::copy(m_particle_indicies.begin(),
-                 m_particle_indicies.begin() + num_points,
-                 this->m_alive_indices.begin());
+    set_query_nodes();
+  }
 
+  ///
+  /// @brief re-bins the particles into the leaves of the existing tree,
+  ///        keeping the tree topology and split planes fixed
+  ///
+  /// @return false if the tree cannot be refitted (particles have been added
+  ///         or removed), or if the leaves are too unbalanced after the
+  ///         refit, in which case the tree needs to be rebuilt
+  ///
+  bool refit(const size_t update_n, const int new_n) {
+    const size_t num_points = this->m_alive_indices.size();
+    const int num_nodes = m_nodes_child.size();
+    if (new_n > 0 || update_n != num_points || num_points == 0 ||
+        m_particle_leaf.size() != num_points) {
+      return false;
+    }
+
+    LOG(3, "update_positions_impl(kdtree): refit tree");
+
+    // find the leaf of each particle, only traversing the tree for
+    // particles that are no longer within the bounds of their old leaf. The
+    // keys sort the leaves by their old particle range
+    vector_size_t keys(num_points);
+    detail::tabulate(
+        keys.begin(), keys.end(),
+        [_num_nodes = num_nodes,
+         _p = iterator_to_raw_pointer(get<position>(this->m_particles_begin)),
+         _particle_leaf = iterator_to_raw_pointer(m_particle_leaf.begin()),
+         _nodes_child = iterator_to_raw_pointer(m_nodes_child.begin()),
+         _nodes_split_dim = iterator_to_raw_pointer(m_nodes_split_dim.begin()),
+         _nodes_split_pos = iterator_to_raw_pointer(m_nodes_split_pos.begin()),
+         _nodes_bmin = iterator_to_raw_pointer(m_nodes_bmin.begin()),
+         _nodes_bmax = iterator_to_raw_pointer(m_nodes_bmax.begin())](
+            const int i) {
+          const double_d &p = _p[i];
+          int node = _particle_leaf[i];
+          bool inside = true;
+          for (size_t d = 0; d < dimension; ++d) {
+            if (p[d] < _nodes_bmin[node][d] || !(p[d] < _nodes_bmax[node][d])) {
+              inside = false;
+            }
+          }
+          if (!inside) {
+            node = 0;
+            while (_nodes_child[node] >= 0) {
+              const int d = _nodes_split_dim[node];
+              node = _nodes_child[node] +
+                     static_cast<int>(!(p[d] < _nodes_split_pos[node]));
+            }
+          }
+          const size_t start = -_nodes_child[node] - 1;
+          return start * _num_nodes + node;
+        });
+
+    detail::sort_by_key(keys.begin(), keys.end(),
+                        this->m_alive_indices.begin());
+
+    // find the new particle range of each leaf
+    vector_size_t nodes_key(num_nodes);
+    detail::tabulate(
+        nodes_key.begin(), nodes_key.end(),
+        [_num_nodes = num_nodes,
+         _nodes_child = iterator_to_raw_pointer(m_nodes_child.begin())](
+            const int i) {
+          const size_t start = -_nodes_child[i] - 1;
+          return _nodes_child[i] < 0 ? start * _num_nodes + i
+                                     : std::numeric_limits<size_t>::max();
+        });
+    vector_int leaf_begin(num_nodes);
+    vector_int leaf_end(num_nodes);
+    detail::lower_bound(keys.begin(), keys.end(), nodes_key.begin(),
+                        nodes_key.end(), leaf_begin.begin());
+    detail::upper_bound(keys.begin(), keys.end(), nodes_key.begin(),
+                        nodes_key.end(), leaf_end.begin());
+
+    // check the quality of the refitted tree
+    vector_int leaf_size(num_nodes);
+    detail::tabulate(
+        leaf_size.begin(), leaf_size.end(),
+        [_leaf_begin = iterator_to_raw_pointer(leaf_begin.begin()),
+         _leaf_end = iterator_to_raw_pointer(leaf_end.begin())](const int i) {
+          return _leaf_end[i] - _leaf_begin[i];
+        });
+    const int max_leaf_size = detail::reduce(
+        leaf_size.begin(), leaf_size.end(), 0,
+        [](const int a, const int b) { return a > b ? a : b; });
+    if (max_leaf_size > m_refit_max_imbalance * this->m_n_particles_in_leaf) {
+      LOG(3, "update_positions_impl(kdtree): largest leaf has "
+                 << max_leaf_size << " particles, rebuilding tree");
+      return false;
+    }
+
+    // update the leaves and the leaf of each particle
+    detail::for_each(
+        Traits::make_counting_iterator(0),
+        Traits::make_counting_iterator(num_nodes),
+        [_nodes_child = iterator_to_raw_pointer(m_nodes_child.begin()),
+         _nodes_split_dim = iterator_to_raw_pointer(m_nodes_split_dim.begin()),
+         _leaf_begin = iterator_to_raw_pointer(leaf_begin.begin()),
+         _leaf_end = iterator_to_raw_pointer(leaf_end.begin())](const int i) {
+          if (_nodes_child[i] < 0) {
+            _nodes_child[i] = -_leaf_begin[i] - 1;
+            _nodes_split_dim[i] = -_leaf_end[i] - 1;
+          }
+        });
+    detail::transform(keys.begin(), keys.end(), m_particle_leaf.begin(),
+                      [_num_nodes = num_nodes](const size_t key) {
+                        return static_cast<int>(key % _num_nodes);
+                      });
+
+    set_query_nodes();
+    return true;
+  }
+
+  void set_query_nodes() {
     this->m_query.m_nodes_child =
         iterator_to_raw_pointer(m_nodes_child.begin());
     this->m_query.m_nodes_split_dim =
@@ -193,6 +391,203 @@ private:
   KdtreeQuery<Traits> &get_query_impl() { return m_query; }
 
 private:
+  ///
+  /// @brief builds the tree by repeatedly splitting each node at the median
+  ///        particle along the dimension of largest spread
+  ///
+  /// The tree is built one level at a time, and the nodes are stored in
+  /// level order, giving the same node layout as build_tree(). The splits of
+  /// the nodes in each level are found in parallel, each using
+  /// `std::nth_element` on its range of the particle indices
+  /// (m_alive_indices). The top levels have fewer nodes than threads, so
+  /// most of their selection work is serial. This is only used for host
+  /// vectors, and only if enabled with set_build_by_selection()
+  ///
+  void build_tree_by_selection() {
+    const int num_points = this->m_alive_indices.size();
+
+    m_nodes_child.resize(1);
+    m_nodes_split_pos.resize(1);
+    m_nodes_split_dim.resize(1);
+    if (m_refit) {
+      m_nodes_bmin.resize(1);
+      m_nodes_bmax.resize(1);
+    }
+
+    // the index, particle range and bounds of each node in the current level
+    std::vector<int> level_node(1, 0);
+    std::vector<vint2> level_range(1, vint2(0, num_points));
+    std::vector<bbox<dimension>> level_bounds(1, this->m_bounds);
+    std::vector<int> next_node;
+    std::vector<vint2> next_range;
+    std::vector<bbox<dimension>> next_bounds;
+
+    // the split of each node in the current level, the left child holds the
+    // particles in [range[0], split_mid), or split_mid is -1 for a leaf
+    std::vector<int> split_mid;
+    std::vector<int> split_dim;
+    std::vector<double> split_pos;
+
+    m_number_of_levels = 0;
+    while (!level_node.empty()) {
+      LOG(3, "build_tree_by_selection(kdtree): building level "
+                 << m_number_of_levels);
+      const int level_size = level_node.size();
+      split_mid.resize(level_size);
+      split_dim.resize(level_size);
+      split_pos.resize(level_size);
+#ifdef HAVE_OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+      for (int i = 0; i < level_size; ++i) {
+        split_mid[i] = select_split(level_range[i], level_bounds[i],
+                                    level_node[i] == 0, split_dim[i],
+                                    split_pos[i]);
+      }
+
+      // write the nodes in this level, and add the children of the split
+      // nodes to the next level
+      next_node.clear();
+      next_range.clear();
+      next_bounds.clear();
+      for (int i = 0; i < level_size; ++i) {
+        const int node = level_node[i];
+        const vint2 &range = level_range[i];
+        if (m_refit) {
+          m_nodes_bmin[node] = level_bounds[i].bmin;
+          m_nodes_bmax[node] = level_bounds[i].bmax;
+        }
+        if (split_mid[i] < 0) {
+          m_nodes_child[node] = -range[0] - 1;
+          m_nodes_split_dim[node] = -range[1] - 1;
+          m_nodes_split_pos[node] = 0;
+          continue;
+        }
+        const int child = m_nodes_child.size();
+        m_nodes_child[node] = child;
+        m_nodes_split_dim[node] = split_dim[i];
+        m_nodes_split_pos[node] = split_pos[i];
+
+        bbox<dimension> left_bounds = level_bounds[i];
+        bbox<dimension> right_bounds = level_bounds[i];
+        left_bounds.bmax[split_dim[i]] = split_pos[i];
+        right_bounds.bmin[split_dim[i]] = split_pos[i];
+        next_node.push_back(child);
+        next_range.push_back(vint2(range[0], split_mid[i]));
+        next_bounds.push_back(left_bounds);
+        next_node.push_back(child + 1);
+        next_range.push_back(vint2(split_mid[i], range[1]));
+        next_bounds.push_back(right_bounds);
+
+        m_nodes_child.resize(child + 2);
+        m_nodes_split_pos.resize(child + 2);
+        m_nodes_split_dim.resize(child + 2);
+        if (m_refit) {
+          m_nodes_bmin.resize(child + 2);
+          m_nodes_bmax.resize(child + 2);
+        }
+      }
+      level_node.swap(next_node);
+      level_range.swap(next_range);
+      level_bounds.swap(next_bounds);
+      ++m_number_of_levels;
+    }
+
+#ifndef __CUDA_ARCH__
+    if (3 <= ABORIA_LOG_LEVEL) {
+      print_tree();
+    }
+#endif
+  }
+
+  ///
+  /// @brief finds the split of a node with bounds @p bounds, which contains
+  ///        the particles `m_alive_indices[range[0]:range[1]]`
+  ///
+  /// The node is split at the median particle along the dimension of
+  /// largest spread, and its particles are partitioned so that the left
+  /// child holds those with a position less than the split (the same rule
+  /// used by build_tree(), refit() and KdtreeQuery::go_to()). Particles at
+  /// the median go to the right child, unless this would leave the left
+  /// child empty. The split is placed between the largest position in the
+  /// left child and the smallest in the right child
+  ///
+  /// @param is_root true for the root node, which is always split
+  /// @param split_d set to the dimension of the split
+  /// @param split set to the position of the split
+  /// @return the index of the first particle in the right child, or -1 if
+  ///         the node is a leaf
+  ///
+  int select_split(const vint2 &range, const bbox<dimension> &bounds,
+                   const bool is_root, int &split_d, double &split) {
+    const int begin = range[0];
+    const int end = range[1];
+    const int n = end - begin;
+    if (!is_root && n <= this->m_n_particles_in_leaf) {
+      return -1;
+    }
+    const double_d *p = iterator_to_raw_pointer(
+        get<position>(this->m_particles_begin));
+    int *indices = iterator_to_raw_pointer(this->m_alive_indices.begin());
+
+    // split along the dimension of largest spread
+    bbox<dimension> spread;
+    for (int i = begin; i < end; ++i) {
+      spread = spread + bbox<dimension>(p[indices[i]]);
+    }
+    split_d = 0;
+    double max_spread = -1;
+    for (size_t i = 0; i < dimension; ++i) {
+      const double width = n > 0 ? spread.bmax[i] - spread.bmin[i]
+                                 : bounds.bmax[i] - bounds.bmin[i];
+      if (width > max_spread) {
+        max_spread = width;
+        split_d = i;
+      }
+    }
+    if (n == 0) {
+      split = 0.5 * (bounds.bmin[split_d] + bounds.bmax[split_d]);
+      return begin;
+    }
+    // all the particles are at the same position
+    if (!is_root && !(max_spread > 0)) {
+      return -1;
+    }
+
+    // split at the median particle
+    const int d = split_d;
+    auto less = [p, d](const int a, const int b) { return p[a][d] < p[b][d]; };
+    int mid = begin + n / 2;
+    std::nth_element(indices + begin, indices + mid, indices + end, less);
+    const double median = p[indices[mid]][d];
+    mid = std::partition(indices + begin, indices + mid,
+                         [p, d, median](const int a) {
+                           return p[a][d] < median;
+                         }) -
+          indices;
+    if (mid == begin && max_spread > 0) {
+      mid = std::partition(indices + begin, indices + end,
+                           [p, d, median](const int a) {
+                             return !(median < p[a][d]);
+                           }) -
+            indices;
+    }
+
+    if (mid == begin) {
+      split = median;
+    } else {
+      const double left_max =
+          p[*std::max_element(indices + begin, indices + mid, less)][d];
+      const double right_min =
+          p[*std::min_element(indices + mid, indices + end, less)][d];
+      split = 0.5 * (left_max + right_min);
+      if (!(left_max < split)) {
+        split = right_min;
+      }
+    }
+    return mid;
+  }
+
   void build_tree() {
     const size_t num_points = this->m_alive_indices.size();
 
@@ -214,6 +609,12 @@ private:
     m_nodes_split_pos.resize(1);
     m_nodes_split_dim.resize(1);
     m_nodes_child[0] = 1;
+    if (m_refit) {
+      m_nodes_bmin.resize(1);
+      m_nodes_bmax.resize(1);
+      m_nodes_bmin[0] = this->m_bounds.bmin;
+      m_nodes_bmax[0] = this->m_bounds.bmax;
+    }
     m_number_of_levels = 1;
     int prev_level_index = 0;
     // m_nodes_child  int-> index of first child node (<0 is a leaf, gives index
@@ -543,6 +944,16 @@ private:
             }
           });
 
+      // record the bounds of the children, used for refitting
+      if (m_refit) {
+        m_nodes_bmin.resize(children_end);
+        m_nodes_bmax.resize(children_end);
+        detail::copy(children_bmin.begin(), children_bmin.end(),
+                     m_nodes_bmin.begin() + prev_level_index);
+        detail::copy(children_bmax.begin(), children_bmax.end(),
+                     m_nodes_bmax.begin() + prev_level_index);
+      }
+
       // setup new parent nodes (don't copy leafs)
       parents_leaf.resize(total_children_nodes);
       parents_bmin.resize(total_children_nodes);
@@ -568,6 +979,16 @@ private:
   vector_int m_particle_indicies;
   vector_int m_particle_node;
   int m_number_of_levels;
+
+  // refitting
+  bool m_refit;
+  double m_refit_max_imbalance;
+  vector_int m_particle_leaf;
+  vector_double_d m_nodes_bmin;
+  vector_double_d m_nodes_bmax;
+
+  // build the tree with build_tree_by_selection() rather than build_tree()
+  bool m_build_by_selection;
   KdtreeQuery<Traits> m_query;
 }; // namespace Aboria
 
@@ -669,6 +1090,8 @@ template <typename Traits> struct KdtreeQuery {
   bbox<dimension> m_bounds;
   raw_pointer m_particles_begin;
   raw_pointer m_particles_end;
+  detail::position_soa<dimension> m_position_soa;
+  detail::ghost_halo<dimension> m_ghosts;
   size_t m_number_of_buckets;
   size_t m_number_of_levels;
 
@@ -676,8 +1099,7 @@ template <typename Traits> struct KdtreeQuery {
   int *m_nodes_split_dim;
   double *m_nodes_split_pos;
 
-  size_t *m_id_map_key;
-  size_t *m_id_map_value;
+  detail::id_map_table m_id_map;
 
   const box_type &get_bounds() const { return m_bounds; }
   const bool_d &get_periodic() const { return m_periodic; }
@@ -697,13 +1119,7 @@ public:
   CUDA_HOST_DEVICE
   raw_pointer find(const size_t id) const {
     const size_t n = number_of_particles();
-    size_t *last = m_id_map_key + n;
-    size_t *first = detail::lower_bound(m_id_map_key, last, id);
-    if ((first != last) && !(id < *first)) {
-      return m_particles_begin + m_id_map_value[first - m_id_map_key];
-    } else {
-      return m_particles_begin + n;
-    }
+    return m_particles_begin + m_id_map.find(id, n);
   }
 
   /*
@@ -771,13 +1187,31 @@ public:
                              m_particles_begin - m_nodes_split_dim[cindex] - 1);
   }
 
+  ///
+  /// @copydoc NeighbourQueryBase::number_of_particles(const reference) const
+  ///
+  /// The particles in a subtree are contiguous, so this only needs to find
+  /// the first and last leaf of the subtree
+  ///
+  size_t number_of_particles(reference bucket) const {
+    int first = get_child_index(bucket);
+    int last = first;
+    while (m_nodes_child[first] >= 0) {
+      first = m_nodes_child[first];
+    }
+    while (m_nodes_child[last] >= 0) {
+      last = m_nodes_child[last] + 1;
+    }
+    return m_nodes_child[first] - m_nodes_split_dim[last];
+  }
+
   void go_to(const double_d &position, child_iterator &ci) const {
     const int pindex = get_parent_index(*ci);
     const int i = m_nodes_split_dim[pindex];
     ASSERT(position[i] < ci.m_data.bounds.bmax[i], "position out of bounds");
     ASSERT(position[i] >= ci.m_data.bounds.bmin[i], "position out of bounds");
     const double diff = position[i] - m_nodes_split_pos[pindex];
-    if (diff > 0)
+    if (diff >= 0)
       ++ci;
   }
 
@@ -695,26 +695,18 @@ public:
     const RowElements &a = this->m_row_elements;
     const ColElements &b = this->m_col_elements;
 
-    const size_t na = a.size();
-
-    ASSERT(na == rhs.size(), "lhs vector has incompatible size");
+    ASSERT(a.size() == rhs.size(), "lhs vector has incompatible size");
     ASSERT(b.size() == lhs.size(), "rhs vector has incompatible size");
 
-#ifdef HAVE_OPENMP
-#pragma omp parallel for
-#endif
-    for (size_t i = 0; i < na; ++i) {
-      const_row_reference ai = a[i];
-      const double radius = m_radius_function(ai);
-      for (auto pairj =
-               euclidean_search(b.get_query(), get<position>(ai), radius);
-           pairj != false; ++pairj) {
-        const_position_reference dx = pairj.dx();
-        const_col_reference bj = *pairj;
-        const size_t j = &get<position>(bj) - get<position>(b).data();
-        lhs[i] += m_dx_function(dx, ai, bj) * rhs[j];
-      }
-    }
+    batch_search(b.get_query(), get<position>(a).begin(),
+                 get<position>(a).end(),
+                 [&](const size_t i) { return m_radius_function(a[i]); },
+                 [&](const size_t i, const_col_reference bj,
+                     const double_d &dx) {
+                   const size_t j =
+                       &get<position>(bj) - get<position>(b).data();
+                   lhs[i] += m_dx_function(dx, a[i], bj) * rhs[j];
+                 });
   }
 
   template <typename DerivedLHS, typename DerivedRHS>
@@ -729,25 +721,17 @@ public:
     const RowElements &a = this->m_row_elements;
     const ColElements &b = this->m_col_elements;
 
-    const size_t na = a.size();
-
-#ifdef HAVE_OPENMP
-#pragma omp parallel for
-#endif
-    for (size_t i = 0; i < na; ++i) {
-      const_row_reference ai = a[i];
-      const double radius = m_radius_function(ai);
-      for (auto pairj =
-               euclidean_search(b.get_query(), get<position>(ai), radius);
-           pairj != false; ++pairj) {
-        const_position_reference dx = pairj.dx();
-        const_col_reference bj = *pairj;
-        const size_t j = &get<position>(bj) - get<position>(b).data();
-        lhs.template segment<BlockRows>(i * BlockRows) +=
-            m_dx_function(dx, ai, bj) *
-            rhs.template segment<BlockCols>(j * BlockCols);
-      }
-    }
+    batch_search(b.get_query(), get<position>(a).begin(),
+                 get<position>(a).end(),
+                 [&](const size_t i) { return m_radius_function(a[i]); },
+                 [&](const size_t i, const_col_reference bj,
+                     const double_d &dx) {
+                   const size_t j =
+                       &get<position>(bj) - get<position>(b).data();
+                   lhs.template segment<BlockRows>(i * BlockRows) +=
+                       m_dx_function(dx, a[i], bj) *
+                       rhs.template segment<BlockCols>(j * BlockCols);
+                 });
   }
 };
 
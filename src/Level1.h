@@ -41,8 +41,11 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #endif
 
 // Level1
+#include "BoundingVolumeHierarchy.h"
 #include "CellList.h"
+#include "CellListMultiLevel.h"
 #include "CellListOrdered.h"
+#include "HashedCellList.h"
 #include "CudaInclude.h"
 #include "Elements.h"
 #include "Get.h"
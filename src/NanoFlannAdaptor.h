@@ -404,14 +404,15 @@ template <typename Traits> struct KdtreeNanoflannQuery {
   bbox<dimension> m_bounds;
   raw_pointer m_particles_begin;
   raw_pointer m_particles_end;
+  detail::position_soa<dimension> m_position_soa;
+  detail::ghost_halo<dimension> m_ghosts;
   size_t m_number_of_buckets;
   size_t m_number_of_levels;
 
   value_type *m_root;
   value_type m_dummy_root;
 
-  size_t *m_id_map_key;
-  size_t *m_id_map_value;
+  detail::id_map_table m_id_map;
 
   const box_type &get_bounds() const { return m_bounds; }
   const bool_d &get_periodic() const { return m_periodic; }
@@ -423,13 +424,7 @@ template <typename Traits> struct KdtreeNanoflannQuery {
   CUDA_HOST_DEVICE
   raw_pointer find(const size_t id) const {
     const size_t n = number_of_particles();
-    size_t *last = m_id_map_key + n;
-    size_t *first = detail::lower_bound(m_id_map_key, last, id);
-    if ((first != last) && !(id < *first)) {
-      return m_particles_begin + m_id_map_value[first - m_id_map_key];
-    } else {
-      return m_particles_begin + n;
-    }
+    return m_particles_begin + m_id_map.find(id, n);
   }
 
   /*
@@ -528,6 +523,24 @@ template <typename Traits> struct KdtreeNanoflannQuery {
                              m_particles_begin + bucket.node_type.lr.right);
   }
 
+  ///
+  /// @copydoc NeighbourQueryBase::number_of_particles(const reference) const
+  ///
+  /// The particles in a subtree are contiguous, so this only needs to find
+  /// the first and last leaf of the subtree
+  ///
+  static size_t number_of_particles(reference bucket) {
+    pointer first = &bucket;
+    pointer last = &bucket;
+    while (!is_leaf_node(*first)) {
+      first = first->child1;
+    }
+    while (!is_leaf_node(*last)) {
+      last = last->child2;
+    }
+    return last->node_type.lr.right - first->node_type.lr.left;
+  }
+
   /*
   static double_d
   get_bucket_bounds_low(reference bucket) {
@@ -50,6 +50,10 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "Vector.h"
 #include "detail/Algorithms.h"
 #include "detail/Distance.h"
+#include "detail/GhostHalo.h"
+#include "detail/IdMap.h"
+#include "detail/PositionSoA.h"
+#include <array>
 #include <stack>
 
 namespace Aboria {
@@ -144,8 +148,12 @@ public:
   typedef typename Traits::vector_unsigned_int vector_unsigned_int;
   typedef typename Traits::vector_int vector_int;
   typedef typename Traits::vector_size_t vector_size_t;
+  typedef typename Traits::vector_double vector_double;
+  typedef typename Traits::vector_double_d vector_double_d;
   typedef typename Traits::reference reference;
   typedef typename Traits::raw_reference raw_reference;
+  typedef typename Traits::position position;
+  static const unsigned int dimension = Traits::dimension;
 
   const Derived &cast() const { return static_cast<const Derived &>(*this); }
   Derived &cast() { return static_cast<Derived &>(*this); }
@@ -157,7 +165,9 @@ public:
   /// possible using the `double` type. All periodicity is turned off, and the
   /// number of particle per bucket is set to 10
   ///
-  neighbour_search_base() : m_id_map(false) {
+  neighbour_search_base()
+      : m_id_map_size(0), m_id_map(false), m_position_soa(false),
+        m_halo_width(0) {
     LOG_CUDA(2, "neighbour_search_base: constructor, setting default domain");
     const double min = std::numeric_limits<double>::min();
     const double max = std::numeric_limits<double>::max();
@@ -174,6 +184,14 @@ public:
   ///
   static constexpr bool ordered() { return true; }
 
+  ///
+  /// @brief Returns true if particles outside the domain are removed in
+  ///        non-periodic dimensions. This is overloaded by the Derived class
+  ///
+  /// @return true
+  ///
+  static constexpr bool bounded() { return true; }
+
   ///
   /// @brief A function object used to enforce the domain extents on the set
   ///        of particles
@@ -187,10 +205,11 @@ public:
     typedef position_d<D> position;
     const double_d low, high;
     const bool_d periodic;
+    const bool bounded;
 
     enforce_domain_lambda(const double_d &low, const double_d &high,
-                          const bool_d &periodic)
-        : low(low), high(high), periodic(periodic) {}
+                          const bool_d &periodic, const bool bounded = true)
+        : low(low), high(high), periodic(periodic), bounded(bounded) {}
 
     ///
     /// @brief updates the position of @p i (periodic domain) or its alive
@@ -200,7 +219,8 @@ public:
     /// If dimension $j$ is periodic, and $r_j$ is outside the domain,
     /// then $r_j$ is updated to the correct position within the domain.
     /// If dimensino $j$ is non-periodic, and $r_j$ is outside the domain,
-    /// then the `alive` variable for @p i is set to `false`
+    /// then the `alive` variable for @p i is set to `false` (only if
+    /// `bounded` is true)
     ///
     ///
     CUDA_HOST_DEVICE
@@ -221,7 +241,7 @@ public:
           while (r[d] >= high[d]) {
             r[d] -= (high[d] - low[d]);
           }
-        } else {
+        } else if (bounded) {
           if ((r[d] < low[d]) || (r[d] >= high[d])) {
 #ifdef __CUDA_ARCH__
             LOG_CUDA(2, "removing particle");
@@ -274,19 +294,30 @@ public:
   ///
   size_t find_id_map(const size_t id) const {
     const size_t n = m_particles_end - m_particles_begin;
-    return detail::lower_bound(m_id_map_key.begin(), m_id_map_key.begin() + n,
-                               id) -
-           m_id_map_key.begin();
+    if (m_id_map_key.empty()) {
+      return n;
+    }
+    if (id_map_is_sorted()) {
+      auto first = detail::lower_bound(m_id_map_key.begin(),
+                                       m_id_map_key.end(), id);
+      return (first != m_id_map_key.end()) && !(id < *first)
+                 ? m_id_map_value[first - m_id_map_key.begin()]
+                 : n;
+    }
+    const size_t slot = find_id_map_slot(id);
+    return m_id_map_key[slot] == id ? m_id_map_value[slot] : n;
   }
 
   ///
   /// @brief This function initialises the find-by-id functionality
   ///
-  /// Find-by-id works using a key and value vector pair that act as a map
-  /// between ids and particle indicies. This pair is sorted by id for
-  /// quick(ish) searching, especially in parallel. It is not as good as
-  /// `std::map` on a (single-core) CPU, but can be done on a GPU using
-  /// `thrust::vector`
+  /// Find-by-id works using a key and value vector pair that together form
+  /// an open-addressing hash table (see detail::id_map_table) mapping ids to
+  /// particle indicies, so each lookup takes O(1) time. The table is created
+  /// on the next call to update_positions(), after which only the entries
+  /// of particles that are added, deleted or moved are changed. For
+  /// non-std vectors the pair is instead sorted by id, in parallel, on each
+  /// update
   ///
   /// @see find_id_map
   ///
@@ -294,6 +325,7 @@ public:
     m_id_map = true;
     m_id_map_key.clear();
     m_id_map_value.clear();
+    m_id_map_size = 0;
   }
 
   ///
@@ -314,7 +346,11 @@ public:
 
     std::cout << "id map (id,index):\n";
     for (size_t i = 0; i < m_id_map_key.size(); ++i) {
-      std::cout << "(" << m_id_map_key[i] << "," << m_id_map_value[i] << ")\n";
+      if (id_map_is_sorted() ||
+          m_id_map_key[i] != detail::id_map_table::empty_key()) {
+        std::cout << "(" << m_id_map_key[i] << "," << m_id_map_value[i]
+                  << ")\n";
+      }
     }
     std::cout << std::endl;
   }
@@ -380,7 +416,8 @@ public:
     if (m_domain_has_been_set) {
       detail::for_each(update_begin, update_end,
                        enforce_domain_lambda<Traits::dimension, raw_reference>(
-                           get_min(), get_max(), get_periodic()));
+                           get_min(), get_max(), get_periodic(),
+                           Derived::bounded()));
     }
 
     // m_alive_sum will hold a cummulative sum of the living
@@ -442,40 +479,8 @@ public:
       // that previous id map is correct
       if (cast().ordered() || new_n > 0 || num_dead > 0 ||
           m_id_map_key.size() == 0) {
-        m_id_map_key.resize(dead_and_alive_n - num_dead);
-        m_id_map_value.resize(dead_and_alive_n - num_dead);
-
-        // before update range
-        if (update_start_index > 0) {
-          detail::sequence(m_id_map_value.begin(),
-                           m_id_map_value.begin() + update_start_index);
-          detail::copy(get<id>(begin), get<id>(begin) + update_start_index,
-                       m_id_map_key.begin());
-        }
-
-        // after update range
-        ASSERT(update_end_index == dead_and_alive_n,
-               "if not updateing last particle then should not get here");
-
-        // update range
-        /*
-        detail::transform(m_alive_indices.begin(),m_alive_indices.end(),
-                     m_id_map_value.begin()+update_start_index,
-                     [&](const int index) {
-                        const int index_into_update = index -
-        update_start_index; const int num_dead_before_index = index_into_update
-        - m_alive_sum[index_into_update]; return index - num_dead_before_index;
-                     });
-                     */
-        detail::sequence(m_id_map_value.begin() + update_start_index,
-                         m_id_map_value.end(), update_start_index);
-        auto raw_id = iterator_to_raw_pointer(get<id>(begin));
-        detail::transform(
-            m_alive_indices.begin(), m_alive_indices.end(),
-            m_id_map_key.begin() + update_start_index,
-            [=] CUDA_HOST_DEVICE(const int index) { return raw_id[index]; });
-        detail::sort_by_key(m_id_map_key.begin(), m_id_map_key.end(),
-                            m_id_map_value.begin());
+        update_id_map(previous_n, update_start_index, update_end_index,
+                      num_dead > 0);
 #ifndef __CUDA_ARCH__
         if (4 <= ABORIA_LOG_LEVEL) {
           print_id_map();
@@ -485,12 +490,27 @@ public:
     }
 
     query_type &query = cast().get_query_impl();
-    query.m_id_map_key = iterator_to_raw_pointer(m_id_map_key.begin());
-    query.m_id_map_value = iterator_to_raw_pointer(m_id_map_value.begin());
+    if (m_id_map_key.size() > 0) {
+      query.m_id_map.m_keys = iterator_to_raw_pointer(m_id_map_key.begin());
+      query.m_id_map.m_values = iterator_to_raw_pointer(m_id_map_value.begin());
+      query.m_id_map.m_mask = m_id_map_key.size() - 1;
+      query.m_id_map.m_size = m_id_map_key.size();
+      query.m_id_map.m_sorted = id_map_is_sorted();
+    } else {
+      query.m_id_map = detail::id_map_table();
+    }
     query.m_particles_begin = iterator_to_raw_pointer(m_particles_begin);
     query.m_particles_end = iterator_to_raw_pointer(m_particles_end);
 
-    return cast().ordered() || num_dead > 0;
+    const bool reorder = cast().ordered() || num_dead > 0;
+    if (m_position_soa && !reorder) {
+      // if reordering, this is done in update_iterators()
+      update_position_soa(update_start_index, update_end_index);
+    }
+    if (m_halo_width > 0 && !reorder) {
+      update_ghost_halo();
+    }
+    return reorder;
   }
 
   ///
@@ -508,8 +528,73 @@ public:
     query.m_particles_end = iterator_to_raw_pointer(m_particles_end);
     LOG(2, "neighbour_search_base: update iterators");
     cast().update_iterator_impl();
+    if (m_position_soa) {
+      update_position_soa(0, m_particles_end - m_particles_begin);
+    }
+    if (m_halo_width > 0) {
+      update_ghost_halo();
+    }
   }
 
+  ///
+  /// @brief This function turns on or off a copy of the particle positions
+  /// stored as a structure-of-arrays
+  ///
+  /// If @p enable is true then each coordinate of the particle positions is
+  /// copied into its own contiguous array whenever the positions are
+  /// updated, and made available to the query object via
+  /// detail::position_soa. This allows distance calculations over a
+  /// contiguous range of particles to be vectorised, at the cost of storing
+  /// the positions twice. The copy is created on the next call to
+  /// update_positions() or update_iterators()
+  ///
+  void init_position_soa(const bool enable) {
+    m_position_soa = enable;
+    for (size_t d = 0; d < dimension; ++d) {
+      vector_double empty;
+      m_position_soa_data[d].swap(empty);
+    }
+    cast().get_query_impl().m_position_soa = detail::position_soa<dimension>();
+  }
+
+  ///
+  /// @return true if the structure-of-arrays positions are switched on
+  ///
+  bool get_position_soa() const { return m_position_soa; }
+
+  ///
+  /// @brief This function turns on or off the ghost particles for periodic
+  /// domains
+  ///
+  /// If @p width is greater than zero then copies of the particles within
+  /// @p width of each periodic boundary are stored, shifted by the domain
+  /// width so that they form a halo around the opposite boundary (see
+  /// detail::ghost_halo). The ghosts are regenerated whenever the positions
+  /// are updated. Searches with a radius no greater than @p width then
+  /// search the data structure once, as if the domain was not periodic, plus
+  /// the nearby ghosts, instead of once for every periodic image of the
+  /// domain. The ghosts are created on the next call to update_positions()
+  /// or update_iterators()
+  ///
+  /// @param width the halo width, this must be no greater than the width of
+  /// the domain along any periodic dimension. Set to 0 to turn off
+  ///
+  void init_ghost_halo(const double width) {
+    m_halo_width = width;
+    vector_double_d empty_positions;
+    m_ghost_positions.swap(empty_positions);
+    vector_int empty_indices;
+    m_ghost_indices.swap(empty_indices);
+    vector_int empty_cell_begin;
+    m_ghost_cell_begin.swap(empty_cell_begin);
+    cast().get_query_impl().m_ghosts = detail::ghost_halo<dimension>();
+  }
+
+  ///
+  /// @return the width of the ghost particle halo, or 0 if it is turned off
+  ///
+  double get_halo_width() const { return m_halo_width; }
+
   ///
   /// @return the query object
   ///
@@ -554,6 +639,353 @@ public:
   double get_max_bucket_size() const { return m_n_particles_in_leaf; }
 
 protected:
+  ///
+  /// @brief copies the positions of the particles with indices in [@p first,
+  /// @p last) to the structure-of-arrays positions, and updates the query
+  /// object to point to them
+  ///
+  void update_position_soa(const size_t first, const size_t last) {
+    const size_t n = m_particles_end - m_particles_begin;
+    detail::position_soa<dimension> &soa =
+        cast().get_query_impl().m_position_soa;
+    for (size_t d = 0; d < dimension; ++d) {
+      m_position_soa_data[d].resize(n);
+      detail::transform(get<position>(m_particles_begin) + first,
+                        get<position>(m_particles_begin) + last,
+                        m_position_soa_data[d].begin() + first,
+                        [=] CUDA_HOST_DEVICE(const double_d &p) {
+                          return static_cast<double>(p[d]);
+                        });
+      soa.m_data[d] = iterator_to_raw_pointer(m_position_soa_data[d].begin());
+    }
+  }
+
+  ///
+  /// @brief regenerates the ghost particles from the current particle
+  /// positions, and updates the query object to point to them
+  ///
+  void update_ghost_halo() {
+    query_type &query = cast().get_query_impl();
+    query.m_ghosts = detail::ghost_halo<dimension>();
+    if (!m_periodic.any()) {
+      return;
+    }
+    for (size_t d = 0; d < dimension; ++d) {
+      CHECK(!m_periodic[d] ||
+                m_halo_width <= m_bounds.bmax[d] - m_bounds.bmin[d],
+            "halo width " << m_halo_width
+                          << " is greater than the width of the domain");
+    }
+
+    // count the ghosts of each particle
+    const int n = m_particles_end - m_particles_begin;
+    detail::ghost_halo<dimension> halo;
+    halo.m_width = m_halo_width;
+    m_ghost_offsets.resize(n);
+    const detail::ghost_halo_generator<dimension> count_ghosts(
+        m_bounds, m_periodic, halo);
+    const double_d *positions = get<position>(query.get_particles_begin());
+    int n_ghosts = 0;
+    if (n > 0) {
+      detail::transform_exclusive_scan(
+          get<position>(m_particles_begin), get<position>(m_particles_end),
+          m_ghost_offsets.begin(), count_ghosts, 0, std::plus<int>());
+      n_ghosts = m_ghost_offsets[n - 1] + count_ghosts(positions[n - 1]);
+    }
+
+    // a grid over the domain plus the halo, with cells no smaller than the
+    // halo width and no more cells than about twice the number of ghosts
+    bbox<dimension> bounds = m_bounds;
+    for (size_t d = 0; d < dimension; ++d) {
+      if (m_periodic[d]) {
+        bounds.bmin[d] -= m_halo_width;
+        bounds.bmax[d] += m_halo_width;
+      }
+    }
+    const double_d side = bounds.bmax - bounds.bmin;
+    typename detail::ghost_halo<dimension>::int_d size;
+    double n_cells = 1;
+    for (size_t d = 0; d < dimension; ++d) {
+      size[d] = static_cast<int>(std::max(
+          1.0, std::min(std::floor(side[d] / m_halo_width), 1048576.0)));
+      n_cells *= size[d];
+    }
+    const double max_n_cells = std::max(16.0, 2.0 * n_ghosts);
+    while (n_cells > max_n_cells) {
+      size_t largest = 0;
+      for (size_t d = 1; d < dimension; ++d) {
+        if (size[d] > size[largest]) {
+          largest = d;
+        }
+      }
+      n_cells /= size[largest];
+      size[largest] = (size[largest] + 1) / 2;
+      n_cells *= size[largest];
+    }
+    halo.m_size = size;
+    halo.m_point_to_cell = detail::point_to_bucket_index<dimension>(
+        size.template cast<unsigned int>(), side / size.template cast<double>(),
+        bounds);
+
+    // generate the ghosts, then sort them by cell
+    vector_double_d unsorted_positions(n_ghosts);
+    vector_int unsorted_indices(n_ghosts);
+    vector_int cells(n_ghosts);
+    vector_int order(n_ghosts);
+    const detail::ghost_halo_generator<dimension> generate_ghosts(
+        m_bounds, m_periodic, halo);
+    const int *offsets = iterator_to_raw_pointer(m_ghost_offsets.begin());
+    double_d *ghost_positions =
+        iterator_to_raw_pointer(unsorted_positions.begin());
+    int *ghost_indices = iterator_to_raw_pointer(unsorted_indices.begin());
+    int *ghost_cells = iterator_to_raw_pointer(cells.begin());
+    detail::for_each(Traits::make_counting_iterator(0),
+                     Traits::make_counting_iterator(n),
+                     [=] CUDA_HOST_DEVICE(const int i) {
+                       generate_ghosts.generate(positions[i], i, offsets[i],
+                                                ghost_positions, ghost_indices,
+                                                ghost_cells);
+                     });
+    detail::sequence(order.begin(), order.end());
+    detail::sort_by_key(cells.begin(), cells.end(), order.begin());
+    m_ghost_positions.resize(n_ghosts);
+    m_ghost_indices.resize(n_ghosts);
+    detail::gather(order.begin(), order.end(), unsorted_positions.begin(),
+                   m_ghost_positions.begin());
+    detail::gather(order.begin(), order.end(), unsorted_indices.begin(),
+                   m_ghost_indices.begin());
+
+    // find the first ghost in each cell
+    const int n_cells_int = size.prod();
+    m_ghost_cell_begin.resize(n_cells_int + 1);
+    auto search_begin = Traits::make_counting_iterator(0);
+    detail::lower_bound(cells.begin(), cells.end(), search_begin,
+                        search_begin + n_cells_int + 1,
+                        m_ghost_cell_begin.begin());
+
+    halo.m_positions = iterator_to_raw_pointer(m_ghost_positions.begin());
+    halo.m_indices = iterator_to_raw_pointer(m_ghost_indices.begin());
+    halo.m_cell_begin = iterator_to_raw_pointer(m_ghost_cell_begin.begin());
+    query.m_ghosts = halo;
+
+    LOG(2, "neighbour_search_base: update_ghost_halo: generated "
+               << n_ghosts << " ghosts in " << size << " cells");
+  }
+
+  ///
+  /// @return true if the find-by-id map is a pair of vectors sorted by id,
+  /// rather than a hash table. The hash table is updated in serial, so this
+  /// is used for vectors that are not std vectors (e.g. thrust vectors)
+  ///
+  static bool id_map_is_sorted() {
+    return !detail::is_std_iterator<
+        typename vector_size_t::iterator>::type::value;
+  }
+
+  ///
+  /// @return the slot in the find-by-id hash table that holds @p id, or the
+  /// empty slot where it would be inserted
+  ///
+  size_t find_id_map_slot(const size_t id) const {
+    const size_t mask = m_id_map_key.size() - 1;
+    size_t slot = detail::id_map_table::hash(id) & mask;
+    while (m_id_map_key[slot] != id &&
+           m_id_map_key[slot] != detail::id_map_table::empty_key()) {
+      slot = (slot + 1) & mask;
+    }
+    return slot;
+  }
+
+  ///
+  /// @brief removes the entry in slot @p slot of the find-by-id hash table,
+  /// shifting back any later entries in the same probe sequence so that no
+  /// tombstones are needed
+  ///
+  void erase_id_map_slot(size_t slot) {
+    const size_t mask = m_id_map_key.size() - 1;
+    for (size_t next = (slot + 1) & mask;
+         m_id_map_key[next] != detail::id_map_table::empty_key();
+         next = (next + 1) & mask) {
+      // leave the entry where it is if its home slot is cyclically in
+      // (slot, next]
+      const size_t home = detail::id_map_table::hash(m_id_map_key[next]) & mask;
+      const bool stays = slot <= next ? (slot < home && home <= next)
+                                      : (slot < home || home <= next);
+      if (!stays) {
+        m_id_map_key[slot] = m_id_map_key[next];
+        m_id_map_value[slot] = m_id_map_value[next];
+        slot = next;
+      }
+    }
+    m_id_map_key[slot] = detail::id_map_table::empty_key();
+    --m_id_map_size;
+  }
+
+  ///
+  /// @brief updates the find-by-id hash table to match the particle set after
+  /// it is reordered using #m_alive_indices
+  ///
+  /// The particle with index `m_alive_indices[i]` will be moved to index
+  /// @p update_start_index + i, so only the entries of the particles that
+  /// are deleted, added or moved are changed. The table is rebuilt if it
+  /// would become more than half full, or if it is found to be inconsistent
+  /// with the particle set (e.g. if the particles have been changed without
+  /// an update). If id_map_is_sorted() the map is instead recreated by
+  /// sort_id_map()
+  ///
+  /// @param previous_n the number of particles before the update
+  /// @param has_dead true if particles with a false `alive` flag will be
+  /// deleted
+  ///
+  void update_id_map(const size_t previous_n, const size_t update_start_index,
+                     const size_t update_end_index, const bool has_dead) {
+    const size_t n = m_particles_end - m_particles_begin - update_end_index +
+                     update_start_index + m_alive_indices.size();
+    if (id_map_is_sorted()) {
+      sort_id_map(n, update_start_index, update_end_index);
+    } else if (2 * n > m_id_map_key.size() ||
+               !patch_id_map(previous_n, update_start_index,
+                             update_end_index, has_dead) ||
+               m_id_map_size != n) {
+      LOG(3, "neighbour_search_base: rebuilding id map");
+      rebuild_id_map(n, update_start_index, update_end_index);
+    }
+  }
+
+  ///
+  /// @brief incrementally updates the find-by-id hash table
+  ///
+  /// @return false if the table is inconsistent with the particle set, in
+  /// which case it needs to be rebuilt
+  /// @see update_id_map()
+  ///
+  bool patch_id_map(const size_t previous_n, const size_t update_start_index,
+                    const size_t update_end_index, const bool has_dead) {
+    // remove the deleted particles
+    if (has_dead) {
+      for (size_t i = update_start_index; i < update_end_index; ++i) {
+        if (!*get<alive>(m_particles_begin + i)) {
+          const size_t slot = find_id_map_slot(*get<id>(m_particles_begin + i));
+          if (m_id_map_key[slot] != detail::id_map_table::empty_key()) {
+            if (m_id_map_value[slot] != i) {
+              return false;
+            }
+            erase_id_map_slot(slot);
+          } else if (i < previous_n) {
+            return false;
+          }
+        }
+      }
+    }
+
+    // move the entries of particles that change index, and add new particles
+    for (size_t i = 0; i < m_alive_indices.size(); ++i) {
+      const size_t old_index = m_alive_indices[i];
+      const size_t new_index = update_start_index + i;
+      const size_t particle_id = *get<id>(m_particles_begin + old_index);
+      const size_t slot = find_id_map_slot(particle_id);
+      if (m_id_map_key[slot] == particle_id) {
+        if (m_id_map_value[slot] != old_index) {
+          return false;
+        }
+        if (new_index != old_index) {
+          m_id_map_value[slot] = new_index;
+        }
+      } else if (old_index >= previous_n) {
+        m_id_map_key[slot] = particle_id;
+        m_id_map_value[slot] = new_index;
+        ++m_id_map_size;
+      } else {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  ///
+  /// @brief creates the find-by-id hash table from scratch, with enough
+  /// slots for @p n particles
+  ///
+  /// @see update_id_map()
+  ///
+  void rebuild_id_map(const size_t n, const size_t update_start_index,
+                      const size_t update_end_index) {
+    size_t capacity = 16;
+    while (capacity < 2 * n) {
+      capacity *= 2;
+    }
+    m_id_map_key.resize(capacity);
+    m_id_map_value.resize(capacity);
+    detail::fill(m_id_map_key.begin(), m_id_map_key.end(),
+                 detail::id_map_table::empty_key());
+    m_id_map_size = 0;
+
+    auto insert = [&](const size_t old_index, const size_t new_index) {
+      const size_t particle_id = *get<id>(m_particles_begin + old_index);
+      const size_t slot = find_id_map_slot(particle_id);
+      m_id_map_key[slot] = particle_id;
+      m_id_map_value[slot] = new_index;
+      ++m_id_map_size;
+    };
+
+    // before and after the update range
+    for (size_t i = 0; i < update_start_index; ++i) {
+      insert(i, i);
+    }
+    const size_t n_after =
+        m_particles_end - m_particles_begin - update_end_index;
+    for (size_t i = 0; i < n_after; ++i) {
+      insert(update_end_index + i,
+             update_start_index + m_alive_indices.size() + i);
+    }
+
+    // update range
+    for (size_t i = 0; i < m_alive_indices.size(); ++i) {
+      insert(m_alive_indices[i], update_start_index + i);
+    }
+  }
+
+  ///
+  /// @brief creates the find-by-id map as a pair of key and value vectors
+  /// sorted by id, using only parallel algorithms
+  ///
+  /// @see update_id_map()
+  ///
+  void sort_id_map(const size_t n, const size_t update_start_index,
+                   const size_t update_end_index) {
+    const size_t update_n = m_alive_indices.size();
+    m_id_map_key.resize(n);
+    m_id_map_value.resize(n);
+
+    // before update range
+    detail::sequence(m_id_map_value.begin(),
+                     m_id_map_value.begin() + update_start_index);
+    detail::copy(get<id>(m_particles_begin),
+                 get<id>(m_particles_begin) + update_start_index,
+                 m_id_map_key.begin());
+
+    // update range
+    detail::sequence(m_id_map_value.begin() + update_start_index,
+                     m_id_map_value.begin() + update_start_index + update_n,
+                     update_start_index);
+    auto raw_id = iterator_to_raw_pointer(get<id>(m_particles_begin));
+    detail::transform(
+        m_alive_indices.begin(), m_alive_indices.end(),
+        m_id_map_key.begin() + update_start_index,
+        [=] CUDA_HOST_DEVICE(const int index) { return raw_id[index]; });
+
+    // after update range
+    detail::sequence(m_id_map_value.begin() + update_start_index + update_n,
+                     m_id_map_value.end(), update_start_index + update_n);
+    detail::copy(get<id>(m_particles_begin) + update_end_index,
+                 get<id>(m_particles_end),
+                 m_id_map_key.begin() + update_start_index + update_n);
+
+    detail::sort_by_key(m_id_map_key.begin(), m_id_map_key.end(),
+                        m_id_map_value.begin());
+    m_id_map_size = n;
+  }
+
   ///
   /// @brief a copy of the `begin` iterator for the particle set
   ///
@@ -577,22 +1009,66 @@ protected:
   vector_int m_alive_indices;
 
   ///
-  /// @brief The `key` vector of the id->index map for the find-by-id
-  /// functionality
+  /// @brief The `key` vector of the id->index hash table for the find-by-id
+  /// functionality. Empty slots hold detail::id_map_table::empty_key()
   ///
   vector_size_t m_id_map_key;
 
   ///
-  /// @brief The `value` vector of the id->index map for the find-by-id
+  /// @brief The `value` vector of the id->index hash table for the find-by-id
   /// functionality
   ///
   vector_size_t m_id_map_value;
 
+  ///
+  /// @brief the number of occupied slots in the id->index hash table
+  ///
+  size_t m_id_map_size;
+
   ///
   /// @brief flag set to `true` if find-by-id functionality is turned on
   ///
   bool m_id_map;
 
+  ///
+  /// @brief flag set to `true` if the structure-of-arrays positions are
+  /// turned on
+  ///
+  bool m_position_soa;
+
+  ///
+  /// @brief each coordinate of the particle positions, stored in its own
+  /// vector
+  /// @see init_position_soa()
+  ///
+  std::array<vector_double, dimension> m_position_soa_data;
+
+  ///
+  /// @brief the width of the ghost particle halo, or 0 if it is turned off
+  /// @see init_ghost_halo()
+  ///
+  double m_halo_width;
+
+  ///
+  /// @brief the number of ghosts of the particles before each particle
+  ///
+  vector_int m_ghost_offsets;
+
+  ///
+  /// @brief the positions of the ghost particles, sorted by cell
+  ///
+  vector_double_d m_ghost_positions;
+
+  ///
+  /// @brief the index of the particle that each ghost is a copy of
+  ///
+  vector_int m_ghost_indices;
+
+  ///
+  /// @brief the index of the first ghost in each cell of the halo grid
+  ///
+  vector_int m_ghost_cell_begin;
+
   ///
   /// @brief @Vector of bools indicating the periodicity of the domain
   ///
@@ -870,6 +1346,13 @@ template <typename Traits> struct NeighbourQueryBase {
   ///
   size_t number_of_particles() const;
 
+  ///
+  /// @brief return the number of particles in the given @p bucket. For tree
+  /// data structures this is the number of particles in the entire subtree
+  /// under @p bucket
+  ///
+  size_t number_of_particles(const reference bucket) const;
+
   ///
   /// @brief get a pointer to the beginning of the particle container
   ///
@@ -112,6 +112,7 @@ class HyperOctree : public neighbour_search_base<HyperOctree<Traits>, Traits,
       vector_unsigned_int_iterator;
   typedef typename Traits::vector_unsigned_int vector_unsigned_int;
   typedef typename Traits::vector_int vector_int;
+  typedef typename Traits::vector_size_t vector_size_t;
   typedef typename Traits::unsigned_int_d unsigned_int_d;
   typedef typename Traits::template vector_type<vint2>::type vector_int2;
   static const unsigned int dimension = Traits::dimension;
@@ -128,7 +129,8 @@ class HyperOctree : public neighbour_search_base<HyperOctree<Traits>, Traits,
   friend base_type;
 
 public:
-  HyperOctree() : base_type(), m_max_level(32 / dimension - 2) {
+  HyperOctree()
+      : base_type(), m_max_level(detail::get_max_tag_level(dimension)) {
 
     // need to init a tree with 1 level (for 0 particles) in case
     // someone does a query on an empty data structure
@@ -318,7 +320,7 @@ private:
   int m_max_level;
   unsigned m_number_of_levels;
 
-  vector_int m_tags;
+  vector_size_t m_tags;
   vector_int m_nodes;
   vector_int2 m_leaves;
 
@@ -328,7 +330,7 @@ private:
 template <typename Traits> void HyperOctree<Traits>::build_tree() {
   m_nodes.clear();
   m_leaves.clear();
-  vector_int active_nodes(1, 0);
+  vector_size_t active_nodes(1, 0);
 
   LOG(4, "octree: building tree with max_level = " << m_max_level);
 
@@ -343,7 +345,7 @@ template <typename Traits> void HyperOctree<Traits>::build_tree() {
      ******************************************/
 
     // New children: 2^D quadrants per active node
-    vector_int children(nchild * active_nodes.size());
+    vector_size_t children(nchild * active_nodes.size());
 
     // For each active node, generate the tag mask for each of its 2^D children
     detail::tabulate(
@@ -362,9 +364,11 @@ template <typename Traits> void HyperOctree<Traits>::build_tree() {
     detail::lower_bound(m_tags.begin(), m_tags.end(), children.begin(),
                         children.end(), lower_bounds.begin());
 
-    int length = (1 << (m_max_level - level) * dimension) - 1;
+    const size_t length = (size_t(1) << (m_max_level - level) * dimension) - 1;
 
-    auto plus_length = [=] CUDA_HOST_DEVICE(const int i) { return i + length; };
+    auto plus_length = [=] CUDA_HOST_DEVICE(const size_t i) {
+      return i + length;
+    };
     detail::upper_bound(
         m_tags.begin(), m_tags.end(),
         Traits::make_transform_iterator(children.begin(), plus_length),
@@ -483,7 +487,7 @@ template <typename traits> struct HyperOctree<traits>::classify_point {
   classify_point(const bbox<dimension> &b, int lvl) : box(b), max_level(lvl) {}
 
   // Classify a point
-  inline CUDA_HOST_DEVICE int operator()(const double_d &p) {
+  inline CUDA_HOST_DEVICE size_t operator()(const double_d &p) {
     return detail::point_to_tag(p, box, max_level);
   }
 };
@@ -494,14 +498,14 @@ template <typename traits> struct HyperOctree<traits>::child_index_to_tag_mask {
   // mask for lower n bits, where n is the number of dimensions
   const static unsigned mask = nchild - 1;
 
-  typedef typename vector_int::const_pointer ptr_type;
+  typedef typename vector_size_t::const_pointer ptr_type;
   ptr_type m_nodes;
 
   child_index_to_tag_mask(int lvl, int max_lvl, ptr_type nodes)
       : level(lvl), max_level(max_lvl), m_nodes(nodes) {}
 
-  inline CUDA_HOST_DEVICE int operator()(int idx) const {
-    int tag = m_nodes[idx / nchild];
+  inline CUDA_HOST_DEVICE size_t operator()(int idx) const {
+    size_t tag = m_nodes[idx / nchild];
     int which_child = (idx & mask);
     return detail::child_tag_mask(tag, which_child, level, max_level,
                                   dimension);
@@ -698,7 +702,8 @@ private:
 ///
 template <typename Traits> struct HyperOctreeQuery {
   const static unsigned int dimension = Traits::dimension;
-  const static unsigned int m_max_tree_depth = 32 / dimension - 2;
+  const static unsigned int m_max_tree_depth =
+      detail::get_max_tag_level(dimension);
 
   typedef Traits traits_type;
   typedef typename Traits::raw_pointer raw_pointer;
@@ -722,14 +727,15 @@ template <typename Traits> struct HyperOctreeQuery {
   box_type m_bounds;
   raw_pointer m_particles_begin;
   raw_pointer m_particles_end;
+  detail::position_soa<dimension> m_position_soa;
+  detail::ghost_halo<dimension> m_ghosts;
   size_t m_number_of_nodes;
   unsigned m_number_of_levels;
 
   vint2 *m_leaves_begin;
   int *m_nodes_begin;
 
-  size_t *m_id_map_key;
-  size_t *m_id_map_value;
+  detail::id_map_table m_id_map;
 
   /*
    * functions for id mapping
@@ -738,13 +744,7 @@ template <typename Traits> struct HyperOctreeQuery {
   CUDA_HOST_DEVICE
   raw_pointer find(const size_t id) const {
     const size_t n = number_of_particles();
-    size_t *last = m_id_map_key + n;
-    size_t *first = detail::lower_bound(m_id_map_key, last, id);
-    if ((first != last) && !(id < *first)) {
-      return m_particles_begin + m_id_map_value[first - m_id_map_key];
-    } else {
-      return m_particles_begin + n;
-    }
+    return m_particles_begin + m_id_map.find(id, n);
   }
 
   ABORIA_HOST_DEVICE_IGNORE_WARN
@@ -831,6 +831,39 @@ template <typename Traits> struct HyperOctreeQuery {
                              m_particles_begin + particle_idxs[1]);
   }
 
+  ///
+  /// @copydoc NeighbourQueryBase::number_of_particles(const reference) const
+  ///
+  /// The particles are sorted by their morton tag, so the particles in a
+  /// subtree are contiguous and this only needs to find the first and last
+  /// non-empty leaf of the subtree
+  ///
+  ABORIA_HOST_DEVICE_IGNORE_WARN
+  CUDA_HOST_DEVICE
+  size_t number_of_particles(reference bucket) const {
+    if (detail::is_empty(bucket)) {
+      return 0;
+    }
+    int first = bucket;
+    int last = bucket;
+    while (!detail::is_leaf(first)) {
+      const int *child = m_nodes_begin + first;
+      while (detail::is_empty(*child)) {
+        ++child;
+      }
+      first = *child;
+    }
+    while (!detail::is_leaf(last)) {
+      const int *child = m_nodes_begin + last + (1 << dimension) - 1;
+      while (detail::is_empty(*child)) {
+        --child;
+      }
+      last = *child;
+    }
+    return m_leaves_begin[detail::get_leaf_offset(last)][1] -
+           m_leaves_begin[detail::get_leaf_offset(first)][0];
+  }
+
   ABORIA_HOST_DEVICE_IGNORE_WARN
   CUDA_HOST_DEVICE
   child_iterator get_bucket(const double_d &position) const {
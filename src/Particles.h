@@ -36,6 +36,8 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef PARTICLES_H_
 #define PARTICLES_H_
 
+#include <chrono>
+#include <limits>
 #include <random>
 #include <string>
 #include <vector>
@@ -64,6 +66,7 @@ class Particles;
 
 #include "CellList.h"
 #include "Get.h"
+#include "Search.h"
 #include "Traits.h"
 #include "Variable.h"
 #include "Vector.h"
@@ -121,6 +124,10 @@ public:
   /// Contains Level 0 vector class and dimension information
   typedef TraitsCommon<VAR, DomainD, 1, TRAITS_USER> traits_type;
 
+  ///
+  /// The user-supplied traits class, specialised on VECTOR
+  typedef TRAITS_USER traits_user_type;
+
   ///
   /// a tuple type containing value_types for each Variable
   typedef typename traits_type::value_type value_type;
@@ -211,12 +218,21 @@ public:
   typedef typename traits_type::position position;
 
   /// Contructs an empty container with no searching or id tracking enabled
-  Particles() : next_id(0), searchable(false), seed(time(NULL)) {}
+  Particles()
+      : next_id(0), searchable(false), in_place_reorder(false),
+        sfc_curve(space_filling_curve::morton), sfc_n_updates(0),
+        sfc_max_disorder(1.0), sfc_update_count(0), autotune_radius(0),
+        autotune_n_queries(100), autotune_threshold(0.5), autotune_n(0),
+        autotune_mean_neighbours(0), seed(time(NULL)) {}
 
   /// Constructs a container with `size` particles. Searching or id tracking
   /// is disabled
   Particles(const size_t size)
-      : next_id(0), searchable(false), seed(time(NULL)) {
+      : next_id(0), searchable(false), in_place_reorder(false),
+        sfc_curve(space_filling_curve::morton), sfc_n_updates(0),
+        sfc_max_disorder(1.0), sfc_update_count(0), autotune_radius(0),
+        autotune_n_queries(100), autotune_threshold(0.5), autotune_n(0),
+        autotune_mean_neighbours(0), seed(time(NULL)) {
     resize(size);
   }
 
@@ -224,12 +240,25 @@ public:
   /// to \a *this
   Particles(const particles_type &other)
       : data(other.data), next_id(other.next_id), searchable(other.searchable),
+        in_place_reorder(other.in_place_reorder), sfc_curve(other.sfc_curve),
+        sfc_n_updates(other.sfc_n_updates),
+        sfc_max_disorder(other.sfc_max_disorder),
+        sfc_update_count(other.sfc_update_count),
+        autotune_radius(other.autotune_radius),
+        autotune_n_queries(other.autotune_n_queries),
+        autotune_threshold(other.autotune_threshold),
+        autotune_n(other.autotune_n),
+        autotune_mean_neighbours(other.autotune_mean_neighbours),
         seed(other.seed), search(other.search) {}
 
   /// range-based copy-constructor. performs deep copying of all
   /// particles from \p first to \p last
   Particles(iterator first, iterator last)
-      : data(traits_type::construct(first, last)), searchable(false), seed(0) {}
+      : data(traits_type::construct(first, last)), searchable(false),
+        in_place_reorder(false), sfc_curve(space_filling_curve::morton),
+        sfc_n_updates(0), sfc_max_disorder(1.0), sfc_update_count(0),
+        autotune_radius(0), autotune_n_queries(100), autotune_threshold(0.5),
+        autotune_n(0), autotune_mean_neighbours(0), seed(0) {}
 
   //
   // STL Container
@@ -442,13 +471,28 @@ public:
   /// \param n_particles_in_leaf By default the neighbourhood data structure
   /// will have either an average (cell-list) or a maximum of this number of
   /// particles within each bucket. Set this argument to change this number
+  /// \param halo_width If greater than zero (and the domain is periodic),
+  /// ghost copies of the particles within this distance of each periodic
+  /// boundary are stored with the neighbourhood data structure, and updated
+  /// by update_positions(). Searches with a radius up to \p halo_width then
+  /// find the periodic images of the particles from the ghosts, rather than
+  /// searching the data structure once for every periodic image of the
+  /// domain. This should be set to the maximum search radius, and must not
+  /// be greater than the width of the domain along any periodic dimension
+  ///
+  /// \see set_leaf_size_autotune() to choose \p n_particles_in_leaf
+  /// automatically
   void init_neighbour_search(const double_d &low, const double_d &high,
                              const bool_d &periodic,
-                             const double n_particles_in_leaf = 10.0) {
+                             const double n_particles_in_leaf = 10.0,
+                             const double halo_width = 0.0) {
     LOG(2, "Particles:init_neighbour_search: low = "
                << low << " high = " << high << " periodic = " << periodic
-               << " n_particles_in_leaf = " << n_particles_in_leaf);
+               << " n_particles_in_leaf = " << n_particles_in_leaf
+               << " halo_width = " << halo_width);
     search.set_domain(low, high, periodic, n_particles_in_leaf);
+    search.init_ghost_halo(halo_width);
+    autotune_n = 0;
     update_positions(begin(), end());
 
     searchable = true;
@@ -509,10 +553,249 @@ public:
   /// \see init_neighbour_search()
   const bool_d &get_periodic() const { return search.get_periodic(); }
 
+  /// return the width of the halo of ghost particles, or 0 if there is none
+  /// \see init_neighbour_search()
+  double get_halo_width() const { return search.get_halo_width(); }
+
   /// A neighbourhood search data structure can be ordered (i.e. the
   /// order of the particles in the container is important) or not.
   bool is_ordered() const { return search.ordered(); }
 
+  /// Set how the particles are reordered by update_positions(), either when
+  /// particles are deleted or when an ordered neighbourhood search data
+  /// structure is used.
+  ///
+  /// By default (\p in_place == false) the particles are gathered into a
+  /// secondary buffer that holds a complete copy of every variable, and then
+  /// the two buffers are swapped. Setting \p in_place to true instead
+  /// reorders each variable in turn, so that the extra memory needed is
+  /// only that of the largest single variable. This is slightly slower, but
+  /// roughly halves the peak memory use of the container.
+  void set_in_place_reorder(const bool in_place) {
+    in_place_reorder = in_place;
+    if (in_place_reorder) {
+      // release the secondary buffer, it is no longer needed
+      data_type empty;
+      other_data.swap(empty);
+    }
+  }
+
+  /// returns true if the particles are reordered in-place
+  /// \see set_in_place_reorder()
+  bool get_in_place_reorder() const { return in_place_reorder; }
+
+  /// Set whether a copy of the particle positions is kept as a
+  /// structure-of-arrays, i.e. with each coordinate stored in its own
+  /// contiguous array.
+  ///
+  /// The copy is updated by update_positions(), and is accessible from the
+  /// query object (see detail::position_soa). This allows distance
+  /// calculations over contiguous ranges of particles (e.g. the contents of
+  /// a bucket in CellListOrdered, Kdtree or HyperOctree) to be vectorised,
+  /// at the cost of storing the positions twice. Note that the copy is
+  /// only valid after update_positions() has been called.
+  void set_position_soa(const bool enable) {
+    search.init_position_soa(enable);
+    if (enable) {
+      search.update_iterators(begin(), end());
+    }
+  }
+
+  /// returns true if a structure-of-arrays copy of the positions is kept
+  /// \see set_position_soa()
+  bool get_position_soa() const { return search.get_position_soa(); }
+
+  /// Set whether the neighbour search tree is refitted, rather than rebuilt,
+  /// by update_positions() when no particles have been added or removed.
+  /// A full rebuild is still triggered if the number of particles in any leaf
+  /// grows beyond \p max_imbalance times the number of particles per leaf.
+  /// This is only supported by the Kdtree data structure
+  /// \see Kdtree::set_refit()
+  void set_refit(const bool enable, const double max_imbalance = 2.0) {
+    search.set_refit(enable, max_imbalance);
+  }
+
+  /// Set whether the neighbour search tree is built by splitting each node at
+  /// its median particle, with the subtrees built in parallel, rather than by
+  /// the default builder. This takes effect at the next init_neighbour_search()
+  /// or update_positions(), and is only supported by the Kdtree data
+  /// structure with std::vector storage
+  /// \see Kdtree::set_build_by_selection()
+  void set_build_by_selection(const bool enable) {
+    search.set_build_by_selection(enable);
+  }
+
+  /// Cache the stencil of buckets that are within \p radius of each bucket,
+  /// so that euclidean searches with a radius up to \p radius do not need to
+  /// calculate the distance to each candidate bucket. This is only supported
+  /// by the CellList data structure
+  /// \see CellList::set_stencil_radius()
+  void set_stencil_radius(const double radius) {
+    search.set_stencil_radius(radius);
+  }
+
+  /// Reorder the particles in memory so that they follow a space filling
+  /// \p curve through the search domain, and then update the neighbourhood
+  /// search data structure.
+  ///
+  /// Particles that are close in space will then also be close in memory,
+  /// which improves the cache performance of neighbourhood searches using an
+  /// unordered data structure (e.g. CellList). Ordered data structures
+  /// (e.g. CellListOrdered) already determine the order of the particles, so
+  /// for these this function does nothing
+  ///
+  /// \see set_space_filling_curve_policy()
+  void sort_by_space_filling_curve(
+      const space_filling_curve curve = space_filling_curve::morton) {
+    ASSERT(search.domain_has_been_set(),
+           "init_neighbour_search not called on this particle set");
+    sfc_update_count = 0;
+    if (search.ordered()) {
+      LOG(2, "Particles: search is ordered, not sorting along curve");
+      return;
+    }
+    LOG(2, "Particles: sorting particles along space filling curve");
+    const size_t n = size();
+    vector_size_t keys(n);
+    calculate_space_filling_curve_keys(keys, curve);
+    vector_int order(n);
+    detail::sequence(order.begin(), order.end());
+    detail::sort_by_key(keys.begin(), keys.end(), order.begin());
+    reorder(begin(), end(), order.cbegin(), order.cend());
+
+    // all the particles have moved, so rebuild search and id map
+    if (search.get_id_map()) {
+      search.init_id_map();
+    }
+    update_search(begin(), end());
+  }
+
+  /// Returns the fraction of neighbouring particles in memory that are out of
+  /// order along the space filling \p curve, from 0 (sorted) to 1 (reverse
+  /// sorted). Randomly ordered particles have a disorder of about 0.5
+  ///
+  /// \see sort_by_space_filling_curve()
+  double space_filling_curve_disorder(
+      const space_filling_curve curve = space_filling_curve::morton) const {
+    ASSERT(search.domain_has_been_set(),
+           "init_neighbour_search not called on this particle set");
+    const size_t n = size();
+    if (n < 2) {
+      return 0.0;
+    }
+    vector_size_t keys(n);
+    calculate_space_filling_curve_keys(keys, curve);
+    vector_int is_descending(n - 1);
+    detail::transform(traits_type::make_counting_iterator(0),
+                      traits_type::make_counting_iterator(int(n - 1)),
+                      is_descending.begin(),
+                      detail::is_descending<size_t>(
+                          iterator_to_raw_pointer(keys.begin())));
+    const int n_descending = detail::reduce(
+        is_descending.begin(), is_descending.end(), 0, std::plus<int>());
+    return static_cast<double>(n_descending) / (n - 1);
+  }
+
+  /// Set a policy for automatically sorting the particles along the space
+  /// filling \p curve (using sort_by_space_filling_curve()) within
+  /// update_positions(). The particles are sorted after every \p n_updates
+  /// calls to update_positions(), or whenever the disorder
+  /// (see space_filling_curve_disorder()) of the particles exceeds \p
+  /// max_disorder. Only updates of the entire particle set are counted.
+  ///
+  /// \param curve the space filling curve to sort along
+  /// \param n_updates sort every this number of updates. Set to 0 to disable
+  /// \param max_disorder sort if the disorder exceeds this value. Set to 1 or
+  /// greater to disable. Note that checking the disorder requires the curve
+  /// keys of every particle, so has a cost of O(N) per update
+  void set_space_filling_curve_policy(const space_filling_curve curve,
+                                      const size_t n_updates,
+                                      const double max_disorder = 1.0) {
+    sfc_curve = curve;
+    sfc_n_updates = n_updates;
+    sfc_max_disorder = max_disorder;
+    sfc_update_count = 0;
+  }
+
+  /// Set a policy for automatically choosing the number of particles in each
+  /// bucket of the neighbourhood search data structure (i.e. the \p
+  /// n_particles_in_leaf argument of init_neighbour_search()). The best value
+  /// depends on the search radius, the density of the particles, the
+  /// dimension and the data structure, so instead the search data structure
+  /// is rebuilt with each of a few candidate values, and the value that
+  /// gives the fastest euclidean searches of radius \p radius around a
+  /// sample of \p n_queries particles is kept (see tune_leaf_size()).
+  ///
+  /// The tuning is done by the next update_positions() of the entire
+  /// particle set (or init_neighbour_search()), and repeated whenever the
+  /// number of particles, or the mean number of neighbours found by the
+  /// sample searches, has changed by more than a fraction \p threshold since
+  /// the last tuning. Note that checking the number of neighbours costs \p
+  /// n_queries searches per update
+  ///
+  /// \param radius the typical search radius. Set to 0 to disable
+  /// \param n_queries the number of searches used to time each candidate
+  /// \param threshold the relative change that triggers a re-tune
+  void set_leaf_size_autotune(const double radius,
+                              const size_t n_queries = 100,
+                              const double threshold = 0.5) {
+    autotune_radius = radius;
+    autotune_n_queries = n_queries;
+    autotune_threshold = threshold;
+    autotune_n = 0;
+  }
+
+  /// Rebuild the neighbourhood search data structure with each candidate
+  /// number of particles per bucket (2, 4, 8, 16 and 32), time a sample of
+  /// euclidean searches for each, and keep the fastest. The searches are
+  /// centred on evenly spaced particles in the set, and use the radius and
+  /// number of searches given to set_leaf_size_autotune()
+  ///
+  /// \return the chosen number of particles per bucket
+  /// \see set_leaf_size_autotune()
+  double tune_leaf_size() {
+    ASSERT(search.domain_has_been_set(),
+           "init_neighbour_search not called on this particle set");
+    ASSERT(autotune_radius > 0, "set_leaf_size_autotune not called");
+    const double candidates[] = {2, 4, 8, 16, 32};
+
+    // copy the sample points, as the particles might be reordered
+    const std::vector<double_d> points = leaf_size_autotune_points();
+    double best_leaf_size = get_max_bucket_size();
+    double best_time = std::numeric_limits<double>::max();
+    size_t n_neighbours = 0;
+    for (const double leaf_size : candidates) {
+      search.set_domain(get_min(), get_max(), get_periodic(), leaf_size);
+      update_search(begin(), end());
+
+      // best of a few runs, to reduce the noise from the first run
+      double search_time = std::numeric_limits<double>::max();
+      for (int run = 0; run < 3; ++run) {
+        const auto start = std::chrono::high_resolution_clock::now();
+        n_neighbours = count_leaf_size_autotune_neighbours(points);
+        const auto stop = std::chrono::high_resolution_clock::now();
+        search_time = std::min(
+            search_time, std::chrono::duration<double>(stop - start).count());
+      }
+      LOG(2, "Particles: tune_leaf_size: n_particles_in_leaf = "
+                 << leaf_size << " time = " << search_time);
+      if (search_time < best_time) {
+        best_time = search_time;
+        best_leaf_size = leaf_size;
+      }
+    }
+
+    search.set_domain(get_min(), get_max(), get_periodic(), best_leaf_size);
+    update_search(begin(), end());
+    autotune_n = size();
+    autotune_mean_neighbours =
+        static_cast<double>(n_neighbours) / points.size();
+    LOG(2, "Particles: tune_leaf_size: chose n_particles_in_leaf = "
+               << best_leaf_size << " for " << autotune_n << " particles with "
+               << autotune_mean_neighbours << " neighbours");
+    return best_leaf_size;
+  }
+
   /// Update the neighbourhood search data for particles between
   /// \p update_begin and \p update_end (not including \p update_end).
   ///
@@ -523,10 +806,32 @@ public:
   /// the range have `alive==false`, then the \p update_end iterator must
   /// be the same as that returned by end()
   ///
+  /// If a space filling curve policy has been set, the particles might also
+  /// be sorted along the curve \see set_space_filling_curve_policy()
+  ///
+  /// If leaf size autotuning is enabled, the number of particles in each
+  /// bucket might also be re-tuned \see set_leaf_size_autotune()
+  ///
   void update_positions(iterator update_begin, iterator update_end) {
-    if (search.update_positions(begin(), end(), update_begin, update_end)) {
-      reorder(update_begin, update_end, search.get_alive_indicies().begin(),
-              search.get_alive_indicies().end());
+    const bool update_all = update_begin == begin() && update_end == end();
+    const bool sfc_policy = sfc_n_updates > 0 || sfc_max_disorder < 1.0;
+    bool sorted = false;
+    if (sfc_policy && searchable && search.domain_has_been_set() &&
+        !search.ordered() && update_all) {
+      ++sfc_update_count;
+      if ((sfc_n_updates > 0 && sfc_update_count >= sfc_n_updates) ||
+          (sfc_max_disorder < 1.0 &&
+           space_filling_curve_disorder(sfc_curve) > sfc_max_disorder)) {
+        sort_by_space_filling_curve(sfc_curve);
+        sorted = true;
+      }
+    }
+    if (!sorted) {
+      update_search(update_begin, update_end);
+    }
+    if (search.domain_has_been_set() && update_all &&
+        leaf_size_autotune_needed()) {
+      tune_leaf_size();
     }
   }
 
@@ -683,6 +988,78 @@ public:
 private:
   typedef typename traits_type::vector_unsigned_int vector_unsigned_int;
   typedef typename traits_type::vector_int vector_int;
+  typedef typename traits_type::vector_size_t vector_size_t;
+
+  /// Used by update_positions(). Updates the neighbourhood search data
+  /// structure for particles between \p update_begin and \p update_end,
+  /// reordering the particles if required
+  void update_search(iterator update_begin, iterator update_end) {
+    if (search.update_positions(begin(), end(), update_begin, update_end)) {
+      reorder(update_begin, update_end, search.get_alive_indicies().begin(),
+              search.get_alive_indicies().end());
+    }
+  }
+
+  /// Used by tune_leaf_size(). Returns the positions of evenly spaced
+  /// particles in the container, to centre the sample searches on
+  std::vector<double_d> leaf_size_autotune_points() const {
+    const size_t n = size();
+    const size_t n_points = std::min(n, autotune_n_queries);
+    std::vector<double_d> points(n_points);
+    for (size_t i = 0; i < n_points; ++i) {
+      points[i] = Aboria::get<position>(data)[(i * n) / n_points];
+    }
+    return points;
+  }
+
+  /// Used by tune_leaf_size(). Returns the total number of particles within
+  /// the autotune radius of each of \p points
+  size_t count_leaf_size_autotune_neighbours(
+      const std::vector<double_d> &points) const {
+    size_t count = 0;
+    for (const double_d &point : points) {
+      for (auto i = euclidean_search(search.get_query(), point,
+                                     autotune_radius);
+           i != false; ++i) {
+        ++count;
+      }
+    }
+    return count;
+  }
+
+  /// Used by update_positions(). Returns true if the leaf size autotuning is
+  /// enabled, and either the leaf size has not been tuned, or the number of
+  /// particles or neighbours has changed significantly since it was
+  /// \see set_leaf_size_autotune()
+  bool leaf_size_autotune_needed() const {
+    if (autotune_radius <= 0 || size() == 0) {
+      return false;
+    }
+    if (autotune_n == 0) {
+      return true;
+    }
+    const double n = size();
+    if (std::abs(n - autotune_n) > autotune_threshold * autotune_n) {
+      return true;
+    }
+    const std::vector<double_d> points = leaf_size_autotune_points();
+    const double mean_neighbours =
+        static_cast<double>(count_leaf_size_autotune_neighbours(points)) /
+        points.size();
+    return std::abs(mean_neighbours - autotune_mean_neighbours) >
+           autotune_threshold * std::max(autotune_mean_neighbours, 1.0);
+  }
+
+  /// Used by sort_by_space_filling_curve(). Calculates the position of each
+  /// particle along the space filling \p curve and writes it to \p keys
+  void calculate_space_filling_curve_keys(
+      vector_size_t &keys, const space_filling_curve curve) const {
+    detail::transform(
+        get<position>(cbegin()), get<position>(cend()), keys.begin(),
+        detail::space_filling_curve_key<dimension>(
+            bbox<dimension>(get_min(), get_max()),
+            curve == space_filling_curve::hilbert));
+  }
 
   /// Used by update_particles(). The parameters \p update_begin and \p
   /// update_end are the same as given to update_particles(). This function
@@ -698,7 +1075,11 @@ private:
     const size_t n_alive = order_end - order_start;
     const size_t old_n = size();
     const size_t new_n = old_n - (n_update - n_alive);
-    if (n_alive > old_n / 2) {
+    if (in_place_reorder) {
+      reorder_in_place(update_begin - begin(), order_start, order_end, new_n,
+                       detail::make_index_sequence<traits_type::N>());
+      search.update_iterators(begin(), end());
+    } else if (n_alive > old_n / 2) {
       traits_type::resize(other_data, new_n);
       // copy non-update region to other data buffer
       detail::copy(begin(), update_begin, traits_type::begin(other_data));
@@ -728,6 +1109,33 @@ private:
     }
   }
 
+  /// Used by reorder() if in_place_reorder is true. Each variable is
+  /// gathered in turn into a temporary vector holding only the update
+  /// region, which is then copied back.
+  template <std::size_t... I>
+  void reorder_in_place(const size_t update_start,
+                        const typename vector_int::const_iterator &order_start,
+                        const typename vector_int::const_iterator &order_end,
+                        const size_t new_n, detail::index_sequence<I...>) {
+    int dummy[] = {0, (reorder_vector_in_place(get_by_index<I>(data),
+                                               update_start, order_start,
+                                               order_end, new_n),
+                       0)...};
+    static_cast<void>(dummy);
+  }
+
+  template <typename VectorType>
+  static void reorder_vector_in_place(
+      VectorType &vector, const size_t update_start,
+      const typename vector_int::const_iterator &order_start,
+      const typename vector_int::const_iterator &order_end,
+      const size_t new_n) {
+    VectorType buffer(order_end - order_start);
+    detail::gather(order_start, order_end, vector.begin(), buffer.begin());
+    vector.resize(new_n);
+    detail::copy(buffer.begin(), buffer.end(), vector.begin() + update_start);
+  }
+
   template <class InputIterator>
   iterator insert_dispatch(iterator position, InputIterator first,
                            InputIterator last, std::false_type) {
@@ -759,6 +1167,39 @@ private:
   /// Has neighbour searching been enabled? \see init_neighbour_search()
   bool searchable;
 
+  /// Reorder particles one variable at a time? \see set_in_place_reorder()
+  bool in_place_reorder;
+
+  /// The curve used by the automatic space filling curve sort
+  /// \see set_space_filling_curve_policy()
+  space_filling_curve sfc_curve;
+
+  /// Sort along the curve every sfc_n_updates updates (0 to disable)
+  size_t sfc_n_updates;
+
+  /// Sort along the curve if the disorder exceeds this fraction
+  double sfc_max_disorder;
+
+  /// The number of updates since the last space filling curve sort
+  size_t sfc_update_count;
+
+  /// The search radius used to tune the leaf size (0 to disable)
+  /// \see set_leaf_size_autotune()
+  double autotune_radius;
+
+  /// The number of searches used to tune the leaf size
+  size_t autotune_n_queries;
+
+  /// Re-tune the leaf size if the number of particles or neighbours changes
+  /// by more than this fraction
+  double autotune_threshold;
+
+  /// The number of particles at the last leaf size tuning (0 if not tuned)
+  size_t autotune_n;
+
+  /// The mean number of neighbours found at the last leaf size tuning
+  double autotune_mean_neighbours;
+
   /// The base random seed for the container
   uint32_t seed;
 
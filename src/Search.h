@@ -51,9 +51,12 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "detail/Distance.h"
 
 #include "Log.h"
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 #include <queue>
+#include <utility>
+#include <vector>
 
 namespace Aboria {
 
@@ -76,6 +79,14 @@ template <typename Query, int LNormNumber> class search_iterator {
   typedef typename particle_iterator::reference p_reference;
   typedef typename particle_iterator::pointer p_pointer;
   typedef lattice_iterator<dimension> periodic_iterator_type;
+  typedef typename std::is_same<particle_iterator,
+                                ranges_iterator<Traits>>::type is_contiguous;
+
+  ///
+  /// @brief the number of candidate particles checked at once using the
+  /// structure-of-arrays positions
+  ///
+  static const size_t chunk_size = 64;
 
   ///
   /// @brief true if the iterator has run out of particles within the search
@@ -109,6 +120,13 @@ template <typename Query, int LNormNumber> class search_iterator {
   ///
   double m_max_distance2;
 
+  ///
+  /// @brief true if the periodic images are found using the ghost particles
+  /// of the query object (see detail::ghost_halo), rather than by searching
+  /// each periodic image of the domain
+  ///
+  bool m_search_ghosts;
+
   ///
   /// @brief iterator for searching periodic domains, iterates over the periodic
   /// lattice
@@ -131,6 +149,41 @@ template <typename Query, int LNormNumber> class search_iterator {
   ///
   particle_iterator m_current_particle;
 
+  ///
+  /// @brief true once all the candidate buckets have been searched, and the
+  /// iterator is searching the ghost particles
+  ///
+  bool m_in_ghosts;
+
+  ///
+  /// @brief the current candidate cell of ghost particles
+  ///
+  lattice_iterator<dimension> m_current_ghost_cell;
+
+  ///
+  /// @brief the current candidate ghost particle
+  ///
+  int m_current_ghost;
+
+  ///
+  /// @brief one past the last ghost particle in the current cell
+  ///
+  int m_ghosts_end;
+
+  ///
+  /// @brief the range of particle indices [m_chunk_first, m_chunk_last) in
+  /// the current bucket that have already been checked using the
+  /// structure-of-arrays positions (see check_candidate(std::true_type))
+  ///
+  size_t m_chunk_first;
+  size_t m_chunk_last;
+
+  ///
+  /// @brief bit `i` is set if particle `m_chunk_first + i` is within the
+  /// search distance
+  ///
+  uint64_t m_chunk_within;
+
 public:
   typedef p_pointer pointer;
   typedef std::forward_iterator_tag iterator_category;
@@ -159,7 +212,9 @@ public:
   ///
   ABORIA_HOST_DEVICE_IGNORE_WARN
   CUDA_HOST_DEVICE
-  search_iterator() : m_valid(false) {}
+  search_iterator()
+      : m_valid(false), m_in_ghosts(false), m_chunk_first(0), m_chunk_last(0) {
+  }
 
   ///
   /// @brief should generally use this constructor to make a search iterator.
@@ -178,12 +233,16 @@ public:
         m_max_distance2(
             detail::distance_helper<LNormNumber>::get_value_to_accumulate(
                 max_distance)),
-        m_current_periodic(get_periodic_range(m_query->get_periodic())),
+        m_search_ghosts(query.m_ghosts.covers(max_distance)),
+        m_current_periodic(get_periodic_range(
+            m_search_ghosts ? bool_d::Constant(false)
+                            : m_query->get_periodic())),
         m_current_point(
             r + (*m_current_periodic) *
                     (m_query->get_bounds().bmax - m_query->get_bounds().bmin)),
         m_current_bucket(query.template get_buckets_near_point<LNormNumber>(
-            m_current_point, max_distance)) {
+            m_current_point, max_distance)),
+        m_in_ghosts(false), m_chunk_first(0), m_chunk_last(0) {
 
 #if defined(__CUDA_ARCH__)
     CHECK_CUDA((!std::is_same<typename Traits::template vector<double>,
@@ -195,13 +254,14 @@ public:
     LOG(3, "\tconstructor (search_iterator with query pt = "
                << m_r << ", and m_current_point = " << m_current_point << ")");
 #endif
-    if ((m_valid = get_valid_bucket())) {
+    if (get_valid_bucket()) {
       m_current_particle = m_query->get_bucket_particles(*m_current_bucket);
-      if ((m_valid = get_valid_candidate())) {
-        if (!check_candidate()) {
-          increment();
-        }
-      }
+      m_valid = get_valid_candidate();
+    } else {
+      m_valid = go_to_ghosts();
+    }
+    if (m_valid && !check_candidate()) {
+      increment();
     }
 #if defined(__CUDA_ARCH__)
     if (m_valid) {
@@ -213,7 +273,7 @@ public:
     if (m_valid) {
       LOG_BOLD(3, "\tconstructor (search_iterator with query pt = "
                       << m_r << "): found good canditate at "
-                      << get<position>(*m_current_particle));
+                      << get<position>(dereference()));
     } else {
       LOG(3, "\tconstructor (search_iterator with query pt = "
                  << m_r << "): didn't find good candidate");
@@ -330,8 +390,14 @@ private:
   ABORIA_HOST_DEVICE_IGNORE_WARN
   CUDA_HOST_DEVICE
   bool equal(search_iterator const &other) const {
-    return m_valid ? m_current_particle == other.m_current_particle
-                   : !other.m_valid;
+    if (!m_valid) {
+      return !other.m_valid;
+    } else if (m_in_ghosts) {
+      return other.m_in_ghosts && m_current_ghost == other.m_current_ghost;
+    } else {
+      return !other.m_in_ghosts &&
+             m_current_particle == other.m_current_particle;
+    }
   }
 
   ///
@@ -383,6 +449,48 @@ private:
     return true;
   }
 
+  ///
+  /// @brief to be called once all the candidate buckets have been searched.
+  /// If the ghost particles are being used for the periodic images then
+  /// start searching the cells of ghosts near the search point, otherwise
+  /// the iterator becomes invalid
+  ///
+  ABORIA_HOST_DEVICE_IGNORE_WARN
+  CUDA_HOST_DEVICE
+  bool go_to_ghosts() {
+    if (!m_search_ghosts) {
+      return false;
+    }
+#ifndef __CUDA_ARCH__
+    LOG(4, "\tgo_to_ghosts (search_iterator):");
+#endif
+    m_in_ghosts = true;
+    int_d min, max;
+    m_query->m_ghosts.get_cells_near_point(m_r, m_max_distance, min, max);
+    m_current_ghost_cell = lattice_iterator<dimension>(min, max);
+    m_current_ghost = m_query->m_ghosts.cell_begin(*m_current_ghost_cell);
+    m_ghosts_end = m_query->m_ghosts.cell_end(*m_current_ghost_cell);
+    return get_valid_ghost();
+  }
+
+  ///
+  /// @brief to be called after incrementing m_current_ghost. If
+  /// m_current_ghost is at the end of its cell, then move to the next cell
+  ///
+  ABORIA_HOST_DEVICE_IGNORE_WARN
+  CUDA_HOST_DEVICE
+  bool get_valid_ghost() {
+    while (m_current_ghost == m_ghosts_end) {
+      ++m_current_ghost_cell;
+      if (m_current_ghost_cell == false) {
+        return false;
+      }
+      m_current_ghost = m_query->m_ghosts.cell_begin(*m_current_ghost_cell);
+      m_ghosts_end = m_query->m_ghosts.cell_end(*m_current_ghost_cell);
+    }
+    return true;
+  }
+
   ///
   /// @brief to be called after incrementing m_current_particle. If
   /// m_current_particle is invalid, then move to the next bucket
@@ -399,9 +507,10 @@ private:
 #endif
       ++m_current_bucket;
       if (!get_valid_bucket()) {
-        return false;
+        return go_to_ghosts();
       }
       m_current_particle = m_query->get_bucket_particles(*m_current_bucket);
+      m_chunk_last = 0;
     }
     return true;
   }
@@ -415,22 +524,88 @@ private:
 #ifndef __CUDA_ARCH__
     LOG(4, "\tgo_to_next_candidate (search_iterator):");
 #endif
+    if (m_in_ghosts) {
+      ++m_current_ghost;
+      return get_valid_ghost();
+    }
     ++m_current_particle;
     return get_valid_candidate();
   }
 
   ///
-  /// @brief checks that the current particle in m_current_particle is within
-  /// the search distance
+  /// @brief checks that the current particle in m_current_particle (or the
+  /// current ghost particle) is within the search distance
   ///
   ABORIA_HOST_DEVICE_IGNORE_WARN
   CUDA_HOST_DEVICE
   bool check_candidate() {
+    if (m_in_ghosts) {
+      return check_candidate(m_query->m_ghosts.m_positions[m_current_ghost]);
+    }
+    return check_candidate(is_contiguous());
+  }
+
+  ///
+  /// @brief checks the current particle in m_current_particle, for data
+  /// structures that don't store the particles in each bucket contiguously
+  ///
+  ABORIA_HOST_DEVICE_IGNORE_WARN
+  CUDA_HOST_DEVICE
+  bool check_candidate(std::false_type) {
+    return check_candidate(get<position>(*m_current_particle));
+  }
+
+  ///
+  /// @brief checks the current particle in m_current_particle, for data
+  /// structures that store the particles in each bucket contiguously
+  ///
+  /// If the structure-of-arrays positions are enabled, the next
+  /// #chunk_size particles in the bucket are checked together using
+  /// detail::position_soa::within(), which the compiler can vectorise, and
+  /// the result is kept for the following candidates
+  ///
+  ABORIA_HOST_DEVICE_IGNORE_WARN
+  CUDA_HOST_DEVICE
+  bool check_candidate(std::true_type) {
+    const auto &soa = m_query->m_position_soa;
+    if (!soa.is_valid()) {
+      return check_candidate(std::false_type());
+    }
+    const typename Query::raw_pointer particles_begin =
+        m_query->get_particles_begin();
+    const size_t i = m_current_particle -
+                     particle_iterator(particles_begin, particles_begin);
+    if (i < m_chunk_first || i >= m_chunk_last) {
+      const size_t n = m_current_particle.distance_to_end();
+      const size_t max_n = chunk_size;
+      m_chunk_first = i;
+      m_chunk_last = i + (n < max_n ? n : max_n);
+      int within[chunk_size];
+      soa.template within<LNormNumber>(m_chunk_first, m_chunk_last,
+                                       m_current_point, m_max_distance2,
+                                       within);
+      m_chunk_within = 0;
+      for (size_t j = 0; j < m_chunk_last - m_chunk_first; ++j) {
+        m_chunk_within |= static_cast<uint64_t>(within[j]) << j;
+      }
+    }
+    if (((m_chunk_within >> (i - m_chunk_first)) & 1) == 0) {
+      return false;
+    }
+    for (size_t d = 0; d < dimension; ++d) {
+      m_dx[d] = soa[d][i] - m_current_point[d];
+    }
+    return true;
+  }
+
+  ///
+  /// @brief checks that the candidate position @p p is within the search
+  /// distance
+  ///
+  ABORIA_HOST_DEVICE_IGNORE_WARN
+  CUDA_HOST_DEVICE
+  bool check_candidate(const double_d &p) {
     LOG_CUDA(4, "\tcheck_candidate:");
-    // const double_d& p = get<position>(*m_current_particle) +
-    // m_particle_range.get_transpose();
-    const double_d &p = get<position>(*m_current_particle);
-    // const double_d& transpose = m_particle_range.get_transpose();
     double accum = 0;
     bool outside = false;
     for (size_t i = 0; i < Traits::dimension; i++) {
@@ -450,14 +625,13 @@ private:
         }
         printf(") other r = (");
         for (int i = 0; i < Traits::dimension; ++i) {
-            printf("%d,",get<position>(*m_current_particle)[i]);
+            printf("%d,",p[i]);
         }
         printf("). outside = %d",outside);
     } 
 #else
     LOG(3, "\tcheck_candidate: m_r = " << m_current_point << " other r = "
-                                       << get<position>(*m_current_particle)
-                                       << ". outside = " << outside);
+                                       << p << ". outside = " << outside);
 #endif
     return !outside;
   }
@@ -490,7 +664,13 @@ private:
   ///
   ABORIA_HOST_DEVICE_IGNORE_WARN
   CUDA_HOST_DEVICE
-  reference dereference() const { return *m_current_particle; }
+  reference dereference() const {
+    if (m_in_ghosts) {
+      return *(m_query->get_particles_begin() +
+               m_query->m_ghosts.m_indices[m_current_ghost]);
+    }
+    return *m_current_particle;
+  }
 };
 
 template <typename Query> class bucket_pair_iterator {
@@ -837,6 +1017,818 @@ euclidean_search(const Query &query, const typename Query::double_d &centre,
   return SearchIterator(query, centre, max_distance);
 }
 
+namespace detail {
+
+///
+/// @brief true if @p Query is the query object of a tree data structure
+/// (i.e. it can be searched using a @ref tree_query_iterator)
+///
+template <typename Query, typename Enable = void>
+struct is_tree_query : std::false_type {};
+
+template <typename Query>
+struct is_tree_query<
+    Query, typename std::enable_if<(Query::m_max_tree_depth > 0)>::type>
+    : std::true_type {};
+
+///
+/// @brief returns the squared euclidean distance from @p point to the
+/// furthest corner of @p box
+///
+template <unsigned int D>
+CUDA_HOST_DEVICE double max_distance2(const bbox<D> &box,
+                                      const Vector<double, D> &point) {
+  double accum = 0;
+  for (size_t i = 0; i < D; ++i) {
+    const double dmin = std::abs(point[i] - box.bmin[i]);
+    const double dmax = std::abs(box.bmax[i] - point[i]);
+    const double dist = dmin > dmax ? dmin : dmax;
+    accum += dist * dist;
+  }
+  return accum;
+}
+
+///
+/// @brief returns the squared euclidean distance from @p point to the
+/// closest point of @p box
+///
+template <unsigned int D>
+CUDA_HOST_DEVICE double min_distance2(const bbox<D> &box,
+                                      const Vector<double, D> &point) {
+  double accum = 0;
+  for (size_t i = 0; i < D; ++i) {
+    double dist = 0;
+    if (point[i] < box.bmin[i]) {
+      dist = box.bmin[i] - point[i];
+    } else if (point[i] > box.bmax[i]) {
+      dist = point[i] - box.bmax[i];
+    }
+    accum += dist * dist;
+  }
+  return accum;
+}
+
+///
+/// @brief counts the particles in @p bucket that are within @p radius of @p
+/// point
+///
+template <typename Query, typename Bucket>
+CUDA_HOST_DEVICE size_t count_within_bucket(const Query &query,
+                                            const Bucket &bucket,
+                                            const typename Query::double_d
+                                                &point,
+                                            const double radius2,
+                                            std::false_type) {
+  typedef typename Query::traits_type::position position;
+  size_t count = 0;
+  for (auto i = query.get_bucket_particles(bucket); i != false; ++i) {
+    if ((get<position>(*i) - point).squaredNorm() <= radius2) {
+      ++count;
+    }
+  }
+  return count;
+}
+
+///
+/// @brief count_within_bucket() for data structures that store the particles
+/// in each bucket contiguously. If the structure-of-arrays positions are
+/// enabled, the particles are counted using
+/// detail::position_soa::count_within(), which the compiler can vectorise
+///
+template <typename Query, typename Bucket>
+CUDA_HOST_DEVICE size_t count_within_bucket(const Query &query,
+                                            const Bucket &bucket,
+                                            const typename Query::double_d
+                                                &point,
+                                            const double radius2,
+                                            std::true_type) {
+  typedef typename Query::particle_iterator particle_iterator;
+  typedef typename Query::raw_pointer raw_pointer;
+  const auto &soa = query.m_position_soa;
+  if (!soa.is_valid()) {
+    return count_within_bucket(query, bucket, point, radius2,
+                               std::false_type());
+  }
+  const raw_pointer particles_begin = query.get_particles_begin();
+  const size_t first =
+      query.get_bucket_particles(bucket) -
+      particle_iterator(particles_begin, particles_begin);
+  const size_t last = first + query.number_of_particles(bucket);
+  return soa.template count_within<2>(first, last, point, radius2);
+}
+
+///
+/// @brief count_within() for cell list data structures. Buckets that lie
+/// fully within the search radius are counted in constant time
+///
+template <typename Query>
+CUDA_HOST_DEVICE size_t count_within_impl(const Query &query,
+                                          const typename Query::double_d &point,
+                                          const double radius,
+                                          std::false_type) {
+  typedef typename std::is_same<
+      typename Query::particle_iterator,
+      ranges_iterator<typename Query::traits_type>>::type is_contiguous;
+  const double radius2 = radius * radius;
+  size_t count = 0;
+  for (auto bucket = query.template get_buckets_near_point<2>(point, radius);
+       bucket != false; ++bucket) {
+    if (max_distance2(query.get_bucket_bbox(*bucket), point) <= radius2) {
+      count += query.number_of_particles(*bucket);
+    } else {
+      count += count_within_bucket(query, *bucket, point, radius2,
+                                   is_contiguous());
+    }
+  }
+  return count;
+}
+
+///
+/// @brief count_within() for tree data structures. The tree is searched
+/// depth-first, and subtrees that lie fully within the search radius are
+/// counted without descending any further
+///
+template <typename Query>
+CUDA_HOST_DEVICE size_t count_within_impl(const Query &query,
+                                          const typename Query::double_d &point,
+                                          const double radius,
+                                          std::true_type) {
+  typedef typename Query::child_iterator child_iterator;
+  typedef typename std::is_same<
+      typename Query::particle_iterator,
+      ranges_iterator<typename Query::traits_type>>::type is_contiguous;
+  const double radius2 = radius * radius;
+  size_t count = 0;
+  static_vector<child_iterator, Query::m_max_tree_depth> stack;
+  stack.push_back(query.get_children());
+  while (!stack.empty()) {
+    child_iterator &ci = stack.back();
+    if (ci == false) {
+      stack.pop_back();
+      if (!stack.empty()) {
+        ++stack.back();
+      }
+      continue;
+    }
+    const auto bounds = query.get_bounds(ci);
+    if (min_distance2(bounds, point) > radius2) {
+      ++ci;
+    } else if (max_distance2(bounds, point) <= radius2) {
+      count += query.number_of_particles(*ci);
+      ++ci;
+    } else if (query.is_leaf_node(*ci)) {
+      count += count_within_bucket(query, *ci, point, radius2,
+                                   is_contiguous());
+      ++ci;
+    } else {
+      stack.push_back(query.get_children(ci));
+    }
+  }
+  return count;
+}
+
+} // namespace detail
+
+///
+/// @brief returns the number of particles within a given euclidean distance
+/// of a point
+///
+/// This gives the same result as counting the particles returned by
+/// euclidean_search(), but does not need to visit every particle. Buckets (for
+/// cell lists) or tree nodes (for trees) that lie entirely within @p
+/// max_distance of @p centre are counted in constant time, and only the
+/// particles in buckets that straddle the boundary of the search sphere are
+/// checked individually. For periodic domains each periodic image of a
+/// particle that is within @p max_distance is counted.
+///
+/// @tparam Query the query object type
+/// @param query the query object
+/// @param centre the central point of the search
+/// @param max_distance the maximum distance to search around @p centre
+/// @return the number of particles found
+///
+template <typename Query>
+CUDA_HOST_DEVICE size_t count_within(const Query &query,
+                                     const typename Query::double_d &centre,
+                                     const double max_distance) {
+  typedef typename Query::double_d double_d;
+  typedef typename Query::traits_type::bool_d bool_d;
+  if (query.number_of_particles() == 0) {
+    return 0;
+  }
+  const double_d width = query.get_bounds().bmax - query.get_bounds().bmin;
+  const bool search_ghosts = query.m_ghosts.covers(max_distance);
+  size_t count = 0;
+  for (auto periodic_it = search_iterator<Query, 2>::get_periodic_range(
+           search_ghosts ? bool_d::Constant(false) : query.get_periodic());
+       periodic_it != false; ++periodic_it) {
+    count += detail::count_within_impl(
+        query, centre + (*periodic_it) * width, max_distance,
+        typename detail::is_tree_query<Query>::type());
+  }
+  if (search_ghosts) {
+    count += query.m_ghosts.count_within(centre, max_distance);
+  }
+  return count;
+}
+
+namespace detail {
+
+///
+/// @brief calls @p f for each particle in @p bucket that is within a
+/// euclidean distance of @p point, following the particle iterator of the
+/// bucket
+///
+/// @param radius2 the search distance squared
+///
+template <typename Query, typename Function>
+CUDA_HOST_DEVICE void for_each_neighbour_in_bucket(
+    const Query &query, const typename Query::reference bucket,
+    const typename Query::double_d &point, const double radius2, Function &f,
+    std::false_type) {
+  typedef typename Query::traits_type::position position;
+  typedef typename Query::double_d double_d;
+  for (auto i = query.get_bucket_particles(bucket); i != false; ++i) {
+    const double_d dx = get<position>(*i) - point;
+    if (dx.squaredNorm() <= radius2) {
+      f(*i, dx);
+    }
+  }
+}
+
+///
+/// @brief for_each_neighbour_in_bucket() for data structures that store the
+/// particles in each bucket contiguously.
+///
+/// If the structure-of-arrays positions are enabled, the distances are
+/// calculated in chunks using detail::position_soa::within(), which the
+/// compiler can vectorise, before calling @p f for the particles found
+///
+template <typename Query, typename Function>
+CUDA_HOST_DEVICE void for_each_neighbour_in_bucket(
+    const Query &query, const typename Query::reference bucket,
+    const typename Query::double_d &point, const double radius2, Function &f,
+    std::true_type) {
+  typedef typename Query::particle_iterator particle_iterator;
+  typedef typename Query::raw_pointer raw_pointer;
+  const auto &soa = query.m_position_soa;
+  if (!soa.is_valid()) {
+    for_each_neighbour_in_bucket(query, bucket, point, radius2, f,
+                                 std::false_type());
+    return;
+  }
+
+  const raw_pointer particles_begin = query.get_particles_begin();
+  const size_t first =
+      query.get_bucket_particles(bucket) -
+      particle_iterator(particles_begin, particles_begin);
+  const size_t last = first + query.number_of_particles(bucket);
+
+  const size_t chunk_size = 64;
+  int within[chunk_size];
+  for (size_t chunk_first = first; chunk_first < last;
+       chunk_first += chunk_size) {
+    const size_t chunk_last =
+        chunk_first + chunk_size < last ? chunk_first + chunk_size : last;
+    soa.template within<2>(chunk_first, chunk_last, point, radius2, within);
+    for (size_t i = chunk_first; i < chunk_last; ++i) {
+      if (within[i - chunk_first]) {
+        f(*(particles_begin + i), soa.get(i) - point);
+      }
+    }
+  }
+}
+
+} // namespace detail
+
+///
+/// @brief calls a function for every particle within a given euclidean
+/// distance of a point
+///
+/// This visits the same particles as euclidean_search(), but instead of
+/// advancing a @ref search_iterator (which must store and check the state of
+/// each of its nested loops on every increment), it runs a tight nested loop
+/// over the candidate buckets and the particles in each bucket, so the
+/// compiler can inline @p f into the innermost loop. For data structures that
+/// store the particles of each bucket contiguously, and have the
+/// structure-of-arrays positions enabled (see Particles::set_position_soa()),
+/// the distance calculations are also vectorised.
+///
+/// @tparam Query the query object type
+/// @tparam Function function object type
+/// @param query the query object
+/// @param centre the central point of the search
+/// @param max_distance the maximum distance to search around @p centre
+/// @param f the function to call for each particle found. It is called as
+/// `f(particle, dx)`, where `particle` is a reference to the particle and
+/// `dx` is the shortest difference between the particle's position and @p
+/// centre (the same as search_iterator::dx())
+///
+template <typename Query, typename Function>
+CUDA_HOST_DEVICE void for_each_neighbour(const Query &query,
+                                         const typename Query::double_d &centre,
+                                         const double max_distance,
+                                         Function f) {
+  typedef typename Query::double_d double_d;
+  typedef typename Query::traits_type::bool_d bool_d;
+  typedef typename std::is_same<
+      typename Query::particle_iterator,
+      ranges_iterator<typename Query::traits_type>>::type is_contiguous;
+  if (query.number_of_particles() == 0) {
+    return;
+  }
+  const double max_distance2 = max_distance * max_distance;
+  const double_d width = query.get_bounds().bmax - query.get_bounds().bmin;
+  const bool search_ghosts = query.m_ghosts.covers(max_distance);
+  for (auto periodic_it = search_iterator<Query, 2>::get_periodic_range(
+           search_ghosts ? bool_d::Constant(false) : query.get_periodic());
+       periodic_it != false; ++periodic_it) {
+    const double_d point = centre + (*periodic_it) * width;
+    for (auto bucket =
+             query.template get_buckets_near_point<2>(point, max_distance);
+         bucket != false; ++bucket) {
+      detail::for_each_neighbour_in_bucket(query, *bucket, point,
+                                           max_distance2, f, is_contiguous());
+    }
+  }
+  if (search_ghosts) {
+    query.m_ghosts.template for_each_within<2>(query.get_particles_begin(),
+                                               centre, max_distance, f);
+  }
+}
+
+namespace detail {
+
+///
+/// @brief the search radius for point `i` of a batch_search(), for a
+/// constant radius
+///
+template <typename Radius, bool = std::is_arithmetic<Radius>::value>
+struct batch_search_radius {
+  double m_radius;
+  batch_search_radius(const Radius radius) : m_radius(radius) {}
+  CUDA_HOST_DEVICE
+  double operator()(const size_t i) const { return m_radius; }
+};
+
+///
+/// @brief the search radius for point `i` of a batch_search(), for a
+/// function object that takes the index of the point
+///
+template <typename Radius> struct batch_search_radius<Radius, false> {
+  Radius m_radius;
+  batch_search_radius(const Radius &radius) : m_radius(radius) {}
+  CUDA_HOST_DEVICE
+  double operator()(const size_t i) const { return m_radius(i); }
+};
+
+///
+/// @brief the function passed to for_each_neighbour() by batch_search(),
+/// which forwards each particle found to the sink along with the original
+/// index of the query point
+///
+template <typename Sink> struct batch_search_neighbour {
+  const Sink &m_sink;
+  size_t m_index;
+
+  template <typename Reference, typename DoubleD>
+  CUDA_HOST_DEVICE void operator()(Reference particle,
+                                   const DoubleD &dx) const {
+    m_sink(m_index, particle, dx);
+  }
+};
+
+} // namespace detail
+
+///
+/// @brief calls a function for every particle within a given euclidean
+/// distance of each of a batch of points
+///
+/// This gives the same results as calling for_each_neighbour() for each point
+/// in turn, but first sorts the points along a Morton curve through the
+/// domain of @p query. The sorted points are then split into tiles of
+/// consecutive points, which are close together and therefore search mostly
+/// the same buckets, and each tile is searched in turn (in parallel if
+/// OpenMP is enabled), so the buckets and particles found for one point are
+/// still in cache for the next. This is useful when the points are not
+/// ordered spatially, for example the positions of a different particle set,
+/// or of a set using an unordered @ref CellList
+///
+/// @tparam Query the query object type
+/// @tparam PointIterator a random access iterator to the points
+/// @tparam Radius either a floating point type, or a function object type
+/// @tparam Sink function object type
+/// @param query the query object
+/// @param points_begin iterator to the first point to search around
+/// @param points_end iterator to one past the last point to search around
+/// @param radius either the maximum distance to search around every point,
+/// or a function object called as `radius(i)` that returns the maximum
+/// distance to search around point `i`
+/// @param sink the function to call for each particle found. It is called as
+/// `sink(i, particle, dx)`, where `i` is the index of the point in the range
+/// [@p points_begin, @p points_end), and `particle` and `dx` are as in
+/// for_each_neighbour(). All the calls for a given `i` are made by the same
+/// thread, but calls for different points may be made concurrently, so @p
+/// sink must be safe to call as a const function object from several
+/// threads as long as each writes only to the results for its own `i`
+///
+template <typename Query, typename PointIterator, typename Radius,
+          typename Sink>
+void batch_search(const Query &query, PointIterator points_begin,
+                  PointIterator points_end, const Radius &radius, Sink sink) {
+  typedef typename Query::traits_type traits_type;
+  typedef typename traits_type::vector_int vector_int;
+  typedef typename traits_type::vector_size_t vector_size_t;
+  const unsigned int dimension = Query::dimension;
+
+  const int n = points_end - points_begin;
+  if (n == 0) {
+    return;
+  }
+
+  // order the points along a space filling curve
+  vector_size_t keys(n);
+  vector_int order(n);
+  detail::transform(
+      points_begin, points_end, keys.begin(),
+      detail::space_filling_curve_key<dimension>(query.get_bounds(), false));
+  detail::sequence(order.begin(), order.end());
+  detail::sort_by_key(keys.begin(), keys.end(), order.begin());
+
+  const int tile_size = 32;
+  const int n_tiles = (n + tile_size - 1) / tile_size;
+  const int *const raw_order = iterator_to_raw_pointer(order.begin());
+  const detail::batch_search_radius<Radius> radius_i(radius);
+  detail::for_each(traits_type::make_counting_iterator(0),
+                   traits_type::make_counting_iterator(n_tiles),
+                   [=] CUDA_HOST_DEVICE(const int tile) {
+                     const int last = (tile + 1) * tile_size < n
+                                          ? (tile + 1) * tile_size
+                                          : n;
+                     for (int k = tile * tile_size; k < last; ++k) {
+                       const size_t i = raw_order[k];
+                       for_each_neighbour(
+                           query, points_begin[i], radius_i(i),
+                           detail::batch_search_neighbour<Sink>{sink, i});
+                     }
+                   });
+}
+
+namespace detail {
+
+///
+/// @brief moves element @p i of a binary max-heap of (squared distance,
+/// index) pairs down the heap until the heap property is restored
+///
+CUDA_HOST_DEVICE
+inline void knn_heap_sift_down(double *distances, int *indices, int i,
+                               const int n) {
+  while (true) {
+    const int left = 2 * i + 1;
+    const int right = left + 1;
+    int largest = i;
+    if (left < n && distances[left] > distances[largest]) {
+      largest = left;
+    }
+    if (right < n && distances[right] > distances[largest]) {
+      largest = right;
+    }
+    if (largest == i) {
+      return;
+    }
+    const double tmp_distance = distances[i];
+    distances[i] = distances[largest];
+    distances[largest] = tmp_distance;
+    const int tmp_index = indices[i];
+    indices[i] = indices[largest];
+    indices[largest] = tmp_index;
+    i = largest;
+  }
+}
+
+///
+/// @brief moves element @p i of a binary max-heap of (squared distance,
+/// index) pairs up the heap until the heap property is restored
+///
+CUDA_HOST_DEVICE
+inline void knn_heap_sift_up(double *distances, int *indices, int i) {
+  while (i > 0) {
+    const int parent = (i - 1) / 2;
+    if (distances[parent] >= distances[i]) {
+      return;
+    }
+    const double tmp_distance = distances[i];
+    distances[i] = distances[parent];
+    distances[parent] = tmp_distance;
+    const int tmp_index = indices[i];
+    indices[i] = indices[parent];
+    indices[parent] = tmp_index;
+    i = parent;
+  }
+}
+
+} // namespace detail
+
+///
+/// @brief finds the @p k nearest particles to a point
+///
+/// The particles are found by searching all the buckets within a search
+/// radius of @p centre, keeping the @p k closest candidates in a bounded
+/// max-heap. Once the heap is full, any candidate further away than the
+/// current @p k-th closest particle is discarded without being inserted. The
+/// initial search radius is estimated from the average particle density, and
+/// if fewer than @p k particles are found within it then the radius is
+/// doubled and the search repeated. Periodic domains are handled by
+/// searching around each periodic image of @p centre, and the distances
+/// returned are the shortest distances between @p centre and each particle.
+///
+/// This function works with the query object of any of the spatial data
+/// structures, and can be called from device code
+///
+/// @tparam Query the query object type
+/// @param query the query object
+/// @param centre the point to search around
+/// @param k the number of neighbours to find
+/// @param indices an array of length @p k. On return, holds the indices of
+/// the particles found (into the particle container), sorted in order of
+/// increasing distance from @p centre
+/// @param distances an array of length @p k. On return, holds the euclidean
+/// distances of the particles found from @p centre
+/// @return the number of particles found, which is @p k unless there are
+/// fewer than @p k particles in the container
+///
+template <typename Query>
+CUDA_HOST_DEVICE int knn_search(const Query &query,
+                                const typename Query::double_d &centre,
+                                const int k, int *indices,
+                                double *distances) {
+  typedef typename Query::traits_type Traits;
+  typedef typename Traits::position position;
+  typedef typename Query::double_d double_d;
+  typedef typename Query::bool_d bool_d;
+  const unsigned int dimension = Query::dimension;
+
+  const int n = query.number_of_particles();
+  if (k <= 0 || n == 0) {
+    return 0;
+  }
+  const int max_k = k < n ? k : n;
+
+  const bool_d &periodic = query.get_periodic();
+  const double_d &bmin = query.get_bounds().bmin;
+  const double_d &bmax = query.get_bounds().bmax;
+  const double_d width = bmax - bmin;
+
+  // the search radius that is guarenteed to include every particle
+  double_d extent;
+  double volume = 1;
+  for (size_t i = 0; i < dimension; ++i) {
+    double outside = 0;
+    if (centre[i] < bmin[i]) {
+      outside = bmin[i] - centre[i];
+    } else if (centre[i] > bmax[i]) {
+      outside = centre[i] - bmax[i];
+    }
+    extent[i] = periodic[i] ? 0.5 * width[i] : width[i] + outside;
+    volume *= width[i];
+  }
+  const double max_radius = 1.01 * extent.norm();
+
+  // start with the half-width of a hypercube that would contain k particles
+  // at the average particle density
+  double radius = 0.5 * std::pow(max_k * volume / n, 1.0 / dimension);
+  if (!(radius < max_radius)) {
+    radius = max_radius;
+  }
+
+  const double_d *positions_begin = get<position>(query.get_particles_begin());
+  int count = 0;
+  while (true) {
+    const double radius2 = radius * radius;
+
+    // if the radius is larger than half a periodic domain, the same particle
+    // can be found in more than one periodic image
+    bool may_duplicate = false;
+    for (size_t i = 0; i < dimension; ++i) {
+      if (periodic[i] && 2 * radius > width[i]) {
+        may_duplicate = true;
+      }
+    }
+
+    count = 0;
+    for (auto periodic_it =
+             search_iterator<Query, 2>::get_periodic_range(periodic);
+         periodic_it != false; ++periodic_it) {
+      const double_d point = centre + (*periodic_it) * width;
+      for (auto bucket =
+               query.template get_buckets_near_point<2>(point, radius);
+           bucket != false; ++bucket) {
+        for (auto particle = query.get_bucket_particles(*bucket);
+             particle != false; ++particle) {
+          const double_d &p = get<position>(*particle);
+          const double distance2 = (p - point).squaredNorm();
+          if (distance2 > radius2 ||
+              (count == max_k && distance2 >= distances[0])) {
+            continue;
+          }
+          const int index = &p - positions_begin;
+          if (may_duplicate) {
+            int found = -1;
+            for (int i = 0; i < count; ++i) {
+              if (indices[i] == index) {
+                found = i;
+                break;
+              }
+            }
+            if (found != -1) {
+              if (distance2 < distances[found]) {
+                distances[found] = distance2;
+                detail::knn_heap_sift_down(distances, indices, found, count);
+              }
+              continue;
+            }
+          }
+          if (count < max_k) {
+            distances[count] = distance2;
+            indices[count] = index;
+            detail::knn_heap_sift_up(distances, indices, count);
+            ++count;
+          } else {
+            distances[0] = distance2;
+            indices[0] = index;
+            detail::knn_heap_sift_down(distances, indices, 0, count);
+          }
+        }
+      }
+    }
+
+    // every particle within the radius has been considered, so if k have been
+    // found these are the k nearest
+    if (count == max_k || radius >= max_radius) {
+      break;
+    }
+    radius = 2 * radius < max_radius ? 2 * radius : max_radius;
+  }
+
+  // heap sort into order of increasing distance
+  for (int i = count - 1; i > 0; --i) {
+    const double tmp_distance = distances[0];
+    distances[0] = distances[i];
+    distances[i] = tmp_distance;
+    const int tmp_index = indices[0];
+    indices[0] = indices[i];
+    indices[i] = tmp_index;
+    detail::knn_heap_sift_down(distances, indices, 0, i);
+  }
+  for (int i = 0; i < count; ++i) {
+    distances[i] = std::sqrt(distances[i]);
+  }
+  return count;
+}
+
+///
+/// @brief finds the @p k nearest particles to a point. This is a host-only
+/// convenience wrapper around the array version of knn_search()
+///
+/// @return a vector of (index, distance) pairs for the particles found,
+/// sorted in order of increasing distance from @p centre
+///
+template <typename Query>
+std::vector<std::pair<int, double>>
+knn_search(const Query &query, const typename Query::double_d &centre,
+           const int k) {
+  std::vector<int> indices(k);
+  std::vector<double> distances(k);
+  const int count =
+      knn_search(query, centre, k, indices.data(), distances.data());
+  std::vector<std::pair<int, double>> result(count);
+  for (int i = 0; i < count; ++i) {
+    result[i] = std::make_pair(indices[i], distances[i]);
+  }
+  return result;
+}
+
+///
+/// @brief finds the @p k nearest neighbours of every particle in @p particles,
+/// and stores them as a graph in compressed sparse row (CSR) format
+///
+/// On return, the neighbours of particle `i` are given by `indices[j]` for
+/// `offsets[i] <= j < offsets[i+1]`, sorted in order of increasing distance,
+/// and `distances[j]` holds the corresponding distances. Unless @p
+/// include_self is true, each particle is excluded from its own list of
+/// neighbours.
+///
+/// The queries are run in parallel using knn_search(), and are ordered along
+/// a Morton curve through the domain so that consecutive queries search the
+/// same buckets. Results are written directly to the output vectors, so no
+/// memory is allocated per query
+///
+/// @param particles the particle set, which must have been initialised with
+/// Particles::init_neighbour_search()
+/// @param k the number of neighbours to find for each particle
+/// @param offsets output vector of size `particles.size()+1`. These are
+/// `size_t`, as the total number of neighbours can exceed the range of `int`
+/// @param indices output vector of neighbour indices
+/// @param distances output vector of neighbour distances
+/// @param include_self if true, each particle is included in its own list of
+/// neighbours
+///
+template <typename ParticlesType>
+void build_knn_graph(
+    const ParticlesType &particles, const int k,
+    typename ParticlesType::traits_type::vector_size_t &offsets,
+    typename ParticlesType::traits_type::vector_int &indices,
+    typename ParticlesType::traits_type::vector_double &distances,
+    const bool include_self = false) {
+  typedef typename ParticlesType::traits_type traits_type;
+  typedef typename ParticlesType::position position;
+  typedef typename ParticlesType::double_d double_d;
+  typedef typename ParticlesType::query_type query_type;
+  typedef typename traits_type::vector_int vector_int;
+  typedef typename traits_type::vector_double vector_double;
+  typedef typename traits_type::vector_size_t vector_size_t;
+  const unsigned int dimension = ParticlesType::dimension;
+
+  const int n = particles.size();
+  const int max_neighbours = include_self ? n : n - 1;
+  const int n_neighbours =
+      k < max_neighbours ? (k > 0 ? k : 0) : max_neighbours;
+  const int n_search = include_self ? n_neighbours : n_neighbours + 1;
+
+  LOG(2, "build_knn_graph: finding " << n_neighbours << " neighbours for "
+                                     << n << " particles");
+
+  // the products of a particle index and the number of neighbours are
+  // found in size_t, as they can exceed the range of int for large graphs
+  const size_t n_total = static_cast<size_t>(n) * n_neighbours;
+  offsets.resize(n + 1);
+  detail::tabulate(offsets.begin(), offsets.end(),
+                   [=] CUDA_HOST_DEVICE(const int i) {
+                     return static_cast<size_t>(i) * n_neighbours;
+                   });
+  indices.resize(n_total);
+  distances.resize(n_total);
+  if (n_neighbours == 0) {
+    return;
+  }
+
+  // order the queries along a space filling curve
+  vector_size_t keys(n);
+  vector_int order(n);
+  detail::transform(get<position>(particles).begin(),
+                    get<position>(particles).end(), keys.begin(),
+                    detail::space_filling_curve_key<dimension>(
+                        bbox<dimension>(particles.get_min(),
+                                        particles.get_max()),
+                        false));
+  detail::sequence(order.begin(), order.end());
+  detail::sort_by_key(keys.begin(), keys.end(), order.begin());
+
+  // if excluding self, search for one extra neighbour into a buffer
+  const size_t n_search_total = static_cast<size_t>(n) * n_search;
+  vector_int search_indices(include_self ? 0 : n_search_total);
+  vector_double search_distances(include_self ? 0 : n_search_total);
+  int *const raw_search_indices = iterator_to_raw_pointer(
+      include_self ? indices.begin() : search_indices.begin());
+  double *const raw_search_distances = iterator_to_raw_pointer(
+      include_self ? distances.begin() : search_distances.begin());
+
+  const query_type query = particles.get_query();
+  const double_d *const positions = get<position>(query.get_particles_begin());
+  detail::for_each(order.begin(), order.end(),
+                   [=] CUDA_HOST_DEVICE(const int i) {
+                     const size_t offset = static_cast<size_t>(i) * n_search;
+                     knn_search(query, positions[i], n_search,
+                                raw_search_indices + offset,
+                                raw_search_distances + offset);
+                   });
+
+  if (!include_self) {
+    int *const raw_indices = iterator_to_raw_pointer(indices.begin());
+    double *const raw_distances = iterator_to_raw_pointer(distances.begin());
+    detail::for_each(
+        traits_type::make_counting_iterator(0),
+        traits_type::make_counting_iterator(n),
+        [=] CUDA_HOST_DEVICE(const int i) {
+          const size_t search_offset = static_cast<size_t>(i) * n_search;
+          const size_t offset = static_cast<size_t>(i) * n_neighbours;
+          const int *search_i = raw_search_indices + search_offset;
+          const double *search_distances_i =
+              raw_search_distances + search_offset;
+          int *indices_i = raw_indices + offset;
+          double *distances_i = raw_distances + offset;
+          int count = 0;
+          for (int j = 0; j < n_search && count < n_neighbours; ++j) {
+            if (search_i[j] != i) {
+              indices_i[count] = search_i[j];
+              distances_i[count] = search_distances_i[j];
+              ++count;
+            }
+          }
+        });
+  }
+}
+
 ///
 /// @brief returns a @ref bucket_pair_iterator that iterates through all the
 /// neighbouring buckets (i.e. buckets that are touching) within a domain. Note
@@ -852,6 +1844,580 @@ CUDA_HOST_DEVICE Iterator get_neighbouring_buckets(const Query &query) {
   return Iterator(query);
 }
 
+template <typename Traits> struct HashedCellListQuery;
+
+namespace detail {
+
+///
+/// @brief calls @p f in parallel for each bucket in the lattice of buckets
+/// `first + k * step`, for `0 <= k < count` in each dimension
+///
+template <typename Query, typename Function>
+void for_each_bucket_of_colour(const Query &query,
+                               const typename Query::int_d &first,
+                               const typename Query::int_d &step,
+                               const typename Query::int_d &count,
+                               Function f) {
+  typedef typename Query::traits_type Traits;
+  typedef typename Query::int_d int_d;
+  const unsigned int dimension = Query::dimension;
+  detail::for_each(Traits::make_counting_iterator(0),
+                   Traits::make_counting_iterator(count.prod()),
+                   [=] CUDA_HOST_DEVICE(int index) {
+                     int_d bucket;
+                     for (int d = dimension - 1; d >= 0; --d) {
+                       bucket[d] = first[d] + (index % count[d]) * step[d];
+                       index /= count[d];
+                     }
+                     f(bucket);
+                   });
+}
+
+///
+/// @brief for_each_bucket_of_colour() for a HashedCellList, which only
+/// visits the occupied buckets, so its cost does not depend on the volume of
+/// the grid
+///
+template <typename Traits, typename Function>
+void for_each_bucket_of_colour(const HashedCellListQuery<Traits> &query,
+                               const typename Traits::int_d &first,
+                               const typename Traits::int_d &step,
+                               const typename Traits::int_d &count,
+                               Function f) {
+  typedef typename Traits::int_d int_d;
+  const unsigned int dimension = Traits::dimension;
+  const size_t *keys = query.m_cell_keys;
+  const auto point_to_cell_key = query.m_point_to_cell_key;
+  detail::for_each(
+      Traits::make_counting_iterator(0),
+      Traits::make_counting_iterator(
+          static_cast<int>(query.number_of_occupied_buckets())),
+      [=] CUDA_HOST_DEVICE(const int index) {
+        const int_d bucket =
+            point_to_cell_key.reassemble_index_vector(keys[index]);
+        for (size_t d = 0; d < dimension; ++d) {
+          const int offset = bucket[d] - first[d];
+          if (offset < 0 || offset % step[d] != 0 ||
+              offset / step[d] >= count[d]) {
+            return;
+          }
+        }
+        f(bucket);
+      });
+}
+
+} // namespace detail
+
+///
+/// @brief calls a function for each unordered pair of particles within a
+/// given distance of each other. Note that this will only work for cell list
+/// spatial data structures
+///
+/// Each pair of particles `i` and `j` with `|x_j - x_i| <= radius` is visited
+/// once, by calling `f(i, j, dx)`, where `i` and `j` are references to the two
+/// particles and `dx = x_j - x_i` is their separation, corrected for periodic
+/// boundaries. For periodic domains, each periodic image of a pair within
+/// @p radius is visited, so if @p radius is less than half the domain width
+/// each pair is visited exactly once. This halves the number of evaluations
+/// needed for symmetric interactions, as @p f can apply equal and opposite
+/// contributions to both particles.
+///
+/// Each bucket is paired with the neighbouring buckets in one half of its
+/// stencil. The buckets are coloured so that no two buckets of the same
+/// colour have overlapping stencils, and the buckets of each colour are
+/// processed in parallel, so @p f can safely write to both particles without
+/// any locking, provided it only writes to data belonging to `i` and `j`.
+/// For a @ref HashedCellListQuery only the occupied buckets are visited.
+///
+/// @tparam Query query object type (must be @ref CellListQuery, @ref
+/// CellListOrderedQuery or @ref HashedCellListQuery)
+/// @tparam Function function object type
+/// @param query the query object
+/// @param radius the maximum separation of each pair
+/// @param f the function to call for each pair
+///
+template <typename Query, typename Function>
+void for_each_pair_within(const Query &query, const double radius,
+                          Function f) {
+  typedef typename Query::traits_type Traits;
+  typedef typename Traits::position position;
+  typedef typename Query::double_d double_d;
+  typedef typename Query::bool_d bool_d;
+  typedef typename Query::int_d int_d;
+  const unsigned int dimension = Query::dimension;
+
+  const int_d n = query.get_end_bucket() + 1;
+  const bool_d periodic = query.get_periodic();
+  const double_d width = query.get_bounds().bmax - query.get_bounds().bmin;
+  const double radius2 = radius * radius;
+
+  // the stencil of buckets within radius of a bucket is [-w,w] in each
+  // dimension, the colours are spaced 2w+1 apart so that buckets of the same
+  // colour don't share any neighbours. For periodic dimensions the buckets
+  // left over after the last whole stride get a colour each
+  int_d w, stride, n_strided, n_colours;
+  for (size_t d = 0; d < dimension; ++d) {
+    w[d] = static_cast<int>(std::ceil(radius / query.m_bucket_side_length[d]));
+    stride[d] = 2 * w[d] + 1;
+    n_strided[d] = periodic[d] ? (n[d] / stride[d]) * stride[d] : n[d];
+    n_colours[d] = std::min(stride[d], n_strided[d]) + n[d] - n_strided[d];
+  }
+  const lattice_iterator<dimension> stencil(-w, w + 1);
+
+  LOG(2, "for_each_pair_within: radius = " << radius << " stencil = " << w
+                                           << " colours = " << n_colours);
+
+  for (auto colour = lattice_iterator<dimension>(int_d::Constant(0),
+                                                 n_colours);
+       colour != false; ++colour) {
+    int_d first, step, count;
+    for (size_t d = 0; d < dimension; ++d) {
+      const int c = (*colour)[d];
+      const int n_strided_colours = std::min(stride[d], n_strided[d]);
+      if (c < n_strided_colours) {
+        first[d] = c;
+        step[d] = stride[d];
+        count[d] = (n_strided[d] - c + stride[d] - 1) / stride[d];
+      } else {
+        first[d] = n_strided[d] + c - n_strided_colours;
+        step[d] = 1;
+        count[d] = 1;
+      }
+    }
+
+    detail::for_each_bucket_of_colour(
+        query, first, step, count, [=] CUDA_HOST_DEVICE(const int_d &bucket) {
+          // pairs within the bucket
+          for (auto i = query.get_bucket_particles(bucket); i != false; ++i) {
+            const double_d &xi = get<position>(*i);
+            auto j = i;
+            for (++j; j != false; ++j) {
+              const double_d dx = get<position>(*j) - xi;
+              if (dx.squaredNorm() <= radius2) {
+                f(*i, *j, dx);
+              }
+            }
+          }
+
+          // pairs with the buckets in the upper half of the stencil
+          for (auto offset = stencil; offset != false; ++offset) {
+            int leading = 0;
+            for (size_t d = 0; d < dimension && leading == 0; ++d) {
+              leading = (*offset)[d];
+            }
+            if (leading <= 0) {
+              continue;
+            }
+
+            int_d other = bucket + *offset;
+            double_d shift = double_d::Constant(0);
+            bool outside = false;
+            for (size_t d = 0; d < dimension; ++d) {
+              if (other[d] < 0 || other[d] >= n[d]) {
+                if (!periodic[d]) {
+                  outside = true;
+                  break;
+                }
+                const int image = other[d] >= 0
+                                      ? other[d] / n[d]
+                                      : -((n[d] - 1 - other[d]) / n[d]);
+                other[d] -= image * n[d];
+                shift[d] = image * width[d];
+              }
+            }
+            if (outside) {
+              continue;
+            }
+
+            for (auto i = query.get_bucket_particles(bucket); i != false;
+                 ++i) {
+              const double_d xi = get<position>(*i) - shift;
+              for (auto j = query.get_bucket_particles(other); j != false;
+                   ++j) {
+                const double_d dx = get<position>(*j) - xi;
+                if (dx.squaredNorm() <= radius2) {
+                  f(*i, *j, dx);
+                }
+              }
+            }
+          }
+        });
+  }
+}
+
+///
+/// @brief a contact between two moving spheres found by
+/// swept_sphere_contacts()
+///
+struct swept_contact {
+  /// the index of the first particle of the pair
+  size_t i;
+  /// the index of the second particle of the pair
+  size_t j;
+  /// the earliest time at which the two spheres touch, 0 if they already
+  /// overlap
+  double time;
+};
+
+namespace detail {
+
+///
+/// @brief returns the earliest time `t` in [0, @p dt] at which two spheres
+/// separated by @p dx and moving with relative velocity @p dv are within
+/// distance @p sum_radius of each other, or -1 if they do not touch over the
+/// timestep
+///
+template <typename DoubleD>
+CUDA_HOST_DEVICE double swept_sphere_contact_time(const DoubleD &dx,
+                                                  const DoubleD &dv,
+                                                  const double sum_radius,
+                                                  const double dt) {
+  // solve |dx + dv t|^2 = sum_radius^2 for the smallest root
+  const double c = dx.squaredNorm() - sum_radius * sum_radius;
+  if (c <= 0) {
+    return 0;
+  }
+  const double b = dx.dot(dv);
+  if (b >= 0) {
+    // moving apart
+    return -1;
+  }
+  const double a = dv.squaredNorm();
+  const double discriminant = b * b - a * c;
+  if (discriminant < 0) {
+    return -1;
+  }
+  // avoids the cancellation in (-b - sqrt(discriminant)) / a
+  const double t = c / (std::sqrt(discriminant) - b);
+  return t <= dt ? t : -1;
+}
+
+} // namespace detail
+
+///
+/// @brief finds every pair of spheres that touch over a timestep, assuming
+/// each moves with a constant velocity
+///
+/// Each particle is a sphere with centre given by its position and radius
+/// given by the variable @p Radius, moving with the velocity given by the
+/// variable @p Velocity. A pair of particles `i` and `j` is in contact if
+/// `|dx + dv t| <= r_i + r_j` for some `t` in [0, @p dt], where `dx = x_j -
+/// x_i` is their separation (corrected for periodic boundaries) and `dv = v_j
+/// - v_i` their relative velocity. Unlike a search for overlapping spheres at
+/// the start or end of the timestep, this does not miss pairs that pass
+/// through each other during the timestep, so @p dt can be chosen as the
+/// largest step that can resolve the earliest contact found.
+///
+/// The candidate pairs are found using for_each_pair_within(), with a radius
+/// of twice the largest sphere radius plus twice the largest distance moved
+/// by any particle over the timestep, so this is efficient as long as this
+/// is comparable to the size of the buckets.
+///
+/// @tparam Velocity the variable type holding the velocity of each particle
+/// @tparam Radius the variable type holding the radius of each particle
+/// @tparam Query query object type (must be @ref CellListQuery, @ref
+/// CellListOrderedQuery or @ref HashedCellListQuery)
+/// @param query the query object
+/// @param dt the length of the timestep
+/// @return the pairs in contact, sorted by their earliest contact time (so
+/// the first contact gives the earliest contact time over all the pairs).
+/// Each pair (or periodic image of a pair) is listed once, and the particles
+/// are given by their index in the particle set
+///
+template <typename Velocity, typename Radius, typename Query>
+std::vector<swept_contact> swept_sphere_contacts(const Query &query,
+                                                 const double dt) {
+  typedef typename Query::traits_type Traits;
+  typedef typename Traits::position position;
+  typedef typename Traits::raw_reference raw_reference;
+  typedef typename Query::double_d double_d;
+
+  const size_t n = query.number_of_particles();
+  if (n == 0) {
+    return std::vector<swept_contact>();
+  }
+
+  // the largest separation at the start of the timestep of any pair that
+  // can touch during it
+  double max_radius = 0;
+  double max_speed2 = 0;
+  for (size_t i = 0; i < n; ++i) {
+    raw_reference p = *(query.get_particles_begin() + i);
+    max_radius = std::max(max_radius, static_cast<double>(get<Radius>(p)));
+    max_speed2 = std::max(max_speed2, get<Velocity>(p).squaredNorm());
+  }
+  const double search_radius =
+      2 * max_radius + 2 * std::sqrt(max_speed2) * dt;
+
+  LOG(2, "swept_sphere_contacts: dt = "
+             << dt << " max_radius = " << max_radius
+             << " search_radius = " << search_radius);
+
+  // for_each_pair_within() never calls the function for the same particle
+  // concurrently, so each thread can store the contacts of particle i
+  std::vector<std::vector<swept_contact>> contacts_by_particle(n);
+  std::vector<swept_contact> *const contacts_ptr = contacts_by_particle.data();
+  const double_d *const positions =
+      get<position>(query.get_particles_begin());
+  for_each_pair_within(
+      query, search_radius,
+      [=](raw_reference i, raw_reference j, const double_d &dx) {
+        const double_d dv = get<Velocity>(j) - get<Velocity>(i);
+        const double time = detail::swept_sphere_contact_time(
+            dx, dv, get<Radius>(i) + get<Radius>(j), dt);
+        if (time >= 0) {
+          const size_t i_index = &get<position>(i) - positions;
+          const size_t j_index = &get<position>(j) - positions;
+          contacts_ptr[i_index].push_back(
+              swept_contact{i_index, j_index, time});
+        }
+      });
+
+  std::vector<swept_contact> contacts;
+  for (const auto &particle_contacts : contacts_by_particle) {
+    contacts.insert(contacts.end(), particle_contacts.begin(),
+                    particle_contacts.end());
+  }
+  std::stable_sort(contacts.begin(), contacts.end(),
+                   [](const swept_contact &a, const swept_contact &b) {
+                     return a.time < b.time;
+                   });
+  return contacts;
+}
+
+namespace detail {
+
+///
+/// @brief returns the squared euclidean distance between the closest points
+/// of boxes @p a and @p b
+///
+template <unsigned int D>
+CUDA_HOST_DEVICE double min_distance2(const bbox<D> &a, const bbox<D> &b) {
+  double accum = 0;
+  for (size_t i = 0; i < D; ++i) {
+    double dist = 0;
+    if (a.bmax[i] < b.bmin[i]) {
+      dist = b.bmin[i] - a.bmax[i];
+    } else if (b.bmax[i] < a.bmin[i]) {
+      dist = a.bmin[i] - b.bmax[i];
+    }
+    accum += dist * dist;
+  }
+  return accum;
+}
+
+///
+/// @brief returns the length of the longest side of @p box
+///
+template <unsigned int D>
+CUDA_HOST_DEVICE double max_side_length(const bbox<D> &box) {
+  double max = 0;
+  for (size_t i = 0; i < D; ++i) {
+    const double side = box.bmax[i] - box.bmin[i];
+    if (side > max) {
+      max = side;
+    }
+  }
+  return max;
+}
+
+///
+/// @brief a pair of nodes (one from each tree) in a dual tree traversal.
+///
+/// Only the child iterator selected by @p iterate_a is incremented, the
+/// other is held fixed on a single node
+///
+template <typename ChildIteratorA, typename ChildIteratorB>
+struct dual_tree_entry {
+  ChildIteratorA a;
+  ChildIteratorB b;
+  bool iterate_a;
+};
+
+///
+/// @brief traverses the subtree of @p query_a under the node @p root_a
+/// together with the whole of @p query_b, calling @p f for each pair of
+/// particles within the search radius
+///
+/// The traversal is depth-first. Node pairs are pruned if their bounding
+/// boxes are further apart than the search radius, otherwise the node with
+/// the larger bounding box is split into its children. The particles in each
+/// pair of leaf nodes that are not pruned are compared directly
+///
+/// @param shift added to the positions and bounding boxes in @p query_b (the
+/// periodic image of @p query_b being searched)
+///
+template <typename QueryA, typename QueryB, typename Function>
+CUDA_HOST_DEVICE void dual_tree_traversal(
+    const QueryA &query_a, const QueryB &query_b,
+    const typename QueryA::child_iterator &root_a,
+    const typename QueryA::double_d &shift, const double radius2,
+    Function f) {
+  typedef typename QueryA::child_iterator child_iterator_a;
+  typedef typename QueryB::child_iterator child_iterator_b;
+  typedef typename QueryA::traits_type::position position_a;
+  typedef typename QueryB::traits_type::position position_b;
+  typedef typename QueryA::double_d double_d;
+  typedef bbox<QueryA::dimension> box_type;
+  typedef dual_tree_entry<child_iterator_a, child_iterator_b> entry_type;
+
+  static_vector<entry_type,
+                QueryA::m_max_tree_depth + QueryB::m_max_tree_depth + 1>
+      stack;
+  stack.push_back(entry_type{root_a, query_b.get_children(), false});
+  while (!stack.empty()) {
+    entry_type &entry = stack.back();
+    if ((entry.iterate_a ? (entry.a == false) : (entry.b == false))) {
+      stack.pop_back();
+      if (!stack.empty()) {
+        entry_type &parent = stack.back();
+        if (parent.iterate_a) {
+          ++parent.a;
+        } else {
+          ++parent.b;
+        }
+      }
+      continue;
+    }
+
+    const child_iterator_a ci_a = entry.a;
+    const child_iterator_b ci_b = entry.b;
+    const box_type bounds_a = query_a.get_bounds(ci_a);
+    box_type bounds_b = query_b.get_bounds(ci_b);
+    bounds_b.bmin += shift;
+    bounds_b.bmax += shift;
+
+    const bool leaf_a = query_a.is_leaf_node(*ci_a);
+    const bool leaf_b = query_b.is_leaf_node(*ci_b);
+    if (min_distance2(bounds_a, bounds_b) > radius2) {
+      // prune this pair
+    } else if (leaf_a && leaf_b) {
+      for (auto i = query_a.get_bucket_particles(*ci_a); i != false; ++i) {
+        const double_d xi = get<position_a>(*i) - shift;
+        for (auto j = query_b.get_bucket_particles(*ci_b); j != false; ++j) {
+          const double_d dx = get<position_b>(*j) - xi;
+          if (dx.squaredNorm() <= radius2) {
+            f(*i, *j, dx);
+          }
+        }
+      }
+    } else if (!leaf_a && (leaf_b || max_side_length(bounds_a) >=
+                                         max_side_length(bounds_b))) {
+      stack.push_back(entry_type{query_a.get_children(ci_a), ci_b, true});
+      continue;
+    } else {
+      stack.push_back(entry_type{ci_a, query_b.get_children(ci_b), false});
+      continue;
+    }
+
+    if (entry.iterate_a) {
+      ++entry.a;
+    } else {
+      ++entry.b;
+    }
+  }
+}
+
+} // namespace detail
+
+///
+/// @brief calls a function for every pair of particles, one from each of two
+/// particle sets, that are within a given distance of each other
+///
+/// This is the two-set equivalent of for_each_pair_within(), for two tree
+/// data structures. Rather than searching the second tree once for each
+/// particle in the first, the two trees are traversed together: pairs of
+/// nodes are pruned if their bounding boxes are further apart than @p
+/// radius, so each subtree of the second tree is only visited once for each
+/// nearby node of the first tree.
+///
+/// The first tree is split into subtrees that are traversed in parallel.
+/// Each particle in @p query_a belongs to only one subtree, so @p f can
+/// safely write to data belonging to the particle from @p query_a without
+/// any locking, but not to the particle from @p query_b. The work is only
+/// divided between the subtrees of the first tree, not between node pairs,
+/// so it is balanced best when @p query_a is the larger of the two sets.
+/// Each subtree (and periodic image) is traversed with its own copy of @p f.
+///
+/// The two particle sets are assumed to share the same domain, and the
+/// periodicity of @p query_b is used.
+///
+/// @tparam QueryA query object type of the first set (must be @ref
+/// KdtreeQuery, @ref KdtreeNanoflannQuery or @ref HyperOctreeQuery)
+/// @tparam QueryB query object type of the second set (same restrictions)
+/// @tparam Function function object type
+/// @param query_a the query object of the first particle set
+/// @param query_b the query object of the second particle set
+/// @param radius the maximum separation of each pair
+/// @param f the function to call for each pair. It is called as `f(a, b,
+/// dx)`, where `a` and `b` are references to the particles from each set,
+/// and `dx` is the shortest difference between their positions, from `a` to
+/// `b`
+///
+template <typename QueryA, typename QueryB, typename Function>
+void for_each_pair_within(const QueryA &query_a, const QueryB &query_b,
+                          const double radius, Function f) {
+  static_assert(detail::is_tree_query<QueryA>::value &&
+                    detail::is_tree_query<QueryB>::value,
+                "dual tree for_each_pair_within requires two tree queries");
+  typedef typename QueryA::traits_type Traits;
+  typedef typename QueryA::child_iterator child_iterator;
+  typedef typename QueryA::double_d double_d;
+  typedef typename Traits::template vector<child_iterator> vector_child;
+
+  if (query_a.number_of_particles() == 0 ||
+      query_b.number_of_particles() == 0) {
+    return;
+  }
+
+  const double radius2 = radius * radius;
+  const double_d width = query_b.get_bounds().bmax - query_b.get_bounds().bmin;
+
+  // split the first tree into enough subtrees to process in parallel. The
+  // subtrees are expanded breadth-first, so they are of similar size
+  const size_t min_subtrees = 256;
+  std::vector<child_iterator> subtrees;
+  for (auto ci = query_a.get_children(); ci != false; ++ci) {
+    subtrees.push_back(ci);
+  }
+  bool all_leaves = false;
+  while (subtrees.size() < min_subtrees && !all_leaves) {
+    std::vector<child_iterator> next_subtrees;
+    all_leaves = true;
+    for (const child_iterator &ci : subtrees) {
+      if (query_a.is_leaf_node(*ci)) {
+        next_subtrees.push_back(ci);
+      } else {
+        all_leaves = false;
+        for (auto child = query_a.get_children(ci); child != false;
+             ++child) {
+          next_subtrees.push_back(child);
+        }
+      }
+    }
+    subtrees.swap(next_subtrees);
+  }
+  vector_child subtrees_copy(subtrees.begin(), subtrees.end());
+  const child_iterator *subtrees_ptr =
+      iterator_to_raw_pointer(subtrees_copy.begin());
+
+  LOG(2, "for_each_pair_within: dual tree traversal with radius = "
+             << radius << " and " << subtrees.size() << " subtrees");
+
+  detail::for_each(
+      Traits::make_counting_iterator(0),
+      Traits::make_counting_iterator(static_cast<int>(subtrees.size())),
+      [=] CUDA_HOST_DEVICE(const int index) {
+        for (auto periodic_it = search_iterator<QueryB, 2>::get_periodic_range(
+                 query_b.get_periodic());
+             periodic_it != false; ++periodic_it) {
+          const double_d shift = (*periodic_it) * width;
+          detail::dual_tree_traversal(query_a, query_b, subtrees_ptr[index],
+                                      shift, radius2, f);
+        }
+      });
+}
+
 } // namespace Aboria
 
 #endif
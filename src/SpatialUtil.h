@@ -134,6 +134,17 @@ std::ostream &operator<<(std::ostream &out, const bbox<D> &b) {
   return out << "bbox(" << b.bmin << "<->" << b.bmax << ")";
 }
 
+///
+/// @brief the space filling curves that can be used to order particles in
+/// memory
+///
+/// @see Particles::sort_by_space_filling_curve()
+///
+enum class space_filling_curve {
+  morton, ///< Morton (z-order) curve, cheapest to compute
+  hilbert ///< Hilbert curve, better locality but more expensive to compute
+};
+
 }
 
 #endif
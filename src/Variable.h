@@ -78,5 +78,8 @@ ABORIA_VARIABLE(alive,uint8_t,"is_alive")
 ABORIA_VARIABLE(id,size_t,"id")
 ABORIA_VARIABLE(generator,generator_type,"random_generator_seed")
 
+/// \brief the search radius of each particle, used by CellListMultiLevel
+ABORIA_VARIABLE(multi_level_radius,double,"multi_level_radius")
+
 }
 #endif /* VARIABLE_H_ */
@@ -387,7 +387,7 @@ public:
   CUDA_HOST_DEVICE
   T minCoeff() const {
     T min = mem[0];
-    for (int i = 1; i < N; ++i) {
+    for (size_t i = 1; i < N; ++i) {
       if (mem[i] < min) {
         min = mem[i];
       }
@@ -0,0 +1,318 @@
+/*
+
+Copyright (c) 2005-2016, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Aboria.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+
+#ifndef VERLET_LIST_H_
+#define VERLET_LIST_H_
+
+#include "CudaInclude.h"
+#include "Get.h"
+#include "Log.h"
+#include "Search.h"
+#include "Vector.h"
+#include "detail/Algorithms.h"
+
+#include <cmath>
+#include <limits>
+
+namespace Aboria {
+
+///
+/// @brief A Verlet neighbour list for a Particles container
+///
+/// Stores, for each particle, the indices of all the other particles within a
+/// distance `radius + skin`, in compressed sparse row (CSR) format. The
+/// positions and ids of the particles are recorded when the list is built,
+/// and update() only rebuilds the list once the maximum displacement of any
+/// particle since the last build exceeds half the skin, since until then the
+/// list is guarenteed to contain every pair of particles within `radius`.
+/// The list is also rebuilt if the particles have been added, deleted or
+/// reordered by the container.
+///
+/// Both the displacement check and the rebuild are run in parallel. The list
+/// holds a pointer to the container, so the container must outlive the list,
+/// and the neighbour search of the container must be up to date (i.e.
+/// Particles::update_positions() has been called) before calling update().
+/// For periodic domains `radius + skin` should be less than half the domain
+/// width.
+///
+/// @tparam ParticlesType the type of the Particles container
+///
+template <typename ParticlesType> class VerletList {
+  typedef typename ParticlesType::traits_type traits_type;
+  typedef typename ParticlesType::position position;
+  typedef typename ParticlesType::query_type query_type;
+  typedef typename ParticlesType::double_d double_d;
+  typedef typename ParticlesType::bool_d bool_d;
+  typedef typename traits_type::vector_int vector_int;
+  typedef typename traits_type::vector_double vector_double;
+  typedef typename traits_type::vector_double_d vector_double_d;
+  typedef typename traits_type::vector_size_t vector_size_t;
+  static const unsigned int dimension = ParticlesType::dimension;
+
+public:
+  ///
+  /// @brief constructs and builds a Verlet list for @p particles
+  ///
+  /// @param particles the particle container, which must have been initialised
+  /// with Particles::init_neighbour_search()
+  /// @param radius the interaction radius
+  /// @param skin the extra distance added to @p radius when building the list
+  ///
+  VerletList(const ParticlesType &particles, const double radius,
+             const double skin)
+      : m_particles(&particles), m_radius(radius), m_skin(skin),
+        m_needs_rebuild(true) {
+    CHECK(radius >= 0, "VerletList: radius must be non-negative");
+    CHECK(skin >= 0, "VerletList: skin must be non-negative");
+    update();
+  }
+
+  ///
+  /// @brief sets the interaction radius. The list is rebuilt on the next
+  /// call to update()
+  ///
+  void set_radius(const double radius) {
+    CHECK(radius >= 0, "VerletList: radius must be non-negative");
+    m_radius = radius;
+    m_needs_rebuild = true;
+  }
+
+  ///
+  /// @brief sets the skin distance. The list is rebuilt on the next call to
+  /// update()
+  ///
+  void set_skin(const double skin) {
+    CHECK(skin >= 0, "VerletList: skin must be non-negative");
+    m_skin = skin;
+    m_needs_rebuild = true;
+  }
+
+  double get_radius() const { return m_radius; }
+  double get_skin() const { return m_skin; }
+
+  ///
+  /// @brief rebuilds the list if any particle has moved more than half the
+  /// skin distance since the last build, or if the particles have been
+  /// added, deleted or reordered
+  ///
+  /// @return true if the list was rebuilt
+  ///
+  bool update() {
+    if (m_needs_rebuild || get_max_displacement() > 0.5 * m_skin) {
+      rebuild();
+      return true;
+    }
+    return false;
+  }
+
+  ///
+  /// @brief unconditionally rebuilds the list
+  ///
+  void rebuild() {
+    const int n = m_particles->size();
+    LOG(2, "VerletList: rebuilding list for " << n << " particles");
+
+    const query_type query = m_particles->get_query();
+    const double cutoff = m_radius + m_skin;
+    const double_d *const positions =
+        get<position>(query.get_particles_begin());
+
+    // count the neighbours of each particle, then scan to get the offsets
+    m_offsets.resize(n + 1);
+    detail::tabulate(m_offsets.begin(), m_offsets.end(),
+                     [=] CUDA_HOST_DEVICE(const int i) {
+                       int count = 0;
+                       if (i > 0) {
+                         for (auto j = euclidean_search(
+                                  query, positions[i - 1], cutoff);
+                              j != false; ++j) {
+                           if (&get<position>(*j) - positions != i - 1) {
+                             ++count;
+                           }
+                         }
+                       }
+                       return count;
+                     });
+    detail::inclusive_scan(m_offsets.begin(), m_offsets.end(),
+                           m_offsets.begin());
+
+    // fill in the neighbour indices
+    m_indices.resize(m_offsets[n]);
+    const int *const offsets = iterator_to_raw_pointer(m_offsets.begin());
+    int *const indices = iterator_to_raw_pointer(m_indices.begin());
+    detail::for_each(traits_type::make_counting_iterator(0),
+                     traits_type::make_counting_iterator(n),
+                     [=] CUDA_HOST_DEVICE(const int i) {
+                       int *indices_i = indices + offsets[i];
+                       for (auto j = euclidean_search(query, positions[i],
+                                                      cutoff);
+                            j != false; ++j) {
+                         const int j_index = &get<position>(*j) - positions;
+                         if (j_index != i) {
+                           *indices_i++ = j_index;
+                         }
+                       }
+                     });
+
+    // record the positions and ids at this build
+    m_positions.resize(n);
+    m_ids.resize(n);
+    detail::copy(positions, positions + n, m_positions.begin());
+    const size_t *const ids = get<id>(query.get_particles_begin());
+    detail::copy(ids, ids + n, m_ids.begin());
+    m_needs_rebuild = false;
+  }
+
+  ///
+  /// @brief returns the maximum distance moved by any particle since the last
+  /// build. If the particles have been added, deleted or reordered since
+  /// then, returns the maximum representable double
+  ///
+  double get_max_displacement() const {
+    const int n = m_particles->size();
+    if (m_needs_rebuild || n != static_cast<int>(m_positions.size())) {
+      return std::numeric_limits<double>::max();
+    }
+    if (n == 0) {
+      return 0;
+    }
+
+    const query_type &query = m_particles->get_query();
+    const double_d *const positions =
+        get<position>(query.get_particles_begin());
+    const size_t *const ids = get<id>(query.get_particles_begin());
+    const auto old_positions = m_positions.cbegin();
+    const auto old_ids = m_ids.cbegin();
+    const bool_d periodic = query.get_periodic();
+    const double_d width = query.get_bounds().bmax - query.get_bounds().bmin;
+
+    m_displacements2.resize(n);
+    detail::transform(
+        traits_type::make_counting_iterator(0),
+        traits_type::make_counting_iterator(n), m_displacements2.begin(),
+        [=] CUDA_HOST_DEVICE(const int i) {
+          if (ids[i] != old_ids[i]) {
+            return std::numeric_limits<double>::max();
+          }
+          double_d dx = positions[i] - old_positions[i];
+          for (size_t d = 0; d < dimension; ++d) {
+            if (periodic[d]) {
+              dx[d] -= width[d] * std::round(dx[d] / width[d]);
+            }
+          }
+          return dx.squaredNorm();
+        });
+    const double max_displacement2 = detail::reduce(
+        m_displacements2.begin(), m_displacements2.end(), 0.0,
+        [] CUDA_HOST_DEVICE(const double a, const double b) {
+          return a < b ? b : a;
+        });
+    if (max_displacement2 == std::numeric_limits<double>::max()) {
+      return max_displacement2;
+    }
+    return std::sqrt(max_displacement2);
+  }
+
+  ///
+  /// @brief returns the number of neighbours of particle @p i
+  ///
+  int number_of_neighbours(const int i) const {
+    return m_offsets[i + 1] - m_offsets[i];
+  }
+
+  ///
+  /// @brief calls @p f with the index of each neighbour of particle @p i
+  ///
+  /// @param i the index of the particle
+  /// @param f a function with signature `void(const int j)`
+  ///
+  template <typename Function>
+  void for_each_neighbour(const int i, Function f) const {
+    const int end = m_offsets[i + 1];
+    for (int j = m_offsets[i]; j < end; ++j) {
+      f(m_indices[j]);
+    }
+  }
+
+  ///
+  /// @brief calls @p f with the indices of each particle and each of its
+  /// neighbours. The particles are processed in parallel, so @p f should only
+  /// write to data belonging to particle `i`
+  ///
+  /// @param f a function with signature `void(const int i, const int j)`
+  ///
+  template <typename Function> void for_each_neighbour(Function f) const {
+    const int n = static_cast<int>(m_offsets.size()) - 1;
+    if (n <= 0) {
+      return;
+    }
+    const auto offsets = m_offsets.cbegin();
+    const auto indices = m_indices.cbegin();
+    detail::for_each(traits_type::make_counting_iterator(0),
+                     traits_type::make_counting_iterator(n),
+                     [=] CUDA_HOST_DEVICE(const int i) {
+                       for (int j = offsets[i]; j < offsets[i + 1]; ++j) {
+                         f(i, indices[j]);
+                       }
+                     });
+  }
+
+  ///
+  /// @brief returns the CSR row offsets. The neighbours of particle `i` are
+  /// stored at positions `offsets[i]` to `offsets[i+1]-1` of get_indices()
+  ///
+  const vector_int &get_offsets() const { return m_offsets; }
+
+  ///
+  /// @brief returns the CSR neighbour indices
+  ///
+  const vector_int &get_indices() const { return m_indices; }
+
+private:
+  const ParticlesType *m_particles;
+  double m_radius;
+  double m_skin;
+  bool m_needs_rebuild;
+  vector_int m_offsets;
+  vector_int m_indices;
+  vector_double_d m_positions;
+  vector_size_t m_ids;
+  mutable vector_double m_displacements2;
+};
+
+} // namespace Aboria
+
+#endif /* VERLET_LIST_H_ */
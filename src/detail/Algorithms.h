@@ -4,11 +4,16 @@
 
 #include "../CudaInclude.h"
 #include "Get.h"
+#include "RadixSort.h"
 #include "Traits.h"
 #include <algorithm>
 #include <omp.h>
 #include <random>
 
+#ifdef HAVE_OPENMP
+#include "AlgorithmsOpenMP.h"
+#endif
+
 namespace Aboria {
 
 namespace detail {
@@ -118,7 +123,12 @@ void fill(ForwardIt first, ForwardIt last, const T &value) {
 template <class InputIt, class UnaryFunction>
 UnaryFunction for_each(InputIt first, InputIt last, UnaryFunction f,
                        std::true_type) {
+#ifdef HAVE_OPENMP
+  return openmp::for_each(first, last, f,
+                          typename openmp::is_random_access<InputIt>::type());
+#else
   return std::for_each(first, last, f);
+#endif
 }
 
 #ifdef HAVE_THRUST
@@ -137,7 +147,13 @@ UnaryFunction for_each(InputIt first, InputIt last, UnaryFunction f) {
 
 template <typename RandomIt>
 void sort(RandomIt start, RandomIt end, std::true_type) {
+#ifdef HAVE_OPENMP
+  typedef typename std::iterator_traits<RandomIt>::value_type value_type;
+  openmp::sort(start, end, std::less<value_type>(),
+               typename openmp::is_random_access<RandomIt>::type());
+#else
   std::sort(start, end);
+#endif
 }
 
 #ifdef HAVE_THRUST
@@ -154,7 +170,12 @@ template <typename RandomIt> void sort(RandomIt start, RandomIt end) {
 template <typename RandomIt, typename StrictWeakOrdering>
 void sort(RandomIt start, RandomIt end, StrictWeakOrdering comp,
           std::true_type) {
+#ifdef HAVE_OPENMP
+  openmp::sort(start, end, comp,
+               typename openmp::is_random_access<RandomIt>::type());
+#else
   std::sort(start, end, comp);
+#endif
 }
 
 #ifdef HAVE_THRUST
@@ -170,8 +191,14 @@ void sort(RandomIt start, RandomIt end, StrictWeakOrdering comp) {
   detail::sort(start, end, comp, typename is_std_iterator<RandomIt>::type());
 }
 
+// comparison based sort
 template <typename T1, typename T2>
-void sort_by_key(T1 start_keys, T1 end_keys, T2 start_data, std::true_type) {
+void sort_by_key(T1 start_keys, T1 end_keys, T2 start_data, std::true_type,
+                 std::false_type) {
+#ifdef HAVE_OPENMP
+  openmp::sort_by_key(start_keys, end_keys, start_data,
+                      typename openmp::is_random_access<T1, T2>::type());
+#else
   typedef zip_iterator<std::tuple<T1, T2>, mpl::vector<>> pair_zip_type;
 
   std::sort(
@@ -187,6 +214,20 @@ std::sort(
       end_keys, start_data + std::distance(start_keys, end_keys))),
   [](auto a, auto b) { return a.template get<0>() < b.template get<0>(); });
   */
+#endif
+}
+
+// radix sort for integer keys
+template <typename T1, typename T2>
+void sort_by_key(T1 start_keys, T1 end_keys, T2 start_data, std::true_type,
+                 std::true_type) {
+  radix_sort_by_key(start_keys, end_keys, start_data);
+}
+
+template <typename T1, typename T2>
+void sort_by_key(T1 start_keys, T1 end_keys, T2 start_data, std::true_type) {
+  detail::sort_by_key(start_keys, end_keys, start_data, std::true_type(),
+                      typename is_radix_sortable<T1, T2>::type());
 }
 
 #ifdef HAVE_THRUST
@@ -205,13 +246,73 @@ void sort_by_key(T1 start_keys, T1 end_keys, T2 start_data) {
                       typename is_std_iterator<T1>::type());
 }
 
+template <typename InputIt1, typename InputIt2, typename InputIt3,
+          typename InputIt4, typename OutputIt1, typename OutputIt2>
+void merge_by_key(InputIt1 keys1_first, InputIt1 keys1_last,
+                  InputIt2 keys2_first, InputIt2 keys2_last,
+                  InputIt3 values1_first, InputIt4 values2_first,
+                  OutputIt1 keys_result, OutputIt2 values_result,
+                  std::true_type) {
+  // stable: for equal keys, elements from the first range come first
+  while (keys1_first != keys1_last && keys2_first != keys2_last) {
+    if (*keys2_first < *keys1_first) {
+      *keys_result++ = *keys2_first++;
+      *values_result++ = *values2_first++;
+    } else {
+      *keys_result++ = *keys1_first++;
+      *values_result++ = *values1_first++;
+    }
+  }
+  for (; keys1_first != keys1_last; ++keys1_first) {
+    *keys_result++ = *keys1_first;
+    *values_result++ = *values1_first++;
+  }
+  for (; keys2_first != keys2_last; ++keys2_first) {
+    *keys_result++ = *keys2_first;
+    *values_result++ = *values2_first++;
+  }
+}
+
+#ifdef HAVE_THRUST
+template <typename InputIt1, typename InputIt2, typename InputIt3,
+          typename InputIt4, typename OutputIt1, typename OutputIt2>
+void merge_by_key(InputIt1 keys1_first, InputIt1 keys1_last,
+                  InputIt2 keys2_first, InputIt2 keys2_last,
+                  InputIt3 values1_first, InputIt4 values2_first,
+                  OutputIt1 keys_result, OutputIt2 values_result,
+                  std::false_type) {
+  thrust::merge_by_key(keys1_first, keys1_last, keys2_first, keys2_last,
+                       values1_first, values2_first, keys_result,
+                       values_result);
+}
+#endif
+
+template <typename InputIt1, typename InputIt2, typename InputIt3,
+          typename InputIt4, typename OutputIt1, typename OutputIt2>
+void merge_by_key(InputIt1 keys1_first, InputIt1 keys1_last,
+                  InputIt2 keys2_first, InputIt2 keys2_last,
+                  InputIt3 values1_first, InputIt4 values2_first,
+                  OutputIt1 keys_result, OutputIt2 values_result) {
+  detail::merge_by_key(keys1_first, keys1_last, keys2_first, keys2_last,
+                       values1_first, values2_first, keys_result,
+                       values_result,
+                       typename is_std_iterator<InputIt1>::type());
+}
+
 template <typename ForwardIterator, typename InputIterator,
           typename OutputIterator>
 void lower_bound(ForwardIterator first, ForwardIterator last,
                  InputIterator values_first, InputIterator values_last,
                  OutputIterator result, std::true_type) {
+#ifdef HAVE_OPENMP
+  openmp::vectorized_search(
+      values_first, values_last, result,
+      detail::lower_bound_impl<ForwardIterator>(first, last),
+      typename openmp::is_random_access<InputIterator, OutputIterator>::type());
+#else
   std::transform(values_first, values_last, result,
                  detail::lower_bound_impl<ForwardIterator>(first, last));
+#endif
 }
 
 #ifdef HAVE_THRUST
@@ -263,9 +364,15 @@ template <typename ForwardIterator, typename InputIterator,
 void upper_bound(ForwardIterator first, ForwardIterator last,
                  InputIterator values_first, InputIterator values_last,
                  OutputIterator result, std::true_type) {
-
+#ifdef HAVE_OPENMP
+  openmp::vectorized_search(
+      values_first, values_last, result,
+      detail::upper_bound_impl<ForwardIterator>(first, last),
+      typename openmp::is_random_access<InputIterator, OutputIterator>::type());
+#else
   std::transform(values_first, values_last, result,
                  detail::upper_bound_impl<ForwardIterator>(first, last));
+#endif
 }
 
 #ifdef HAVE_THRUST
@@ -291,8 +398,12 @@ void upper_bound(ForwardIterator first, ForwardIterator last,
 template <class InputIt, class T, class BinaryOperation>
 T reduce(InputIt first, InputIt last, T init, BinaryOperation op,
          std::true_type) {
-
+#ifdef HAVE_OPENMP
+  return openmp::reduce(first, last, init, op,
+                        typename openmp::is_random_access<InputIt>::type());
+#else
   return std::accumulate(first, last, init, op);
+#endif
 }
 
 #ifdef HAVE_THRUST
@@ -307,15 +418,21 @@ T reduce(InputIt first, InputIt last, T init, BinaryOperation op,
 template <class InputIt, class T, class BinaryOperation>
 T reduce(InputIt first, InputIt last, T init, BinaryOperation op) {
 
-  detail::reduce(first, last, init, op,
-                 typename is_std_iterator<InputIt>::type());
+  return detail::reduce(first, last, init, op,
+                        typename is_std_iterator<InputIt>::type());
 }
 
 template <class InputIterator, class OutputIterator, class UnaryOperation>
 OutputIterator transform(InputIterator first, InputIterator last,
                          OutputIterator result, UnaryOperation op,
                          std::true_type) {
+#ifdef HAVE_OPENMP
+  return openmp::transform(
+      first, last, result, op,
+      typename openmp::is_random_access<InputIterator, OutputIterator>::type());
+#else
   return std::transform(first, last, result, op);
+#endif
 }
 
 #ifdef HAVE_THRUST
@@ -334,23 +451,24 @@ OutputIterator transform(InputIterator first, InputIterator last,
                            typename is_std_iterator<OutputIterator>::type());
 }
 
-template <class ForwardIterator>
-void sequence(ForwardIterator first, ForwardIterator last, std::true_type) {
-  boost::counting_iterator<unsigned int> count(0);
-  std::transform(
-      first, last, count, first,
-      [](const typename std::iterator_traits<ForwardIterator>::reference,
-         const unsigned int i) { return i; });
-}
-
 template <class ForwardIterator, typename T>
 void sequence(ForwardIterator first, ForwardIterator last, T init,
               std::true_type) {
+#ifdef HAVE_OPENMP
+  openmp::sequence(first, last, init,
+                   typename openmp::is_random_access<ForwardIterator>::type());
+#else
   boost::counting_iterator<unsigned int> count(init);
   std::transform(
       first, last, count, first,
       [](const typename std::iterator_traits<ForwardIterator>::reference,
          const unsigned int i) { return i; });
+#endif
+}
+
+template <class ForwardIterator>
+void sequence(ForwardIterator first, ForwardIterator last, std::true_type) {
+  detail::sequence(first, last, 0u, std::true_type());
 }
 
 #ifdef HAVE_THRUST
@@ -381,13 +499,17 @@ void sequence(ForwardIterator first, ForwardIterator last, T init) {
 template <typename ForwardIterator, typename UnaryOperation>
 void tabulate(ForwardIterator first, ForwardIterator last,
               UnaryOperation unary_op, std::true_type) {
-
+#ifdef HAVE_OPENMP
+  openmp::tabulate(first, last, unary_op,
+                   typename openmp::is_random_access<ForwardIterator>::type());
+#else
   boost::counting_iterator<unsigned int> count(0);
   std::transform(
       first, last, count, first,
       [&unary_op](
           const typename std::iterator_traits<ForwardIterator>::reference,
           const unsigned int i) { return unary_op(i); });
+#endif
 }
 
 #ifdef HAVE_THRUST
@@ -489,13 +611,18 @@ OutputIterator
 transform_exclusive_scan(InputIterator first, InputIterator last,
                          OutputIterator result, UnaryFunction unary_op, T init,
                          AssociativeOperator binary_op, std::true_type) {
-
+#ifdef HAVE_OPENMP
+  return openmp::transform_exclusive_scan(
+      first, last, result, unary_op, init, binary_op,
+      typename openmp::is_random_access<InputIterator, OutputIterator>::type());
+#else
   const size_t n = last - first;
   result[0] = init;
   for (size_t i = 1; i < n; ++i) {
     result[i] = binary_op(result[i - 1], unary_op(first[i - 1]));
   }
   return result + n;
+#endif
 }
 
 #ifdef HAVE_THRUST
@@ -526,7 +653,11 @@ OutputIterator transform_exclusive_scan(InputIterator first, InputIterator last,
 template <class InputIt, class OutputIt>
 OutputIt inclusive_scan(InputIt first, InputIt last, OutputIt d_first,
                         std::true_type) {
-#if __cplusplus >= 201703L
+#if defined(HAVE_OPENMP)
+  return openmp::inclusive_scan(
+      first, last, d_first,
+      typename openmp::is_random_access<InputIt, OutputIt>::type());
+#elif __cplusplus >= 201703L
   // C++17 code here
   return std::inclusive_scan(first, last, d_first);
 #else
@@ -551,7 +682,11 @@ OutputIt inclusive_scan(InputIt first, InputIt last, OutputIt d_first) {
 template <class InputIt, class OutputIt, class T>
 OutputIt exclusive_scan(InputIt first, InputIt last, OutputIt d_first, T init,
                         std::true_type) {
-#if __cplusplus >= 201703L
+#if defined(HAVE_OPENMP)
+  return openmp::exclusive_scan(
+      first, last, d_first, init,
+      typename openmp::is_random_access<InputIt, OutputIt>::type());
+#elif __cplusplus >= 201703L
   // C++17 code here
   return std::exclusive_scan(first, last, d_first,init);
 #else
@@ -620,10 +755,17 @@ template <typename InputIterator1, typename InputIterator2,
           typename RandomAccessIterator>
 void scatter(InputIterator1 first, InputIterator1 last, InputIterator2 map,
              RandomAccessIterator output, std::true_type) {
+#ifdef HAVE_OPENMP
+  openmp::scatter(first, last, map, output,
+                  typename openmp::is_random_access<
+                      InputIterator1, InputIterator2,
+                      RandomAccessIterator>::type());
+#else
   const size_t n = last - first;
   for (size_t i = 0; i < n; ++i) {
     output[map[i]] = first[i];
   }
+#endif
 }
 
 #ifdef HAVE_THRUST
@@ -649,13 +791,20 @@ template <typename InputIterator1, typename InputIterator2,
 void scatter_if(InputIterator1 first, InputIterator1 last, InputIterator2 map,
                 InputIterator3 stencil, RandomAccessIterator output,
                 Predicate pred, std::true_type) {
-
+#ifdef HAVE_OPENMP
+  openmp::scatter_if(
+      first, last, map, stencil, output, pred,
+      typename openmp::is_random_access<InputIterator1, InputIterator2,
+                                        InputIterator3,
+                                        RandomAccessIterator>::type());
+#else
   const size_t n = last - first;
   for (size_t i = 0; i < n; ++i) {
     if (pred(stencil[i])) {
       output[map[i]] = first[i];
     }
   }
+#endif
 }
 
 #ifdef HAVE_THRUST
@@ -686,13 +835,11 @@ template <typename InputIterator1, typename InputIterator2,
 void scatter_if(InputIterator1 first, InputIterator1 last, InputIterator2 map,
                 InputIterator3 stencil, RandomAccessIterator output,
                 std::true_type) {
-
-  const size_t n = last - first;
-  for (size_t i = 0; i < n; ++i) {
-    if (stencil[i]) {
-      output[map[i]] = first[i];
-    }
-  }
+  typedef typename std::iterator_traits<InputIterator3>::value_type
+      stencil_type;
+  detail::scatter_if(first, last, map, stencil, output,
+                     [](const stencil_type &i) { return static_cast<bool>(i); },
+                     std::true_type());
 }
 
 #ifdef HAVE_THRUST
@@ -720,10 +867,17 @@ template <typename InputIterator, typename RandomAccessIterator,
 void gather(InputIterator map_first, InputIterator map_last,
             RandomAccessIterator input_first, OutputIterator result,
             std::true_type) {
+#ifdef HAVE_OPENMP
+  openmp::gather(map_first, map_last, input_first, result,
+                 typename openmp::is_random_access<
+                     InputIterator, RandomAccessIterator,
+                     OutputIterator>::type());
+#else
   std::transform(map_first, map_last, result,
                  [&input_first](typename InputIterator::value_type const &i) {
                    return input_first[i];
                  });
+#endif
 }
 
 #ifdef HAVE_THRUST
@@ -749,7 +903,12 @@ template <typename InputIterator1, typename InputIterator2,
 OutputIterator copy_if(InputIterator1 first, InputIterator1 last,
                        InputIterator2 stencil, OutputIterator result,
                        Predicate pred, std::true_type) {
-  // TODO: need to parallise this....
+#ifdef HAVE_OPENMP
+  return openmp::copy_if(
+      first, last, stencil, result, pred,
+      typename openmp::is_random_access<InputIterator1, InputIterator2,
+                                        OutputIterator>::type());
+#else
   const size_t n = last - first;
   for (size_t i = 0; i < n; ++i) {
     if (pred(stencil[i])) {
@@ -758,6 +917,7 @@ OutputIterator copy_if(InputIterator1 first, InputIterator1 last,
     }
   }
   return result;
+#endif
 }
 
 #ifdef HAVE_THRUST
@@ -0,0 +1,587 @@
+/*
+
+Copyright (c) 2005-2016, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Aboria.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef ALGORITHMS_OPENMP_H_
+#define ALGORITHMS_OPENMP_H_
+
+#include "Get.h"
+#include <algorithm>
+#include <boost/iterator/counting_iterator.hpp>
+#include <boost/iterator/iterator_categories.hpp>
+#include <iterator>
+#include <numeric>
+#include <omp.h>
+#include <vector>
+
+namespace Aboria {
+namespace detail {
+
+///
+/// OpenMP host backend for the algorithms in detail/Algorithms.h. These are
+/// used instead of the serial std:: algorithms when HAVE_OPENMP is defined
+/// and thrust is not in use. Each algorithm takes a trailing tag that is
+/// std::true_type if all the given iterators are random access (i.e. the
+/// range can be split between threads), otherwise it falls back to the
+/// serial std:: version
+///
+namespace openmp {
+
+/// true_type if all the iterators in \p T are random access
+template <typename... T> struct is_random_access;
+
+template <> struct is_random_access<> : std::true_type {};
+
+template <typename T, typename... Ts>
+struct is_random_access<T, Ts...>
+    : std::integral_constant<
+          bool,
+          std::is_convertible<
+              typename boost::iterators::iterator_traversal<T>::type,
+              boost::iterators::random_access_traversal_tag>::value &&
+              is_random_access<Ts...>::value> {};
+
+/// splits the range [0,n) into (at most) one contiguous block per thread,
+/// block k being [bounds[k],bounds[k+1])
+inline std::vector<size_t> block_bounds(const size_t n) {
+  const size_t nblocks =
+      std::max(size_t(1), std::min(n, size_t(omp_get_max_threads())));
+  std::vector<size_t> bounds(nblocks + 1);
+  for (size_t k = 0; k <= nblocks; ++k) {
+    bounds[k] = (k * n) / nblocks;
+  }
+  return bounds;
+}
+
+template <class InputIt, class UnaryFunction>
+UnaryFunction for_each(InputIt first, InputIt last, UnaryFunction f,
+                       std::false_type) {
+  return std::for_each(first, last, f);
+}
+
+template <class InputIt, class UnaryFunction>
+UnaryFunction for_each(InputIt first, InputIt last, UnaryFunction f,
+                       std::true_type) {
+  const size_t n = std::distance(first, last);
+#pragma omp parallel for
+  for (size_t i = 0; i < n; ++i) {
+    f(*(first + i));
+  }
+  return f;
+}
+
+template <class InputIterator, class OutputIterator, class UnaryOperation>
+OutputIterator transform(InputIterator first, InputIterator last,
+                         OutputIterator result, UnaryOperation op,
+                         std::false_type) {
+  return std::transform(first, last, result, op);
+}
+
+template <class InputIterator, class OutputIterator, class UnaryOperation>
+OutputIterator transform(InputIterator first, InputIterator last,
+                         OutputIterator result, UnaryOperation op,
+                         std::true_type) {
+  const size_t n = std::distance(first, last);
+#pragma omp parallel for
+  for (size_t i = 0; i < n; ++i) {
+    *(result + i) = op(*(first + i));
+  }
+  return result + n;
+}
+
+template <typename ForwardIterator, typename UnaryOperation>
+void tabulate(ForwardIterator first, ForwardIterator last,
+              UnaryOperation unary_op, std::false_type) {
+  boost::counting_iterator<unsigned int> count(0);
+  std::transform(
+      first, last, count, first,
+      [&unary_op](
+          const typename std::iterator_traits<ForwardIterator>::reference,
+          const unsigned int i) { return unary_op(i); });
+}
+
+template <typename ForwardIterator, typename UnaryOperation>
+void tabulate(ForwardIterator first, ForwardIterator last,
+              UnaryOperation unary_op, std::true_type) {
+  const size_t n = std::distance(first, last);
+#pragma omp parallel for
+  for (size_t i = 0; i < n; ++i) {
+    *(first + i) = unary_op(static_cast<unsigned int>(i));
+  }
+}
+
+template <class ForwardIterator, typename T>
+void sequence(ForwardIterator first, ForwardIterator last, T init,
+              std::false_type) {
+  boost::counting_iterator<unsigned int> count(init);
+  std::transform(
+      first, last, count, first,
+      [](const typename std::iterator_traits<ForwardIterator>::reference,
+         const unsigned int i) { return i; });
+}
+
+template <class ForwardIterator, typename T>
+void sequence(ForwardIterator first, ForwardIterator last, T init,
+              std::true_type) {
+  const size_t n = std::distance(first, last);
+#pragma omp parallel for
+  for (size_t i = 0; i < n; ++i) {
+    *(first + i) = init + static_cast<unsigned int>(i);
+  }
+}
+
+template <typename InputIterator, typename OutputIterator,
+          typename SearchFunction>
+void vectorized_search(InputIterator values_first, InputIterator values_last,
+                       OutputIterator result, SearchFunction search,
+                       std::false_type) {
+  std::transform(values_first, values_last, result, search);
+}
+
+template <typename InputIterator, typename OutputIterator,
+          typename SearchFunction>
+void vectorized_search(InputIterator values_first, InputIterator values_last,
+                       OutputIterator result, SearchFunction search,
+                       std::true_type) {
+  const size_t n = std::distance(values_first, values_last);
+#pragma omp parallel for
+  for (size_t i = 0; i < n; ++i) {
+    *(result + i) = search(*(values_first + i));
+  }
+}
+
+template <class InputIt, class T, class BinaryOperation>
+T reduce(InputIt first, InputIt last, T init, BinaryOperation op,
+         std::false_type) {
+  return std::accumulate(first, last, init, op);
+}
+
+template <class InputIt, class T, class BinaryOperation>
+T reduce(InputIt first, InputIt last, T init, BinaryOperation op,
+         std::true_type) {
+  const std::vector<size_t> bounds = block_bounds(std::distance(first, last));
+  const int nblocks = bounds.size() - 1;
+  std::vector<T> partial(nblocks, init);
+#pragma omp parallel for
+  for (int k = 0; k < nblocks; ++k) {
+    if (bounds[k] == bounds[k + 1])
+      continue;
+    T sum = *(first + bounds[k]);
+    for (size_t i = bounds[k] + 1; i < bounds[k + 1]; ++i) {
+      sum = op(sum, *(first + i));
+    }
+    partial[k] = sum;
+  }
+  for (int k = 0; k < nblocks; ++k) {
+    if (bounds[k] != bounds[k + 1]) {
+      init = op(init, partial[k]);
+    }
+  }
+  return init;
+}
+
+template <typename InputIterator, typename OutputIterator,
+          typename UnaryFunction, typename T, typename AssociativeOperator>
+OutputIterator
+transform_exclusive_scan(InputIterator first, InputIterator last,
+                         OutputIterator result, UnaryFunction unary_op, T init,
+                         AssociativeOperator binary_op, std::false_type) {
+  const size_t n = last - first;
+  result[0] = init;
+  for (size_t i = 1; i < n; ++i) {
+    result[i] = binary_op(result[i - 1], unary_op(first[i - 1]));
+  }
+  return result + n;
+}
+
+/// two pass blocked scan: each thread reduces its own block, the block
+/// totals are scanned serially, then each thread scans its own block again
+/// starting from its offset. Safe to use in-place (result == first)
+template <typename InputIterator, typename OutputIterator,
+          typename UnaryFunction, typename T, typename AssociativeOperator>
+OutputIterator
+transform_exclusive_scan(InputIterator first, InputIterator last,
+                         OutputIterator result, UnaryFunction unary_op, T init,
+                         AssociativeOperator binary_op, std::true_type) {
+  const size_t n = std::distance(first, last);
+  const std::vector<size_t> bounds = block_bounds(n);
+  const int nblocks = bounds.size() - 1;
+  std::vector<T> offsets(nblocks, init);
+#pragma omp parallel for
+  for (int k = 0; k < nblocks - 1; ++k) {
+    if (bounds[k] == bounds[k + 1])
+      continue;
+    T sum = unary_op(*(first + bounds[k]));
+    for (size_t i = bounds[k] + 1; i < bounds[k + 1]; ++i) {
+      sum = binary_op(sum, unary_op(*(first + i)));
+    }
+    offsets[k + 1] = sum;
+  }
+  for (int k = 1; k < nblocks; ++k) {
+    if (bounds[k - 1] != bounds[k]) {
+      offsets[k] = binary_op(offsets[k - 1], offsets[k]);
+    } else {
+      offsets[k] = offsets[k - 1];
+    }
+  }
+#pragma omp parallel for
+  for (int k = 0; k < nblocks; ++k) {
+    T sum = offsets[k];
+    for (size_t i = bounds[k]; i < bounds[k + 1]; ++i) {
+      const T value = unary_op(*(first + i));
+      *(result + i) = sum;
+      sum = binary_op(sum, value);
+    }
+  }
+  return result + n;
+}
+
+template <class InputIt, class OutputIt>
+OutputIt inclusive_scan(InputIt first, InputIt last, OutputIt d_first,
+                        std::false_type) {
+#if __cplusplus >= 201703L
+  // C++17 code here
+  return std::inclusive_scan(first, last, d_first);
+#else
+  return std::partial_sum(first, last, d_first);
+#endif
+}
+
+template <class InputIt, class OutputIt>
+OutputIt inclusive_scan(InputIt first, InputIt last, OutputIt d_first,
+                        std::true_type) {
+  typedef typename std::iterator_traits<InputIt>::value_type T;
+  const size_t n = std::distance(first, last);
+  const std::vector<size_t> bounds = block_bounds(n);
+  const int nblocks = bounds.size() - 1;
+  std::vector<T> offsets(nblocks);
+#pragma omp parallel for
+  for (int k = 0; k < nblocks; ++k) {
+    if (bounds[k] == bounds[k + 1])
+      continue;
+    T sum = *(first + bounds[k]);
+    for (size_t i = bounds[k] + 1; i < bounds[k + 1]; ++i) {
+      sum = sum + *(first + i);
+    }
+    offsets[k] = sum;
+  }
+  // offsets[k] holds the total of all blocks before block k, the first
+  // non-empty block has no offset
+  bool have_offset = false;
+  T total = T();
+  for (int k = 0; k < nblocks; ++k) {
+    if (bounds[k] == bounds[k + 1])
+      continue;
+    const T block_total = offsets[k];
+    offsets[k] = total;
+    total = have_offset ? total + block_total : block_total;
+    have_offset = true;
+  }
+#pragma omp parallel for
+  for (int k = 0; k < nblocks; ++k) {
+    if (bounds[k] == bounds[k + 1])
+      continue;
+    T sum = *(first + bounds[k]);
+    if (bounds[k] != bounds[0]) {
+      sum = offsets[k] + sum;
+    }
+    *(d_first + bounds[k]) = sum;
+    for (size_t i = bounds[k] + 1; i < bounds[k + 1]; ++i) {
+      sum = sum + *(first + i);
+      *(d_first + i) = sum;
+    }
+  }
+  return d_first + n;
+}
+
+template <class InputIt, class OutputIt, class T>
+OutputIt exclusive_scan(InputIt first, InputIt last, OutputIt d_first, T init,
+                        std::false_type) {
+#if __cplusplus >= 201703L
+  // C++17 code here
+  return std::exclusive_scan(first, last, d_first, init);
+#else
+  if (first != last) {
+    *d_first++ = init;
+    for (; first != last - 1; ++first, ++d_first) {
+      *d_first = *(d_first - 1) + *first;
+    }
+  }
+  return d_first;
+#endif
+}
+
+template <class InputIt, class OutputIt, class T>
+OutputIt exclusive_scan(InputIt first, InputIt last, OutputIt d_first, T init,
+                        std::true_type) {
+  typedef typename std::iterator_traits<InputIt>::value_type value_type;
+  return transform_exclusive_scan(
+      first, last, d_first, [](const value_type &i) { return i; }, init,
+      [](const T &a, const T &b) { return a + b; }, std::true_type());
+}
+
+template <typename InputIterator1, typename InputIterator2,
+          typename RandomAccessIterator>
+void scatter(InputIterator1 first, InputIterator1 last, InputIterator2 map,
+             RandomAccessIterator output, std::false_type) {
+  const size_t n = last - first;
+  for (size_t i = 0; i < n; ++i) {
+    output[map[i]] = first[i];
+  }
+}
+
+template <typename InputIterator1, typename InputIterator2,
+          typename RandomAccessIterator>
+void scatter(InputIterator1 first, InputIterator1 last, InputIterator2 map,
+             RandomAccessIterator output, std::true_type) {
+  const size_t n = std::distance(first, last);
+#pragma omp parallel for
+  for (size_t i = 0; i < n; ++i) {
+    *(output + *(map + i)) = *(first + i);
+  }
+}
+
+template <typename InputIterator1, typename InputIterator2,
+          typename InputIterator3, typename RandomAccessIterator,
+          typename Predicate>
+void scatter_if(InputIterator1 first, InputIterator1 last, InputIterator2 map,
+                InputIterator3 stencil, RandomAccessIterator output,
+                Predicate pred, std::false_type) {
+  const size_t n = last - first;
+  for (size_t i = 0; i < n; ++i) {
+    if (pred(stencil[i])) {
+      output[map[i]] = first[i];
+    }
+  }
+}
+
+template <typename InputIterator1, typename InputIterator2,
+          typename InputIterator3, typename RandomAccessIterator,
+          typename Predicate>
+void scatter_if(InputIterator1 first, InputIterator1 last, InputIterator2 map,
+                InputIterator3 stencil, RandomAccessIterator output,
+                Predicate pred, std::true_type) {
+  const size_t n = std::distance(first, last);
+#pragma omp parallel for
+  for (size_t i = 0; i < n; ++i) {
+    if (pred(*(stencil + i))) {
+      *(output + *(map + i)) = *(first + i);
+    }
+  }
+}
+
+template <typename InputIterator, typename RandomAccessIterator,
+          typename OutputIterator>
+void gather(InputIterator map_first, InputIterator map_last,
+            RandomAccessIterator input_first, OutputIterator result,
+            std::false_type) {
+  std::transform(map_first, map_last, result,
+                 [&input_first](typename InputIterator::value_type const &i) {
+                   return input_first[i];
+                 });
+}
+
+template <typename InputIterator, typename RandomAccessIterator,
+          typename OutputIterator>
+void gather(InputIterator map_first, InputIterator map_last,
+            RandomAccessIterator input_first, OutputIterator result,
+            std::true_type) {
+  const size_t n = std::distance(map_first, map_last);
+#pragma omp parallel for
+  for (size_t i = 0; i < n; ++i) {
+    *(result + i) = *(input_first + *(map_first + i));
+  }
+}
+
+template <typename InputIterator1, typename InputIterator2,
+          typename OutputIterator, typename Predicate>
+OutputIterator copy_if(InputIterator1 first, InputIterator1 last,
+                       InputIterator2 stencil, OutputIterator result,
+                       Predicate pred, std::false_type) {
+  const size_t n = last - first;
+  for (size_t i = 0; i < n; ++i) {
+    if (pred(stencil[i])) {
+      *result = first[i];
+      ++result;
+    }
+  }
+  return result;
+}
+
+/// count the number of copied elements in each block, scan the counts to get
+/// the output offset for each block, then copy
+template <typename InputIterator1, typename InputIterator2,
+          typename OutputIterator, typename Predicate>
+OutputIterator copy_if(InputIterator1 first, InputIterator1 last,
+                       InputIterator2 stencil, OutputIterator result,
+                       Predicate pred, std::true_type) {
+  const std::vector<size_t> bounds = block_bounds(std::distance(first, last));
+  const int nblocks = bounds.size() - 1;
+  std::vector<size_t> offsets(nblocks + 1, 0);
+#pragma omp parallel for
+  for (int k = 0; k < nblocks; ++k) {
+    size_t count = 0;
+    for (size_t i = bounds[k]; i < bounds[k + 1]; ++i) {
+      if (pred(*(stencil + i))) {
+        ++count;
+      }
+    }
+    offsets[k + 1] = count;
+  }
+  std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+#pragma omp parallel for
+  for (int k = 0; k < nblocks; ++k) {
+    OutputIterator out = result + offsets[k];
+    for (size_t i = bounds[k]; i < bounds[k + 1]; ++i) {
+      if (pred(*(stencil + i))) {
+        *out = *(first + i);
+        ++out;
+      }
+    }
+  }
+  return result + offsets[nblocks];
+}
+
+/// merge sorted blocks [bounds[lo],bounds[mid]) and [bounds[mid],bounds[hi])
+/// from \p src into \p dst, for each pair of neighbouring runs of \p width
+/// blocks
+template <typename SrcIterator, typename DstIterator, typename Compare>
+void merge_blocks(SrcIterator src, DstIterator dst,
+                  const std::vector<size_t> &bounds, const int width,
+                  Compare comp) {
+  const int nblocks = bounds.size() - 1;
+  const int npairs = (nblocks + 2 * width - 1) / (2 * width);
+#pragma omp parallel for
+  for (int p = 0; p < npairs; ++p) {
+    const int lo = 2 * width * p;
+    const int mid = std::min(lo + width, nblocks);
+    const int hi = std::min(lo + 2 * width, nblocks);
+    std::merge(src + bounds[lo], src + bounds[mid], src + bounds[mid],
+               src + bounds[hi], dst + bounds[lo], comp);
+  }
+}
+
+/// parallel merge sort. Each thread sorts one block using std::sort, then the
+/// sorted blocks are merged pairwise (in parallel) until only one remains
+template <typename RandomIt, typename Compare>
+void merge_sort(RandomIt first, RandomIt last, Compare comp) {
+  typedef typename std::iterator_traits<RandomIt>::value_type value_type;
+  const size_t n = std::distance(first, last);
+  const std::vector<size_t> bounds = block_bounds(n);
+  const int nblocks = bounds.size() - 1;
+  if (nblocks == 1) {
+    std::sort(first, last, comp);
+    return;
+  }
+#pragma omp parallel for
+  for (int k = 0; k < nblocks; ++k) {
+    std::sort(first + bounds[k], first + bounds[k + 1], comp);
+  }
+
+  std::vector<value_type> buffer(n);
+  bool sorted_into_buffer = false;
+  for (int width = 1; width < nblocks; width *= 2) {
+    if (sorted_into_buffer) {
+      merge_blocks(buffer.begin(), first, bounds, width, comp);
+    } else {
+      merge_blocks(first, buffer.begin(), bounds, width, comp);
+    }
+    sorted_into_buffer = !sorted_into_buffer;
+  }
+
+  if (sorted_into_buffer) {
+#pragma omp parallel for
+    for (size_t i = 0; i < n; ++i) {
+      *(first + i) = buffer[i];
+    }
+  }
+}
+
+template <typename RandomIt, typename StrictWeakOrdering>
+void sort(RandomIt start, RandomIt end, StrictWeakOrdering comp,
+          std::false_type) {
+  std::sort(start, end, comp);
+}
+
+template <typename RandomIt, typename StrictWeakOrdering>
+void sort(RandomIt start, RandomIt end, StrictWeakOrdering comp,
+          std::true_type) {
+  merge_sort(start, end, comp);
+}
+
+template <typename T1, typename T2>
+void sort_by_key(T1 start_keys, T1 end_keys, T2 start_data, std::false_type) {
+  typedef zip_iterator<std::tuple<T1, T2>, mpl::vector<>> pair_zip_type;
+
+  std::sort(
+      pair_zip_type(start_keys, start_data),
+      pair_zip_type(end_keys, start_data + std::distance(start_keys, end_keys)),
+      [](auto a, auto b) {
+        return std::get<0>(a.get_tuple()) < std::get<0>(b.get_tuple());
+      });
+}
+
+/// copies the keys and data into a contiguous buffer of pairs, which is then
+/// sorted using merge_sort() and copied back
+template <typename T1, typename T2>
+void sort_by_key(T1 start_keys, T1 end_keys, T2 start_data, std::true_type) {
+  typedef typename std::iterator_traits<T1>::value_type key_type;
+  typedef typename std::iterator_traits<T2>::value_type data_type;
+  typedef std::pair<key_type, data_type> pair_type;
+
+  const size_t n = std::distance(start_keys, end_keys);
+  std::vector<pair_type> pairs(n);
+#pragma omp parallel for
+  for (size_t i = 0; i < n; ++i) {
+    pairs[i].first = *(start_keys + i);
+    pairs[i].second = *(start_data + i);
+  }
+
+  merge_sort(pairs.begin(), pairs.end(),
+             [](const pair_type &a, const pair_type &b) {
+               return a.first < b.first;
+             });
+
+#pragma omp parallel for
+  for (size_t i = 0; i < n; ++i) {
+    *(start_keys + i) = pairs[i].first;
+    *(start_data + i) = pairs[i].second;
+  }
+}
+
+} // namespace openmp
+} // namespace detail
+} // namespace Aboria
+
+#endif
@@ -275,17 +275,40 @@ template <typename labels_type, typename dx_type> struct EvalCtx {
 
     result_type sum = accum.init;
     // TODO: get query range and put it in box search
-    for (auto b = distance_search<LNormNumber>(
-             particlesb.get_query(), get<position>(ai), accum.max_distance);
-         b != false; ++b) {
-      EvalCtx<map_type, list_type> const new_ctx(
-          // fusion::make_map<label_a_type, label_b_type>(ai, *b),
-          map_type(ai, *b),
-          list_type(b.dx())); // fusion::make_list(b.dx()));
+    for_each_within_distance(
+        particlesb.get_query(), get<position>(ai), accum.max_distance,
+        [&](const_b_reference b, const double_d &dx) {
+          EvalCtx<map_type, list_type> const new_ctx(map_type(ai, b),
+                                                     list_type(dx));
+          sum = accum.functor(sum, proto::eval(expr, new_ctx));
+        },
+        mpl::int_<LNormNumber>());
+    return sum;
+  }
 
-      sum = accum.functor(sum, proto::eval(expr, new_ctx));
+  // calls f for each particle within max_distance of centre, using the
+  // distance_search iterator for a general norm
+  template <typename Query, typename Function, int LNormNumber>
+  static void
+  for_each_within_distance(const Query &query,
+                           const typename Query::double_d &centre,
+                           const double max_distance, Function f,
+                           mpl::int_<LNormNumber>) {
+    for (auto b = distance_search<LNormNumber>(query, centre, max_distance);
+         b != false; ++b) {
+      f(*b, b.dx());
     }
-    return sum;
+  }
+
+  // for the euclidean norm for_each_neighbour() visits the same particles,
+  // but runs a tight loop over each bucket rather than a search_iterator
+  template <typename Query, typename Function>
+  static void
+  for_each_within_distance(const Query &query,
+                           const typename Query::double_d &centre,
+                           const double max_distance, Function f,
+                           mpl::int_<2>) {
+    for_each_neighbour(query, centre, max_distance, f);
   }
 
   template <typename Expr>
@@ -0,0 +1,301 @@
+/*
+
+Copyright (c) 2005-2016, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Aboria.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+
+#ifndef DETAIL_GHOST_HALO_H_
+#define DETAIL_GHOST_HALO_H_
+
+#include "CudaInclude.h"
+#include "Distance.h"
+#include "SpatialUtil.h"
+#include "Vector.h"
+
+namespace Aboria {
+namespace detail {
+
+///
+/// @brief raw pointers to the ghost particles of a periodic domain
+///
+/// The ghost particles are copies of the particles that lie within a given
+/// width (the halo width) of a periodic boundary, shifted by the width of the
+/// domain so that they lie just outside the opposite boundary. Each ghost
+/// refers back to the original particle using its index in the particle set,
+/// and the ghosts are sorted into a regular grid of cells that covers the
+/// domain plus the halo.
+///
+/// This is held by each query object. A search with a radius no greater than
+/// the halo width can then search the spatial data structure as if the domain
+/// was not periodic, followed by the ghosts in the cells near the search
+/// point, rather than searching the data structure once for every periodic
+/// image of the domain. All the pointers are null if the halo has not been
+/// enabled
+///
+/// @tparam D the number of spatial dimensions
+///
+template <unsigned int D> struct ghost_halo {
+  typedef Vector<double, D> double_d;
+  typedef Vector<int, D> int_d;
+  typedef Vector<unsigned int, D> unsigned_int_d;
+
+  /// the position of each ghost, sorted by cell
+  const double_d *m_positions;
+
+  /// the index in the particle set of the particle each ghost is a copy of
+  const int *m_indices;
+
+  /// the index of the first ghost in each cell, followed by the total number
+  /// of ghosts
+  const int *m_cell_begin;
+
+  /// converts a position to the index of the cell that contains it
+  point_to_bucket_index<D> m_point_to_cell;
+
+  /// the number of cells along each dimension
+  int_d m_size;
+
+  /// the halo width
+  double m_width;
+
+  CUDA_HOST_DEVICE
+  ghost_halo()
+      : m_positions(nullptr), m_indices(nullptr), m_cell_begin(nullptr),
+        m_point_to_cell(unsigned_int_d::Constant(1), double_d::Constant(1),
+                        bbox<D>()),
+        m_size(int_d::Constant(0)), m_width(0) {}
+
+  ///
+  /// @return true if the ghost particles have been enabled
+  ///
+  CUDA_HOST_DEVICE
+  bool is_valid() const { return m_cell_begin != nullptr; }
+
+  ///
+  /// @return true if the ghost particles include every periodic image within
+  /// @p max_distance of a point in the domain
+  ///
+  CUDA_HOST_DEVICE
+  bool covers(const double max_distance) const {
+    return is_valid() && max_distance <= m_width;
+  }
+
+  ///
+  /// @brief returns the cell index of the point @p r, clamped to the grid
+  ///
+  CUDA_HOST_DEVICE
+  int_d get_cell(const double_d &r) const {
+    int_d cell = m_point_to_cell.find_bucket_index_vector(r);
+    for (size_t d = 0; d < D; ++d) {
+      cell[d] = cell[d] < 0 ? 0 : (cell[d] >= m_size[d] ? m_size[d] - 1
+                                                         : cell[d]);
+    }
+    return cell;
+  }
+
+  ///
+  /// @brief sets [@p min, @p max) to the range of cell indices that overlap
+  /// the cube of half-width @p max_distance around @p r
+  ///
+  CUDA_HOST_DEVICE
+  void get_cells_near_point(const double_d &r, const double max_distance,
+                            int_d &min, int_d &max) const {
+    min = get_cell(r - double_d::Constant(max_distance));
+    max = get_cell(r + double_d::Constant(max_distance));
+    for (size_t d = 0; d < D; ++d) {
+      ++max[d];
+    }
+  }
+
+  ///
+  /// @return the index of the first ghost in @p cell
+  ///
+  CUDA_HOST_DEVICE
+  int cell_begin(const int_d &cell) const {
+    return m_cell_begin[m_point_to_cell.collapse_index_vector(cell)];
+  }
+
+  ///
+  /// @return the index of one past the last ghost in @p cell
+  ///
+  CUDA_HOST_DEVICE
+  int cell_end(const int_d &cell) const {
+    return m_cell_begin[m_point_to_cell.collapse_index_vector(cell) + 1];
+  }
+
+  ///
+  /// @brief calls `f(particle, dx)` for each ghost within a given distance
+  /// of @p r, where `particle` is the original particle and `dx` is the
+  /// difference between the position of the ghost and @p r
+  ///
+  /// @tparam LNormNumber the norm used to measure distance
+  /// @param particles_begin pointer to the beginning of the particle set
+  ///
+  template <int LNormNumber, typename RawPointer, typename Function>
+  CUDA_HOST_DEVICE void for_each_within(const RawPointer &particles_begin,
+                                        const double_d &r,
+                                        const double max_distance,
+                                        Function &f) const {
+    const double max_accumulated =
+        distance_helper<LNormNumber>::get_value_to_accumulate(max_distance);
+    int_d min, max;
+    get_cells_near_point(r, max_distance, min, max);
+    int_d cell = min;
+    for (size_t d = 0; d < D;) {
+      for (int i = cell_begin(cell); i < cell_end(cell); ++i) {
+        const double_d dx = m_positions[i] - r;
+        double accum = 0;
+        for (size_t j = 0; j < D; ++j) {
+          accum = distance_helper<LNormNumber>::accumulate_norm(accum, dx[j]);
+        }
+        if (accum <= max_accumulated) {
+          f(*(particles_begin + m_indices[i]), dx);
+        }
+      }
+      // move to the next cell in the range
+      for (d = 0; d < D && ++cell[d] == max[d]; ++d) {
+        cell[d] = min[d];
+      }
+    }
+  }
+
+  ///
+  /// @return the number of ghosts within a given euclidean distance of @p r
+  ///
+  CUDA_HOST_DEVICE
+  size_t count_within(const double_d &r, const double max_distance) const {
+    const double max_distance2 = max_distance * max_distance;
+    size_t count = 0;
+    int_d min, max;
+    get_cells_near_point(r, max_distance, min, max);
+    int_d cell = min;
+    for (size_t d = 0; d < D;) {
+      for (int i = cell_begin(cell); i < cell_end(cell); ++i) {
+        count += (m_positions[i] - r).squaredNorm() <= max_distance2;
+      }
+      for (d = 0; d < D && ++cell[d] == max[d]; ++d) {
+        cell[d] = min[d];
+      }
+    }
+    return count;
+  }
+};
+
+///
+/// @brief A function object that generates the ghost particles of a periodic
+/// domain (see ghost_halo)
+///
+/// A particle within the halo width of the lower boundary of a periodic
+/// dimension has a ghost shifted up by the domain width, and one within the
+/// halo width of the upper boundary has a ghost shifted down. Particles near
+/// a corner or edge of the domain also have ghosts shifted along more than
+/// one dimension
+///
+/// @tparam D the number of spatial dimensions
+///
+template <unsigned int D> struct ghost_halo_generator {
+  typedef Vector<double, D> double_d;
+  typedef Vector<int, D> int_d;
+  typedef Vector<bool, D> bool_d;
+
+  bbox<D> m_bounds;
+  bool_d m_periodic;
+  ghost_halo<D> m_halo;
+
+  ghost_halo_generator(const bbox<D> &bounds, const bool_d &periodic,
+                       const ghost_halo<D> &halo)
+      : m_bounds(bounds), m_periodic(periodic), m_halo(halo) {}
+
+  ///
+  /// @brief sets [@p min, @p max) to the range of periodic shifts (in units
+  /// of the domain width) for which the image of @p p lies in the halo
+  ///
+  CUDA_HOST_DEVICE
+  void get_shifts(const double_d &p, int_d &min, int_d &max) const {
+    for (size_t d = 0; d < D; ++d) {
+      const bool periodic = m_periodic[d];
+      min[d] = periodic && p[d] >= m_bounds.bmax[d] - m_halo.m_width ? -1 : 0;
+      max[d] = periodic && p[d] < m_bounds.bmin[d] + m_halo.m_width ? 2 : 1;
+    }
+  }
+
+  ///
+  /// @return the number of ghosts of the particle at @p p
+  ///
+  CUDA_HOST_DEVICE
+  int operator()(const double_d &p) const {
+    int_d min, max;
+    get_shifts(p, min, max);
+    int n = 1;
+    for (size_t d = 0; d < D; ++d) {
+      n *= max[d] - min[d];
+    }
+    return n - 1;
+  }
+
+  ///
+  /// @brief writes the ghosts of the particle with index @p index and position
+  /// @p p to @p positions, @p indices and (the cell of each ghost) @p cells,
+  /// starting at index @p first
+  ///
+  CUDA_HOST_DEVICE
+  void generate(const double_d &p, const int index, const int first,
+                double_d *positions, int *indices, int *cells) const {
+    int_d min, max;
+    get_shifts(p, min, max);
+    const double_d width = m_bounds.bmax - m_bounds.bmin;
+    int_d shift = min;
+    int i = first;
+    for (size_t d = 0; d < D;) {
+      bool is_image = false;
+      for (size_t j = 0; j < D; ++j) {
+        is_image |= shift[j] != 0;
+      }
+      if (is_image) {
+        positions[i] = p + shift * width;
+        indices[i] = index;
+        cells[i] = m_halo.m_point_to_cell.collapse_index_vector(
+            m_halo.get_cell(positions[i]));
+        ++i;
+      }
+      for (d = 0; d < D && ++shift[d] == max[d]; ++d) {
+        shift[d] = min[d];
+      }
+    }
+  }
+};
+
+} // namespace detail
+} // namespace Aboria
+
+#endif // DETAIL_GHOST_HALO_H_
@@ -0,0 +1,125 @@
+/*
+
+Copyright (c) 2005-2016, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Aboria.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef DETAIL_ID_MAP_H_
+#define DETAIL_ID_MAP_H_
+
+#include "Algorithms.h"
+#include "CudaInclude.h"
+#include <cstdint>
+#include <limits>
+
+namespace Aboria {
+namespace detail {
+
+///
+/// @brief raw pointers to a table that maps particle ids to indices into the
+/// particle set.
+///
+/// For host vectors this is an open-addressing hash table. It uses linear
+/// probing, and has a power-of-two number of slots that is at least twice
+/// the number of particles, so a probe sequence always ends at an empty
+/// slot. Empty slots have a key of empty_key().
+///
+/// Otherwise (e.g. for thrust device vectors) the table can be built in
+/// parallel, so it is instead a pair of key and value vectors sorted by key
+/// (#m_sorted is true), and lookups use a binary search.
+///
+/// The table is owned (and kept up to date) by neighbour_search_base, this
+/// object is held by each query object to perform the lookups
+///
+struct id_map_table {
+  const size_t *m_keys;
+  const size_t *m_values;
+  size_t m_mask;
+  size_t m_size;
+  bool m_sorted;
+
+  CUDA_HOST_DEVICE
+  id_map_table()
+      : m_keys(nullptr), m_values(nullptr), m_mask(0), m_size(0),
+        m_sorted(false) {}
+
+  ///
+  /// @return the key used to mark an empty slot
+  ///
+  CUDA_HOST_DEVICE
+  static size_t empty_key() { return std::numeric_limits<size_t>::max(); }
+
+  ///
+  /// @return the slot at the start of the probe sequence for @p id, before
+  /// masking by the table size
+  ///
+  /// Particle ids are normally consecutive integers, so these are spread
+  /// over the table using Fibonacci hashing
+  ///
+  CUDA_HOST_DEVICE
+  static size_t hash(const size_t id) {
+    const uint64_t h = static_cast<uint64_t>(id) * 0x9E3779B97F4A7C15ull;
+    return static_cast<size_t>(h ^ (h >> 32));
+  }
+
+  ///
+  /// @return the index of the particle with id @p id, or @p not_found if
+  /// there is no such particle (or the table has not been created)
+  ///
+  CUDA_HOST_DEVICE
+  size_t find(const size_t id, const size_t not_found) const {
+    if (m_keys == nullptr) {
+      return not_found;
+    }
+    if (m_sorted) {
+      const size_t *last = m_keys + m_size;
+      const size_t *first = detail::lower_bound(m_keys, last, id);
+      if ((first != last) && !(id < *first)) {
+        return m_values[first - m_keys];
+      } else {
+        return not_found;
+      }
+    }
+    for (size_t slot = hash(id) & m_mask;; slot = (slot + 1) & m_mask) {
+      if (m_keys[slot] == id) {
+        return m_values[slot];
+      } else if (m_keys[slot] == empty_key()) {
+        return not_found;
+      }
+    }
+  }
+};
+
+} // namespace detail
+} // namespace Aboria
+
+#endif // DETAIL_ID_MAP_H_
@@ -0,0 +1,183 @@
+/*
+
+Copyright (c) 2005-2016, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Aboria.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef DETAIL_POSITION_SOA_H_
+#define DETAIL_POSITION_SOA_H_
+
+#include "CudaInclude.h"
+#include "Distance.h"
+#include "Vector.h"
+
+namespace Aboria {
+namespace detail {
+
+///
+/// @brief raw pointers to a copy of the particle positions stored as a
+/// structure-of-arrays, i.e. one contiguous array per spatial dimension.
+///
+/// This is held by each query object, so that kernels scanning a contiguous
+/// range of particles (e.g. the contents of a bucket) can load each
+/// coordinate with unit stride, allowing the compiler to vectorise the
+/// distance calculations. All the pointers are null if the
+/// structure-of-arrays copy has not been enabled
+///
+/// @tparam D the number of spatial dimensions
+///
+template <unsigned int D> struct position_soa {
+  typedef Vector<double, D> double_d;
+
+  const double *m_data[D];
+
+  CUDA_HOST_DEVICE
+  position_soa() {
+    for (size_t d = 0; d < D; ++d) {
+      m_data[d] = nullptr;
+    }
+  }
+
+  ///
+  /// @return true if the structure-of-arrays positions have been enabled
+  ///
+  CUDA_HOST_DEVICE
+  bool is_valid() const { return m_data[0] != nullptr; }
+
+  ///
+  /// @return a pointer to the array of coordinates along dimension @p d
+  ///
+  CUDA_HOST_DEVICE
+  const double *operator[](const size_t d) const { return m_data[d]; }
+
+  ///
+  /// @return the position of the particle with index @p i
+  ///
+  CUDA_HOST_DEVICE
+  double_d get(const size_t i) const {
+    double_d p;
+    for (size_t d = 0; d < D; ++d) {
+      p[d] = m_data[d][i];
+    }
+    return p;
+  }
+
+  ///
+  /// @brief the number of particles processed at once by count_within() and
+  /// within()
+  ///
+  static const size_t block_size = 64;
+
+  ///
+  /// @brief for each particle with index i in [@p first, @p first + @p n),
+  /// sets `accum[i - first]` to the distance between the particle and @p r,
+  /// as accumulated by distance_helper. Each dimension is accumulated in
+  /// turn, so that the inner loop is over contiguous coordinates and can be
+  /// vectorised
+  ///
+  template <int LNormNumber>
+  CUDA_HOST_DEVICE void accumulate_distance(const size_t first,
+                                            const size_t n,
+                                            const double_d &r,
+                                            double *accum) const {
+    for (size_t j = 0; j < n; ++j) {
+      accum[j] = 0;
+    }
+    for (size_t d = 0; d < D; ++d) {
+      const double *x = m_data[d] + first;
+      const double rd = r[d];
+#ifdef HAVE_OPENMP
+#pragma omp simd
+#endif
+      for (size_t j = 0; j < n; ++j) {
+        accum[j] =
+            distance_helper<LNormNumber>::accumulate_norm(accum[j], x[j] - rd);
+      }
+    }
+  }
+
+  ///
+  /// @brief counts the particles with indices in [@p first, @p last) that are
+  /// within a given distance of @p r
+  ///
+  /// @tparam LNormNumber the norm used to measure distance
+  /// @param max_accumulated the search distance raised to the power of @p
+  /// LNormNumber, as accumulated by distance_helper
+  ///
+  template <int LNormNumber>
+  CUDA_HOST_DEVICE size_t count_within(const size_t first, const size_t last,
+                                       const double_d &r,
+                                       const double max_accumulated) const {
+    const size_t max_n = block_size;
+    double accum[block_size];
+    size_t count = 0;
+    for (size_t block_first = first; block_first < last;
+         block_first += max_n) {
+      const size_t n =
+          last - block_first < max_n ? last - block_first : max_n;
+      accumulate_distance<LNormNumber>(block_first, n, r, accum);
+      for (size_t j = 0; j < n; ++j) {
+        count += accum[j] <= max_accumulated;
+      }
+    }
+    return count;
+  }
+
+  ///
+  /// @brief for each particle with index i in [@p first, @p last), sets
+  /// `within[i - first]` to 1 if the particle is within a given distance of
+  /// @p r, or 0 otherwise
+  ///
+  /// @see count_within()
+  ///
+  template <int LNormNumber>
+  CUDA_HOST_DEVICE void within(const size_t first, const size_t last,
+                               const double_d &r, const double max_accumulated,
+                               int *within) const {
+    const size_t max_n = block_size;
+    double accum[block_size];
+    for (size_t block_first = first; block_first < last;
+         block_first += max_n) {
+      const size_t n =
+          last - block_first < max_n ? last - block_first : max_n;
+      accumulate_distance<LNormNumber>(block_first, n, r, accum);
+      for (size_t j = 0; j < n; ++j) {
+        within[block_first - first + j] = accum[j] <= max_accumulated;
+      }
+    }
+  }
+};
+
+} // namespace detail
+} // namespace Aboria
+
+#endif // DETAIL_POSITION_SOA_H_
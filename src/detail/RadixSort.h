@@ -0,0 +1,214 @@
+/*
+
+Copyright (c) 2005-2016, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Aboria.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef RADIX_SORT_H_
+#define RADIX_SORT_H_
+
+#include <algorithm>
+#include <array>
+#include <boost/iterator/iterator_categories.hpp>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#ifdef HAVE_OPENMP
+#include <omp.h>
+#endif
+
+namespace Aboria {
+namespace detail {
+
+/// true_type if a sort_by_key over keys \p KeyIterator and data \p
+/// DataIterator can use radix_sort_by_key(), i.e. the keys are integers and
+/// both iterators are random access
+template <typename KeyIterator, typename DataIterator>
+struct is_radix_sortable
+    : std::integral_constant<
+          bool,
+          std::is_integral<typename std::iterator_traits<
+              KeyIterator>::value_type>::value &&
+              !std::is_same<typename std::iterator_traits<
+                                KeyIterator>::value_type,
+                            bool>::value &&
+              std::is_convertible<
+                  typename boost::iterators::iterator_traversal<
+                      KeyIterator>::type,
+                  boost::iterators::random_access_traversal_tag>::value &&
+              std::is_convertible<
+                  typename boost::iterators::iterator_traversal<
+                      DataIterator>::type,
+                  boost::iterators::random_access_traversal_tag>::value> {};
+
+/// maps integer keys to unsigned integers with the same ordering, by
+/// flipping the sign bit of signed keys
+template <typename Key> struct radix_key {
+  typedef typename std::make_unsigned<Key>::type type;
+  static const type sign_bit =
+      std::is_signed<Key>::value
+          ? type(1) << (std::numeric_limits<type>::digits - 1)
+          : type(0);
+
+  static type to_radix(const Key key) { return type(key) ^ sign_bit; }
+  static Key from_radix(const type key) { return Key(key ^ sign_bit); }
+};
+
+///
+/// @brief stable least-significant-digit radix sort of the keys in [\p
+/// keys_first, \p keys_last), with the same permutation applied to the data
+/// starting at \p data_first.
+///
+/// The keys are sorted one 8-bit digit at a time. Only the digits in which
+/// the keys actually differ are sorted, so bounded keys (e.g. bucket indices)
+/// only need one pass per significant byte. If HAVE_OPENMP is defined each
+/// pass is split into one block per thread, with each thread computing a
+/// histogram of its block and then scattering its block into place
+///
+template <typename KeyIterator, typename DataIterator>
+void radix_sort_by_key(KeyIterator keys_first, KeyIterator keys_last,
+                       DataIterator data_first) {
+  typedef typename std::iterator_traits<KeyIterator>::value_type key_type;
+  typedef typename std::iterator_traits<DataIterator>::value_type data_type;
+  typedef radix_key<key_type> radix_key_type;
+  typedef typename radix_key_type::type unsigned_key_type;
+  const int bits_per_pass = 8;
+  const size_t nbuckets = 1 << bits_per_pass;
+  const unsigned_key_type digit_mask = nbuckets - 1;
+  typedef std::array<size_t, 1 << bits_per_pass> histogram_type;
+
+  const size_t n = std::distance(keys_first, keys_last);
+  if (n < 2) {
+    return;
+  }
+
+#ifdef HAVE_OPENMP
+  const size_t nblocks =
+      std::max(size_t(1), std::min(n, size_t(omp_get_max_threads())));
+#else
+  const size_t nblocks = 1;
+#endif
+  std::vector<size_t> bounds(nblocks + 1);
+  for (size_t k = 0; k <= nblocks; ++k) {
+    bounds[k] = (k * n) / nblocks;
+  }
+
+  std::vector<unsigned_key_type> keys(n), keys_tmp(n);
+  std::vector<data_type> data(n), data_tmp(n);
+  std::vector<unsigned_key_type> differing_bits(nblocks, 0);
+  const unsigned_key_type first_key = radix_key_type::to_radix(*keys_first);
+#ifdef HAVE_OPENMP
+#pragma omp parallel for
+#endif
+  for (size_t k = 0; k < nblocks; ++k) {
+    for (size_t i = bounds[k]; i < bounds[k + 1]; ++i) {
+      keys[i] = radix_key_type::to_radix(*(keys_first + i));
+      data[i] = *(data_first + i);
+      differing_bits[k] |= keys[i] ^ first_key;
+    }
+  }
+
+  // only need to sort up to the most significant bit that differs
+  unsigned_key_type differing = 0;
+  for (size_t k = 0; k < nblocks; ++k) {
+    differing |= differing_bits[k];
+  }
+  int nbits = 0;
+  while (differing != 0) {
+    differing >>= 1;
+    ++nbits;
+  }
+
+  std::vector<histogram_type> histograms(nblocks);
+  for (int shift = 0; shift < nbits; shift += bits_per_pass) {
+#ifdef HAVE_OPENMP
+#pragma omp parallel for
+#endif
+    for (size_t k = 0; k < nblocks; ++k) {
+      histogram_type &histogram = histograms[k];
+      std::fill(histogram.begin(), histogram.end(), 0);
+      for (size_t i = bounds[k]; i < bounds[k + 1]; ++i) {
+        ++histogram[(keys[i] >> shift) & digit_mask];
+      }
+    }
+
+    // convert histograms to offsets, ordered by digit then block so that
+    // the sort is stable. Skip the pass if all keys share the same digit
+    bool all_same_digit = false;
+    size_t offset = 0;
+    for (size_t digit = 0; digit < nbuckets; ++digit) {
+      size_t count = 0;
+      for (size_t k = 0; k < nblocks; ++k) {
+        const size_t block_count = histograms[k][digit];
+        histograms[k][digit] = offset;
+        offset += block_count;
+        count += block_count;
+      }
+      if (count == n) {
+        all_same_digit = true;
+        break;
+      }
+    }
+    if (all_same_digit) {
+      continue;
+    }
+
+#ifdef HAVE_OPENMP
+#pragma omp parallel for
+#endif
+    for (size_t k = 0; k < nblocks; ++k) {
+      histogram_type &offsets = histograms[k];
+      for (size_t i = bounds[k]; i < bounds[k + 1]; ++i) {
+        const size_t new_index = offsets[(keys[i] >> shift) & digit_mask]++;
+        keys_tmp[new_index] = keys[i];
+        data_tmp[new_index] = data[i];
+      }
+    }
+    keys.swap(keys_tmp);
+    data.swap(data_tmp);
+  }
+
+#ifdef HAVE_OPENMP
+#pragma omp parallel for
+#endif
+  for (size_t i = 0; i < n; ++i) {
+    *(keys_first + i) = radix_key_type::from_radix(keys[i]);
+    *(data_first + i) = data[i];
+  }
+}
+
+} // namespace detail
+} // namespace Aboria
+
+#endif
@@ -7,6 +7,7 @@
 #include "Vector.h"
 
 #include <bitset>  // std::bitset
+#include <cstdint>
 #include <iomanip> // std::setw
 #include <limits>
 
@@ -192,10 +193,11 @@ inline CUDA_HOST_DEVICE int get_leaf_id(int offset) {
 
 inline CUDA_HOST_DEVICE int get_leaf_offset(int id) { return 0x80000000 ^ id; }
 
-inline CUDA_HOST_DEVICE int child_tag_mask(int tag, int which_child, int level,
-                                           int max_level, unsigned int D) {
+inline CUDA_HOST_DEVICE size_t child_tag_mask(size_t tag, int which_child,
+                                              int level, int max_level,
+                                              unsigned int D) {
   int shift = (max_level - level) * D;
-  return tag | (which_child << shift);
+  return tag | (static_cast<size_t>(which_child) << shift);
 }
 
 template <int CODE> struct is_a {
@@ -205,40 +207,192 @@ template <int CODE> struct is_a {
   }
 };
 
+/// spreads the bits of \p x out so that there are \p D-1 zero bits between
+/// each of them, i.e. bit \f$b\f$ of \p x is moved to bit \f$Db\f$ of the
+/// result. Bits that would not fit in 64 bits are discarded
+template <unsigned int D> struct spread_bits {
+  CUDA_HOST_DEVICE
+  uint64_t operator()(const uint64_t x) const {
+    uint64_t result = 0;
+    for (unsigned int b = 0; b < 64 / D; ++b) {
+      result |= ((x >> b) & 1u) << (D * b);
+    }
+    return result;
+  }
+};
+
+template <> struct spread_bits<1> {
+  CUDA_HOST_DEVICE
+  uint64_t operator()(const uint64_t x) const { return x; }
+};
+
+/// magic-number bit spreading of the lower 32 bits
+template <> struct spread_bits<2> {
+  CUDA_HOST_DEVICE
+  uint64_t operator()(uint64_t x) const {
+    x &= 0x00000000ffffffffull;
+    x = (x | (x << 16)) & 0x0000ffff0000ffffull;
+    x = (x | (x << 8)) & 0x00ff00ff00ff00ffull;
+    x = (x | (x << 4)) & 0x0f0f0f0f0f0f0f0full;
+    x = (x | (x << 2)) & 0x3333333333333333ull;
+    x = (x | (x << 1)) & 0x5555555555555555ull;
+    return x;
+  }
+};
+
+/// magic-number bit spreading of the lower 21 bits
+template <> struct spread_bits<3> {
+  CUDA_HOST_DEVICE
+  uint64_t operator()(uint64_t x) const {
+    x &= 0x00000000001fffffull;
+    x = (x | (x << 32)) & 0x001f00000000ffffull;
+    x = (x | (x << 16)) & 0x001f0000ff0000ffull;
+    x = (x | (x << 8)) & 0x100f00f00f00f00full;
+    x = (x | (x << 4)) & 0x10c30c30c30c30c3ull;
+    x = (x | (x << 2)) & 0x1249249249249249ull;
+    return x;
+  }
+};
+
+/// interleave the lowest \p bits bits of each index in \p index, so that for
+/// each bit level dimension 0 ends up in the most significant position
 template <unsigned int D>
-CUDA_HOST_DEVICE int point_to_tag(const Vector<double, D> &p, bbox<D> box,
-                                  int max_level) {
-  typedef Vector<double, D> double_d;
-  typedef Vector<int, D> int_d;
-  int result = 0;
+CUDA_HOST_DEVICE size_t morton_key(const Vector<unsigned int, D> &index,
+                                   const unsigned int bits) {
+  const uint64_t mask = (uint64_t(1) << bits) - 1;
+  uint64_t result = 0;
+  for (size_t i = 0; i < D; ++i) {
+    result |= spread_bits<D>()(index[i] & mask) << (D - 1 - i);
+  }
+  return static_cast<size_t>(result);
+}
 
-  for (int level = 1; level <= max_level; ++level) {
-    double_d mid;
-    int_d hi_half;
+/// the maximum number of levels in a tree that uses point_to_tag(), so that
+/// the tag fits in 64 bits and the index along each dimension fits in an
+/// unsigned int
+inline CUDA_HOST_DEVICE constexpr int get_max_tag_level(unsigned int D) {
+  return 63 / D < 31 ? 63 / D : 31;
+}
 
+/// returns the tag of the \p max_level level hyper oct-tree node in \p box
+/// that contains \p p, which is the morton_key() of the point's bucket in a
+/// regular grid with \f$2^{max\_level}\f$ buckets along each dimension.
+/// Points outside \p box are clamped to the nearest bucket
+template <unsigned int D>
+CUDA_HOST_DEVICE size_t point_to_tag(const Vector<double, D> &p,
+                                     const bbox<D> &box, int max_level) {
+  typedef Vector<unsigned int, D> unsigned_int_d;
+  const double n = static_cast<double>(uint64_t(1) << max_level);
+  unsigned_int_d index;
+  for (size_t i = 0; i < D; ++i) {
+    const double x = n * (p[i] - box.bmin[i]) / (box.bmax[i] - box.bmin[i]);
+    index[i] = x < 0 ? 0
+                     : (x < n ? static_cast<unsigned int>(x)
+                              : static_cast<unsigned int>(n - 1));
+  }
+  return morton_key(index, max_level);
+}
+
+/// position of \p index along a \p D dimensional Hilbert curve of order \p
+/// bits. This is Skilling's "AxesToTranspose" algorithm (J. Skilling,
+/// "Programming the Hilbert curve", AIP Conf. Proc. 707, 2004), followed by
+/// interleaving the transposed bits using morton_key()
+template <unsigned int D>
+CUDA_HOST_DEVICE size_t hilbert_key(Vector<unsigned int, D> index,
+                                    const unsigned int bits) {
+  const unsigned int M = 1u << (bits - 1);
+
+  // inverse undo
+  for (unsigned int Q = M; Q > 1; Q >>= 1) {
+    const unsigned int P = Q - 1;
     for (size_t i = 0; i < D; ++i) {
-      // Classify in i-direction
-      mid[i] = 0.5f * (box.bmin[i] + box.bmax[i]);
-      hi_half[i] = (p[i] < mid[i]) ? 0 : 1;
+      if (index[i] & Q) {
+        index[0] ^= P;
+      } else {
+        const unsigned int t = (index[0] ^ index[i]) & P;
+        index[0] ^= t;
+        index[i] ^= t;
+      }
+    }
+  }
 
-      // Push the bit into the result as we build it
-      result |= hi_half[i];
-      result <<= 1;
+  // gray encode
+  for (size_t i = 1; i < D; ++i) {
+    index[i] ^= index[i - 1];
+  }
+  unsigned int t = 0;
+  for (unsigned int Q = M; Q > 1; Q >>= 1) {
+    if (index[D - 1] & Q) {
+      t ^= Q - 1;
     }
+  }
+  for (size_t i = 0; i < D; ++i) {
+    index[i] ^= t;
+  }
+
+  return morton_key(index, bits);
+}
+
+///
+/// @brief maps a point to its position along a space filling curve
+///
+/// The domain \p bounds is split into a regular grid of \f$2^b\f$ buckets
+/// along each dimension (using point_to_bucket_index), and the key is the
+/// position of the point's bucket along either a Morton (z-order) or Hilbert
+/// curve through the grid. Points outside the domain are clamped to the
+/// nearest bucket
+///
+template <unsigned int D> struct space_filling_curve_key {
+  typedef Vector<double, D> double_d;
+  typedef Vector<int, D> int_d;
+  typedef Vector<unsigned int, D> unsigned_int_d;
+
+  /// number of bits per dimension, chosen so that the key fits in a size_t
+  /// and the bucket indices fit in an int
+  static const unsigned int bits =
+      (sizeof(size_t) * 8 - 1) / D < 21 ? (sizeof(size_t) * 8 - 1) / D : 21;
 
-    // Shrink the bounding box, still encapsulating the point
+  point_to_bucket_index<D> m_point_to_bucket_index;
+  bool m_hilbert;
+
+  CUDA_HOST_DEVICE
+  space_filling_curve_key(){};
+
+  CUDA_HOST_DEVICE
+  space_filling_curve_key(const bbox<D> &bounds, const bool hilbert)
+      : m_point_to_bucket_index(
+            unsigned_int_d::Constant(1u << bits),
+            (bounds.bmax - bounds.bmin) / static_cast<double>(1u << bits),
+            bounds),
+        m_hilbert(hilbert) {}
+
+  CUDA_HOST_DEVICE
+  size_t operator()(const double_d &r) const {
+    const int max_index = (1 << bits) - 1;
+    const int_d index = m_point_to_bucket_index.find_bucket_index_vector(r);
+    unsigned_int_d clamped_index;
     for (size_t i = 0; i < D; ++i) {
-      box.bmin[i] = (hi_half[i]) ? mid[i] : box.bmin[i];
-      box.bmax[i] = (hi_half[i]) ? box.bmax[i] : mid[i];
+      clamped_index[i] =
+          index[i] < 0 ? 0 : (index[i] > max_index ? max_index : index[i]);
     }
+    return m_hilbert ? hilbert_key(clamped_index, bits)
+                     : morton_key(clamped_index, bits);
   }
-  // Unshift the last
-  result >>= 1;
+};
 
-  return result;
-}
+/// returns 1 if the key at index \p i is greater than the key at index \p i+1
+template <typename T> struct is_descending {
+  const T *m_keys;
+
+  is_descending(const T *keys) : m_keys(keys) {}
+
+  CUDA_HOST_DEVICE
+  int operator()(const int i) const {
+    return m_keys[i] > m_keys[i + 1] ? 1 : 0;
+  }
+};
 
-template <unsigned int D> void print_tag(int tag, int max_level) {
+template <unsigned int D> void print_tag(size_t tag, int max_level) {
   for (int level = 1; level <= max_level; ++level) {
     std::bitset<D> bits = tag >> (max_level - level) * D;
     std::cout << bits << " ";
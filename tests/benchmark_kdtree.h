@@ -0,0 +1,106 @@
+/*
+
+Copyright (c) 2005-2016, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Aboria.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef BENCHMARK_KDTREE_H_
+#define BENCHMARK_KDTREE_H_
+
+#include "Aboria.h"
+#include <chrono>
+#include <cxxtest/TestSuite.h>
+typedef std::chrono::system_clock Clock;
+#include <fstream> // std::ofstream
+#include <iomanip>
+
+using namespace Aboria;
+
+class BenchmarkKdtree : public CxxTest::TestSuite {
+public:
+  template <unsigned int D>
+  double build(const size_t N, const bool build_by_selection,
+               const size_t repeats) {
+    typedef Vector<double, D> double_d;
+    typedef Vector<bool, D> bool_d;
+    typedef Particles<std::tuple<>, D, std::vector, Kdtree> particles_t;
+    typedef typename particles_t::position position;
+    std::cout << "kdtree build: D = " << D << " N = " << N
+              << " build_by_selection = " << build_by_selection
+              << " repeats = " << repeats << std::endl;
+    particles_t particles(N);
+
+    std::default_random_engine gen;
+    std::uniform_real_distribution<double> uniform(0, 1);
+    for (size_t i = 0; i < N; ++i) {
+      for (size_t d = 0; d < D; ++d) {
+        get<position>(particles)[i][d] = uniform(gen);
+      }
+    }
+    particles.set_build_by_selection(build_by_selection);
+
+    auto t0 = Clock::now();
+    for (size_t i = 0; i < repeats; ++i) {
+      particles.init_neighbour_search(double_d::Constant(0),
+                                      double_d::Constant(1),
+                                      bool_d::Constant(false));
+    }
+    auto t1 = Clock::now();
+    std::chrono::duration<double> time = t1 - t0;
+    std::cout << "time = " << time.count() / repeats << std::endl;
+    return time.count() / repeats;
+  }
+
+  template <unsigned int D> void helper_build() {
+    std::ofstream file;
+    const size_t base_repeats = 1e6;
+    file.open("benchmark_kdtree_build" + std::to_string(D) + ".csv");
+    file << "#" << std::setw(14) << "N" << std::setw(15) << "build_tree"
+         << std::setw(15) << "selection" << std::endl;
+    for (double i = 1000; i < 2e6; i *= 2) {
+      const size_t N = i;
+      const size_t repeats = base_repeats / N + 1;
+      file << std::setw(15) << N;
+      file << std::setw(15) << build<D>(N, false, repeats);
+      file << std::setw(15) << build<D>(N, true, repeats);
+      file << std::endl;
+    }
+    file.close();
+  }
+
+  void test_build() {
+    helper_build<2>();
+    helper_build<3>();
+  }
+};
+
+#endif /* BENCHMARK_KDTREE_H_ */
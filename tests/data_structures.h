@@ -478,6 +478,111 @@ public:
 #endif // HAVE_CAIRO
   }
 
+  template <unsigned int D, unsigned int SelfD>
+  void helper_bounding_volume_hierarchy(const int N) {
+    ABORIA_VARIABLE(connections, std::vector<size_t>, "element connections")
+    typedef Particles<std::tuple<connections>, D> particles_type;
+    typedef Elements<particles_type, connections, std::tuple<>, SelfD>
+        elements_type;
+    typedef typename elements_type::particles element_particles;
+    typedef position_d<D> position;
+    typedef Vector<double, D> double_d;
+    typedef bbox<D> box_type;
+
+    std::cout << "bounding volume hierarchy test (D=" << D
+              << " SelfD=" << SelfD << " N=" << N << "):" << std::endl;
+
+    // N small elements scattered over the unit cube
+    generator_type gen(N);
+    std::uniform_real_distribution<double> uniform(0, 1);
+    std::uniform_real_distribution<double> small(-0.02, 0.02);
+    particles_type particles(N * SelfD);
+    for (int i = 0; i < N; ++i) {
+      double_d centre;
+      for (size_t d = 0; d < D; ++d) {
+        centre[d] = uniform(gen);
+      }
+      for (size_t k = 0; k < SelfD; ++k) {
+        for (size_t d = 0; d < D; ++d) {
+          get<position>(particles)[i * SelfD + k][d] = centre[d] + small(gen);
+        }
+      }
+    }
+    particles.init_id_search();
+
+    elements_type elements(particles);
+    for (int i = 0; i < N; ++i) {
+      typename elements_type::value_type element;
+      for (size_t k = 0; k < SelfD; ++k) {
+        get<element_particles>(element)[k] = i * SelfD + k;
+      }
+      elements.push_back(element);
+    }
+
+    BoundingVolumeHierarchy<elements_type> bvh(elements);
+    TS_ASSERT_EQUALS(bvh.size(), N);
+
+    const double radius = 0.05;
+    for (int q = 0; q < 100; ++q) {
+      double_d p;
+      for (size_t d = 0; d < D; ++d) {
+        p[d] = uniform(gen);
+      }
+      const box_type box(p - double_d::Constant(radius),
+                         p + double_d::Constant(radius));
+
+      int brute_within = 0;
+      int brute_intersecting = 0;
+      int brute_closest = -1;
+      double brute_closest_distance = std::numeric_limits<double>::max();
+      for (int i = 0; i < N; ++i) {
+        const double distance = bvh.distance(i, p);
+        if (distance <= radius) {
+          ++brute_within;
+        }
+        if (distance < brute_closest_distance) {
+          brute_closest = i;
+          brute_closest_distance = distance;
+        }
+        const box_type bounds = bvh.get_element_bounds(i);
+        bool intersects = true;
+        for (size_t d = 0; d < D; ++d) {
+          intersects &= bounds.bmin[d] <= box.bmax[d] &&
+                        box.bmin[d] <= bounds.bmax[d];
+        }
+        if (intersects) {
+          ++brute_intersecting;
+        }
+
+        // the distance is a lower bound for points on the element
+        double_d sample = double_d::Constant(0);
+        double weight_sum = 0;
+        for (size_t k = 0; k < SelfD; ++k) {
+          const double weight = uniform(gen);
+          sample += weight * get<position>(particles)[i * SelfD + k];
+          weight_sum += weight;
+        }
+        TS_ASSERT_LESS_THAN_EQUALS(distance - 1e-10,
+                                   (sample / weight_sum - p).norm());
+      }
+
+      int within = 0;
+      bvh.for_each_within(p, radius, [&](const int i, const double distance) {
+        TS_ASSERT_DELTA(distance, bvh.distance(i, p), 1e-12);
+        ++within;
+      });
+      TS_ASSERT_EQUALS(within, brute_within);
+
+      int intersecting = 0;
+      bvh.for_each_intersecting(box, [&](const int i) { ++intersecting; });
+      TS_ASSERT_EQUALS(intersecting, brute_intersecting);
+
+      const auto closest = bvh.closest_element(p);
+      TS_ASSERT_EQUALS(closest.first, brute_closest);
+      TS_ASSERT_DELTA(closest.second, brute_closest_distance, 1e-12);
+    }
+  }
+
   void test_visualise_data_structures() {
     draw_data_structure<CellList>();
     draw_data_structure<CellListOrdered>();
@@ -502,6 +607,12 @@ public:
     std::cout << "kd tree" << std::endl;
     helper_data_structure<std::vector, Kdtree>();
   }
+
+  void test_BoundingVolumeHierarchy() {
+    helper_bounding_volume_hierarchy<2, 2>(1000);
+    helper_bounding_volume_hierarchy<3, 3>(1000);
+    helper_bounding_volume_hierarchy<3, 2>(500);
+  }
 };
 
 #endif /* SPATIAL_DATA_STRUCTURES_H_ */
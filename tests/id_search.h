@@ -103,10 +103,11 @@ public:
 
 /*`
 Finally, a note on performance: The id search is done by internally creating
-vectors of id and indicies ordered by id. Keeping these vectors ordered at each
-call to [memberref Aboria::Particles::update_positions] takes O(Nlog(N)). The
-call to `find` performs a binary search on the ordered vectors, with takes
-O(log(N)) time.
+a hash table that maps each id to the index of that particle. At each call to
+[memberref Aboria::Particles::update_positions], only the entries of particles
+that have been added, deleted or moved are updated, which takes at most O(N)
+time. The call to `find` performs a lookup in the hash table, which takes O(1)
+time.
 
 [endsect]
 
@@ -304,9 +305,89 @@ O(log(N)) time.
               << " versus brute force = " << dt_brute.count() << std::endl;
   }
 
+  template <typename ParticlesType>
+  void check_all_ids(const ParticlesType &particles,
+                     const std::vector<size_t> &deleted_ids) {
+    auto query = particles.get_query();
+    auto end = query.get_particles_begin() + query.number_of_particles();
+    for (size_t i = 0; i < particles.size(); ++i) {
+      auto result = query.find(get<id>(particles)[i]);
+      TS_ASSERT_EQUALS(
+          static_cast<size_t>(result - query.get_particles_begin()), i);
+    }
+    for (size_t deleted_id : deleted_ids) {
+      TS_ASSERT(query.find(deleted_id) == end);
+    }
+  }
+
+  template <unsigned int D, template <typename, typename> class VectorType,
+            template <typename> class SearchMethod>
+  void helper_id_map_updates(const int N) {
+    typedef Particles<std::tuple<>, D, VectorType, SearchMethod>
+        particles_type;
+    typedef position_d<D> position;
+    typedef Vector<double, D> double_d;
+    typedef Vector<bool, D> bool_d;
+
+    std::cout << "id map updates (D=" << D << " N=" << N << "):" << std::endl;
+
+    particles_type particles(N);
+    generator_type gen(42);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    for (int i = 0; i < N; ++i) {
+      double_d x;
+      for (size_t d = 0; d < D; ++d) {
+        x[d] = uniform(gen);
+      }
+      get<position>(particles)[i] = x;
+    }
+    particles.init_neighbour_search(double_d::Constant(0),
+                                    double_d::Constant(1),
+                                    bool_d::Constant(true));
+    particles.init_id_search();
+    std::vector<size_t> deleted_ids;
+    check_all_ids(particles, deleted_ids);
+
+    for (int step = 0; step < 5; ++step) {
+      // move the particles, reordering them for ordered data structures
+      for (size_t i = 0; i < particles.size(); ++i) {
+        double_d x = get<position>(particles)[i];
+        for (size_t d = 0; d < D; ++d) {
+          x[d] += 0.1 * (uniform(gen) - 0.5);
+        }
+        get<position>(particles)[i] = x;
+      }
+      particles.update_positions();
+      check_all_ids(particles, deleted_ids);
+
+      // delete some particles
+      std::uniform_int_distribution<int> uniform_index(0,
+                                                       particles.size() - 1);
+      const size_t index = uniform_index(gen);
+      deleted_ids.push_back(get<id>(particles)[index]);
+      deleted_ids.push_back(get<id>(particles)[particles.size() - 1]);
+      get<alive>(particles)[index] = false;
+      get<alive>(particles)[particles.size() - 1] = false;
+      particles.update_positions();
+      check_all_ids(particles, deleted_ids);
+
+      // add some particles
+      typename particles_type::value_type p;
+      for (int i = 0; i < N / 10; ++i) {
+        for (size_t d = 0; d < D; ++d) {
+          get<position>(p)[d] = uniform(gen);
+        }
+        particles.push_back(p);
+      }
+      check_all_ids(particles, deleted_ids);
+    }
+  }
+
   template <template <typename, typename> class VectorType,
             template <typename> class SearchMethod>
   void helper_d_test_list_random() {
+    helper_id_map_updates<2, VectorType, SearchMethod>(1000);
+
     helper_d_random<2, VectorType, SearchMethod>(14, false, false);
     helper_d_random<2, VectorType, SearchMethod>(14, true, false);
     helper_d_random<2, VectorType, SearchMethod>(14, false, true);
@@ -326,6 +407,10 @@ O(log(N)) time.
     helper_d_test_list_random<std::vector, CellListOrdered>();
   }
 
+  void test_std_vector_HashedCellList(void) {
+    helper_d_test_list_random<std::vector, HashedCellList>();
+  }
+
   void test_std_vector_Kdtree(void) {
 #if not defined(__CUDACC__)
     helper_d_test_list_random<std::vector, Kdtree>();
@@ -629,6 +629,52 @@ public:
     }
   };
 
+  // place every particle uniformly at random in [a,b)^D
+  template <typename ParticlesType>
+  static void set_random_positions(ParticlesType &particles, double a = -1.0,
+                                   double b = 1.0) {
+    detail::for_each(
+        std::begin(particles), std::end(particles),
+        set_random_position<ParticlesType::dimension,
+                            typename ParticlesType::raw_reference>(a, b));
+  }
+
+  // shortest separation between the periodic images of two particles
+  // separated by dx, using the domain of the particle set
+  template <typename ParticlesType>
+  static typename ParticlesType::double_d
+  brute_force_dx(const ParticlesType &particles,
+                 typename ParticlesType::double_d dx, const bool periodic) {
+    if (periodic) {
+      const typename ParticlesType::double_d width =
+          particles.get_max() - particles.get_min();
+      for (size_t d = 0; d < ParticlesType::dimension; ++d) {
+        dx[d] -= width[d] * std::round(dx[d] / width[d]);
+      }
+    }
+    return dx;
+  }
+
+  // brute force euclidean search, returns the index and (shortest) separation
+  // of every particle within distance r of point, in order of index
+  template <typename ParticlesType>
+  static std::vector<std::pair<size_t, typename ParticlesType::double_d>>
+  brute_force_within(const ParticlesType &particles,
+                     const typename ParticlesType::double_d &point,
+                     const double r, const bool periodic) {
+    typedef typename ParticlesType::position position;
+    typedef typename ParticlesType::double_d double_d;
+    std::vector<std::pair<size_t, double_d>> within;
+    for (size_t i = 0; i < particles.size(); ++i) {
+      const double_d dx = brute_force_dx(
+          particles, get<position>(particles)[i] - point, periodic);
+      if (dx.squaredNorm() <= r * r) {
+        within.push_back(std::make_pair(i, dx));
+      }
+    }
+    return within;
+  }
+
   template <typename Reference> struct zero_neighbours_aboria {
     CUDA_HOST_DEVICE
     void operator()(Reference arg) { get<neighbours_aboria>(arg) = 1; }
@@ -814,10 +860,7 @@ public:
       }
     } else {
       particles.resize(N);
-      detail::for_each(
-          std::begin(particles), std::end(particles),
-          set_random_position<D, typename particles_type::raw_reference>(-1.0,
-                                                                         1.0));
+      set_random_positions(particles);
 
       particles.init_neighbour_search(min, max, periodic, neighbour_n);
     }
@@ -981,6 +1024,1556 @@ public:
               << " versus brute force = " << dt_brute.count() << std::endl;
   }
 
+  template <unsigned int D, template <typename, typename> class VectorType,
+            template <typename> class SearchMethod>
+  void helper_space_filling_curve(const int N, const double r,
+                                  const space_filling_curve curve) {
+    typedef Particles<std::tuple<neighbours_brute, neighbours_aboria>, D,
+                      VectorType, SearchMethod>
+        particles_type;
+    typedef Vector<double, D> double_d;
+    typedef Vector<bool, D> bool_d;
+    double_d min = double_d::Constant(-1);
+    double_d max = double_d::Constant(1);
+    bool_d periodic = bool_d::Constant(false);
+    particles_type particles(N);
+    const double r2 = r * r;
+
+    std::cout << "space filling curve test (D=" << D << " N=" << N
+              << " r=" << r
+              << " hilbert=" << (curve == space_filling_curve::hilbert)
+              << "):" << std::endl;
+
+    set_random_positions(particles);
+    particles.init_neighbour_search(min, max, periodic);
+    particles.init_id_search();
+
+    particles.sort_by_space_filling_curve(curve);
+    TS_ASSERT_EQUALS(particles.size(), N);
+    TS_ASSERT_EQUALS(particles.space_filling_curve_disorder(curve), 0.0);
+
+    // neighbour and id search still work after sorting
+    detail::for_each(particles.begin(), particles.end(),
+                     brute_force_check<particles_type>(particles, min, max, r2,
+                                                       false));
+    detail::for_each(particles.begin(), particles.end(),
+                     aboria_check<particles_type>(particles, r));
+    for (size_t i = 0; i < particles.size(); ++i) {
+      TS_ASSERT_EQUALS(int(get<neighbours_brute>(particles)[i]),
+                       int(get<neighbours_aboria>(particles)[i]));
+      const size_t id_i = get<id>(particles)[i];
+      TS_ASSERT_EQUALS(*get<id>(particles.get_query().find(id_i)), id_i);
+    }
+
+    // move particles and check that the policy re-sorts on the second update
+    particles.set_space_filling_curve_policy(curve, 2);
+    for (int update = 0; update < 2; ++update) {
+      set_random_positions(particles);
+      particles.update_positions();
+    }
+    TS_ASSERT_EQUALS(particles.space_filling_curve_disorder(curve), 0.0);
+    detail::for_each(particles.begin(), particles.end(),
+                     brute_force_check<particles_type>(particles, min, max, r2,
+                                                       false));
+    detail::for_each(particles.begin(), particles.end(),
+                     aboria_check<particles_type>(particles, r));
+    for (size_t i = 0; i < particles.size(); ++i) {
+      TS_ASSERT_EQUALS(int(get<neighbours_brute>(particles)[i]),
+                       int(get<neighbours_aboria>(particles)[i]));
+    }
+  }
+
+  template <unsigned int D, template <typename, typename> class VectorType,
+            template <typename> class SearchMethod>
+  void helper_position_soa(const int N, const double r) {
+    typedef Particles<std::tuple<scalar>, D, VectorType, SearchMethod>
+        particles_type;
+    typedef position_d<D> position;
+    typedef Vector<double, D> double_d;
+    typedef Vector<bool, D> bool_d;
+    particles_type particles(N);
+
+    set_random_positions(particles);
+    particles.init_neighbour_search(double_d::Constant(-1),
+                                    double_d::Constant(1),
+                                    bool_d::Constant(false));
+    particles.set_position_soa(true);
+    TS_ASSERT(particles.get_position_soa());
+
+    auto check_soa = [&]() {
+      const detail::position_soa<D> &soa =
+          particles.get_query().m_position_soa;
+      TS_ASSERT(soa.is_valid());
+      for (size_t i = 0; i < particles.size(); ++i) {
+        for (size_t d = 0; d < D; ++d) {
+          TS_ASSERT_EQUALS(soa[d][i], get<position>(particles)[i][d]);
+        }
+      }
+
+      // vectorised count against brute force
+      const double_d centre = double_d::Constant(0.1);
+      const int brute_count =
+          brute_force_within(particles, centre, r, false).size();
+      TS_ASSERT_EQUALS(
+          soa.template count_within<2>(0, particles.size(), centre, r * r),
+          brute_count);
+
+      // searches, which use the structure-of-arrays positions for data
+      // structures that store the particles in each bucket contiguously
+      TS_ASSERT_EQUALS(count_within(particles.get_query(), centre, r),
+                       size_t(brute_count));
+      int search_count = 0;
+      for (auto i = euclidean_search(particles.get_query(), centre, r);
+           i != false; ++i) {
+        TS_ASSERT_DELTA((get<position>(*i) - centre - i.dx()).norm(), 0,
+                        1e-10);
+        TS_ASSERT_LESS_THAN_EQUALS(i.dx().norm(), r);
+        ++search_count;
+      }
+      TS_ASSERT_EQUALS(search_count, brute_count);
+
+      int brute_chebyshev_count = 0;
+      for (size_t i = 0; i < particles.size(); ++i) {
+        const double_d dx = get<position>(particles)[i] - centre;
+        bool within = true;
+        for (size_t d = 0; d < D; ++d) {
+          within &= std::abs(dx[d]) <= r;
+        }
+        brute_chebyshev_count += within;
+      }
+      search_count = 0;
+      for (auto i = chebyshev_search(particles.get_query(), centre, r);
+           i != false; ++i) {
+        ++search_count;
+      }
+      TS_ASSERT_EQUALS(search_count, brute_chebyshev_count);
+    };
+    check_soa();
+
+    // delete and move particles
+    for (int i = 0; i < N; i += 5) {
+      get<alive>(particles)[i] = false;
+    }
+    set_random_positions(particles);
+    particles.update_positions();
+    TS_ASSERT_EQUALS(particles.size(), N - (N + 4) / 5);
+    check_soa();
+
+    particles.set_position_soa(false);
+    TS_ASSERT(!particles.get_query().m_position_soa.is_valid());
+  }
+
+  template <unsigned int D, template <typename, typename> class VectorType,
+            template <typename> class SearchMethod>
+  void helper_knn(const int N, const int k, const bool is_periodic) {
+    typedef Particles<std::tuple<scalar>, D, VectorType, SearchMethod>
+        particles_type;
+    typedef position_d<D> position;
+    typedef Vector<double, D> double_d;
+    typedef Vector<bool, D> bool_d;
+    const double_d min = double_d::Constant(-1);
+    const double_d max = double_d::Constant(1);
+    particles_type particles(N);
+
+    std::cout << "knn test (D=" << D << " N=" << N << " k=" << k
+              << " periodic=" << is_periodic << "):" << std::endl;
+
+    set_random_positions(particles);
+    particles.init_neighbour_search(min, max, bool_d::Constant(is_periodic));
+
+    generator_type gen(N);
+    std::uniform_real_distribution<double> uniform(-1.0, 1.0);
+    for (int test = 0; test < 20; ++test) {
+      double_d centre;
+      for (size_t d = 0; d < D; ++d) {
+        centre[d] = uniform(gen);
+      }
+
+      // brute force, using the shortest periodic distance
+      std::vector<double> brute_distances(particles.size());
+      for (size_t i = 0; i < particles.size(); ++i) {
+        brute_distances[i] =
+            brute_force_dx(particles, get<position>(particles)[i] - centre,
+                           is_periodic)
+                .norm();
+      }
+      std::vector<double> sorted_distances(brute_distances);
+      std::sort(sorted_distances.begin(), sorted_distances.end());
+
+      auto result = knn_search(particles.get_query(), centre, k);
+      TS_ASSERT_EQUALS(result.size(), std::min(k, N));
+      for (size_t i = 0; i < result.size(); ++i) {
+        TS_ASSERT_DELTA(result[i].second, sorted_distances[i], 1e-10);
+        TS_ASSERT_DELTA(result[i].second, brute_distances[result[i].first],
+                        1e-10);
+      }
+    }
+  }
+
+  template <unsigned int D, template <typename, typename> class VectorType,
+            template <typename> class SearchMethod>
+  void helper_knn_graph(const int N, const int k, const bool is_periodic) {
+    typedef Particles<std::tuple<scalar>, D, VectorType, SearchMethod>
+        particles_type;
+    typedef typename particles_type::traits_type traits_type;
+    typedef position_d<D> position;
+    typedef Vector<double, D> double_d;
+    typedef Vector<bool, D> bool_d;
+    const double_d min = double_d::Constant(-1);
+    const double_d max = double_d::Constant(1);
+    particles_type particles(N);
+
+    std::cout << "knn graph test (D=" << D << " N=" << N << " k=" << k
+              << " periodic=" << is_periodic << "):" << std::endl;
+
+    set_random_positions(particles);
+    particles.init_neighbour_search(min, max, bool_d::Constant(is_periodic));
+
+    typename traits_type::vector_size_t offsets;
+    typename traits_type::vector_int indices;
+    typename traits_type::vector_double distances;
+    for (bool include_self : {false, true}) {
+      build_knn_graph(particles, k, offsets, indices, distances, include_self);
+      const int n_neighbours = std::min(k, include_self ? N : N - 1);
+      TS_ASSERT_EQUALS(offsets.size(), N + 1);
+      TS_ASSERT_EQUALS(indices.size(), N * n_neighbours);
+      TS_ASSERT_EQUALS(distances.size(), N * n_neighbours);
+
+      for (int i = 0; i < N; ++i) {
+        // brute force, using the shortest periodic distance
+        std::vector<double> brute_distances(N);
+        for (int j = 0; j < N; ++j) {
+          brute_distances[j] =
+              brute_force_dx(particles,
+                             get<position>(particles)[j] -
+                                 get<position>(particles)[i],
+                             is_periodic)
+                  .norm();
+        }
+        std::vector<double> sorted_distances(brute_distances);
+        std::sort(sorted_distances.begin(), sorted_distances.end());
+
+        TS_ASSERT_EQUALS(offsets[i], static_cast<size_t>(i * n_neighbours));
+        TS_ASSERT_EQUALS(offsets[i + 1] - offsets[i],
+                         static_cast<size_t>(n_neighbours));
+        const int skip = include_self ? 0 : 1;
+        for (size_t j = offsets[i]; j < offsets[i + 1]; ++j) {
+          if (!include_self) {
+            TS_ASSERT_DIFFERS(indices[j], i);
+          }
+          TS_ASSERT_DELTA(distances[j],
+                          sorted_distances[j - offsets[i] + skip], 1e-10);
+          TS_ASSERT_DELTA(distances[j], brute_distances[indices[j]], 1e-10);
+        }
+      }
+    }
+  }
+
+  template <unsigned int D, template <typename, typename> class VectorType,
+            template <typename> class SearchMethod>
+  void helper_count_within(const int N, const double r,
+                           const bool is_periodic) {
+    typedef Particles<std::tuple<scalar>, D, VectorType, SearchMethod>
+        particles_type;
+    typedef Vector<double, D> double_d;
+    typedef Vector<bool, D> bool_d;
+    const double_d min = double_d::Constant(-1);
+    const double_d max = double_d::Constant(1);
+    particles_type particles(N);
+
+    std::cout << "count_within test (D=" << D << " N=" << N << " r=" << r
+              << " periodic=" << is_periodic << "):" << std::endl;
+
+    set_random_positions(particles);
+    particles.init_neighbour_search(min, max, bool_d::Constant(is_periodic));
+
+    generator_type gen(N);
+    std::uniform_real_distribution<double> uniform(-1.0, 1.0);
+    for (int test = 0; test < 20; ++test) {
+      double_d centre;
+      for (size_t d = 0; d < D; ++d) {
+        centre[d] = uniform(gen);
+      }
+
+      size_t expected = 0;
+      for (auto i = euclidean_search(particles.get_query(), centre, r);
+           i != false; ++i) {
+        ++expected;
+      }
+      if (!is_periodic || r < 1.0) {
+        // brute force, using the shortest periodic distance
+        TS_ASSERT_EQUALS(
+            expected,
+            brute_force_within(particles, centre, r, is_periodic).size());
+      }
+
+      TS_ASSERT_EQUALS(count_within(particles.get_query(), centre, r),
+                       expected);
+    }
+  }
+
+  template <template <typename, typename> class VectorType,
+            template <typename> class SearchMethod>
+  void helper_count_within_list() {
+    helper_count_within<2, VectorType, SearchMethod>(1000, 0.3, false);
+    helper_count_within<2, VectorType, SearchMethod>(1000, 0.3, true);
+    helper_count_within<3, VectorType, SearchMethod>(1000, 0.6, false);
+    helper_count_within<3, VectorType, SearchMethod>(1000, 0.6, true);
+    helper_count_within<2, VectorType, SearchMethod>(1000, 3.0, false);
+    helper_count_within<3, VectorType, SearchMethod>(100, 1.5, true);
+  }
+
+  template <unsigned int D, template <typename, typename> class VectorType,
+            template <typename> class SearchMethod>
+  void helper_for_each_neighbour(const int N, const double r,
+                                 const bool is_periodic,
+                                 const bool position_soa) {
+    typedef Particles<std::tuple<scalar>, D, VectorType, SearchMethod>
+        particles_type;
+    typedef typename particles_type::raw_const_reference raw_const_reference;
+    typedef Vector<double, D> double_d;
+    typedef Vector<bool, D> bool_d;
+    const double_d min = double_d::Constant(-1);
+    const double_d max = double_d::Constant(1);
+    particles_type particles(N);
+
+    std::cout << "for_each_neighbour test (D=" << D << " N=" << N
+              << " r=" << r << " periodic=" << is_periodic
+              << " position_soa=" << position_soa << "):" << std::endl;
+
+    set_random_positions(particles);
+    particles.init_neighbour_search(min, max, bool_d::Constant(is_periodic));
+    particles.set_position_soa(position_soa);
+
+    generator_type gen(N);
+    std::uniform_real_distribution<double> uniform(-1.0, 1.0);
+    for (int test = 0; test < 20; ++test) {
+      double_d centre;
+      for (size_t d = 0; d < D; ++d) {
+        centre[d] = uniform(gen);
+      }
+
+      // (id, dx) for each particle found
+      std::vector<std::pair<size_t, double_d>> expected;
+      for (auto i = euclidean_search(particles.get_query(), centre, r);
+           i != false; ++i) {
+        expected.push_back(std::make_pair(get<id>(*i), i.dx()));
+      }
+      std::vector<std::pair<size_t, double_d>> found;
+      for_each_neighbour(particles.get_query(), centre, r,
+                         [&](raw_const_reference j, const double_d &dx) {
+                           found.push_back(std::make_pair(get<id>(j), dx));
+                         });
+
+      auto compare = [](const std::pair<size_t, double_d> &a,
+                        const std::pair<size_t, double_d> &b) {
+        return a.first < b.first ||
+               (a.first == b.first && a.second[0] < b.second[0]);
+      };
+      std::sort(expected.begin(), expected.end(), compare);
+      std::sort(found.begin(), found.end(), compare);
+      TS_ASSERT_EQUALS(found.size(), expected.size());
+      for (size_t i = 0; i < std::min(found.size(), expected.size()); ++i) {
+        TS_ASSERT_EQUALS(found[i].first, expected[i].first);
+        TS_ASSERT_DELTA((found[i].second - expected[i].second).norm(), 0,
+                        1e-10);
+      }
+    }
+  }
+
+  template <template <typename, typename> class VectorType,
+            template <typename> class SearchMethod>
+  void helper_for_each_neighbour_list() {
+    helper_for_each_neighbour<2, VectorType, SearchMethod>(1000, 0.3, false,
+                                                           false);
+    helper_for_each_neighbour<2, VectorType, SearchMethod>(1000, 0.3, true,
+                                                           true);
+    helper_for_each_neighbour<3, VectorType, SearchMethod>(1000, 0.6, true,
+                                                           false);
+    helper_for_each_neighbour<3, VectorType, SearchMethod>(1000, 0.6, false,
+                                                           true);
+    helper_for_each_neighbour<3, VectorType, SearchMethod>(100, 1.5, true,
+                                                           true);
+  }
+
+  template <unsigned int D, template <typename, typename> class VectorType,
+            template <typename> class SearchMethod>
+  void helper_ghost_halo(const int N, const double r, const double halo_width) {
+    typedef Particles<std::tuple<scalar>, D, VectorType, SearchMethod>
+        particles_type;
+    typedef typename particles_type::raw_const_reference raw_const_reference;
+    typedef typename particles_type::position position;
+    typedef Vector<double, D> double_d;
+    typedef Vector<bool, D> bool_d;
+    typedef std::vector<std::pair<size_t, double_d>> found_type;
+    const double_d min = double_d::Constant(-1);
+    const double_d max = double_d::Constant(1);
+    particles_type particles(N);
+
+    std::cout << "ghost halo test (D=" << D << " N=" << N << " r=" << r
+              << " halo_width=" << halo_width << "):" << std::endl;
+
+    set_random_positions(particles);
+    particles.init_neighbour_search(min, max, bool_d::Constant(true), 10,
+                                    halo_width);
+    TS_ASSERT_EQUALS(particles.get_halo_width(), halo_width);
+
+    auto compare = [](const std::pair<size_t, double_d> &a,
+                      const std::pair<size_t, double_d> &b) {
+      return a.first < b.first ||
+             (a.first == b.first && a.second[0] < b.second[0]);
+    };
+    auto check_equal = [](const found_type &found,
+                          const found_type &expected) {
+      TS_ASSERT_EQUALS(found.size(), expected.size());
+      for (size_t i = 0; i < std::min(found.size(), expected.size()); ++i) {
+        TS_ASSERT_EQUALS(found[i].first, expected[i].first);
+        TS_ASSERT_DELTA((found[i].second - expected[i].second).norm(), 0,
+                        1e-10);
+      }
+    };
+
+    generator_type gen(N);
+    std::uniform_real_distribution<double> uniform(-1.0, 1.0);
+    for (int step = 0; step < 3; ++step) {
+      for (int test = 0; test < 20; ++test) {
+        double_d centre;
+        for (size_t d = 0; d < D; ++d) {
+          centre[d] = uniform(gen);
+        }
+
+        // search radii within the halo use the ghosts, and larger radii fall
+        // back to searching each periodic image
+        for (double radius : {r, halo_width, 1.5 * halo_width}) {
+          found_type expected_euclidean;
+          for (const auto &j :
+               brute_force_within(particles, centre, radius, true)) {
+            expected_euclidean.push_back(
+                std::make_pair(get<id>(particles)[j.first], j.second));
+          }
+          found_type expected_chebyshev;
+          for (size_t i = 0; i < particles.size(); ++i) {
+            const double_d dx = brute_force_dx(
+                particles, get<position>(particles)[i] - centre, true);
+            double max_dx = 0;
+            for (size_t d = 0; d < D; ++d) {
+              max_dx = std::max(max_dx, std::abs(dx[d]));
+            }
+            if (max_dx <= radius) {
+              expected_chebyshev.push_back(
+                  std::make_pair(get<id>(particles)[i], dx));
+            }
+          }
+          std::sort(expected_euclidean.begin(), expected_euclidean.end(),
+                    compare);
+          std::sort(expected_chebyshev.begin(), expected_chebyshev.end(),
+                    compare);
+
+          found_type found;
+          for (auto i = euclidean_search(particles.get_query(), centre, radius);
+               i != false; ++i) {
+            found.push_back(std::make_pair(get<id>(*i), i.dx()));
+          }
+          std::sort(found.begin(), found.end(), compare);
+          check_equal(found, expected_euclidean);
+
+          found.clear();
+          for (auto i = chebyshev_search(particles.get_query(), centre, radius);
+               i != false; ++i) {
+            found.push_back(std::make_pair(get<id>(*i), i.dx()));
+          }
+          std::sort(found.begin(), found.end(), compare);
+          check_equal(found, expected_chebyshev);
+
+          found.clear();
+          for_each_neighbour(particles.get_query(), centre, radius,
+                             [&](raw_const_reference j, const double_d &dx) {
+                               found.push_back(std::make_pair(get<id>(j), dx));
+                             });
+          std::sort(found.begin(), found.end(), compare);
+          check_equal(found, expected_euclidean);
+
+          TS_ASSERT_EQUALS(count_within(particles.get_query(), centre, radius),
+                           expected_euclidean.size());
+        }
+      }
+
+      // move the particles, the ghosts are regenerated by update_positions
+      for (size_t i = 0; i < particles.size(); ++i) {
+        double_d p = get<position>(particles)[i];
+        for (size_t d = 0; d < D; ++d) {
+          p[d] += 0.1 * uniform(gen);
+        }
+        get<position>(particles)[i] = p;
+      }
+      particles.update_positions();
+    }
+  }
+
+  template <unsigned int D, template <typename, typename> class VectorType,
+            template <typename> class SearchMethod>
+  void helper_batch_search(const int N, const int n_points, const double r,
+                           const bool is_periodic) {
+    typedef Particles<std::tuple<scalar>, D, VectorType, SearchMethod>
+        particles_type;
+    typedef typename particles_type::raw_const_reference raw_const_reference;
+    typedef Vector<double, D> double_d;
+    typedef Vector<bool, D> bool_d;
+    typedef std::vector<std::pair<size_t, double_d>> found_type;
+    const double_d min = double_d::Constant(-1);
+    const double_d max = double_d::Constant(1);
+    particles_type particles(N);
+
+    std::cout << "batch_search test (D=" << D << " N=" << N
+              << " n_points=" << n_points << " r=" << r
+              << " periodic=" << is_periodic << "):" << std::endl;
+
+    set_random_positions(particles);
+    particles.init_neighbour_search(min, max, bool_d::Constant(is_periodic));
+
+    generator_type gen(N);
+    std::uniform_real_distribution<double> uniform(-1.0, 1.0);
+    std::vector<double_d> points(n_points);
+    for (int i = 0; i < n_points; ++i) {
+      for (size_t d = 0; d < D; ++d) {
+        points[i][d] = uniform(gen);
+      }
+    }
+
+    auto compare = [](const std::pair<size_t, double_d> &a,
+                      const std::pair<size_t, double_d> &b) {
+      return a.first < b.first ||
+             (a.first == b.first && a.second[0] < b.second[0]);
+    };
+
+    // a constant radius, and a different radius for each point
+    auto radius = [&](const size_t i) { return r * (0.5 + 0.25 * (i % 3)); };
+    for (int variable_radius = 0; variable_radius < 2; ++variable_radius) {
+      std::vector<found_type> found(n_points);
+      auto sink = [&](const size_t i, raw_const_reference j,
+                      const double_d &dx) {
+        found[i].push_back(std::make_pair(get<id>(j), dx));
+      };
+      if (variable_radius) {
+        batch_search(particles.get_query(), points.begin(), points.end(),
+                     radius, sink);
+      } else {
+        batch_search(particles.get_query(), points.begin(), points.end(), r,
+                     sink);
+      }
+
+      for (int i = 0; i < n_points; ++i) {
+        found_type expected;
+        for_each_neighbour(particles.get_query(), points[i],
+                           variable_radius ? radius(i) : r,
+                           [&](raw_const_reference j, const double_d &dx) {
+                             expected.push_back(std::make_pair(get<id>(j), dx));
+                           });
+        std::sort(expected.begin(), expected.end(), compare);
+        std::sort(found[i].begin(), found[i].end(), compare);
+        TS_ASSERT_EQUALS(found[i].size(), expected.size());
+        for (size_t k = 0; k < std::min(found[i].size(), expected.size());
+             ++k) {
+          TS_ASSERT_EQUALS(found[i][k].first, expected[k].first);
+          TS_ASSERT_DELTA((found[i][k].second - expected[k].second).norm(), 0,
+                          1e-10);
+        }
+      }
+    }
+  }
+
+  template <unsigned int D, template <typename, typename> class VectorType,
+            template <typename> class SearchMethod>
+  void helper_verlet_list(const int N, const double radius, const double skin,
+                          const bool expect_reuse) {
+    typedef Particles<std::tuple<scalar>, D, VectorType, SearchMethod>
+        particles_type;
+    typedef position_d<D> position;
+    typedef Vector<double, D> double_d;
+    typedef Vector<bool, D> bool_d;
+    const double_d min = double_d::Constant(0);
+    const double_d max = double_d::Constant(1);
+    particles_type particles(N);
+
+    std::cout << "verlet list test (D=" << D << " N=" << N
+              << " radius=" << radius << " skin=" << skin << "):" << std::endl;
+
+    set_random_positions(particles, 0.0, 1.0);
+    particles.init_neighbour_search(min, max, bool_d::Constant(true));
+
+    // checks that the list contains every particle within radius, and
+    // exactly the particles within radius + skin if it has just been built
+    auto check_list = [&](VerletList<particles_type> &verlet,
+                          const bool just_built) {
+      TS_ASSERT_EQUALS(verlet.get_offsets().size(), particles.size() + 1);
+      for (size_t i = 0; i < particles.size(); ++i) {
+        std::vector<int> list;
+        verlet.for_each_neighbour(i, [&](const int j) { list.push_back(j); });
+        TS_ASSERT_EQUALS(list.size(), verlet.number_of_neighbours(i));
+        std::sort(list.begin(), list.end());
+        std::vector<int> brute;
+        for (size_t j = 0; j < particles.size(); ++j) {
+          const double r =
+              brute_force_dx(particles,
+                             get<position>(particles)[j] -
+                                 get<position>(particles)[i],
+                             true)
+                  .norm();
+          if (j == i) {
+            continue;
+          }
+          if (r < radius) {
+            TS_ASSERT(std::binary_search(list.begin(), list.end(), j));
+          }
+          if (r < radius + skin) {
+            brute.push_back(j);
+          }
+        }
+        if (just_built) {
+          TS_ASSERT(list == brute);
+        }
+      }
+
+      // the parallel version should visit the same neighbours
+      std::vector<int> counts(particles.size(), 0);
+      int *counts_ptr = counts.data();
+      verlet.for_each_neighbour(
+          [=](const int i, const int j) { ++counts_ptr[i]; });
+      for (size_t i = 0; i < particles.size(); ++i) {
+        TS_ASSERT_EQUALS(counts[i], verlet.number_of_neighbours(i));
+      }
+    };
+
+    VerletList<particles_type> verlet(particles, radius, skin);
+    TS_ASSERT_EQUALS(verlet.get_max_displacement(), 0);
+    check_list(verlet, true);
+
+    // move every particle less than a quarter of the skin
+    generator_type gen(N);
+    const double step = 0.25 * skin / std::sqrt(D);
+    std::uniform_real_distribution<double> uniform(-step, step);
+    for (size_t i = 0; i < particles.size(); ++i) {
+      for (size_t d = 0; d < D; ++d) {
+        get<position>(particles)[i][d] += uniform(gen);
+      }
+    }
+    particles.update_positions();
+    const bool rebuilt = verlet.update();
+    if (expect_reuse) {
+      TS_ASSERT(!rebuilt);
+      TS_ASSERT_LESS_THAN_EQUALS(verlet.get_max_displacement(),
+                                 0.25 * skin + 1e-10);
+    }
+    check_list(verlet, rebuilt);
+
+    // move one particle by more than half the skin
+    get<position>(particles)[0][0] += skin;
+    particles.update_positions();
+    TS_ASSERT(verlet.update());
+    check_list(verlet, true);
+  }
+
+  template <unsigned int D, template <typename, typename> class VectorType,
+            template <typename> class SearchMethod>
+  void helper_for_each_pair_within(const int N, const double r,
+                                   const double n_particles_in_leaf,
+                                   const bool is_periodic,
+                                   const double lattice = 0) {
+    typedef Particles<std::tuple<scalar>, D, VectorType, SearchMethod>
+        particles_type;
+    typedef typename particles_type::raw_reference raw_reference;
+    typedef position_d<D> position;
+    typedef Vector<double, D> double_d;
+    typedef Vector<bool, D> bool_d;
+    const double_d min = double_d::Constant(-1);
+    const double_d max = double_d::Constant(1);
+    particles_type particles(N);
+
+    std::cout << "for_each_pair_within test (D=" << D << " N=" << N
+              << " r=" << r << " n_particles_in_leaf=" << n_particles_in_leaf
+              << " periodic=" << is_periodic << " lattice=" << lattice
+              << "):" << std::endl;
+
+    set_random_positions(particles);
+    // snap the particles to a lattice, so that many pairs are exactly r apart
+    if (lattice > 0) {
+      for (size_t i = 0; i < particles.size(); ++i) {
+        for (size_t d = 0; d < D; ++d) {
+          double &x = get<position>(particles)[i][d];
+          x = lattice * std::floor(x / lattice);
+        }
+      }
+    }
+    particles.init_neighbour_search(min, max, bool_d::Constant(is_periodic),
+                                    n_particles_in_leaf);
+
+    // count neighbours and sum separations, scattering to both particles
+    std::vector<int> counts(N, 0);
+    std::vector<double_d> sum_dx(N, double_d::Constant(0));
+    int *counts_ptr = counts.data();
+    double_d *sum_dx_ptr = sum_dx.data();
+    const double_d *positions =
+        get<position>(particles.get_query().get_particles_begin());
+    for_each_pair_within(particles.get_query(), r,
+                         [=](raw_reference i, raw_reference j,
+                             const double_d &dx) {
+                           const int i_index = &get<position>(i) - positions;
+                           const int j_index = &get<position>(j) - positions;
+                           ++counts_ptr[i_index];
+                           ++counts_ptr[j_index];
+                           sum_dx_ptr[i_index] += dx;
+                           sum_dx_ptr[j_index] -= dx;
+                         });
+
+    for (int i = 0; i < N; ++i) {
+      int brute_count = 0;
+      double_d brute_sum_dx = double_d::Constant(0);
+      for (const auto &j : brute_force_within(
+               particles, get<position>(particles)[i], r, is_periodic)) {
+        if (j.first != static_cast<size_t>(i)) {
+          ++brute_count;
+          brute_sum_dx += j.second;
+        }
+      }
+      TS_ASSERT_EQUALS(counts[i], brute_count);
+      for (size_t d = 0; d < D; ++d) {
+        TS_ASSERT_DELTA(sum_dx[i][d], brute_sum_dx[d], 1e-10);
+      }
+    }
+  }
+
+  template <unsigned int D, template <typename, typename> class VectorType,
+            template <typename> class SearchMethod>
+  void helper_swept_sphere_contacts(const int N, const double radius,
+                                    const double speed, const double dt,
+                                    const bool is_periodic) {
+    typedef Vector<double, D> double_d;
+    typedef Vector<bool, D> bool_d;
+    ABORIA_VARIABLE(sphere_radius, double, "sphere radius")
+    ABORIA_VARIABLE(sphere_velocity, double_d, "sphere velocity")
+    typedef Particles<std::tuple<sphere_radius, sphere_velocity>, D,
+                      VectorType, SearchMethod>
+        particles_type;
+    typedef typename particles_type::position position;
+    const double_d min = double_d::Constant(-1);
+    const double_d max = double_d::Constant(1);
+    particles_type particles(N);
+
+    std::cout << "swept_sphere_contacts test (D=" << D << " N=" << N
+              << " radius=" << radius << " speed=" << speed << " dt=" << dt
+              << " periodic=" << is_periodic << "):" << std::endl;
+
+    // a range of radii and speeds, so that some pairs tunnel through each
+    // other over the timestep
+    generator_type gen(N);
+    std::uniform_real_distribution<double> uniform(-1.0, 1.0);
+    for (int i = 0; i < N; ++i) {
+      double_d p, v;
+      for (size_t d = 0; d < D; ++d) {
+        p[d] = uniform(gen);
+        v[d] = speed * uniform(gen);
+      }
+      get<position>(particles)[i] = p;
+      get<sphere_velocity>(particles)[i] = v;
+      get<sphere_radius>(particles)[i] = radius * (0.75 + 0.25 * uniform(gen));
+    }
+    particles.init_neighbour_search(min, max, bool_d::Constant(is_periodic));
+
+    const std::vector<swept_contact> contacts =
+        swept_sphere_contacts<sphere_velocity, sphere_radius>(
+            particles.get_query(), dt);
+
+    auto separation = [&](const size_t i, const size_t j, const double t) {
+      return brute_force_dx(
+          particles,
+          get<position>(particles)[j] - get<position>(particles)[i] +
+              (get<sphere_velocity>(particles)[j] -
+               get<sphere_velocity>(particles)[i]) *
+                  t,
+          is_periodic);
+    };
+    auto sum_radius = [&](const size_t i, const size_t j) {
+      return get<sphere_radius>(particles)[i] +
+             get<sphere_radius>(particles)[j];
+    };
+
+    // every contact found touches at its contact time, and not before
+    std::vector<std::tuple<size_t, size_t, double>> found;
+    for (size_t k = 0; k < contacts.size(); ++k) {
+      const swept_contact &c = contacts[k];
+      if (k > 0) {
+        TS_ASSERT_LESS_THAN_EQUALS(contacts[k - 1].time, c.time);
+      }
+      TS_ASSERT_LESS_THAN_EQUALS(0, c.time);
+      TS_ASSERT_LESS_THAN_EQUALS(c.time, dt);
+      const double distance = separation(c.i, c.j, c.time).norm();
+      if (c.time > 0) {
+        TS_ASSERT_DELTA(distance, sum_radius(c.i, c.j), 1e-10);
+      } else {
+        TS_ASSERT_LESS_THAN_EQUALS(distance, sum_radius(c.i, c.j));
+      }
+      found.push_back(std::make_tuple(std::min(c.i, c.j), std::max(c.i, c.j),
+                                      c.time));
+    }
+    std::sort(found.begin(), found.end());
+
+    // brute force, by sampling the separation of each pair over the
+    // timestep. Every sampled contact must be found, with a contact time
+    // between the sample and the one before
+    const int n_samples = 1000;
+    size_t n_expected = 0;
+    int n_tunnelled = 0;
+    for (size_t i = 0; i < particles.size(); ++i) {
+      for (size_t j = i + 1; j < particles.size(); ++j) {
+        // pairs further apart than this cannot touch
+        const double max_distance =
+            sum_radius(i, j) + (get<sphere_velocity>(particles)[j] -
+                                get<sphere_velocity>(particles)[i])
+                                       .norm() *
+                                   dt;
+        if (separation(i, j, 0).norm() > max_distance) {
+          continue;
+        }
+        for (int k = 0; k <= n_samples; ++k) {
+          const double t = dt * k / n_samples;
+          if (separation(i, j, t).norm() > sum_radius(i, j)) {
+            continue;
+          }
+          ++n_expected;
+          auto f = std::lower_bound(found.begin(), found.end(),
+                                    std::make_tuple(i, j, 0.0));
+          TS_ASSERT(f != found.end());
+          if (f != found.end()) {
+            TS_ASSERT_EQUALS(std::get<0>(*f), i);
+            TS_ASSERT_EQUALS(std::get<1>(*f), j);
+            TS_ASSERT_LESS_THAN_EQUALS(std::get<2>(*f), t + 1e-10);
+            TS_ASSERT_LESS_THAN_EQUALS(t - dt / n_samples - 1e-10,
+                                       std::get<2>(*f));
+          }
+          if (k > 0 && separation(i, j, dt).norm() > sum_radius(i, j)) {
+            ++n_tunnelled;
+          }
+          break;
+        }
+      }
+    }
+    TS_ASSERT_LESS_THAN_EQUALS(n_expected, found.size());
+    std::cout << "\tfound " << found.size() << " contacts, " << n_tunnelled
+              << " of which pass through each other" << std::endl;
+  }
+
+  template <unsigned int D, template <typename, typename> class VectorType,
+            template <typename> class SearchMethod>
+  void helper_leaf_size_autotune(const int N, const double r) {
+    typedef Particles<std::tuple<scalar>, D, VectorType, SearchMethod>
+        particles_type;
+    typedef typename particles_type::position position;
+    typedef Vector<double, D> double_d;
+    typedef Vector<bool, D> bool_d;
+    const double_d min = double_d::Constant(-1);
+    const double_d max = double_d::Constant(1);
+    const std::vector<double> candidates = {2, 4, 8, 16, 32};
+    particles_type particles(N);
+
+    std::cout << "leaf size autotune test (D=" << D << " N=" << N
+              << " r=" << r << "):" << std::endl;
+
+    generator_type gen(N);
+    std::uniform_real_distribution<double> uniform(-1.0, 1.0);
+    for (int i = 0; i < N; ++i) {
+      for (size_t d = 0; d < D; ++d) {
+        get<position>(particles)[i][d] = uniform(gen);
+      }
+    }
+
+    auto check_search = [&]() {
+      for (int test = 0; test < 20; ++test) {
+        double_d centre;
+        for (size_t d = 0; d < D; ++d) {
+          centre[d] = uniform(gen);
+        }
+        std::vector<size_t> expected;
+        for (size_t i = 0; i < particles.size(); ++i) {
+          if ((get<position>(particles)[i] - centre).squaredNorm() <= r * r) {
+            expected.push_back(get<id>(particles)[i]);
+          }
+        }
+        std::vector<size_t> found;
+        for (auto i = euclidean_search(particles.get_query(), centre, r);
+             i != false; ++i) {
+          found.push_back(get<id>(*i));
+        }
+        std::sort(expected.begin(), expected.end());
+        std::sort(found.begin(), found.end());
+        TS_ASSERT(found == expected);
+      }
+    };
+
+    // the leaf size given to init_neighbour_search is replaced by the
+    // tuned leaf size
+    particles.set_leaf_size_autotune(r);
+    particles.init_neighbour_search(min, max, bool_d::Constant(false), 7);
+    const double leaf_size = particles.get_max_bucket_size();
+    std::cout << "\tchose n_particles_in_leaf = " << leaf_size << std::endl;
+    TS_ASSERT(std::find(candidates.begin(), candidates.end(), leaf_size) !=
+              candidates.end());
+    check_search();
+
+    // doubling the particles triggers a re-tune, which might choose another
+    // leaf size
+    for (int i = 0; i < N; ++i) {
+      typename particles_type::value_type p;
+      for (size_t d = 0; d < D; ++d) {
+        get<position>(p)[d] = uniform(gen);
+      }
+      particles.push_back(p, false);
+    }
+    particles.update_positions();
+    std::cout << "\tchose n_particles_in_leaf = "
+              << particles.get_max_bucket_size() << " for "
+              << particles.size() << " particles" << std::endl;
+    TS_ASSERT(std::find(candidates.begin(), candidates.end(),
+                        particles.get_max_bucket_size()) != candidates.end());
+    check_search();
+
+    // tuning can be switched off again
+    particles.set_leaf_size_autotune(0);
+    particles.init_neighbour_search(min, max, bool_d::Constant(false), 7);
+    TS_ASSERT_EQUALS(particles.get_max_bucket_size(), 7);
+    check_search();
+  }
+
+  template <unsigned int D, template <typename, typename> class VectorType,
+            template <typename> class SearchMethodA,
+            template <typename> class SearchMethodB>
+  void helper_dual_tree_pairs(const int Na, const int Nb, const double r,
+                              const bool is_periodic,
+                              const double lattice = 0) {
+    typedef Particles<std::tuple<scalar>, D, VectorType, SearchMethodA>
+        particles_a_type;
+    typedef Particles<std::tuple<scalar>, D, VectorType, SearchMethodB>
+        particles_b_type;
+    typedef typename particles_a_type::raw_reference raw_reference_a;
+    typedef typename particles_b_type::raw_reference raw_reference_b;
+    typedef position_d<D> position;
+    typedef Vector<double, D> double_d;
+    typedef Vector<bool, D> bool_d;
+    const double_d min = double_d::Constant(-1);
+    const double_d max = double_d::Constant(1);
+    particles_a_type particles_a(Na);
+    particles_b_type particles_b(Nb);
+
+    std::cout << "dual tree for_each_pair_within test (D=" << D
+              << " Na=" << Na << " Nb=" << Nb << " r=" << r
+              << " periodic=" << is_periodic << " lattice=" << lattice
+              << "):" << std::endl;
+
+    set_random_positions(particles_a);
+    set_random_positions(particles_b, -0.5, 1.0);
+    // snap the particles to a lattice, so that many pairs are exactly r apart
+    const auto snap = [lattice](auto &particles) {
+      for (size_t i = 0; i < particles.size(); ++i) {
+        for (size_t d = 0; d < D; ++d) {
+          double &x = get<position>(particles)[i][d];
+          x = lattice * std::floor(x / lattice);
+        }
+      }
+    };
+    if (lattice > 0) {
+      snap(particles_a);
+      snap(particles_b);
+    }
+    particles_a.init_neighbour_search(min, max, bool_d::Constant(is_periodic));
+    particles_b.init_neighbour_search(min, max, bool_d::Constant(is_periodic));
+
+    // count neighbours and sum separations for the particles in set a. The
+    // function is mutable, as it is taken by value
+    std::vector<int> counts(Na, 0);
+    std::vector<double_d> sum_dx(Na, double_d::Constant(0));
+    int *counts_ptr = counts.data();
+    double_d *sum_dx_ptr = sum_dx.data();
+    const double_d *positions =
+        get<position>(particles_a.get_query().get_particles_begin());
+    for_each_pair_within(particles_a.get_query(), particles_b.get_query(), r,
+                         [=](raw_reference_a i, raw_reference_b j,
+                             const double_d &dx) mutable {
+                           const int i_index = &get<position>(i) - positions;
+                           ++counts_ptr[i_index];
+                           sum_dx_ptr[i_index] += dx;
+                         });
+
+    for (int i = 0; i < Na; ++i) {
+      int brute_count = 0;
+      double_d brute_sum_dx = double_d::Constant(0);
+      for (const auto &j : brute_force_within(
+               particles_b, get<position>(particles_a)[i], r, is_periodic)) {
+        ++brute_count;
+        brute_sum_dx += j.second;
+      }
+      TS_ASSERT_EQUALS(counts[i], brute_count);
+      for (size_t d = 0; d < D; ++d) {
+        TS_ASSERT_DELTA(sum_dx[i][d], brute_sum_dx[d], 1e-10);
+      }
+    }
+  }
+
+  template <unsigned int D, template <typename, typename> class VectorType>
+  void helper_hashed_cell_list_unbounded(const int N, const double r) {
+    typedef Particles<std::tuple<scalar>, D, VectorType, HashedCellList>
+        particles_type;
+    typedef position_d<D> position;
+    typedef Vector<double, D> double_d;
+    typedef Vector<bool, D> bool_d;
+    const double_d min = double_d::Constant(-1);
+    const double_d max = double_d::Constant(1);
+    particles_type particles(N);
+
+    std::cout << "hashed cell list unbounded test (D=" << D << " N=" << N
+              << " r=" << r << "):" << std::endl;
+
+    // a small plume of particles, well outside the initial domain
+    generator_type gen(N);
+    std::uniform_real_distribution<double> uniform(-0.1, 0.1);
+    for (int i = 0; i < N; ++i) {
+      for (size_t d = 0; d < D; ++d) {
+        get<position>(particles)[i][d] = 50.0 + uniform(gen);
+      }
+    }
+    particles.init_neighbour_search(min, max, bool_d::Constant(false));
+
+    for (int step = 0; step < 2; ++step) {
+      TS_ASSERT_EQUALS(particles.size(), N);
+      const auto &query = particles.get_query();
+      TS_ASSERT_LESS_THAN_EQUALS(query.number_of_occupied_buckets(), N);
+      TS_ASSERT_EQUALS(query.number_of_buckets(),
+                       query.number_of_occupied_buckets());
+      // the buckets are sized using the plume rather than the domain, so
+      // the particles are spread over many buckets
+      TS_ASSERT_LESS_THAN_EQUALS(N / 40, query.number_of_occupied_buckets());
+
+      for (int i = 0; i < N; ++i) {
+        const double_d &xi = get<position>(particles)[i];
+        const size_t brute_count =
+            brute_force_within(particles, xi, r, false).size();
+        size_t count = 0;
+        for (auto j = euclidean_search(query, xi, r); j != false; ++j) {
+          ++count;
+        }
+        TS_ASSERT_EQUALS(count, brute_count);
+      }
+
+      // move the plume somewhere else, on the other side of the domain
+      for (int i = 0; i < N; ++i) {
+        get<position>(particles)[i] -= double_d::Constant(120.0);
+      }
+      particles.update_positions();
+    }
+  }
+
+  template <unsigned int D, template <typename, typename> class VectorType>
+  void helper_hashed_cell_list_far_clusters(const int N, const double r) {
+    typedef Particles<std::tuple<scalar>, D, VectorType, HashedCellList>
+        particles_type;
+    typedef typename particles_type::raw_reference raw_reference;
+    typedef position_d<D> position;
+    typedef Vector<double, D> double_d;
+    typedef Vector<bool, D> bool_d;
+    const double_d min = double_d::Constant(-1);
+    const double_d max = double_d::Constant(1);
+    const double separation = 1e6;
+    particles_type particles(N);
+
+    std::cout << "hashed cell list far clusters test (D=" << D << " N=" << N
+              << " r=" << r << "):" << std::endl;
+
+    generator_type gen(N);
+    std::uniform_real_distribution<double> uniform(-0.1, 0.1);
+    for (int i = 0; i < N; ++i) {
+      for (size_t d = 0; d < D; ++d) {
+        get<position>(particles)[i][d] = uniform(gen);
+      }
+    }
+    particles.init_neighbour_search(min, max, bool_d::Constant(false));
+
+    // move half the particles about 1e6 bucket widths away in every
+    // dimension, so the grid spans more buckets than a dense index can hold
+    const double_d shift =
+        separation * particles.get_query().m_bucket_side_length;
+    for (int i = 0; i < N / 2; ++i) {
+      get<position>(particles)[i] += shift;
+    }
+    particles.update_positions();
+
+    const auto &query = particles.get_query();
+    TS_ASSERT_LESS_THAN_EQUALS(query.number_of_occupied_buckets(), N);
+    double grid_size = 1;
+    for (size_t d = 0; d < D; ++d) {
+      grid_size *= query.get_end_bucket()[d] + 1;
+    }
+    TS_ASSERT_LESS_THAN_EQUALS(std::pow(separation, D), grid_size);
+    TS_ASSERT_EQUALS(query.number_of_buckets(),
+                     query.number_of_occupied_buckets());
+
+    // the walk over the children of the root only visits the occupied
+    // buckets
+    size_t n_children = 0;
+    for (auto ci = query.get_children(); ci != false; ++ci) {
+      TS_ASSERT_EQUALS(query.get_bucket_index(*ci), n_children);
+      ++n_children;
+    }
+    TS_ASSERT_EQUALS(n_children, query.number_of_occupied_buckets());
+
+    // the walk over all buckets only visits the occupied buckets
+    size_t n_buckets = 0;
+    int n_particles = 0;
+    for (auto bucket = query.get_subtree(); bucket != false; ++bucket) {
+      const auto bounds = query.get_bucket_bbox(*bucket);
+      for (auto j = query.get_bucket_particles(*bucket); j != false; ++j) {
+        const double_d &xj = get<position>(*j);
+        for (size_t d = 0; d < D; ++d) {
+          TS_ASSERT_LESS_THAN_EQUALS(bounds.bmin[d] - 1e-6, xj[d]);
+          TS_ASSERT_LESS_THAN_EQUALS(xj[d], bounds.bmax[d] + 1e-6);
+        }
+        ++n_particles;
+      }
+      ++n_buckets;
+    }
+    TS_ASSERT_EQUALS(n_buckets, query.number_of_occupied_buckets());
+    TS_ASSERT_EQUALS(n_particles, N);
+
+    for (int i = 0; i < N; ++i) {
+      const double_d &xi = get<position>(particles)[i];
+      const size_t brute_count =
+          brute_force_within(particles, xi, r, false).size();
+      size_t count = 0;
+      for (auto j = euclidean_search(query, xi, r); j != false; ++j) {
+        ++count;
+      }
+      TS_ASSERT_EQUALS(count, brute_count);
+    }
+
+    // pairs found by the occupied bucket walk of for_each_pair_within
+    std::vector<int> counts(N, 0);
+    int *counts_ptr = counts.data();
+    const double_d *positions = get<position>(query.get_particles_begin());
+    for_each_pair_within(query, r,
+                         [=](raw_reference i, raw_reference j,
+                             const double_d &dx) {
+                           ++counts_ptr[&get<position>(i) - positions];
+                           ++counts_ptr[&get<position>(j) - positions];
+                         });
+    for (int i = 0; i < N; ++i) {
+      const size_t brute_count =
+          brute_force_within(particles, get<position>(particles)[i], r, false)
+              .size();
+      TS_ASSERT_EQUALS(counts[i], static_cast<int>(brute_count) - 1);
+    }
+  }
+
+  template <unsigned int D, template <typename, typename> class VectorType>
+  void helper_multi_level(const int N, const double min_radius,
+                          const double max_radius, const bool periodic,
+                          const unsigned int min_levels) {
+    typedef Particles<std::tuple<multi_level_radius>, D, VectorType,
+                      CellListMultiLevel>
+        particles_type;
+    typedef position_d<D> position;
+    typedef Vector<double, D> double_d;
+    typedef Vector<bool, D> bool_d;
+    const double_d min = double_d::Constant(-1);
+    const double_d max = double_d::Constant(1);
+    particles_type particles(N);
+
+    std::cout << "multi level test (D=" << D << " N=" << N
+              << " radius=" << min_radius << " to " << max_radius
+              << " periodic=" << periodic << "):" << std::endl;
+
+    // radii spread evenly on a log scale
+    generator_type gen(N);
+    std::uniform_real_distribution<double> uniform(-1.0, 1.0);
+    std::uniform_real_distribution<double> uniform_log(
+        std::log(min_radius), std::log(max_radius));
+    for (int i = 0; i < N; ++i) {
+      for (size_t d = 0; d < D; ++d) {
+        get<position>(particles)[i][d] = uniform(gen);
+      }
+      get<multi_level_radius>(particles)[i] = std::exp(uniform_log(gen));
+    }
+    particles.init_neighbour_search(min, max, bool_d::Constant(periodic), 1);
+
+    for (int step = 0; step < 2; ++step) {
+      const auto &query = particles.get_query();
+      TS_ASSERT_LESS_THAN_EQUALS(min_levels, query.number_of_grid_levels());
+
+      for (int i = 0; i < N; ++i) {
+        const double_d &xi = get<position>(particles)[i];
+        const double ri = get<multi_level_radius>(particles)[i];
+        int brute_count = 0;
+        int brute_fixed_count = 0;
+        for (int j = 0; j < N; ++j) {
+          const double_d dx =
+              brute_force_dx(particles, get<position>(particles)[j] - xi,
+                             periodic);
+          const double sum = ri + get<multi_level_radius>(particles)[j];
+          if (dx.squaredNorm() < sum * sum) {
+            ++brute_count;
+          }
+          if (dx.squaredNorm() < max_radius * max_radius) {
+            ++brute_fixed_count;
+          }
+        }
+
+        int count = 0;
+        for_each_overlapping(query, xi, ri,
+                             [&](const auto &j, const double_d &dx) {
+                               const double sum =
+                                   ri + get<multi_level_radius>(j);
+                               TS_ASSERT_LESS_THAN(dx.squaredNorm(),
+                                                   sum * sum);
+                               ++count;
+                             });
+        TS_ASSERT_EQUALS(count, brute_count);
+
+        int fixed_count = 0;
+        for (auto j = euclidean_search(query, xi, max_radius); j != false;
+             ++j) {
+          ++fixed_count;
+        }
+        TS_ASSERT_EQUALS(fixed_count, brute_fixed_count);
+      }
+
+      // move the particles and update the search
+      for (int i = 0; i < N; ++i) {
+        for (size_t d = 0; d < D; ++d) {
+          get<position>(particles)[i][d] =
+              periodic ? get<position>(particles)[i][d] + 0.3
+                       : 0.9 * get<position>(particles)[i][d];
+        }
+      }
+      particles.update_positions();
+    }
+  }
+
+  template <unsigned int D, template <typename, typename> class VectorType,
+            template <typename> class SearchMethod>
+  void helper_clustered(const int N, const double cluster_size,
+                        const int min_levels) {
+    typedef Particles<std::tuple<scalar>, D, VectorType, SearchMethod>
+        particles_type;
+    typedef position_d<D> position;
+    typedef Vector<double, D> double_d;
+    typedef Vector<bool, D> bool_d;
+    const double_d min = double_d::Constant(-1);
+    const double_d max = double_d::Constant(1);
+    const double r = 0.1 * cluster_size;
+    particles_type particles(N);
+
+    std::cout << "clustered test (D=" << D << " N=" << N
+              << " cluster_size=" << cluster_size << "):" << std::endl;
+
+    // half the particles in a tiny cluster, the rest spread over the domain
+    generator_type gen(N);
+    std::uniform_real_distribution<double> uniform(-1.0, 1.0);
+    for (int i = 0; i < N; ++i) {
+      const double scale = i < N / 2 ? cluster_size : 1.0;
+      for (size_t d = 0; d < D; ++d) {
+        get<position>(particles)[i][d] = 0.3 + scale * uniform(gen);
+      }
+    }
+    particles.init_neighbour_search(min, max, bool_d::Constant(false), 4);
+
+    const auto &query = particles.get_query();
+    TS_ASSERT_LESS_THAN_EQUALS(min_levels, query.number_of_levels());
+
+    for (int i = 0; i < N / 2; ++i) {
+      const double_d &xi = get<position>(particles)[i];
+      const size_t brute_count =
+          brute_force_within(particles, xi, r, false).size();
+      size_t count = 0;
+      for (auto j = euclidean_search(query, xi, r); j != false; ++j) {
+        ++count;
+      }
+      TS_ASSERT_EQUALS(count, brute_count);
+    }
+  }
+
+  template <unsigned int D, template <typename, typename> class VectorType>
+  void helper_kdtree_builders(const int N, const double r,
+                              const bool is_periodic,
+                              const double lattice = 0) {
+    typedef Particles<std::tuple<scalar>, D, VectorType, Kdtree>
+        particles_type;
+    typedef position_d<D> position;
+    typedef Vector<double, D> double_d;
+    typedef Vector<bool, D> bool_d;
+    const double_d min = double_d::Constant(-1);
+    const double_d max = double_d::Constant(1);
+    particles_type particles(N);
+
+    set_random_positions(particles);
+    // snap the particles to a lattice, so that many share a coordinate
+    if (lattice > 0) {
+      for (size_t i = 0; i < particles.size(); ++i) {
+        for (size_t d = 0; d < D; ++d) {
+          double &x = get<position>(particles)[i][d];
+          x = lattice * std::floor(x / lattice);
+        }
+      }
+    }
+
+    generator_type gen(N);
+    std::uniform_real_distribution<double> uniform(-1.0, 1.0);
+    for (bool build_by_selection : {false, true}) {
+      // build_tree() cannot split a node of coincident particles
+      if (lattice > 0 && !build_by_selection) {
+        continue;
+      }
+      std::cout << "kdtree builders test (D=" << D << " N=" << N << " r=" << r
+                << " periodic=" << is_periodic << " lattice=" << lattice
+                << " build_by_selection=" << build_by_selection
+                << "):" << std::endl;
+      particles.set_build_by_selection(build_by_selection);
+      particles.init_neighbour_search(min, max, bool_d::Constant(is_periodic),
+                                      10);
+
+      // every particle should be in the leaf that contains it, and which
+      // is found by get_bucket()
+      const auto &query = particles.get_query();
+      int bucket_total = 0;
+      for (auto bucket = query.get_subtree(); bucket != false; ++bucket) {
+        if (!query.is_leaf_node(*bucket)) {
+          continue;
+        }
+        const auto bounds = query.get_bounds(bucket.get_child_iterator());
+        for (auto j = query.get_bucket_particles(*bucket); j != false; ++j) {
+          const double_d &xj = get<position>(*j);
+          for (size_t d = 0; d < D; ++d) {
+            TS_ASSERT_LESS_THAN_EQUALS(bounds.bmin[d], xj[d]);
+            TS_ASSERT_LESS_THAN(xj[d], bounds.bmax[d]);
+          }
+          TS_ASSERT_EQUALS(query.get_bucket_index(*query.get_bucket(xj)),
+                           query.get_bucket_index(*bucket));
+          ++bucket_total;
+        }
+      }
+      TS_ASSERT_EQUALS(bucket_total, N);
+
+      for (int test = 0; test < 20; ++test) {
+        double_d centre;
+        for (size_t d = 0; d < D; ++d) {
+          centre[d] = uniform(gen);
+        }
+        std::vector<size_t> expected;
+        for (const auto &j :
+             brute_force_within(particles, centre, r, is_periodic)) {
+          expected.push_back(get<id>(particles)[j.first]);
+        }
+        std::vector<size_t> found;
+        for (auto i = euclidean_search(query, centre, r); i != false; ++i) {
+          found.push_back(get<id>(*i));
+        }
+        std::sort(expected.begin(), expected.end());
+        std::sort(found.begin(), found.end());
+        TS_ASSERT(found == expected);
+        TS_ASSERT_EQUALS(count_within(query, centre, r), expected.size());
+      }
+    }
+  }
+
+  template <unsigned int D, template <typename, typename> class VectorType,
+            template <typename> class SearchMethod>
+  void helper_refit(const int N, const double r, const double step) {
+    typedef Particles<std::tuple<scalar>, D, VectorType, SearchMethod>
+        particles_type;
+    typedef position_d<D> position;
+    typedef Vector<double, D> double_d;
+    typedef Vector<bool, D> bool_d;
+    const double_d min = double_d::Constant(-1);
+    const double_d max = double_d::Constant(1);
+    particles_type particles(N);
+
+    std::cout << "refit test (D=" << D << " N=" << N << " r=" << r
+              << " step=" << step << "):" << std::endl;
+
+    set_random_positions(particles);
+    particles.set_refit(true);
+    particles.init_neighbour_search(min, max, bool_d::Constant(true));
+
+    // the bounds of every leaf, which a refit keeps fixed
+    const auto leaf_bounds = [&particles]() {
+      const auto &query = particles.get_query();
+      std::vector<double> bounds;
+      for (auto bucket = query.get_subtree(); bucket != false; ++bucket) {
+        if (query.is_leaf_node(*bucket)) {
+          const auto box = query.get_bounds(bucket.get_child_iterator());
+          for (size_t d = 0; d < D; ++d) {
+            bounds.push_back(box.bmin[d]);
+            bounds.push_back(box.bmax[d]);
+          }
+        }
+      }
+      return bounds;
+    };
+
+    generator_type gen(N);
+    std::uniform_real_distribution<double> uniform(-step, step);
+    for (int update = 0; update < 10; ++update) {
+      const std::vector<double> old_bounds = leaf_bounds();
+      for (int i = 0; i < N; ++i) {
+        for (size_t d = 0; d < D; ++d) {
+          get<position>(particles)[i][d] += uniform(gen);
+        }
+      }
+      // the last update moves the particles far enough to force a rebuild
+      if (update == 9) {
+        for (int i = 0; i < N / 2; ++i) {
+          get<position>(particles)[i] = double_d::Constant(0.5) +
+                                        0.01 * get<position>(particles)[i];
+        }
+      }
+      particles.update_positions();
+      TS_ASSERT_EQUALS(particles.size(), N);
+
+      // small moves are refitted, the last update rebuilds the tree
+      if (update < 9) {
+        TS_ASSERT(leaf_bounds() == old_bounds);
+      } else {
+        TS_ASSERT(leaf_bounds() != old_bounds);
+      }
+
+      for (int i = 0; i < N; ++i) {
+        const double_d &xi = get<position>(particles)[i];
+        const size_t brute_count =
+            brute_force_within(particles, xi, r, true).size();
+        size_t count = 0;
+        for (auto j = euclidean_search(particles.get_query(), xi, r);
+             j != false; ++j) {
+          ++count;
+        }
+        TS_ASSERT_EQUALS(count, brute_count);
+      }
+    }
+  }
+
+  template <unsigned int D, template <typename, typename> class VectorType>
+  void helper_incremental_update(const int N, const double r,
+                                 const double step) {
+    typedef Particles<std::tuple<scalar>, D, VectorType, CellListOrdered>
+        particles_type;
+    typedef position_d<D> position;
+    typedef Vector<double, D> double_d;
+    typedef Vector<bool, D> bool_d;
+    const double_d min = double_d::Constant(-1);
+    const double_d max = double_d::Constant(1);
+    particles_type particles(N);
+
+    std::cout << "incremental update test (D=" << D << " N=" << N
+              << " r=" << r << " step=" << step << "):" << std::endl;
+
+    set_random_positions(particles);
+    particles.init_neighbour_search(min, max, bool_d::Constant(true));
+
+    generator_type gen(N);
+    std::uniform_real_distribution<double> uniform(-step, step);
+    for (int update = 0; update < 10; ++update) {
+      // the last update moves every particle, forcing a full rebuild
+      const double scale = update == 9 ? 0.5 / step : 1.0;
+      for (int i = 0; i < N; ++i) {
+        for (size_t d = 0; d < D; ++d) {
+          get<position>(particles)[i][d] += scale * uniform(gen);
+        }
+      }
+      particles.update_positions();
+      TS_ASSERT_EQUALS(particles.size(), N);
+
+      // every id should still be present
+      std::vector<size_t> ids(get<id>(particles).begin(),
+                              get<id>(particles).end());
+      std::sort(ids.begin(), ids.end());
+      for (int i = 0; i < N; ++i) {
+        TS_ASSERT_EQUALS(ids[i], i);
+      }
+
+      // every particle should be in the bucket that contains it
+      const auto &query = particles.get_query();
+      int bucket_total = 0;
+      for (auto bucket = query.get_subtree(); bucket != false; ++bucket) {
+        const auto bounds = query.get_bucket_bbox(*bucket);
+        for (auto j = query.get_bucket_particles(*bucket); j != false; ++j) {
+          const double_d &xj = get<position>(*j);
+          for (size_t d = 0; d < D; ++d) {
+            TS_ASSERT_LESS_THAN_EQUALS(bounds.bmin[d] - 1e-10, xj[d]);
+            TS_ASSERT_LESS_THAN_EQUALS(xj[d], bounds.bmax[d] + 1e-10);
+          }
+          ++bucket_total;
+        }
+      }
+      TS_ASSERT_EQUALS(bucket_total, N);
+
+      for (int i = 0; i < N; ++i) {
+        const double_d &xi = get<position>(particles)[i];
+        const size_t brute_count =
+            brute_force_within(particles, xi, r, true).size();
+        size_t count = 0;
+        for (auto j = euclidean_search(particles.get_query(), xi, r);
+             j != false; ++j) {
+          ++count;
+        }
+        TS_ASSERT_EQUALS(count, brute_count);
+      }
+    }
+  }
+
+  template <unsigned int D, template <typename, typename> class VectorType>
+  void helper_cell_list_stencil(const int N, const double r,
+                                const bool is_periodic) {
+    typedef Particles<std::tuple<scalar>, D, VectorType, CellList>
+        particles_type;
+    typedef position_d<D> position;
+    typedef Vector<double, D> double_d;
+    typedef Vector<bool, D> bool_d;
+    const double_d min = double_d::Constant(-1);
+    const double_d max = double_d::Constant(1);
+    particles_type particles(N);
+
+    std::cout << "cell list stencil test (D=" << D << " N=" << N
+              << " r=" << r << " periodic=" << is_periodic
+              << "):" << std::endl;
+
+    set_random_positions(particles);
+    particles.init_neighbour_search(min, max, bool_d::Constant(is_periodic));
+    particles.set_stencil_radius(r);
+    TS_ASSERT(particles.get_query().m_stencil_size > 0);
+
+    // search within the stencil radius, a smaller radius that uses part of
+    // the stencil, and a larger radius that falls back to the lattice search
+    const double radii[] = {r, 0.5 * r, 2 * r};
+    for (double radius : radii) {
+      for (int i = 0; i < N; i += 10) {
+        const double_d &xi = get<position>(particles)[i];
+        const size_t brute_count =
+            brute_force_within(particles, xi, radius, is_periodic).size();
+        size_t count = 0;
+        for (auto j = euclidean_search(particles.get_query(), xi, radius);
+             j != false; ++j) {
+          ++count;
+        }
+        TS_ASSERT_EQUALS(count, brute_count);
+      }
+    }
+  }
+
+  template <template <typename, typename> class VectorType,
+            template <typename> class SearchMethod>
+  void helper_knn_list() {
+    helper_knn<2, VectorType, SearchMethod>(1000, 10, false);
+    helper_knn<3, VectorType, SearchMethod>(1000, 16, true);
+    helper_knn<2, VectorType, SearchMethod>(10, 20, true);
+    helper_knn_graph<2, VectorType, SearchMethod>(500, 8, false);
+    helper_knn_graph<3, VectorType, SearchMethod>(300, 12, true);
+    helper_knn_graph<2, VectorType, SearchMethod>(5, 10, false);
+  }
+
   template <template <typename, typename> class VectorType,
             template <typename> class SearchMethod>
   void helper_d_test_list_regular() {
@@ -1092,6 +2685,35 @@ public:
     helper_single_particle<std::vector, CellList>();
     helper_two_particles<std::vector, CellList>();
     helper_d_test_list_regular<std::vector, CellList>();
+    helper_space_filling_curve<2, std::vector, CellList>(
+        1000, 0.1, space_filling_curve::morton);
+    helper_space_filling_curve<3, std::vector, CellList>(
+        1000, 0.2, space_filling_curve::hilbert);
+    helper_position_soa<3, std::vector, CellList>(1000, 0.3);
+    helper_knn_list<std::vector, CellList>();
+    helper_count_within_list<std::vector, CellList>();
+    helper_for_each_neighbour_list<std::vector, CellList>();
+    helper_batch_search<2, std::vector, CellList>(1000, 500, 0.1, false);
+    helper_batch_search<3, std::vector, CellList>(1000, 500, 0.3, true);
+    helper_ghost_halo<2, std::vector, CellList>(1000, 0.1, 0.2);
+    helper_ghost_halo<3, std::vector, CellList>(1000, 0.3, 0.4);
+    helper_swept_sphere_contacts<2, std::vector, CellList>(
+        1000, 0.02, 1.0, 0.1, false);
+    helper_swept_sphere_contacts<3, std::vector, CellList>(
+        1000, 0.05, 1.0, 0.1, true);
+    helper_leaf_size_autotune<2, std::vector, CellList>(1000, 0.1);
+    helper_leaf_size_autotune<3, std::vector, CellList>(1000, 0.2);
+    helper_for_each_pair_within<2, std::vector, CellList>(1000, 0.1, 10,
+                                                          true);
+    helper_for_each_pair_within<3, std::vector, CellList>(1000, 0.3, 2,
+                                                          false);
+    helper_for_each_pair_within<2, std::vector, CellList>(1000, 0.25, 10,
+                                                          true, 0.25);
+    helper_verlet_list<2, std::vector, CellList>(1000, 0.05, 0.02, true);
+    helper_verlet_list<3, std::vector, CellList>(1000, 0.1, 0.05, true);
+    helper_cell_list_stencil<2, std::vector>(1000, 0.1, false);
+    helper_cell_list_stencil<2, std::vector>(1000, 0.1, true);
+    helper_cell_list_stencil<3, std::vector>(1000, 0.3, true);
   }
 
   void test_std_vector_CellListOrdered(void) {
@@ -1100,6 +2722,66 @@ public:
     helper_two_particles<std::vector, CellListOrdered>();
 
     helper_d_test_list_regular<std::vector, CellListOrdered>();
+    helper_position_soa<2, std::vector, CellListOrdered>(1000, 0.3);
+    helper_knn_list<std::vector, CellListOrdered>();
+    helper_count_within_list<std::vector, CellListOrdered>();
+    helper_for_each_neighbour_list<std::vector, CellListOrdered>();
+    helper_batch_search<2, std::vector, CellListOrdered>(1000, 500, 0.1, false);
+    helper_batch_search<3, std::vector, CellListOrdered>(1000, 500, 0.3, true);
+    helper_ghost_halo<2, std::vector, CellListOrdered>(1000, 0.1, 0.2);
+    helper_ghost_halo<3, std::vector, CellListOrdered>(1000, 0.3, 0.4);
+    helper_swept_sphere_contacts<2, std::vector, CellListOrdered>(
+        1000, 0.02, 1.0, 0.1, false);
+    helper_swept_sphere_contacts<3, std::vector, CellListOrdered>(
+        1000, 0.05, 1.0, 0.1, true);
+    helper_leaf_size_autotune<2, std::vector, CellListOrdered>(1000, 0.1);
+    helper_leaf_size_autotune<3, std::vector, CellListOrdered>(1000, 0.2);
+    helper_for_each_pair_within<2, std::vector, CellListOrdered>(1000, 0.1,
+                                                                 10, false);
+    helper_for_each_pair_within<3, std::vector, CellListOrdered>(1000, 0.3,
+                                                                 2, true);
+    helper_verlet_list<2, std::vector, CellListOrdered>(1000, 0.05, 0.02,
+                                                        false);
+    helper_incremental_update<2, std::vector>(1000, 0.1, 0.005);
+    helper_incremental_update<3, std::vector>(1000, 0.2, 0.01);
+  }
+
+  void test_std_vector_HashedCellList(void) {
+    helper_d_test_list_random<std::vector, HashedCellList>();
+    helper_single_particle<std::vector, HashedCellList>();
+    helper_two_particles<std::vector, HashedCellList>();
+    helper_d_test_list_regular<std::vector, HashedCellList>();
+    helper_knn_list<std::vector, HashedCellList>();
+    helper_count_within_list<std::vector, HashedCellList>();
+    helper_for_each_neighbour_list<std::vector, HashedCellList>();
+    helper_batch_search<2, std::vector, HashedCellList>(1000, 500, 0.1, false);
+    helper_batch_search<3, std::vector, HashedCellList>(1000, 500, 0.3, true);
+    helper_ghost_halo<2, std::vector, HashedCellList>(1000, 0.1, 0.2);
+    helper_ghost_halo<3, std::vector, HashedCellList>(1000, 0.3, 0.4);
+    helper_swept_sphere_contacts<2, std::vector, HashedCellList>(
+        1000, 0.02, 1.0, 0.1, false);
+    helper_swept_sphere_contacts<3, std::vector, HashedCellList>(
+        1000, 0.05, 1.0, 0.1, true);
+    helper_leaf_size_autotune<2, std::vector, HashedCellList>(1000, 0.1);
+    helper_leaf_size_autotune<3, std::vector, HashedCellList>(1000, 0.2);
+    helper_for_each_pair_within<2, std::vector, HashedCellList>(1000, 0.1,
+                                                                10, true);
+    helper_for_each_pair_within<3, std::vector, HashedCellList>(1000, 0.3,
+                                                                2, false);
+    helper_for_each_pair_within<2, std::vector, HashedCellList>(
+        1000, 0.25, 10, false, 0.25);
+    helper_verlet_list<2, std::vector, HashedCellList>(1000, 0.05, 0.02,
+                                                       false);
+    helper_hashed_cell_list_unbounded<2, std::vector>(1000, 0.01);
+    helper_hashed_cell_list_unbounded<3, std::vector>(1000, 0.02);
+    helper_hashed_cell_list_far_clusters<2, std::vector>(1000, 0.01);
+    helper_hashed_cell_list_far_clusters<3, std::vector>(1000, 0.02);
+  }
+
+  void test_std_vector_CellListMultiLevel(void) {
+    helper_multi_level<2, std::vector>(1000, 0.004, 0.2, false, 4);
+    helper_multi_level<2, std::vector>(1000, 0.004, 0.2, true, 4);
+    helper_multi_level<3, std::vector>(1000, 0.01, 0.5, false, 3);
   }
 
   void test_std_vector_CellList_fast_bucketsearch(void) {
@@ -1119,18 +2801,63 @@ public:
   void test_std_vector_Kdtree(void) {
     helper_d_test_list_random<std::vector, Kdtree>();
     helper_d_test_list_regular<std::vector, Kdtree>();
+    helper_position_soa<3, std::vector, Kdtree>(1000, 0.3);
+    helper_knn_list<std::vector, Kdtree>();
+    helper_count_within_list<std::vector, Kdtree>();
+    helper_for_each_neighbour_list<std::vector, Kdtree>();
+    helper_batch_search<2, std::vector, Kdtree>(1000, 500, 0.1, false);
+    helper_batch_search<3, std::vector, Kdtree>(1000, 500, 0.3, true);
+    helper_ghost_halo<2, std::vector, Kdtree>(1000, 0.1, 0.2);
+    helper_ghost_halo<3, std::vector, Kdtree>(1000, 0.3, 0.4);
+    helper_leaf_size_autotune<2, std::vector, Kdtree>(1000, 0.1);
+    helper_leaf_size_autotune<3, std::vector, Kdtree>(1000, 0.2);
+    helper_dual_tree_pairs<2, std::vector, Kdtree, Kdtree>(1000, 800, 0.1,
+                                                           false);
+    helper_dual_tree_pairs<3, std::vector, Kdtree, Kdtree>(1000, 500, 0.3,
+                                                           true);
+    helper_dual_tree_pairs<2, std::vector, Kdtree, Kdtree>(1000, 800, 0.125,
+                                                           true, 1.0 / 64);
+    helper_dual_tree_pairs<3, std::vector, Kdtree, HyperOctree>(500, 1000,
+                                                                0.3, false);
+    helper_refit<2, std::vector, Kdtree>(1000, 0.1, 0.002);
+    helper_refit<3, std::vector, Kdtree>(1000, 0.2, 0.01);
+    helper_kdtree_builders<2, std::vector>(1000, 0.1, false);
+    helper_kdtree_builders<3, std::vector>(20000, 0.1, true);
+    helper_kdtree_builders<2, std::vector>(2000, 0.3, false, 0.25);
   }
 
   void test_std_vector_KdtreeNanoflann(void) {
 #if not defined(__CUDACC__)
     helper_d_test_list_random<std::vector, KdtreeNanoflann>();
     helper_d_test_list_regular<std::vector, KdtreeNanoflann>();
+    helper_knn_list<std::vector, KdtreeNanoflann>();
+    helper_count_within_list<std::vector, KdtreeNanoflann>();
+    helper_for_each_neighbour_list<std::vector, KdtreeNanoflann>();
+    helper_dual_tree_pairs<2, std::vector, KdtreeNanoflann, KdtreeNanoflann>(
+        1000, 800, 0.1, true);
+    helper_ghost_halo<3, std::vector, KdtreeNanoflann>(1000, 0.3, 0.4);
 #endif
   }
 
   void test_std_vector_HyperOctree(void) {
     helper_d_test_list_random<std::vector, HyperOctree>();
     helper_d_test_list_regular<std::vector, HyperOctree>();
+    helper_knn_list<std::vector, HyperOctree>();
+    helper_count_within_list<std::vector, HyperOctree>();
+    helper_for_each_neighbour_list<std::vector, HyperOctree>();
+    helper_batch_search<2, std::vector, HyperOctree>(1000, 500, 0.1, false);
+    helper_batch_search<3, std::vector, HyperOctree>(1000, 500, 0.3, true);
+    helper_ghost_halo<2, std::vector, HyperOctree>(1000, 0.1, 0.2);
+    helper_ghost_halo<3, std::vector, HyperOctree>(1000, 0.3, 0.4);
+    helper_leaf_size_autotune<2, std::vector, HyperOctree>(1000, 0.1);
+    helper_leaf_size_autotune<3, std::vector, HyperOctree>(1000, 0.2);
+    helper_dual_tree_pairs<2, std::vector, HyperOctree, HyperOctree>(
+        1000, 800, 0.1, true);
+    helper_dual_tree_pairs<3, std::vector, HyperOctree, Kdtree>(1000, 500, 0.3,
+                                                                true);
+    helper_verlet_list<3, std::vector, HyperOctree>(1000, 0.1, 0.05, false);
+    helper_clustered<2, std::vector, HyperOctree>(1000, 1e-6, 16);
+    helper_clustered<3, std::vector, HyperOctree>(1000, 1e-5, 12);
   }
 
   // void test_thrust_vector_CellList(void) {
@@ -113,6 +113,60 @@ public:
     TS_ASSERT_EQUALS(get<id>(p_value), 101);
   }
 
+  template <template <typename, typename> class V,
+            template <typename> class SearchMethod>
+  void helper_in_place_reorder(void) {
+    ABORIA_VARIABLE(scalar, double, "scalar")
+    typedef std::tuple<scalar> variables_type;
+    typedef Particles<variables_type, 3, V, SearchMethod> Test_type;
+    typedef typename Test_type::position position;
+    const size_t n = 1000;
+    Test_type gathered(n);
+    std::default_random_engine gen;
+    std::uniform_real_distribution<double> uniform(0, 1);
+    for (size_t i = 0; i < n; ++i) {
+      get<position>(gathered)[i] =
+          vdouble3(uniform(gen), uniform(gen), uniform(gen));
+      get<scalar>(gathered)[i] = i;
+    }
+    Test_type in_place = gathered;
+    in_place.set_in_place_reorder(true);
+    TS_ASSERT(in_place.get_in_place_reorder());
+    TS_ASSERT(!gathered.get_in_place_reorder());
+
+    gathered.init_neighbour_search(vdouble3::Constant(0),
+                                   vdouble3::Constant(1),
+                                   vbool3::Constant(false));
+    in_place.init_neighbour_search(vdouble3::Constant(0),
+                                   vdouble3::Constant(1),
+                                   vbool3::Constant(false));
+
+    // delete every third particle and move the rest
+    for (size_t i = 0; i < n; ++i) {
+      if (get<id>(gathered)[i] % 3 == 0) {
+        get<alive>(gathered)[i] = false;
+        get<alive>(in_place)[i] = false;
+      } else {
+        const vdouble3 new_position(uniform(gen), uniform(gen), uniform(gen));
+        get<position>(gathered)[i] = new_position;
+        get<position>(in_place)[i] = new_position;
+      }
+    }
+    gathered.update_positions();
+    in_place.update_positions();
+
+    TS_ASSERT_EQUALS(gathered.size(), in_place.size());
+    TS_ASSERT_EQUALS(in_place.size(), n - (n + 2) / 3);
+    for (size_t i = 0; i < in_place.size(); ++i) {
+      TS_ASSERT_EQUALS(get<id>(gathered)[i], get<id>(in_place)[i]);
+      TS_ASSERT_EQUALS(get<scalar>(in_place)[i], get<id>(in_place)[i]);
+      TS_ASSERT(get<alive>(in_place)[i]);
+      TS_ASSERT(((vdouble3)get<position>(gathered)[i] ==
+                 (vdouble3)get<position>(in_place)[i])
+                    .all());
+    }
+  }
+
   void test_documentation(void) {
 #if not defined(__CUDACC__)
     //[particle_container
@@ -410,6 +464,7 @@ public:
     helper_add_particle2<std::vector, CellList>();
     helper_add_particle2_dimensions<std::vector, CellList>();
     helper_add_delete_particle<std::vector, CellList>();
+    helper_in_place_reorder<std::vector, CellList>();
   }
 
   void test_std_vector_CellListOrdered(void) {
@@ -417,6 +472,7 @@ public:
     helper_add_particle2<std::vector, CellListOrdered>();
     helper_add_particle2_dimensions<std::vector, CellListOrdered>();
     helper_add_delete_particle<std::vector, CellListOrdered>();
+    helper_in_place_reorder<std::vector, CellListOrdered>();
   }
 
   void test_thrust_vector_CellListOrdered(void) {
@@ -836,6 +836,67 @@ public:
         return dt.count()/repeats;
     }
 
+    template <template <typename> class SearchMethod>
+    double linear_spring_neighbours(const size_t N, const double radius, const size_t repeats, const bool callback) {
+        std::cout << "linear_spring_neighbours: N = "<<N<<" callback = "<<callback<<std::endl;
+
+        const double r = radius;
+
+        ABORIA_VARIABLE(a_var,vdouble3,"a")
+    	typedef Particles<std::tuple<a_var>,3,std::vector,SearchMethod> nodes_type;
+        typedef typename nodes_type::raw_const_reference raw_const_reference;
+        typedef position_d<3> position;
+       	nodes_type nodes(N*N*N);
+
+        const double h = 1.0/N; 
+        vdouble3 min = vdouble3::Constant(-h/2);
+        vdouble3 max = vdouble3::Constant(1+h/2);
+        vbool3 periodic = vbool3::Constant(false);
+        
+        for (size_t i=0; i<N; ++i) {
+            for (size_t j=0; j<N; ++j) {
+                for (size_t k=0; k<N; ++k) {
+                    const size_t index = i*N*N + j*N + k;
+                    get<position>(nodes)[index] = vdouble3(i*h,j*h,k*h);
+                }
+            }
+        }
+
+        nodes.init_neighbour_search(min,max,periodic);
+        const auto& query = nodes.get_query();
+
+        // same operator as linear_spring_aboria, but written using either
+        // the search iterator or the callback neighbour search
+        auto t0 = Clock::now();
+        for (size_t ii=0; ii<repeats; ++ii) {
+            for (size_t i=0; i<nodes.size(); ++i) {
+                const vdouble3& ri = get<position>(nodes)[i];
+                vdouble3 sum = vdouble3::Constant(0);
+                if (callback) {
+                    for_each_neighbour(query,ri,r,
+                        [&](raw_const_reference, const vdouble3& dx) {
+                            const double norm_dx = dx.norm();
+                            if (norm_dx > 0) {
+                                sum += ((r-norm_dx)/norm_dx)*dx;
+                            }
+                        });
+                } else {
+                    for (auto j = euclidean_search(query,ri,r); j != false; ++j) {
+                        const double norm_dx = j.dx().norm();
+                        if (norm_dx > 0) {
+                            sum += ((r-norm_dx)/norm_dx)*j.dx();
+                        }
+                    }
+                }
+                get<a_var>(nodes)[i] = sum;
+            }
+        }
+        auto t1 = Clock::now();
+        std::chrono::duration<double> dt = t1 - t0;
+        std::cout << "time = "<<dt.count()/repeats<<std::endl;
+        return dt.count()/repeats;
+    }
+
     double linear_spring_gromacs(const size_t N, const double radius, const size_t repeats) {
 #ifdef HAVE_GROMACS
         std::cout << "linear_spring_gromacs: N = "<<N<<std::endl;
@@ -947,7 +1008,9 @@ public:
             file <<"#"<< std::setw(14) << "N" 
                 << std::setw(15) << "aboria_serial" 
                 << std::setw(15) << "aboria_parallel" 
-                << std::setw(15) << "gromacs" << std::endl;
+                << std::setw(15) << "gromacs"
+                << std::setw(15) << "iterator"
+                << std::setw(15) << "callback" << std::endl;
 
 
             for (double i = 2; i < 30; i *= 1.05) {
@@ -960,6 +1023,8 @@ public:
                 file << std::setw(15) << std::pow(N,6)/linear_spring_aboria<CellList>(N,radius,repeats);
                 file << std::setw(15) << std::pow(N,6)/linear_spring_aboria<CellListOrdered>(N,radius,repeats);
                 file << std::setw(15) << std::pow(N,6)/linear_spring_gromacs(N,radius,repeats);
+                file << std::setw(15) << std::pow(N,6)/linear_spring_neighbours<CellListOrdered>(N,radius,repeats,false);
+                file << std::setw(15) << std::pow(N,6)/linear_spring_neighbours<CellListOrdered>(N,radius,repeats,true);
                 file << std::endl;
             }
             file.close();
@@ -109,6 +109,129 @@ public:
     TS_ASSERT_EQUALS(index5_true, index5);
   }
 
+  void test_algorithms(void) {
+    const size_t n = 1003;
+    std::default_random_engine gen;
+    std::uniform_int_distribution<int> uniform(0, 100);
+    std::vector<int> keys(n);
+    std::vector<int> data(n);
+    for (size_t i = 0; i < n; ++i) {
+      keys[i] = uniform(gen);
+      data[i] = i;
+    }
+
+    // sort_by_key
+    std::vector<int> sorted_keys = keys;
+    detail::sort_by_key(sorted_keys.begin(), sorted_keys.end(), data.begin());
+    for (size_t i = 0; i < n; ++i) {
+      TS_ASSERT_EQUALS(sorted_keys[i], keys[data[i]]);
+      if (i > 0) {
+        TS_ASSERT_LESS_THAN_EQUALS(sorted_keys[i - 1], sorted_keys[i]);
+      }
+    }
+
+    // sort
+    std::vector<int> sorted = keys;
+    detail::sort(sorted.begin(), sorted.end());
+    TS_ASSERT(std::equal(sorted.begin(), sorted.end(), sorted_keys.begin()));
+
+    // lower_bound and upper_bound
+    std::vector<int> lower(101), upper(101);
+    detail::lower_bound(sorted.begin(), sorted.end(),
+                        boost::make_counting_iterator(0),
+                        boost::make_counting_iterator(101), lower.begin());
+    detail::upper_bound(sorted.begin(), sorted.end(),
+                        boost::make_counting_iterator(0),
+                        boost::make_counting_iterator(101), upper.begin());
+    for (int i = 0; i <= 100; ++i) {
+      TS_ASSERT_EQUALS(lower[i], std::lower_bound(sorted.begin(), sorted.end(),
+                                                  i) -
+                                     sorted.begin());
+      TS_ASSERT_EQUALS(upper[i], std::upper_bound(sorted.begin(), sorted.end(),
+                                                  i) -
+                                     sorted.begin());
+    }
+
+    // exclusive_scan and inclusive_scan
+    std::vector<int> scan(n), inclusive(n);
+    detail::exclusive_scan(keys.begin(), keys.end(), scan.begin(), 5);
+    detail::inclusive_scan(keys.begin(), keys.end(), inclusive.begin());
+    int sum = 0;
+    for (size_t i = 0; i < n; ++i) {
+      TS_ASSERT_EQUALS(scan[i], sum + 5);
+      sum += keys[i];
+      TS_ASSERT_EQUALS(inclusive[i], sum);
+    }
+    TS_ASSERT_EQUALS(detail::reduce(keys.begin(), keys.end(), 5,
+                                    std::plus<int>()),
+                     sum + 5);
+
+    // copy_if, gather and scatter_if
+    std::vector<int> indices(n);
+    detail::sequence(indices.begin(), indices.end());
+    std::vector<int> odd(n);
+    auto odd_end = detail::copy_if(indices.begin(), indices.end(),
+                                   keys.begin(), odd.begin(),
+                                   [](const int i) { return i % 2 == 1; });
+    TS_ASSERT_EQUALS(odd_end - odd.begin(),
+                     std::count_if(keys.begin(), keys.end(),
+                                   [](const int i) { return i % 2 == 1; }));
+    for (auto i = odd.begin(); i != odd_end; ++i) {
+      TS_ASSERT_EQUALS(keys[*i] % 2, 1);
+      if (i != odd.begin()) {
+        TS_ASSERT_LESS_THAN(*(i - 1), *i);
+      }
+    }
+
+    std::vector<int> gathered(n);
+    detail::gather(data.begin(), data.end(), keys.begin(), gathered.begin());
+    TS_ASSERT(std::equal(gathered.begin(), gathered.end(), sorted.begin()));
+
+    std::vector<int> scattered(n, -1);
+    detail::scatter_if(sorted.begin(), sorted.end(), data.begin(),
+                       data.begin(), scattered.begin());
+    for (size_t i = 1; i < n; ++i) {
+      TS_ASSERT_EQUALS(scattered[i], keys[i]);
+    }
+  }
+
+  template <typename Key> void helper_radix_sort(const Key min, const Key max) {
+    const size_t n = 10007;
+    std::default_random_engine gen;
+    std::uniform_int_distribution<Key> uniform(min, max);
+    std::vector<Key> keys(n);
+    std::vector<int> data(n);
+    for (size_t i = 0; i < n; ++i) {
+      keys[i] = uniform(gen);
+      data[i] = i;
+    }
+    std::vector<Key> sorted_keys = keys;
+    detail::radix_sort_by_key(sorted_keys.begin(), sorted_keys.end(),
+                              data.begin());
+    for (size_t i = 0; i < n; ++i) {
+      TS_ASSERT_EQUALS(sorted_keys[i], keys[data[i]]);
+      if (i > 0) {
+        TS_ASSERT_LESS_THAN_EQUALS(sorted_keys[i - 1], sorted_keys[i]);
+        // radix sort is stable
+        if (sorted_keys[i - 1] == sorted_keys[i]) {
+          TS_ASSERT_LESS_THAN(data[i - 1], data[i]);
+        }
+      }
+    }
+  }
+
+  void test_radix_sort(void) {
+    helper_radix_sort<int>(0, 100);
+    helper_radix_sort<int>(-1000, 1000);
+    helper_radix_sort<int>(std::numeric_limits<int>::min(),
+                           std::numeric_limits<int>::max());
+    helper_radix_sort<unsigned int>(0,
+                                    std::numeric_limits<unsigned int>::max());
+    helper_radix_sort<size_t>(1000, 1000);
+    helper_radix_sort<size_t>(0, std::numeric_limits<size_t>::max());
+    helper_radix_sort<long>(-5, 5);
+  }
+
   void test_low_rank(void) {
 #ifdef HAVE_EIGEN
     const unsigned int D = 2;